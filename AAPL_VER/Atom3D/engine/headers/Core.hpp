@@ -21,17 +21,28 @@
 #include <QuartzCore/CAMetalLayer.h>
 #include <QuartzCore/QuartzCore.hpp>
 
-#include <simd/simd.h>
+#include <dispatch/dispatch.h>
 
 #include "VertexData.hpp"
-#include "Texture.hpp"
+#include "MeshImporter.hpp"
+#include "MeshOptimizer.hpp"
+#include "FrustumCulling.hpp"
+#include "JobSystem.hpp"
+#include "Object.hpp"
+#include "SceneComponents.hpp"
+#include "TransformHierarchy.hpp"
+#include "TextureLoader.hpp"
+#include "UploadRing.hpp"
 
 #include "stb_image.h"
 
-#include "AAPLMathUtilities.h"
-
+#include <chrono>
+#include <cstdio>
 #include <iostream>
 #include <filesystem>
+#include <numeric>
+#include <string>
+#include <vector>
 
 namespace Atom {
     
@@ -43,6 +54,11 @@ public:
     void run();
     void cleanup();
     void setSize(float, float);
+    // Texture coordinate encoding of meshes created after the call.
+    void setUVFormat(UVFormat);
+    // Mesh file (.obj, .gltf, .glb) init() draws instead of the cube, cooked into
+    // kMeshCacheDirectory the first time.
+    void setMesh(const std::string&);
 private:
     void initDevice();
     void initWindow();
@@ -51,6 +67,8 @@ private:
     void createSquare();
     void createCube();
     void createCubeIndexed();
+    void createMeshFromFile();
+    void createPackedVertexBuffer(const VertexData*, size_t, const uint32_t*, size_t);
     
     void createDefaultLib();
     void createCommandQueue();
@@ -63,6 +81,7 @@ private:
     void updateRenderPassDescriptor();
     
     void encodeRenderCommand(MTL::RenderCommandEncoder*);
+    void cullDraws(const float4x4& viewProj);
     void draw();
     
     static void frameBufferSizeCallback(GLFWwindow*, int, int);
@@ -80,18 +99,55 @@ private:
     MTL::RenderPipelineState* mRenderPipelineState;
     
     MTL::Buffer* mVertexBuffer;
-    MTL::Buffer* mTransformBuffer;
-    MTL::Buffer* mIndexBuffer;
+    UploadRing mUploadRing;
+    MTL::Buffer* mIndexBuffer = nullptr;
+    NS::UInteger mVertexCount = 0;
+    NS::UInteger mIndexCount = 0;
+    MTL::IndexType mIndexType = MTL::IndexTypeUInt16;
+    VertexQuantization mVertexQuantization = {};
+    UVFormat mUVFormat = UVFormat::Half;
     MTL::DepthStencilState* mDepthStencilState;
     MTL::RenderPassDescriptor* mRenderPassDescriptor;
     MTL::Texture* mMSAARenderTargetTexture;
     MTL::Texture* mDepthTexture;
     
-    Texture* mTexture;
+    VirtualFileSystem mFiles;
+    TextureLoader mTextures;
+    TextureHandle mTexture = 0;
+    // The whole of mTexture, an atlas handle's draws set their image's region (TextureLoader::region).
+    TextureRegion mTextureRegion = { {1.0f, 1.0f}, {0.0f, 0.0f}, 0 };
+    std::string mMeshPath;
+    
+    World mWorld;
+    TransformHierarchy mHierarchy;
+    Object mObject;
+    TransformHierarchy::Node mObjectNode = TransformHierarchy::NO_NODE;
     
-    simd_float2 mViewSize = {800, 800};
+    // Mesh space box of the one mesh, from mVertexQuantization.
+    Bounds mMeshBounds = {};
+    // This frame's draws and their world boxes, culled against the view before encoding.
+    std::vector<float4x4> mDrawMatrices;
+    std::vector<TextureHandle> mDrawTextures;
+    CullBoxesSoA mDrawBounds;
+    std::vector<uint32_t> mVisibleDraws;
+    CullStats mCullStats;
+    double mCullStatsShownAt = 0;
+    
+    float2 mViewSize = {800, 800};
         
     int mSampleCount = 4;
+    
+    // Frames the CPU may run ahead of the GPU, each gets its own slice of mUploadRing.
+    static constexpr uint32_t kMaxFramesInFlight = 3;
+    static constexpr NS::UInteger kUploadRingSize = 1 << 20;
+    static constexpr const char* kMeshCacheDirectory = "engine/assets/cooked";
+    static constexpr const char* kAssetPack = "engine/assets.apak";
+    // GPU memory for textures and how much of it one frame may stream in.
+    static constexpr uint64_t kTextureBudget = 256ull << 20;
+    static constexpr uint64_t kTextureUploadLimit = 16ull << 20;
+    static constexpr TextureOptions kStreamedTexture = { MipGeneration::Kaiser, true, true };
+    dispatch_semaphore_t mFrameSemaphore;
+    uint32_t mFrameIndex = 0;
 };
     
 };
@@ -8,14 +8,45 @@
 #ifndef Object_hpp
 #define Object_hpp
 
+#include "Ecs.hpp"
+
 namespace Atom {
 
+// Handle to an entity of a World, for code that deals with one object at a time. It doesn't own
+// the entity, copies refer to the same one and destroy() ends it for all of them. Systems that
+// touch many objects should query the World instead.
 class Object {
 public:
     Object() = default;
+    // A new entity without components.
+    explicit Object(World& world) : mWorld(&world), mEntity(world.create()) {}
+    Object(World& world, Entity entity) : mWorld(&world), mEntity(entity) {}
     
-private:
+    // Sets the component, adding it first if need be, and returns it.
+    template<class T>
+    T& add(const T& component = {}) {
+        mWorld->add(mEntity, component);
+        return *mWorld->get<T>(mEntity);
+    }
+    
+    template<class T>
+    void remove() { mWorld->remove<T>(mEntity); }
+    
+    // nullptr if it doesn't have one, valid until the World's next structural change.
+    template<class T>
+    T* get() const { return mWorld ? mWorld->get<T>(mEntity) : nullptr; }
     
+    template<class T>
+    bool has() const { return mWorld && mWorld->has<T>(mEntity); }
+    
+    bool alive() const { return mWorld && mWorld->alive(mEntity); }
+    void destroy() { if (mWorld) mWorld->destroy(mEntity); }
+    
+    Entity entity() const { return mEntity; }
+    
+private:
+    World* mWorld = nullptr;
+    Entity mEntity;
 };
 
 }
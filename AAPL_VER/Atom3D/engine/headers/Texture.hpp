@@ -11,18 +11,70 @@
 #pragma once
 #include <Metal/Metal.hpp>
 #include "stb_image.h"
+#include "DdsTexture.hpp"
+#include "MipChain.hpp"
 #include <iostream>
+#include <string>
+#include <vector>
 
 namespace Atom {
 
+enum class MipGeneration {
+    None,   // Level 0 only
+    Box,    // On the CPU, MipFilter::Box
+    Kaiser, // On the CPU, MipFilter::Kaiser
+    GPU     // Blit encoder generateMipmaps, needs a command queue
+};
+
+struct TextureOptions {
+    MipGeneration mips = MipGeneration::Kaiser;
+    // Color data, downsampled in linear light. Off for data textures like normal maps.
+    bool srgb = true;
+    // Only the levels draws request stay in GPU memory, under the TextureLoader's budget. Images get
+    // CPU mips (Box if asked for, Kaiser otherwise) kept in memory, cooked .dds files stay mapped.
+    bool stream = false;
+};
+
+// One level in memory, what textures are built from.
+struct TextureLevelData {
+    uint32_t width;
+    uint32_t height;
+    const uint8_t* data;
+};
+
+// Every texture is a 2D array, most of them with one layer, so the shader samples atlases, arrays
+// and plain textures alike.
 class Texture {
 public:
-    Texture(const char*, MTL::Device*);
+    // RGBA8 texture from tightly packed pixels, top row first, a single level.
+    Texture(MTL::Device*, const unsigned char* pixels, int width, int height);
+    // RGBA8 texture with every level of chain.
+    Texture(MTL::Device*, const MipChain& chain);
+    // Cooked texture, every level and layer in the file's format straight from the mapping.
+    Texture(MTL::Device*, const DdsTexture& dds);
+    // levelCount levels of format, finest first, each half the one before it. Array textures pass
+    // layerCount layers of levelCount levels one after the other.
+    Texture(MTL::Device*, TextureFormat format, const TextureLevelData* levels, int levelCount, int layerCount = 1);
     ~Texture();
+    
+    // Decodes an image file's contents (name only goes into errors and picks the decoder) into a new
+    // texture with mips as options say, .dds files (see the cooktexture tool) are uploaded as they are
+    // and ignore options. Returns nullptr with the reason in error instead of exiting, and is safe to
+    // call from any thread. GPU mips wait for their blit on the calling thread, without a queue they
+    // fall back to Box.
+    static Texture* load(const char* name, const uint8_t* data, size_t size, MTL::Device*, std::string& error, const TextureOptions& = {}, MTL::CommandQueue* = nullptr);
+    
     MTL::Texture* texture;
     int width, height, channels;
+    int mipLevels;
+    int layers;
+    TextureFormat format;
     
 private:
+    Texture(MTL::Device*, MTL::Texture*, int width, int height, int mipLevels);
+    
+    static MTL::Texture* newGPUMipmapped(MTL::Device*, MTL::CommandQueue*, const unsigned char* pixels, int width, int height, bool srgb);
+    
     MTL::Device* mDevice;
 };
 
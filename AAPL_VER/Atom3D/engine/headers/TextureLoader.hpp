@@ -0,0 +1,148 @@
+//
+//  TextureLoader.hpp
+//  Atom3D
+//
+
+#ifndef TextureLoader_hpp
+#define TextureLoader_hpp
+
+#pragma once
+#include <Metal/Metal.hpp>
+
+#include "AsyncTasks.hpp"
+#include "Texture.hpp"
+#include "TextureAtlas.hpp"
+#include "TextureResidency.hpp"
+#include "VirtualFileSystem.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace Atom {
+
+using TextureHandle = uint32_t;
+
+enum class TextureState {
+    Loading,
+    Ready,
+    Failed
+};
+
+// Reads (through files), decodes, mipmaps and uploads textures on the runAsync threads. load() returns a handle straight away and the
+// handle draws as a grey checker until update() swaps the real texture in. A failed load keeps the
+// checker and is reported from update(), it never exits. Everything but the jobs is render thread only.
+// Streamed textures (TextureOptions::stream) start with their levels of kStreamTailSize and down, draws
+// request() the level they need and update() streams levels in and out under the budget.
+class TextureLoader {
+public:
+    TextureLoader() = default;
+    ~TextureLoader();
+    
+    // files has to outlive the loader and have everything mounted by now.
+    void init(MTL::Device*, const VirtualFileSystem& files);
+    
+    // path is an asset name for files. Loading the same path again returns the first handle, whatever
+    // its options.
+    TextureHandle load(const std::string& path, const TextureOptions& = {});
+    
+    // Once per frame. Publishes the loads that finished since the last call, writes failures to
+    // std::cerr and returns how many finished. Then rebuilds the streamed textures whose resident
+    // levels changed for the request()s since the last call.
+    size_t update();
+    
+    // GPU memory for textures, every texture counts, only streamed ones give levels up. 0 for no budget.
+    void setBudget(uint64_t bytes) { mResidency.setBudget(bytes); }
+    // Bytes one update() streams in at most, 0 for no limit.
+    void setUploadLimit(uint64_t bytes) { mResidency.setUploadLimit(bytes); }
+    
+    // The frame draws handle and samples levels mip.. (see mipForFootprint). Ignored until it's Ready.
+    void request(TextureHandle, float mip);
+    // Same with the mip for a footprint of that many pixels across, see screenFootprint.
+    void requestFootprint(TextureHandle, float pixels);
+    
+    // A cooked atlas or array (see the cookatlas tool), path without the extension. Loads path.dds like
+    // load() and reads path.atlas straight away, region() finds the images in it.
+    TextureHandle loadAtlas(const std::string& path, const TextureOptions& = {});
+    // Region of the image called name in an atlas handle, nullptr if there's none.
+    const AtlasRegion* region(TextureHandle, std::string_view name) const;
+    
+    // Blocks until nothing is loading, then publishes everything.
+    void waitAll();
+    
+    MTL::Texture* texture(TextureHandle) const;
+    TextureState state(TextureHandle) const;
+    const std::string& error(TextureHandle) const;
+    size_t loadingCount() const { return mLoading; }
+    
+    // Only for Ready handles.
+    TextureResidencyStats residency(TextureHandle) const;
+    const TextureResidencyTotals& residencyTotals() const { return mResidency.totals(); }
+    
+    // Levels this size and smaller stay resident whatever the budget.
+    static constexpr uint32_t kStreamTailSize = 64;
+    
+private:
+    // Every level of a streamed texture, a cooked file kept open or a mip chain decoded from an image.
+    struct StreamSource {
+        AssetFile file;
+        DdsTexture dds;
+        MipChain chain;
+        TextureFormat format = TextureFormat::RGBA8;
+        // Every level of the first layer, then of the next.
+        std::vector<TextureLevelData> levels;
+        uint32_t layers = 1;
+        
+        uint32_t levelCount() const { return static_cast<uint32_t>(levels.size()) / layers; }
+    };
+    
+    struct Slot {
+        std::string path;
+        Texture* texture = nullptr;
+        TextureState state = TextureState::Loading;
+        std::string error;
+        std::unique_ptr<StreamSource> source;
+        TextureResidency::Id residency = 0;
+        // Regions only, the layers are in texture.
+        TextureAtlas atlas;
+    };
+    
+    // Handed from the jobs to update().
+    struct Finished {
+        TextureHandle handle;
+        Texture* texture;
+        std::string error;
+        std::unique_ptr<StreamSource> source;
+    };
+    
+    void decode(TextureHandle, const std::string& path, const TextureOptions&);
+    std::unique_ptr<StreamSource> decodeStreamed(const std::string& path, AssetFile file, const TextureOptions&, std::string& error) const;
+    Texture* newStreamed(const StreamSource&, uint32_t firstMip) const;
+    
+    MTL::Device* mDevice = nullptr;
+    const VirtualFileSystem* mFiles = nullptr;
+    // For MipGeneration::GPU blits, separate from the frame's queue.
+    MTL::CommandQueue* mCommandQueue = nullptr;
+    Texture* mPlaceholder = nullptr;
+    std::vector<Slot> mSlots;
+    std::unordered_map<std::string, TextureHandle> mHandles;
+    size_t mLoading = 0;
+    TextureResidency mResidency;
+    // Slot of each residency id.
+    std::vector<TextureHandle> mResidencyHandles;
+    
+    std::mutex mMutex;
+    std::condition_variable mJobDone;
+    std::vector<Finished> mFinished;
+    size_t mJobsRunning = 0;
+    bool mCancelled = false;
+};
+
+}
+
+#endif /* TextureLoader_hpp */
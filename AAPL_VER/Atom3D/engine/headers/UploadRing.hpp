@@ -0,0 +1,56 @@
+//
+//  UploadRing.hpp
+//  Atom3D
+//
+
+#ifndef UploadRing_hpp
+#define UploadRing_hpp
+
+#pragma once
+#include <Metal/Metal.hpp>
+
+#include "RingAllocator.hpp"
+
+#include <cstring>
+
+namespace Atom {
+
+struct UploadAllocation {
+    MTL::Buffer* buffer = nullptr;
+    NS::UInteger offset = 0;
+    void* contents = nullptr;
+};
+
+// One shared MTL::Buffer split between frames in flight. Per-draw data (transforms, dynamic vertices,
+// texture staging) is bumped out of the current frame, and Core::draw hands the frame's space back once
+// the command buffer that read it has completed.
+class UploadRing {
+public:
+    UploadRing() = default;
+    ~UploadRing();
+    
+    void init(MTL::Device*, NS::UInteger size, uint32_t frameSlots);
+    void beginFrame(uint32_t slot);
+    
+    UploadAllocation allocate(NS::UInteger size, NS::UInteger alignment = CONSTANT_ALIGNMENT);
+    
+    template<typename T>
+    UploadAllocation upload(const T& data, NS::UInteger alignment = CONSTANT_ALIGNMENT) {
+        auto a = allocate(sizeof(T), alignment);
+        memcpy(a.contents, &data, sizeof(T));
+        return a;
+    }
+    
+    MTL::Buffer* buffer() const { return mBuffer; }
+    
+    // Constant address space buffer offsets have to be 256 byte aligned on macOS.
+    static constexpr NS::UInteger CONSTANT_ALIGNMENT = 256;
+    
+private:
+    MTL::Buffer* mBuffer = nullptr;
+    RingAllocator mRing;
+};
+
+}
+
+#endif /* UploadRing_hpp */
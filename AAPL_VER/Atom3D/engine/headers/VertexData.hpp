@@ -8,9 +8,20 @@
 #ifndef VertexData_h
 #define VertexData_h
 
+// The shader compiler only sees its own simd types, the host side uses AtomMath with the same layout.
+#ifdef __METAL_VERSION__
 #include <simd/simd.h>
 
 using namespace simd;
+#else
+#include "AtomMath.hpp"
+#include "MeshBuilder.hpp"
+#include "VertexQuantization.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#endif
 
 namespace Atom {
 
@@ -19,6 +30,30 @@ struct VertexData {
     float2 textureCoords;
 };
 
+// 16 byte vertex the engine draws with, VertexData is only the source format meshes are built in.
+// Decoded in the vertex shader with the mesh's VertexQuantization.
+struct PackedVertexData {
+    ushort4 position;      // xyz unorm16 inside the mesh bounds, w unused
+    ushort2 textureCoords; // half floats or unorm16, see VertexQuantization::uvFormat
+    short2 normal;         // Octahedral, snorm16
+};
+
+struct VertexQuantization {
+    float4 positionScale;
+    float4 positionOffset;
+    float2 uvScale;
+    float2 uvOffset;
+    uint32_t uvFormat;     // Atom::UVFormat, 0 half, 1 unorm16
+};
+
+// Where a draw's image sits in its texture, see TextureAtlas. UVs become uv * uvScale + uvOffset on
+// layer, plain textures use a scale of 1 and layer 0.
+struct TextureRegion {
+    float2 uvScale;
+    float2 uvOffset;
+    uint32_t layer;
+};
+
 struct TransformData {
     float4x4 modelMatrix;
     float4x4 viewMatrix;
@@ -27,4 +62,33 @@ struct TransformData {
 
 }
 
+#ifndef __METAL_VERSION__
+static_assert(sizeof(Atom::PackedVertexData) == sizeof(Atom::PackedVertex) &&
+              offsetof(Atom::PackedVertexData, normal) == offsetof(Atom::PackedVertex, normal), "Cooked meshes are uploaded as is");
+static_assert(sizeof(Atom::VertexQuantization) == sizeof(Atom::MeshQuantization), "Layout must match the shaders");
+
+// Welding support for MeshBuilder. Only the members are compared/hashed, VertexData has 8 bytes of
+// tail padding whose contents are unspecified.
+namespace Atom {
+
+inline bool operator==(const VertexData& a, const VertexData& b) {
+    return memcmp(&a.position, &b.position, sizeof a.position) == 0 &&
+           memcmp(&a.textureCoords, &b.textureCoords, sizeof a.textureCoords) == 0;
+}
+
+}
+
+namespace std {
+
+template<>
+struct hash<Atom::VertexData> {
+    size_t operator()(const Atom::VertexData& v) const noexcept {
+        float key[6] = { v.position.x, v.position.y, v.position.z, v.position.w, v.textureCoords.x, v.textureCoords.y };
+        return static_cast<size_t>(Atom::hashBytes(key, sizeof key));
+    }
+};
+
+}
+#endif
+
 #endif /* VertexData_h */
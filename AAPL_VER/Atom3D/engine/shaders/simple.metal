@@ -13,21 +13,43 @@ using namespace metal;
 struct VertexOut {
     float4 position [[position]];
     float2 textureCoords;
+    float3 normal;
+    uint layer [[flat]];
 };
 
+// Inverse of Atom::octEncode.
+static float3 octDecode(short2 encoded) {
+    float2 f = max(float2(encoded) / 32767.0f, -1.0f);
+    float3 n = float3(f, 1.0f - abs(f.x) - abs(f.y));
+    float t = max(-n.z, 0.0f);
+    n.xy += select(float2(t), float2(-t), n.xy >= 0.0f);
+    return normalize(n);
+}
+
 vertex VertexOut vertexShader(uint vertexId [[vertex_id]],
-                              constant Atom::VertexData* vData,
-                              constant Atom::TransformData* tData) {
+                              constant Atom::PackedVertexData* vData,
+                              constant Atom::TransformData* tData,
+                              constant Atom::VertexQuantization* qData,
+                              constant Atom::TextureRegion* rData) {
+    Atom::PackedVertexData v = vData[vertexId];
+    
+    float4 position = float4(qData->positionOffset.xyz + qData->positionScale.xyz * float3(v.position.xyz), 1.0f);
+    float2 textureCoords = qData->uvFormat == 0 ? float2(as_type<half2>(v.textureCoords))
+                                                : qData->uvOffset + qData->uvScale * float2(v.textureCoords);
+    
     VertexOut out;
-    out.position = tData->perspectiveMatrix * tData->viewMatrix * tData->modelMatrix * vData[vertexId].position;
-    out.textureCoords = vData[vertexId].textureCoords;
+    out.position = tData->perspectiveMatrix * tData->viewMatrix * tData->modelMatrix * position;
+    out.textureCoords = rData->uvOffset + rData->uvScale * textureCoords;
+    out.normal = (tData->modelMatrix * float4(octDecode(v.normal), 0.0f)).xyz;
+    out.layer = rData->layer;
     return out;
 }
 
 fragment float4 fragmentShader(VertexOut in [[stage_in]],
-                               texture2d<float> colorTexture [[texture(0)]]) {
-    constexpr sampler textureSampler(mag_filter::linear, mag_filter::linear);
+                               texture2d_array<float> colorTexture [[texture(0)]]) {
+    // Trilinear, textures come with their full mip chain.
+    constexpr sampler textureSampler(mag_filter::linear, min_filter::linear, mip_filter::linear);
     
-    const float4 colorSample = colorTexture.sample(textureSampler, in.textureCoords);
+    const float4 colorSample = colorTexture.sample(textureSampler, in.textureCoords, in.layer);
     return colorSample;
 }
@@ -11,10 +11,36 @@ namespace Atom {
     
 // Public Functions
 void Core::init() {
+    // Starts the job threads from here, so this thread is the one whose waits help with the work
+    // (culling, transforms and asset decode all go through parallelFor).
+    jobSystem();
+    
     initDevice();
     initWindow();
     
-    createCube();
+    // Loose files under the working directory, the asset pack (packassets) over them when there is one.
+    mFiles.mountDirectory(".");
+    mFiles.mountPack(kAssetPack);
+    mTextures.init(mDevice, mFiles);
+    mTextures.setBudget(kTextureBudget);
+    mTextures.setUploadLimit(kTextureUploadLimit);
+    
+    if (mMeshPath.empty())
+        createCubeIndexed();
+    else
+        createMeshFromFile();
+    
+    // Both mesh paths decode positions as offset + scale * raw ushort.
+    const float4 meshMin = mVertexQuantization.positionOffset;
+    const float4 meshMax = meshMin + mVertexQuantization.positionScale * 65535.0f;
+    mMeshBounds = { meshMin.xyz(), meshMax.xyz() };
+    
+    // The scene is one object, the mesh with the texture its create function loaded.
+    mObject = Object(mWorld);
+    mObject.add(WorldMatrix{});
+    mObject.add(Renderable{ 0, mTexture });
+    mObjectNode = mHierarchy.create(TransformHierarchy::NO_NODE, Transform{}, mObject.entity());
+    
     createBuffers();
     createDefaultLib();
     createCommandQueue();
@@ -35,19 +61,32 @@ void Core::run() {
 }
 
 void Core::cleanup() {
+    // Let the frames still in flight finish before anything they use goes away.
+    for (uint32_t i = 0; i < kMaxFramesInFlight; i++)
+        dispatch_semaphore_wait(mFrameSemaphore, DISPATCH_TIME_FOREVER);
+    
     glfwTerminate();
-    mTransformBuffer->release();
     mMSAARenderTargetTexture-> release();
     mDepthTexture->release();
     mRenderPassDescriptor->release();
+    mVertexBuffer->release();
+    if (mIndexBuffer)
+        mIndexBuffer->release();
     mDevice->release();
-    delete mTexture;
 }
 
 void Core::setSize(float x, float y) {
     mViewSize = {x, y};
 }
 
+void Core::setUVFormat(UVFormat format) {
+    mUVFormat = format;
+}
+
+void Core::setMesh(const std::string& path) {
+    mMeshPath = path;
+}
+
 
 // Init functions
 void Core::initDevice() {
@@ -84,7 +123,7 @@ void Core::initWindow() {
 
 // Meshes
 void Core::createTriangle() {
-    simd::float3 verts[] = {
+    float3 verts[] = {
         {-0.5f, -0.5f, 0.0f},
         { 0.5f, -0.5f, 0.0f},
         { 0.0f,  0.5f, 0.0f}
@@ -95,86 +134,160 @@ void Core::createTriangle() {
 
 void Core::createSquare() {
     VertexData verts[] {
-        {{-0.5, -0.5,  0.5, 1.0f}, {0.0f, 0.0f}},
-        {{-0.5,  0.5,  0.5, 1.0f}, {0.0f, 1.0f}},
-        {{ 0.5,  0.5,  0.5, 1.0f}, {1.0f, 1.0f}},
-        {{-0.5, -0.5,  0.5, 1.0f}, {0.0f, 0.0f}},
-        {{ 0.5,  0.5,  0.5, 1.0f}, {1.0f, 1.0f}},
-        {{ 0.5, -0.5,  0.5, 1.0f}, {1.0f, 0.0f}}
+        {{-0.5, -0.5,  0.5, 1.0f}, {0.0f, 1.0f}},
+        {{-0.5,  0.5,  0.5, 1.0f}, {0.0f, 0.0f}},
+        {{ 0.5,  0.5,  0.5, 1.0f}, {1.0f, 0.0f}},
+        {{-0.5, -0.5,  0.5, 1.0f}, {0.0f, 1.0f}},
+        {{ 0.5,  0.5,  0.5, 1.0f}, {1.0f, 0.0f}},
+        {{ 0.5, -0.5,  0.5, 1.0f}, {1.0f, 1.0f}}
     };
     
-    mVertexBuffer = mDevice->newBuffer(&verts, sizeof verts, MTL::ResourceStorageModeShared);
+    createPackedVertexBuffer(verts, sizeof verts / sizeof verts[0], nullptr, 0);
+    mVertexCount = sizeof verts / sizeof verts[0];
     
-    mTexture = new Texture("engine/assets/NickWiz.png", mDevice);
+    mTexture = mTextures.load("engine/assets/NickWiz.png", kStreamedTexture);
 }
 
+// 36 corner cube, 6 faces of 2 triangles, UVs from the top left like imported meshes. createCubeIndexed
+// welds it down to its 20 distinct corners.
+static const VertexData kCubeVertices[] = {
+    // Back face
+    {{-0.5, -0.5,  0.5, 1.0f},  {1.0f, 1.0f}}, // bottom-left  4
+    {{ 0.5, -0.5,  0.5, 1.0f},  {0.0f, 1.0f}}, // bottom-right 6
+    {{-0.5,  0.5,  0.5, 1.0f},  {1.0f, 0.0f}}, // top-left     5
+    {{ 0.5, -0.5,  0.5, 1.0f},  {0.0f, 1.0f}}, // bottom-right 6
+    {{ 0.5,  0.5,  0.5, 1.0f},  {0.0f, 0.0f}}, // top-right    7
+    {{-0.5,  0.5,  0.5, 1.0f},  {1.0f, 0.0f}}, // top-left     5
+                                                // Right face
+    {{ 0.5, -0.5,  0.5, 1.0f},  {1.0f, 1.0f}}, // bottom-right 6
+    {{ 0.5, -0.5, -0.5, 1.0f},  {0.0f, 1.0f}}, // bottom-right 2
+    {{ 0.5,  0.5,  0.5, 1.0f},  {1.0f, 0.0f}}, // top-right    7
+    {{ 0.5, -0.5, -0.5, 1.0f},  {0.0f, 1.0f}}, // bottom-right 2
+    {{ 0.5,  0.5, -0.5, 1.0f},  {0.0f, 0.0f}}, // bottom-right 6
+    {{ 0.5,  0.5,  0.5, 1.0f},  {1.0f, 0.0f}}, // top-right    3
+                                                // Front face
+    {{ 0.5, -0.5, -0.5, 1.0f},  {1.0f, 1.0f}}, // bottom-right 2
+    {{-0.5, -0.5, -0.5, 1.0f},  {0.0f, 1.0f}}, // bottom-left  0
+    {{ 0.5,  0.5, -0.5, 1.0f},  {1.0f, 0.0f}}, // top-right    3
+    {{-0.5, -0.5, -0.5, 1.0f},  {0.0f, 1.0f}}, // bottom-left  0
+    {{-0.5,  0.5, -0.5, 1.0f},  {0.0f, 0.0f}}, // top-left     1
+    {{ 0.5,  0.5, -0.5, 1.0f},  {1.0f, 0.0f}}, // top-right    3
+                                                // Left face
+    {{-0.5, -0.5, -0.5, 1.0f},  {1.0f, 1.0f}}, // bottom-left  0
+    {{-0.5, -0.5,  0.5, 1.0f},  {0.0f, 1.0f}}, // top-left     1
+    {{-0.5,  0.5, -0.5, 1.0f},  {1.0f, 0.0f}}, // top-left     5
+    {{-0.5, -0.5,  0.5, 1.0f},  {0.0f, 1.0f}}, // bottom-left  0
+    {{-0.5,  0.5,  0.5, 1.0f},  {0.0f, 0.0f}}, // top-left     5
+    {{-0.5,  0.5, -0.5, 1.0f},  {1.0f, 0.0f}}, // bottom-left  4
+                                                // Top face
+    {{ 0.5,  0.5, -0.5, 1.0f},  {1.0f, 1.0f}}, // top-left     5
+    {{-0.5,  0.5, -0.5, 1.0f},  {0.0f, 1.0f}}, // top-left     1
+    {{ 0.5,  0.5,  0.5, 1.0f},  {1.0f, 0.0f}}, // top-right    3
+    {{-0.5,  0.5, -0.5, 1.0f},  {0.0f, 1.0f}}, // top-left     5
+    {{-0.5,  0.5,  0.5, 1.0f},  {0.0f, 0.0f}}, // top-right    3
+    {{ 0.5,  0.5,  0.5, 1.0f},  {1.0f, 0.0f}}, // top-right    7
+                                                // Bottom face
+    {{ 0.5, -0.5,  0.5, 1.0f},  {1.0f, 1.0f}}, // bottom-left  0
+    {{-0.5, -0.5,  0.5, 1.0f},  {0.0f, 1.0f}}, // bottom-left  4
+    {{ 0.5, -0.5, -0.5, 1.0f},  {1.0f, 0.0f}}, // bottom-right 6
+    {{-0.5, -0.5,  0.5, 1.0f},  {0.0f, 1.0f}}, // bottom-left  0
+    {{-0.5, -0.5, -0.5, 1.0f},  {0.0f, 0.0f}}, // bottom-right 6
+    {{ 0.5, -0.5, -0.5, 1.0f},  {1.0f, 0.0f}}  // bottom-right 2
+};
+
 void Core::createCube() {
-    VertexData cubeVertices[] = {
-        // Back face
-        {{-0.5, -0.5,  0.5, 1.0f},  {1.0f, 0.0f}}, // bottom-left  4
-        {{ 0.5, -0.5,  0.5, 1.0f},  {0.0f, 0.0f}}, // bottom-right 6
-        {{-0.5,  0.5,  0.5, 1.0f},  {1.0f, 1.0f}}, // top-left     5
-        {{ 0.5, -0.5,  0.5, 1.0f},  {0.0f, 0.0f}}, // bottom-right 6
-        {{ 0.5,  0.5,  0.5, 1.0f},  {0.0f, 1.0f}}, // top-right    7
-        {{-0.5,  0.5,  0.5, 1.0f},  {1.0f, 1.0f}}, // top-left     5
-                                                    // Right face
-        {{ 0.5, -0.5,  0.5, 1.0f},  {1.0f, 0.0f}}, // bottom-right 6
-        {{ 0.5, -0.5, -0.5, 1.0f},  {0.0f, 0.0f}}, // bottom-right 2
-        {{ 0.5,  0.5,  0.5, 1.0f},  {1.0f, 1.0f}}, // top-right    7
-        {{ 0.5, -0.5, -0.5, 1.0f},  {0.0f, 0.0f}}, // bottom-right 2
-        {{ 0.5,  0.5, -0.5, 1.0f},  {0.0f, 1.0f}}, // bottom-right 6
-        {{ 0.5,  0.5,  0.5, 1.0f},  {1.0f, 1.0f}}, // top-right    3
-                                                    // Front face
-        {{ 0.5, -0.5, -0.5, 1.0f},  {1.0f, 0.0f}}, // bottom-right 2
-        {{-0.5, -0.5, -0.5, 1.0f},  {0.0f, 0.0f}}, // bottom-left  0
-        {{ 0.5,  0.5, -0.5, 1.0f},  {1.0f, 1.0f}}, // top-right    3
-        {{-0.5, -0.5, -0.5, 1.0f},  {0.0f, 0.0f}}, // bottom-left  0
-        {{-0.5,  0.5, -0.5, 1.0f},  {0.0f, 1.0f}}, // top-left     1
-        {{ 0.5,  0.5, -0.5, 1.0f},  {1.0f, 1.0f}}, // top-right    3
-                                                    // Left face
-        {{-0.5, -0.5, -0.5, 1.0f},  {1.0f, 0.0f}}, // bottom-left  0
-        {{-0.5, -0.5,  0.5, 1.0f},  {0.0f, 0.0f}}, // top-left     1
-        {{-0.5,  0.5, -0.5, 1.0f},  {1.0f, 1.0f}}, // top-left     5
-        {{-0.5, -0.5,  0.5, 1.0f},  {0.0f, 0.0f}}, // bottom-left  0
-        {{-0.5,  0.5,  0.5, 1.0f},  {0.0f, 1.0f}}, // top-left     5
-        {{-0.5,  0.5, -0.5, 1.0f},  {1.0f, 1.0f}}, // bottom-left  4
-                                                    // Top face
-        {{ 0.5,  0.5, -0.5, 1.0f},  {1.0f, 0.0f}}, // top-left     5
-        {{-0.5,  0.5, -0.5, 1.0f},  {0.0f, 0.0f}}, // top-left     1
-        {{ 0.5,  0.5,  0.5, 1.0f},  {1.0f, 1.0f}}, // top-right    3
-        {{-0.5,  0.5, -0.5, 1.0f},  {0.0f, 0.0f}}, // top-left     5
-        {{-0.5,  0.5,  0.5, 1.0f},  {0.0f, 1.0f}}, // top-right    3
-        {{ 0.5,  0.5,  0.5, 1.0f},  {1.0f, 1.0f}}, // top-right    7
-                                                    // Bottom face
-        {{ 0.5, -0.5,  0.5, 1.0f},  {1.0f, 0.0f}}, // bottom-left  0
-        {{-0.5, -0.5,  0.5, 1.0f},  {0.0f, 0.0f}}, // bottom-left  4
-        {{ 0.5, -0.5, -0.5, 1.0f},  {1.0f, 1.0f}}, // bottom-right 6
-        {{-0.5, -0.5,  0.5, 1.0f},  {0.0f, 0.0f}}, // bottom-left  0
-        {{-0.5, -0.5, -0.5, 1.0f},  {0.0f, 1.0f}}, // bottom-right 6
-        {{ 0.5, -0.5, -0.5, 1.0f},  {1.0f, 1.0f}}  // bottom-right 2
-    };
+    createPackedVertexBuffer(kCubeVertices, sizeof kCubeVertices / sizeof kCubeVertices[0], nullptr, 0);
+    mVertexCount = sizeof kCubeVertices / sizeof kCubeVertices[0];
     
-    mVertexBuffer = mDevice->newBuffer(&cubeVertices, sizeof cubeVertices, MTL::ResourceStorageModeShared);
-    
-    mTexture = new Texture("engine/assets/mc_grass.jpeg", mDevice);
+    mTexture = mTextures.load("engine/assets/mc_grass.jpeg", kStreamedTexture);
 }
 
 void Core::createCubeIndexed() {
-    VertexData cubeVerts[] = {
-        {{-0.5, -0.5,  0.5, 1.0}, {0.0f, 0.0f}}, // Bottom left front
-        {{ 0.5, -0.5,  0.5, 1.0}, {1.0f, 0.0f}}, // Bottom right front
-        {{-0.5,  0.5,  0.5, 1.0}, {0.0f, 1.0f}}, // Top left front
-        {{ 0.5,  0.5,  0.5, 1.0}, {1.0f, 1.0f}}, // Top Right front
-    };
+    MeshBuilder<VertexData> builder;
+    builder.addTriangles(kCubeVertices, sizeof kCubeVertices / sizeof kCubeVertices[0]);
     
-    uint32_t indices[] = {
-        0, 1, 2, 2, 3, 0,
-        
-    };
+    IndexedMesh<VertexData> mesh = builder.build();
+    optimizeMesh(mesh, offsetof(VertexData, position));
+    
+    const std::vector<uint32_t> indices = mesh.indices();
+    createPackedVertexBuffer(mesh.vertices.data(), mesh.vertices.size(), indices.data(), indices.size());
+    mIndexBuffer = mDevice->newBuffer(mesh.indexData.data(), mesh.indexBytes(), MTL::ResourceStorageModeShared);
+    mVertexCount = mesh.vertices.size();
+    mIndexCount = mesh.indexCount;
+    mIndexType = mesh.indexFormat == IndexFormat::UInt16 ? MTL::IndexTypeUInt16 : MTL::IndexTypeUInt32;
+    
+    mTexture = mTextures.load("engine/assets/mc_grass.jpeg", kStreamedTexture);
+}
+
+// Cooked meshes are already PackedVertexData and 16/32 bit indices, both go straight from the mapping
+// into the buffers.
+void Core::createMeshFromFile() {
+    CookedMesh mesh;
+    
+    try {
+        mesh = loadMesh(mMeshPath, kMeshCacheDirectory, mUVFormat);
+    } catch (const std::exception& e) {
+        std::cerr << e.what();
+        std::exit(-1);
+    }
+    
+    mVertexBuffer = mDevice->newBuffer(mesh.vertices(), mesh.vertexBytes(), MTL::ResourceStorageModeShared);
+    mIndexBuffer = mDevice->newBuffer(mesh.indexData(), mesh.indexBytes(), MTL::ResourceStorageModeShared);
+    mVertexCount = mesh.vertexCount();
+    mIndexCount = mesh.indexCount();
+    mIndexType = mesh.indexFormat() == IndexFormat::UInt16 ? MTL::IndexTypeUInt16 : MTL::IndexTypeUInt32;
+    
+    // The shader takes raw ushorts, hence the / 65535. No scene yet, so the decode also centers the
+    // mesh and scales its longest side to the cube's.
+    const auto& q = mesh.quantization();
+    const float extent = std::max({ q.positionScale.x, q.positionScale.y, q.positionScale.z, 1e-6f });
+    
+    mVertexQuantization.positionScale = { q.positionScale.x / extent / 65535.0f, q.positionScale.y / extent / 65535.0f, q.positionScale.z / extent / 65535.0f, 0.0f };
+    mVertexQuantization.positionOffset = { -0.5f * q.positionScale.x / extent, -0.5f * q.positionScale.y / extent, -0.5f * q.positionScale.z / extent, 1.0f };
+    mVertexQuantization.uvScale = { q.uvScale.x / 65535.0f, q.uvScale.y / 65535.0f };
+    mVertexQuantization.uvOffset = q.uvOffset;
+    mVertexQuantization.uvFormat = q.uvFormat;
+    
+    mTexture = mTextures.load("engine/assets/mc_grass.jpeg", kStreamedTexture);
+}
+
+// Quantizes vertices into PackedVertexData, half the size of VertexData, and keeps what the vertex
+// shader needs to decode them in mVertexQuantization. No indices means a plain triangle list.
+void Core::createPackedVertexBuffer(const VertexData* vertices, size_t count, const uint32_t* indices, size_t indexCount) {
+    std::vector<uint32_t> listIndices;
+    
+    if (!indices) {
+        listIndices.resize(count);
+        std::iota(listIndices.begin(), listIndices.end(), 0u);
+        indices = listIndices.data();
+        indexCount = count;
+    }
+    
+    const auto positions = positionQuantization(&vertices[0].position.x, count, sizeof(VertexData));
+    const auto uvs = uvQuantization(&vertices[0].textureCoords.x, count, sizeof(VertexData), mUVFormat);
+    const auto normals = computeVertexNormals(&vertices[0].position.x, count, sizeof(VertexData), indices, indexCount);
+    
+    std::vector<PackedVertexData> packed(count);
+    
+    for (size_t i = 0; i < count; i++) {
+        const auto& v = vertices[i];
+        packed[i].position = quantizePosition(positions, v.position.x, v.position.y, v.position.z);
+        packed[i].textureCoords = quantizeUV(uvs, v.textureCoords.x, v.textureCoords.y);
+        packed[i].normal = octEncode(normals[i].x, normals[i].y, normals[i].z);
+    }
+    
+    mVertexBuffer = mDevice->newBuffer(packed.data(), packed.size() * sizeof(PackedVertexData), MTL::ResourceStorageModeShared);
+    
+    mVertexQuantization.positionScale = { positions.scale.x / 65535.0f, positions.scale.y / 65535.0f, positions.scale.z / 65535.0f, 0.0f };
+    mVertexQuantization.positionOffset = { positions.offset.x, positions.offset.y, positions.offset.z, 1.0f };
+    mVertexQuantization.uvScale = { uvs.scale.x / 65535.0f, uvs.scale.y / 65535.0f };
+    mVertexQuantization.uvOffset = uvs.offset;
+    mVertexQuantization.uvFormat = static_cast<uint32_t>(mUVFormat);
 }
 
 void Core::createBuffers() {
-    mTransformBuffer = mDevice->newBuffer(sizeof(TransformData), MTL::ResourceStorageModeShared);
+    mUploadRing.init(mDevice, kUploadRingSize, kMaxFramesInFlight);
+    mFrameSemaphore = dispatch_semaphore_create(kMaxFramesInFlight);
 }
 
 
@@ -234,12 +347,16 @@ void Core::createRenderPipeline() {
 }
 
 void Core::createDepthAndMSAATextures() {
+    // Sized to the drawable actually being rendered to, the layer size may already be ahead of it.
+    auto width = mMetalDrawable->texture()->width();
+    auto height = mMetalDrawable->texture()->height();
+    
     // MSAA setup
     auto msaaTextureDescriptor = MTL::TextureDescriptor::alloc()->init();
     msaaTextureDescriptor->setTextureType(MTL::TextureType2DMultisample);
     msaaTextureDescriptor->setPixelFormat(MTL::PixelFormatBGRA8Unorm);
-    msaaTextureDescriptor->setWidth(mMetalLayer.drawableSize.width);
-    msaaTextureDescriptor->setHeight(mMetalLayer.drawableSize.height);
+    msaaTextureDescriptor->setWidth(width);
+    msaaTextureDescriptor->setHeight(height);
     msaaTextureDescriptor->setSampleCount(mSampleCount);
     msaaTextureDescriptor->setUsage(MTL::TextureUsageRenderTarget);
     
@@ -249,8 +366,8 @@ void Core::createDepthAndMSAATextures() {
     auto depthStencilDescriptor = MTL::TextureDescriptor::alloc()->init();
     depthStencilDescriptor->setTextureType(MTL::TextureType2DMultisample);
     depthStencilDescriptor->setPixelFormat(MTL::PixelFormatDepth32Float);
-    depthStencilDescriptor->setWidth(mMetalLayer.drawableSize.width);
-    depthStencilDescriptor->setHeight(mMetalLayer.drawableSize.height);
+    depthStencilDescriptor->setWidth(width);
+    depthStencilDescriptor->setHeight(height);
     depthStencilDescriptor->setUsage(MTL::TextureUsageRenderTarget);
     depthStencilDescriptor->setSampleCount(mSampleCount);
     
@@ -290,6 +407,28 @@ void Core::updateRenderPassDescriptor() {
 
 // Actual Rendering Code/Frequently Called.
 void Core::draw() {
+    // Minimized or zero sized, nothing to draw into.
+    if (!mMetalDrawable)
+        return;
+    
+    // Wait for the GPU to finish the frame that last used this slot, then its upload space is free again.
+    dispatch_semaphore_wait(mFrameSemaphore, DISPATCH_TIME_FOREVER);
+    mUploadRing.beginFrame(mFrameIndex);
+    mFrameIndex = (mFrameIndex + 1) % kMaxFramesInFlight;
+    
+    // Textures decoded since the last frame replace their placeholders from this one on.
+    mTextures.update();
+    
+    // Size dependent attachments are rebuilt here, once per size change, instead of on every resize event.
+    // Frames still in flight keep the old ones alive, command buffers retain what they reference.
+    auto drawableTexture = mMetalDrawable->texture();
+    
+    if (mMSAARenderTargetTexture->width() != drawableTexture->width() || mMSAARenderTargetTexture->height() != drawableTexture->height()) {
+        mMSAARenderTargetTexture->release();
+        mDepthTexture->release();
+        createDepthAndMSAATextures();
+    }
+    
     mCommandBuffer = mCommandQueue->commandBuffer();
     
     updateRenderPassDescriptor();
@@ -298,33 +437,36 @@ void Core::draw() {
     encodeRenderCommand(rce);
     rce->endEncoding();
     
+    dispatch_semaphore_t frameSemaphore = mFrameSemaphore;
+    mCommandBuffer->addCompletedHandler([frameSemaphore](MTL::CommandBuffer*) {
+        dispatch_semaphore_signal(frameSemaphore);
+    });
+    
     mCommandBuffer->presentDrawable(mMetalDrawable);
     mCommandBuffer->commit();
-    mCommandBuffer->waitUntilCompleted();
 }
 
 void Core::encodeRenderCommand(MTL::RenderCommandEncoder* rce) {
-    matrix_float4x4 transMat = matrix4x4_translation(0, 0, 0);
-    
     float angleInDeg = glfwGetTime() / 2 * 90;
-    float angleInRad = angleInDeg * M_PI / 180;
-    matrix_float4x4 rotMat = matrix4x4_rotation(angleInRad, 0, -1, 0);
+    float angleInRad = angleInDeg * PI / 180;
+    Transform objectTransform;
+    objectTransform.rotation = quaternion(angleInRad, vector_make(0.0f, -1.0f, 0.0f));
+    mHierarchy.setLocal(mObjectNode, objectTransform);
     
-    matrix_float4x4 modelMat = matrix_identity_float4x4;
-    modelMat = simd_mul(transMat, rotMat);
+    // Only what moved since the last frame is recomputed and copied into the entities.
+    mHierarchy.update();
+    syncWorldMatrices(mHierarchy, mWorld);
     
     matrix_float4x4 viewMat = matrix4x4_translation(0, 0, 2);
     
     float aspectRatio = (mMetalLayer.frame.size.width / mMetalLayer.frame.size.height);
-    float fov = 90 * M_PI / 180; // In radians
+    float fov = 90 * PI / 180; // In radians
     
     // Clipping Planes
     float nearZ = 0.1f;
     float farZ = 1000.f;
     
     matrix_float4x4 perspectiveMat = matrix_perspective_left_hand(fov, aspectRatio, nearZ, farZ);
-    TransformData transData = { modelMat, viewMat, perspectiveMat };
-    memcpy(mTransformBuffer->contents(), &transData, sizeof transData); // Probably could move
     
     rce->setFrontFacingWinding(MTL::WindingClockwise);
     rce->setCullMode(MTL::CullModeBack);
@@ -332,13 +474,61 @@ void Core::encodeRenderCommand(MTL::RenderCommandEncoder* rce) {
     rce->setRenderPipelineState(mRenderPipelineState);
     rce->setDepthStencilState(mDepthStencilState);
     rce->setVertexBuffer(mVertexBuffer, 0, 0);
-    rce->setVertexBuffer(mTransformBuffer, 0, 1);
+    rce->setVertexBytes(&mVertexQuantization, sizeof mVertexQuantization, 2);
+    rce->setVertexBytes(&mTextureRegion, sizeof mTextureRegion, 3);
     
     auto type = MTL::PrimitiveTypeTriangle;
-    NS::UInteger vStart = 0;
-    NS::UInteger vCount = 36;
-    rce->setFragmentTexture(mTexture->texture, 0);
-    rce->drawPrimitives(type, vStart, vCount);
+    
+    cullDraws(matrix_multiply(perspectiveMat, viewMat));
+    
+    for (const uint32_t draw : mVisibleDraws) {
+        TransformData transData = { mDrawMatrices[draw], viewMat, perspectiveMat };
+        auto transforms = mUploadRing.upload(transData);
+        rce->setVertexBuffer(transforms.buffer, transforms.offset, 1);
+        
+        // The mesh is scaled to a unit cube 2 units in front of the camera, that's the texture's footprint.
+        mTextures.requestFootprint(mDrawTextures[draw], screenFootprint(1.0f, 2.0f, fov, static_cast<float>(mMSAARenderTargetTexture->height())));
+        rce->setFragmentTexture(mTextures.texture(mDrawTextures[draw]), 0);
+        
+        if (mIndexBuffer)
+            rce->drawIndexedPrimitives(type, mIndexCount, mIndexType, mIndexBuffer, 0);
+        else
+            rce->drawPrimitives(type, NS::UInteger(0), mVertexCount);
+    }
+}
+
+// Gathers every Renderable's matrix, texture and world box, then keeps the ones inside the view
+// in mVisibleDraws. Counts and time go to the window title once a second.
+void Core::cullDraws(const float4x4& viewProj) {
+    const auto start = std::chrono::steady_clock::now();
+    const size_t count = mWorld.count<const WorldMatrix, const Renderable>();
+    
+    mDrawMatrices.resize(count);
+    mDrawTextures.resize(count);
+    mDrawBounds.resize(count);
+    mVisibleDraws.resize(count);
+    
+    // Every Renderable is the one mesh for now, Renderable::mesh isn't looked at.
+    size_t i = 0;
+    mWorld.each<const WorldMatrix, const Renderable>([&](const WorldMatrix& world, const Renderable& renderable) {
+        mDrawMatrices[i] = world.matrix;
+        mDrawTextures[i] = renderable.texture;
+        mDrawBounds.set(i++, transformBounds(mMeshBounds, world.matrix));
+    });
+    
+    mVisibleDraws.resize(cullBoxes(extractFrustum(viewProj), mDrawBounds, mVisibleDraws.data()));
+    
+    mCullStats.visible = mVisibleDraws.size();
+    mCullStats.culled = count - mVisibleDraws.size();
+    mCullStats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    
+    if (glfwGetTime() - mCullStatsShownAt >= 1.0) {
+        mCullStatsShownAt = glfwGetTime();
+        
+        char title[128];
+        std::snprintf(title, sizeof title, "Atom3D - %zu visible, %zu culled, %.3f ms culling", mCullStats.visible, mCullStats.culled, mCullStats.ms);
+        glfwSetWindowTitle(mGlfwWindow, title);
+    }
 }
 
 
@@ -349,22 +539,9 @@ void Core::frameBufferSizeCallback(GLFWwindow* window, int width, int height) {
     woah->resizeFrameBuffer(width, height);
 }
 
+// Only resizes the layer, draw() picks up the new size lazily from the next drawable.
 void Core::resizeFrameBuffer(int width, int height) {
     mMetalLayer.drawableSize = CGSizeMake(width, height);
-    
-    if (mMSAARenderTargetTexture) {
-        mMSAARenderTargetTexture->release();
-        mMSAARenderTargetTexture = nullptr;
-    }
-    
-    if (mDepthTexture) {
-        mDepthTexture->release();
-        mDepthTexture = nullptr;
-    }
-    
-    createDepthAndMSAATextures();
-    mMetalDrawable = (__bridge CA::MetalDrawable*)[mMetalLayer nextDrawable];
-    updateRenderPassDescriptor();
 }
     
 }
@@ -7,20 +7,40 @@
 
 #include "Texture.hpp"
 
+#include <climits>
+#include <cstring>
+#include <strings.h>
+
 namespace Atom {
 
-Texture::Texture(const char* filePath, MTL::Device* devicePtr) {
-    mDevice = devicePtr;
-    
-    stbi_set_flip_vertically_on_load(true);
-    
-    unsigned char* image = stbi_load(filePath, &width, &height, &channels, STBI_rgb_alpha);
-    if (image == nullptr) {
-        std::cout << "Could not load image at " << filePath << "\n";
-        std::exit(-1);
+// The renderer works on sRGB encoded values throughout (the drawable isn't an sRGB format either), so
+// sRGB flagged files get the plain formats too and sample the same as images loaded with stb_image.
+static MTL::PixelFormat pixelFormat(TextureFormat format) {
+    switch (format) {
+        case TextureFormat::BC1: return MTL::PixelFormatBC1_RGBA;
+        case TextureFormat::BC3: return MTL::PixelFormatBC3_RGBA;
+        case TextureFormat::BC5: return MTL::PixelFormatBC5_RGUnorm;
+        case TextureFormat::BC7: return MTL::PixelFormatBC7_RGBAUnorm;
+        default: return MTL::PixelFormatRGBA8Unorm;
     }
+}
+
+static bool hasExtension(const char* filePath, const char* extension) {
+    const size_t length = strlen(filePath), extensionLength = strlen(extension);
+    return length >= extensionLength && strcasecmp(filePath + length - extensionLength, extension) == 0;
+}
+
+Texture::Texture(MTL::Device* devicePtr, const unsigned char* pixels, int w, int h) {
+    mDevice = devicePtr;
+    width = w;
+    height = h;
+    channels = 4;
+    mipLevels = 1;
+    layers = 1;
+    format = TextureFormat::RGBA8;
     
     MTL::TextureDescriptor* textureDesc = MTL::TextureDescriptor::alloc()->init();
+    textureDesc->setTextureType(MTL::TextureType2DArray);
     textureDesc->setPixelFormat(MTL::PixelFormatRGBA8Unorm);
     textureDesc->setWidth(width);
     textureDesc->setHeight(height);
@@ -30,14 +50,181 @@ Texture::Texture(const char* filePath, MTL::Device* devicePtr) {
     MTL::Region region = MTL::Region(0, 0, 0, width, height, 1);
     NS::UInteger bytesPerRow = 4 * width;
     
-    texture->replaceRegion(region, 0, image, bytesPerRow);
+    texture->replaceRegion(region, 0, 0, pixels, bytesPerRow, 0);
+    
+    textureDesc->release();
+}
+
+Texture::Texture(MTL::Device* devicePtr, const MipChain& chain) {
+    mDevice = devicePtr;
+    width = chain.levels[0].width;
+    height = chain.levels[0].height;
+    channels = 4;
+    mipLevels = static_cast<int>(chain.levels.size());
+    layers = 1;
+    format = TextureFormat::RGBA8;
+    
+    MTL::TextureDescriptor* textureDesc = MTL::TextureDescriptor::alloc()->init();
+    textureDesc->setTextureType(MTL::TextureType2DArray);
+    textureDesc->setPixelFormat(MTL::PixelFormatRGBA8Unorm);
+    textureDesc->setWidth(width);
+    textureDesc->setHeight(height);
+    textureDesc->setMipmapLevelCount(mipLevels);
+    
+    texture = mDevice->newTexture(textureDesc);
+    
+    for (int i = 0; i < mipLevels; i++) {
+        const MipLevel& level = chain.levels[i];
+        MTL::Region region = MTL::Region(0, 0, 0, level.width, level.height, 1);
+        
+        texture->replaceRegion(region, i, 0, chain.level(i), 4 * level.width, 0);
+    }
+    
+    textureDesc->release();
+}
+
+static std::vector<TextureLevelData> levelsOf(const DdsTexture& dds) {
+    std::vector<TextureLevelData> levels;
+    
+    for (size_t layer = 0; layer < dds.layerCount(); layer++)
+        for (size_t i = 0; i < dds.levelCount(); i++)
+            levels.push_back({ dds.level(i).width, dds.level(i).height, dds.levelData(i, layer) });
+    
+    return levels;
+}
+
+Texture::Texture(MTL::Device* devicePtr, const DdsTexture& dds)
+    : Texture(devicePtr, dds.format(), levelsOf(dds).data(), static_cast<int>(dds.levelCount()), static_cast<int>(dds.layerCount())) {
+}
+
+Texture::Texture(MTL::Device* devicePtr, TextureFormat levelFormat, const TextureLevelData* levels, int levelCount, int layerCount) {
+    mDevice = devicePtr;
+    width = levels[0].width;
+    height = levels[0].height;
+    channels = levelFormat == TextureFormat::BC1 ? 3 : levelFormat == TextureFormat::BC5 ? 2 : 4;
+    mipLevels = levelCount;
+    layers = layerCount;
+    format = levelFormat;
+    
+    MTL::TextureDescriptor* textureDesc = MTL::TextureDescriptor::alloc()->init();
+    textureDesc->setTextureType(MTL::TextureType2DArray);
+    textureDesc->setPixelFormat(pixelFormat(format));
+    textureDesc->setWidth(width);
+    textureDesc->setHeight(height);
+    textureDesc->setMipmapLevelCount(mipLevels);
+    textureDesc->setArrayLength(layers);
+    
+    texture = mDevice->newTexture(textureDesc);
+    
+    // Block formats take a row of 4x4 blocks as a row, levels under 4x4 still take whole blocks.
+    for (int layer = 0; layer < layers; layer++)
+        for (int i = 0; i < mipLevels; i++) {
+            const TextureLevelData& level = levels[layer * mipLevels + i];
+            MTL::Region region = MTL::Region(0, 0, 0, level.width, level.height, 1);
+            
+            texture->replaceRegion(region, i, layer, level.data, textureRowBytes(format, level.width), 0);
+        }
     
     textureDesc->release();
-    stbi_image_free(image);
+}
+
+Texture::Texture(MTL::Device* devicePtr, MTL::Texture* tex, int w, int h, int levels) {
+    mDevice = devicePtr;
+    texture = tex;
+    width = w;
+    height = h;
+    channels = 4;
+    mipLevels = levels;
+    layers = 1;
+    format = TextureFormat::RGBA8;
 }
 
 Texture::~Texture() {
     texture->release();
 }
 
+// Uploads level 0 and lets the blit encoder fill in the rest. It only filters in linear light for sRGB
+// formats, so sRGB images are created as RGBA8Unorm_sRGB and sampled through an RGBA8Unorm view,
+// the shader still gets the same values as from the CPU chain.
+MTL::Texture* Texture::newGPUMipmapped(MTL::Device* devicePtr, MTL::CommandQueue* queue, const unsigned char* pixels, int w, int h, bool srgb) {
+    MTL::TextureDescriptor* textureDesc = MTL::TextureDescriptor::alloc()->init();
+    textureDesc->setTextureType(MTL::TextureType2DArray);
+    textureDesc->setPixelFormat(srgb ? MTL::PixelFormatRGBA8Unorm_sRGB : MTL::PixelFormatRGBA8Unorm);
+    textureDesc->setWidth(w);
+    textureDesc->setHeight(h);
+    textureDesc->setMipmapLevelCount(mipLevelCount(w, h));
+    textureDesc->setUsage(MTL::TextureUsageShaderRead | MTL::TextureUsagePixelFormatView);
+    
+    MTL::Texture* mipmapped = devicePtr->newTexture(textureDesc);
+    mipmapped->replaceRegion(MTL::Region(0, 0, 0, w, h, 1), 0, 0, pixels, 4 * w, 0);
+    textureDesc->release();
+    
+    MTL::CommandBuffer* commandBuffer = queue->commandBuffer();
+    MTL::BlitCommandEncoder* blit = commandBuffer->blitCommandEncoder();
+    blit->generateMipmaps(mipmapped);
+    blit->endEncoding();
+    commandBuffer->commit();
+    commandBuffer->waitUntilCompleted();
+    
+    if (!srgb)
+        return mipmapped;
+    
+    // The view keeps its parent alive.
+    MTL::Texture* view = mipmapped->newTextureView(MTL::PixelFormatRGBA8Unorm);
+    mipmapped->release();
+    return view;
+}
+
+Texture* Texture::load(const char* name, const uint8_t* data, size_t size, MTL::Device* devicePtr, std::string& error, const TextureOptions& options, MTL::CommandQueue* queue) {
+    if (hasExtension(name, ".dds")) {
+        DdsTexture dds;
+        
+        if (!dds.parse(data, size)) {
+            error = std::string("Could not load texture at ") + name + ", not a supported DDS";
+            return nullptr;
+        }
+        
+        if (isBlockCompressed(dds.format()) && !devicePtr->supportsBCTextureCompression()) {
+            error = std::string("Could not load texture at ") + name + ", the GPU doesn't support " + textureFormatName(dds.format());
+            return nullptr;
+        }
+        
+        return new Texture(devicePtr, dds);
+    }
+    
+    // Top row first like DDS files. The per thread flag, the global one would race between loader threads.
+    stbi_set_flip_vertically_on_load_thread(false);
+    
+    int w, h, fileChannels;
+    unsigned char* image = size <= INT_MAX ? stbi_load_from_memory(data, static_cast<int>(size), &w, &h, &fileChannels, STBI_rgb_alpha) : nullptr;
+    if (image == nullptr) {
+        const char* reason = stbi_failure_reason();
+        error = std::string("Could not load image at ") + name + (reason ? std::string(", ") + reason : "");
+        return nullptr;
+    }
+    
+    MipGeneration mips = options.mips;
+    if (mips == MipGeneration::GPU && !queue)
+        mips = MipGeneration::Box;
+    
+    Texture* texture;
+    
+    switch (mips) {
+        case MipGeneration::None:
+            texture = new Texture(devicePtr, image, w, h);
+            break;
+        case MipGeneration::GPU:
+            texture = new Texture(devicePtr, newGPUMipmapped(devicePtr, queue, image, w, h, options.srgb), w, h, mipLevelCount(w, h));
+            break;
+        default:
+            texture = new Texture(devicePtr, generateMipChain(image, w, h, options.srgb, mips == MipGeneration::Box ? MipFilter::Box : MipFilter::Kaiser));
+            break;
+    }
+    
+    texture->channels = fileChannels;
+    
+    stbi_image_free(image);
+    return texture;
+}
+
 }
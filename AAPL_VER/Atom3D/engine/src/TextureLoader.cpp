@@ -0,0 +1,291 @@
+//
+//  TextureLoader.cpp
+//  Atom3D
+//
+
+#include "TextureLoader.hpp"
+
+#include <climits>
+#include <strings.h>
+
+namespace Atom {
+
+// First level of kStreamTailSize or smaller, the last one if none is.
+static uint32_t streamTailMip(const std::vector<TextureLevelData>& levels, uint32_t levelCount) {
+    uint32_t i = 0;
+    while (i + 1 < levelCount && std::max(levels[i].width, levels[i].height) > TextureLoader::kStreamTailSize)
+        i++;
+    return i;
+}
+
+TextureLoader::~TextureLoader() {
+    // Jobs still queued skip their decode, the ones already decoding are waited for.
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCancelled = true;
+    mJobDone.wait(lock, [this] { return mJobsRunning == 0; });
+    
+    for (auto& finished : mFinished)
+        delete finished.texture;
+    
+    for (auto& slot : mSlots)
+        delete slot.texture;
+    
+    delete mPlaceholder;
+    
+    if (mCommandQueue)
+        mCommandQueue->release();
+}
+
+void TextureLoader::init(MTL::Device* device, const VirtualFileSystem& files) {
+    mDevice = device;
+    mFiles = &files;
+    mCommandQueue = mDevice->newCommandQueue();
+    
+    // 8x8 grey checker, stands in for textures that are loading or failed.
+    uint32_t pixels[64];
+    for (int i = 0; i < 64; i++)
+        pixels[i] = ((i / 8 + i % 8) & 1) ? 0xFF808080 : 0xFFB0B0B0;
+    
+    mPlaceholder = new Texture(mDevice, reinterpret_cast<const unsigned char*>(pixels), 8, 8);
+}
+
+TextureHandle TextureLoader::load(const std::string& path, const TextureOptions& options) {
+    auto it = mHandles.find(path);
+    if (it != mHandles.end())
+        return it->second;
+    
+    const auto handle = static_cast<TextureHandle>(mSlots.size());
+    mSlots.push_back({ path });
+    mHandles.emplace(path, handle);
+    mLoading++;
+    
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mJobsRunning++;
+    }
+    
+    runAsync([this, handle, path, options] { decode(handle, path, options); });
+    
+    return handle;
+}
+
+TextureHandle TextureLoader::loadAtlas(const std::string& path, const TextureOptions& options) {
+    const TextureHandle handle = load(path + ".dds", options);
+    auto& slot = mSlots[handle];
+    
+    if (!slot.atlas.regions.empty())
+        return handle;
+    
+    // A few lines of text, not worth a job.
+    AssetFile file;
+    if (!mFiles->open(path + ".atlas", file) || !parseAtlas(reinterpret_cast<const char*>(file.data()), file.size(), slot.atlas))
+        std::cerr << "Could not load atlas at " << path << ".atlas\n";
+    
+    return handle;
+}
+
+// Runs on a runAsync thread. Creating and filling a texture is fine off the render thread, it only
+// becomes visible to draws once update() publishes it.
+void TextureLoader::decode(TextureHandle handle, const std::string& path, const TextureOptions& options) {
+    Finished finished = { handle, nullptr, {} };
+    
+    bool cancelled;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        cancelled = mCancelled;
+    }
+    
+    if (!cancelled) {
+        AssetFile file;
+        
+        if (mFiles->open(path, file)) {
+            NS::AutoreleasePool* pool = NS::AutoreleasePool::alloc()->init();
+            
+            if (options.stream) {
+                finished.source = decodeStreamed(path, std::move(file), options, finished.error);
+                
+                // Only the tail goes up front, update() hands the rest to mResidency.
+                if (finished.source)
+                    finished.texture = newStreamed(*finished.source, streamTailMip(finished.source->levels, finished.source->levelCount()));
+            } else {
+                finished.texture = Texture::load(path.c_str(), file.data(), file.size(), mDevice, finished.error, options, mCommandQueue);
+            }
+            
+            pool->release();
+        } else {
+            finished.error = "Could not load image at " + path + ", no such asset";
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(mMutex);
+    mFinished.push_back(std::move(finished));
+    mJobsRunning--;
+    mJobDone.notify_all();
+}
+
+std::unique_ptr<TextureLoader::StreamSource> TextureLoader::decodeStreamed(const std::string& path, AssetFile file, const TextureOptions& options, std::string& error) const {
+    auto source = std::make_unique<StreamSource>();
+    
+    if (path.size() >= 4 && strcasecmp(path.c_str() + path.size() - 4, ".dds") == 0) {
+        // Levels point into the file, which the source keeps open.
+        source->file = std::move(file);
+        
+        if (!source->dds.parse(source->file.data(), source->file.size())) {
+            error = "Could not load texture at " + path + ", not a supported DDS";
+            return nullptr;
+        }
+        
+        if (isBlockCompressed(source->dds.format()) && !mDevice->supportsBCTextureCompression()) {
+            error = "Could not load texture at " + path + ", the GPU doesn't support " + textureFormatName(source->dds.format());
+            return nullptr;
+        }
+        
+        source->format = source->dds.format();
+        source->layers = static_cast<uint32_t>(source->dds.layerCount());
+        
+        for (size_t layer = 0; layer < source->dds.layerCount(); layer++)
+            for (size_t i = 0; i < source->dds.levelCount(); i++)
+                source->levels.push_back({ source->dds.level(i).width, source->dds.level(i).height, source->dds.levelData(i, layer) });
+        
+        return source;
+    }
+    
+    // Top row first like Texture::load, with the per thread flag.
+    stbi_set_flip_vertically_on_load_thread(false);
+    
+    int w, h, fileChannels;
+    unsigned char* image = file.size() <= INT_MAX ? stbi_load_from_memory(file.data(), static_cast<int>(file.size()), &w, &h, &fileChannels, STBI_rgb_alpha) : nullptr;
+    if (image == nullptr) {
+        const char* reason = stbi_failure_reason();
+        error = "Could not load image at " + path + (reason ? std::string(", ") + reason : "");
+        return nullptr;
+    }
+    
+    source->chain = generateMipChain(image, w, h, options.srgb, options.mips == MipGeneration::Box ? MipFilter::Box : MipFilter::Kaiser);
+    stbi_image_free(image);
+    
+    for (size_t i = 0; i < source->chain.levels.size(); i++)
+        source->levels.push_back({ source->chain.levels[i].width, source->chain.levels[i].height, source->chain.level(i) });
+    
+    return source;
+}
+
+// Levels firstMip.. of every layer.
+Texture* TextureLoader::newStreamed(const StreamSource& source, uint32_t firstMip) const {
+    const uint32_t levelCount = source.levelCount();
+    std::vector<TextureLevelData> levels;
+    
+    for (uint32_t layer = 0; layer < source.layers; layer++)
+        levels.insert(levels.end(), source.levels.begin() + layer * levelCount + firstMip, source.levels.begin() + (layer + 1) * levelCount);
+    
+    return new Texture(mDevice, source.format, levels.data(), static_cast<int>(levelCount - firstMip), static_cast<int>(source.layers));
+}
+
+size_t TextureLoader::update() {
+    std::vector<Finished> finished;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        finished.swap(mFinished);
+    }
+    
+    for (auto& f : finished) {
+        auto& slot = mSlots[f.handle];
+        slot.texture = f.texture;
+        slot.state = f.texture ? TextureState::Ready : TextureState::Failed;
+        slot.error = std::move(f.error);
+        
+        if (!f.texture) {
+            std::cerr << slot.error << "\n";
+            continue;
+        }
+        
+        // Everything counts against the budget, textures that aren't streamed are pinned.
+        std::vector<uint64_t> levelBytes;
+        uint32_t tail = 0;
+        
+        // A level of an array texture is that level of every layer.
+        if (f.source) {
+            for (uint32_t i = 0; i < f.source->levelCount(); i++)
+                levelBytes.push_back(textureLevelBytes(f.source->format, f.source->levels[i].width, f.source->levels[i].height) * f.source->layers);
+            
+            tail = streamTailMip(f.source->levels, f.source->levelCount());
+            slot.source = std::move(f.source);
+        } else {
+            for (int i = 0; i < f.texture->mipLevels; i++)
+                levelBytes.push_back(textureLevelBytes(f.texture->format, std::max(1, f.texture->width >> i), std::max(1, f.texture->height >> i)) * f.texture->layers);
+        }
+        
+        slot.residency = mResidency.add(levelBytes, tail);
+        
+        if (mResidencyHandles.size() <= slot.residency)
+            mResidencyHandles.resize(slot.residency + 1);
+        mResidencyHandles[slot.residency] = f.handle;
+    }
+    
+    mLoading -= finished.size();
+    
+    // Streamed textures are rebuilt from their new finest level, the levels come from the source
+    // again rather than a blit from the old texture. Frames in flight keep the old one alive, command
+    // buffers retain what they reference.
+    for (const auto& change : mResidency.update()) {
+        auto& slot = mSlots[mResidencyHandles[change.id]];
+        
+        Texture* streamed = newStreamed(*slot.source, change.residentMip);
+        delete slot.texture;
+        slot.texture = streamed;
+    }
+    
+    return finished.size();
+}
+
+void TextureLoader::waitAll() {
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mJobDone.wait(lock, [this] { return mJobsRunning == 0; });
+    }
+    
+    update();
+}
+
+MTL::Texture* TextureLoader::texture(TextureHandle handle) const {
+    const auto& slot = mSlots[handle];
+    return slot.texture ? slot.texture->texture : mPlaceholder->texture;
+}
+
+void TextureLoader::request(TextureHandle handle, float mip) {
+    const auto& slot = mSlots[handle];
+    
+    if (slot.state == TextureState::Ready)
+        mResidency.request(slot.residency, mip);
+}
+
+void TextureLoader::requestFootprint(TextureHandle handle, float pixels) {
+    const auto& slot = mSlots[handle];
+    
+    if (slot.state != TextureState::Ready)
+        return;
+    
+    // The full size, a streamed texture's own is that of its finest resident level.
+    const uint32_t w = slot.source ? slot.source->levels[0].width : static_cast<uint32_t>(slot.texture->width);
+    const uint32_t h = slot.source ? slot.source->levels[0].height : static_cast<uint32_t>(slot.texture->height);
+    
+    mResidency.request(slot.residency, mipForFootprint(w, h, pixels));
+}
+
+const AtlasRegion* TextureLoader::region(TextureHandle handle, std::string_view name) const {
+    return mSlots[handle].atlas.find(name);
+}
+
+TextureResidencyStats TextureLoader::residency(TextureHandle handle) const {
+    return mResidency.stats(mSlots[handle].residency);
+}
+
+TextureState TextureLoader::state(TextureHandle handle) const {
+    return mSlots[handle].state;
+}
+
+const std::string& TextureLoader::error(TextureHandle handle) const {
+    return mSlots[handle].error;
+}
+
+}
@@ -0,0 +1,44 @@
+//
+//  UploadRing.cpp
+//  Atom3D
+//
+
+#include "UploadRing.hpp"
+
+#include <iostream>
+
+namespace Atom {
+
+UploadRing::~UploadRing() {
+    if (mBuffer)
+        mBuffer->release();
+}
+
+void UploadRing::init(MTL::Device* device, NS::UInteger size, uint32_t frameSlots) {
+    mBuffer = device->newBuffer(size, MTL::ResourceStorageModeShared | MTL::ResourceCPUCacheModeWriteCombined);
+    mBuffer->setLabel(NS::String::string("Upload Ring", NS::ASCIIStringEncoding));
+    
+    mRing.init(size, frameSlots);
+}
+
+void UploadRing::beginFrame(uint32_t slot) {
+    mRing.beginFrame(slot);
+}
+
+UploadAllocation UploadRing::allocate(NS::UInteger size, NS::UInteger alignment) {
+    auto offset = mRing.allocate(size, alignment);
+    
+    if (offset == RingAllocator::INVALID_OFFSET) {
+        std::cerr << "Upload ring out of space (" << mRing.capacity() << " bytes), increase kUploadRingSize.\n";
+        std::exit(-1);
+    }
+    
+    UploadAllocation a;
+    a.buffer = mBuffer;
+    a.offset = offset;
+    a.contents = static_cast<char*>(mBuffer->contents()) + offset;
+    
+    return a;
+}
+
+}
@@ -9,11 +9,15 @@
 
 #include <iostream>
 
-int main() {
+// Optional argument, a .obj/.gltf/.glb to draw instead of the cube.
+int main(int argc, const char* argv[]) {
     
     @autoreleasepool {
         Atom::Core engine;
         
+        if (argc > 1)
+            engine.setMesh(argv[1]);
+        
         engine.init();
         engine.run();
         engine.cleanup();
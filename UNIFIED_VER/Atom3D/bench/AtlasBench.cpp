@@ -0,0 +1,148 @@
+// ReSharper disable CppInconsistentNaming
+// Atlas packing and what it saves at draw time. Packs sets of small texture sizes (UI icons, a
+// mix of decals and props) with the skyline and MaxRects packers and prints how full the pages get
+// and how long packing takes. Then counts texture binding changes for a draw list of 10000 objects
+// over 300 small textures: drawn in list order, sorted by texture, and with the textures in an atlas
+// where draws only change a layer and UV region.
+#include "RectPacker.hpp"
+#include "TextureAtlas.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace Atom;
+
+static int gFailures = 0;
+
+static void check(bool condition, const char* what) {
+	if (!condition) {
+		std::printf("  FAILED: %s\n", what);
+		gFailures++;
+	}
+}
+
+static bool overlaps(const PackRect& a, const PackRect& b) {
+	return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+// Every placement inside its page and clear of the others on it.
+static bool valid(const std::vector<PackRect>& sizes, const std::vector<PackPlacement>& placements, uint32_t size) {
+	for (size_t i = 0; i < placements.size(); i++) {
+		const auto& p = placements[i];
+
+		if (p.page == UINT32_MAX || p.rect.width != sizes[i].width || p.rect.height != sizes[i].height || p.rect.x + p.rect.width > size || p.rect.y + p.rect.height > size)
+			return false;
+
+		for (size_t j = 0; j < i; j++)
+			if (placements[j].page == p.page && overlaps(placements[j].rect, p.rect))
+				return false;
+	}
+
+	return true;
+}
+
+static void pack(const char* name, const std::vector<PackRect>& sizes, uint32_t size) {
+	uint64_t area = 0;
+	for (const auto& s : sizes)
+		area += static_cast<uint64_t>(s.width) * s.height;
+
+	std::printf("%s: %zu rects, %.2f pages of area\n", name, sizes.size(), area / (static_cast<double>(size) * size));
+
+	for (const auto algorithm : { PackAlgorithm::Skyline, PackAlgorithm::MaxRects }) {
+		uint32_t pages = 0;
+		std::vector<PackPlacement> placements;
+
+		const auto start = std::chrono::steady_clock::now();
+		constexpr int runs = 5;
+		for (int i = 0; i < runs; i++)
+			placements = packRects(sizes, size, size, algorithm, &pages);
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / runs;
+
+		check(valid(sizes, placements, size), "placements fit their pages without overlapping");
+		std::printf("  %-8s %u pages, %5.1f%% full, %7.2f ms\n", algorithm == PackAlgorithm::Skyline ? "skyline" : "maxrects", pages, 100.0 * area / (static_cast<double>(size) * size * pages), seconds * 1e3);
+	}
+}
+
+// Binding changes drawing textures in order, counting the first bind.
+static int bindings(const std::vector<uint32_t>& textures) {
+	int changes = 0;
+	for (size_t i = 0; i < textures.size(); i++)
+		if (i == 0 || textures[i] != textures[i - 1])
+			changes++;
+	return changes;
+}
+
+static void draws() {
+	constexpr int textureCount = 300, drawCount = 10000;
+	std::mt19937 random(7);
+
+	// 16 to 256 pixel textures, the kind worth merging.
+	std::vector<std::vector<uint8_t>> pixels(textureCount);
+	std::vector<AtlasImage> images;
+
+	for (int i = 0; i < textureCount; i++) {
+		const uint32_t w = 16u << random() % 5, h = 16u << random() % 5;
+		pixels[i].assign(static_cast<size_t>(w) * h * 4, static_cast<uint8_t>(i));
+		images.push_back({ "texture" + std::to_string(i), pixels[i].data(), w, h });
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	const TextureAtlas atlas = buildAtlas(images);
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// Every region holds its own image, padding included.
+	bool intact = atlas.regions.size() == images.size();
+	for (size_t i = 0; intact && i < atlas.regions.size(); i++) {
+		const auto& r = atlas.regions[i];
+		const auto& layer = atlas.layers[r.layer];
+		const int texture = std::stoi(r.name.substr(7));
+
+		for (uint32_t y = r.y - std::min(r.y, 2u); y < std::min(r.y + r.height + 2, atlas.height); y++)
+			for (uint32_t x = r.x - std::min(r.x, 2u); x < std::min(r.x + r.width + 2, atlas.width); x++)
+				intact &= layer[(static_cast<size_t>(y) * atlas.width + x) * 4] == static_cast<uint8_t>(texture);
+	}
+	check(intact, "images and their padding land in their regions");
+
+	TextureAtlas parsed;
+	const std::string description = atlasDescription(atlas);
+	check(parseAtlas(description.data(), description.size(), parsed) && parsed.regions.size() == atlas.regions.size() &&
+	      parsed.find("texture42")->x == atlas.find("texture42")->x && parsed.find("texture42")->uvScale.x == atlas.find("texture42")->uvScale.x, "the .atlas file round trips");
+
+	std::vector<uint32_t> order(drawCount), sorted;
+	for (auto& texture : order)
+		texture = random() % textureCount;
+
+	sorted = order;
+	std::sort(sorted.begin(), sorted.end());
+
+	// The atlas is one array texture bound once, layers and regions go in with the per draw data.
+	std::printf("%d draws over %d textures, atlas of %zu 2048x2048 layers built in %.0f ms\n", drawCount, textureCount, atlas.layers.size(), seconds * 1e3);
+	std::printf("  binding changes: %d in list order, %d sorted by texture, 1 with the atlas\n", bindings(order), bindings(sorted));
+}
+
+int main() {
+	std::mt19937 random(1);
+	std::vector<PackRect> icons, mixed;
+
+	// UI icons, a few sizes.
+	for (int i = 0; i < 2000; i++) {
+		const uint32_t size = 16u << random() % 3;
+		icons.push_back({ 0, 0, size, size });
+	}
+
+	// Decals and props, anything from 8 to 512 on each side.
+	for (int i = 0; i < 2000; i++)
+		mixed.push_back({ 0, 0, 8 + static_cast<uint32_t>(random() % 505), 8 + static_cast<uint32_t>(random() % 505) });
+
+	pack("Icons", icons, 2048);
+	pack("Mixed", mixed, 2048);
+	draws();
+
+	if (gFailures)
+		std::printf("%d checks failed\n", gFailures);
+
+	return gFailures == 0 ? 0 : 1;
+}
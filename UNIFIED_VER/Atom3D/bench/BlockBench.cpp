@@ -0,0 +1,185 @@
+// ReSharper disable CppInconsistentNaming
+// BCn cooking against plain RGBA8: encode speed, quality (PSNR of the decoded blocks), size of a
+// full mip chain in each format and the copy into a GPU upload buffer that size costs. Writes and
+// maps back a DDS of each to check the container. Images given on the command line replace the
+// generated one when built with the stb_image the cooker uses (-DATOM_BENCH_STB, see the README).
+#include "AtomSimd.hpp"
+#include "BlockCompression.hpp"
+#include "DdsTexture.hpp"
+#include "MipChain.hpp"
+
+#if defined(ATOM_BENCH_STB)
+#include "stb_image.h"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace Atom;
+
+static int gFailures = 0;
+static volatile uint8_t gSink;
+
+static void check(bool condition, const char* what) {
+	if (!condition) {
+		std::printf("  FAILED: %s\n", what);
+		gFailures++;
+	}
+}
+
+template<typename F>
+static double measureSeconds(F&& f) {
+	double best = 1e30;
+
+	for (int run = 0; run < 3; run++) {
+		const auto start = std::chrono::steady_clock::now();
+		f();
+		best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	return best;
+}
+
+// Smooth gradients, soft shapes and a little noise, closer to photos and painted textures than
+// pure noise (which no block format handles) or flat color (which all of them do).
+static std::vector<uint8_t> testImage(uint32_t size) {
+	std::vector<uint8_t> image(static_cast<size_t>(size) * size * 4);
+	uint32_t seed = 1234;
+
+	for (uint32_t y = 0; y < size; y++)
+		for (uint32_t x = 0; x < size; x++) {
+			uint8_t* p = &image[(static_cast<size_t>(y) * size + x) * 4];
+			const float fx = static_cast<float>(x) / size, fy = static_cast<float>(y) / size;
+			seed = seed * 1664525 + 1013904223;
+			const float noise = static_cast<float>(seed >> 24) / 255.0f * 12 - 6;
+			const float circle = std::hypot(fx - 0.5f, fy - 0.5f) < 0.3f ? 60.0f : 0.0f;
+
+			p[0] = static_cast<uint8_t>(std::clamp(127 + 90 * std::sin(fx * 9) * std::cos(fy * 5) + circle + noise, 0.0f, 255.0f));
+			p[1] = static_cast<uint8_t>(std::clamp(127 + 100 * std::sin(fx * 4 + fy * 7) + noise, 0.0f, 255.0f));
+			p[2] = static_cast<uint8_t>(std::clamp(90 + 80 * fy + circle + noise, 0.0f, 255.0f));
+			p[3] = static_cast<uint8_t>(std::clamp(255 * fx, 0.0f, 255.0f));
+		}
+
+	return image;
+}
+
+// Over the channels the format keeps: RGB for BC1, RG for BC5, RGBA otherwise.
+static double psnr(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b, TextureFormat format) {
+	const int channels = format == TextureFormat::BC1 ? 3 : format == TextureFormat::BC5 ? 2 : 4;
+	double error = 0;
+	size_t count = 0;
+
+	for (size_t i = 0; i < a.size(); i += 4)
+		for (int ch = 0; ch < channels; ch++, count++) {
+			const double d = static_cast<double>(a[i + ch]) - b[i + ch];
+			error += d * d;
+		}
+
+	const double mse = error / count;
+	return mse == 0 ? 99.0 : 10 * std::log10(255.0 * 255.0 / mse);
+}
+
+static void run(const char* name, const std::vector<uint8_t>& pixels, uint32_t width, uint32_t height) {
+	std::printf("%s, %ux%u\n", name, width, height);
+
+	const MipChain chain = generateMipChain(pixels.data(), width, height, true, MipFilter::Kaiser);
+	std::vector<uint8_t> upload(chain.data.size());
+
+	std::printf("  %-6s %9s %8s %10s %12s %10s\n", "format", "MPix/s", "PSNR", "chain MB", "upload ms", "DDS");
+
+	const TextureFormat formats[] = { TextureFormat::RGBA8, TextureFormat::BC1, TextureFormat::BC3, TextureFormat::BC5, TextureFormat::BC7 };
+	double rgbaUpload = 0;
+
+	for (TextureFormat format : formats) {
+		std::vector<uint8_t> compressed(textureLevelBytes(format, width, height));
+		const double encodeSeconds = measureSeconds([&] { compressImage(pixels.data(), width, height, format, compressed.data()); });
+
+		std::vector<uint8_t> decoded(pixels.size());
+		decompressImage(compressed.data(), width, height, format, decoded.data());
+		const double quality = psnr(pixels, decoded, format);
+
+		// What a texture upload copies, every level of the chain.
+		const TextureImage image = compressMipChain(chain, format, true);
+		const double uploadSeconds = measureSeconds([&] {
+			memcpy(upload.data(), image.data.data(), image.data.size());
+			gSink = upload[image.data.size() / 2];
+		});
+
+		if (format == TextureFormat::RGBA8)
+			rgbaUpload = uploadSeconds;
+
+		// Round trip through the container.
+		const std::string path = (std::filesystem::temp_directory_path() / (std::string("atom_blockbench_") + textureFormatName(format) + ".dds")).string();
+		writeDds(path, image);
+
+		DdsTexture dds;
+		const bool loaded = dds.open(path) && dds.format() == format && dds.levelCount() == image.levels.size() && dds.width() == width &&
+		                    memcmp(dds.levelData(0), image.data.data(), image.data.size()) == 0;
+		dds.close();
+
+		check(loaded, "DDS round trip");
+
+		// The same file with the old DXT1 FourCC in place of the DX10 header, which has no sRGB
+		// flag, parsed into the DdsTexture that just held the sRGB one.
+		if (format == TextureFormat::BC1) {
+			std::ifstream in(path, std::ios::binary);
+			std::vector<uint8_t> legacy((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+			constexpr size_t fourCCOffset = 84, headerBytes = 128, dx10Bytes = 20;
+
+			if (legacy.size() > headerBytes + dx10Bytes) {
+				legacy.erase(legacy.begin() + headerBytes, legacy.begin() + headerBytes + dx10Bytes);
+				memcpy(legacy.data() + fourCCOffset, "DXT1", 4);
+			}
+
+			check(dds.open(path) && dds.srgb() && dds.parse(legacy.data(), legacy.size()) && !dds.srgb() && dds.format() == TextureFormat::BC1,
+			      "a reused DdsTexture forgets the last file's sRGB flag");
+			dds.close();
+		}
+
+		std::filesystem::remove(path);
+		check(format == TextureFormat::RGBA8 || quality > 30, "PSNR above 30dB");
+
+		std::printf("  %-6s %9.1f %7.1fdB %10.2f %8.2f %4.1fx %10s\n", textureFormatName(format), width * height / encodeSeconds / 1e6, quality,
+		            image.data.size() / 1048576.0, uploadSeconds * 1e3, rgbaUpload / uploadSeconds, loaded ? "ok" : "FAILED");
+	}
+
+	std::printf("\n");
+}
+
+int main(int argc, char** argv) {
+	std::printf("Block compression benchmarks (%s)\n\n", ATOM_SIMD_NAME);
+
+#if defined(ATOM_BENCH_STB)
+	for (int i = 1; i < argc; i++) {
+		int width, height, channels;
+		unsigned char* image = stbi_load(argv[i], &width, &height, &channels, STBI_rgb_alpha);
+
+		if (!image) {
+			std::printf("Could not load %s\n", argv[i]);
+			continue;
+		}
+
+		run(argv[i], std::vector<uint8_t>(image, image + static_cast<size_t>(width) * height * 4), width, height);
+		stbi_image_free(image);
+	}
+
+	if (argc > 1)
+		return gFailures == 0 ? 0 : 1;
+#else
+	(void)argc;
+	(void)argv;
+#endif
+
+	const uint32_t size = 2048;
+	run("generated", testImage(size), size, size);
+
+	return gFailures == 0 ? 0 : 1;
+}
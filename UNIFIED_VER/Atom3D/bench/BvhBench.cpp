@@ -0,0 +1,297 @@
+// ReSharper disable CppInconsistentNaming
+// BVH build, queries and refits. Builds over 100k, 250k and 1M boxes (clustered, mixed sizes), ray
+// casts and box queries against testing every box, then frames where 1% of the boxes move (partial
+// against full refit) and a drift of everything, where the tree is refit, then rebuildDegraded.
+// Checks every query against the brute force answer.
+#include "Bvh.hpp"
+#include "ParallelFor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace Atom;
+
+static volatile float gSink;
+static int gFailures = 0;
+
+static void check(bool condition, const char* what) {
+	if (!condition) {
+		std::printf("  FAILED: %s\n", what);
+		gFailures++;
+	}
+}
+
+template<typename F>
+static double measureMs(F&& f) {
+	double best = 1e30;
+
+	for (int run = 0; run < 5; run++) {
+		const auto start = std::chrono::steady_clock::now();
+		f();
+		best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	return best;
+}
+
+static bool overlaps(const Bounds& a, const Bounds& b) {
+	return a.min.x <= b.max.x && a.max.x >= b.min.x && a.min.y <= b.max.y && a.max.y >= b.min.y && a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+static Bounds box(const float3& center, const float3& half) {
+	return { center - half, center + half };
+}
+
+// Boxes around a few hundred cluster centres in a 1000 unit cube, mostly small with a few large.
+static std::vector<Bounds> makeScene(size_t count, std::mt19937& rng) {
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::normal_distribution<float> spread(0.0f, 20.0f);
+	std::vector<float3> clusters(256);
+
+	for (auto& c : clusters)
+		c = vector_make(unit(rng) * 1000, unit(rng) * 1000, unit(rng) * 1000);
+
+	std::vector<Bounds> bounds(count);
+	for (auto& b : bounds) {
+		const float3& c = clusters[rng() % clusters.size()];
+		const float size = unit(rng) < 0.01f ? 5.0f + unit(rng) * 20.0f : 0.1f + unit(rng) * 1.0f;
+		b = box(c + vector_make(spread(rng), spread(rng), spread(rng)), vector_make(size * (0.5f + unit(rng)), size * (0.5f + unit(rng)), size * (0.5f + unit(rng))));
+	}
+
+	return bounds;
+}
+
+static Ray randomRay(std::mt19937& rng) {
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	Ray ray;
+	ray.origin = vector_make(unit(rng) * 1000, unit(rng) * 1000, unit(rng) * 1000);
+	ray.direction = vector_normalize(vector_make(unit(rng) - 0.5f, unit(rng) - 0.5f, unit(rng) - 0.5f));
+	return ray;
+}
+
+static float bruteRay(const std::vector<Bounds>& bounds, const Ray& ray) {
+	const float3 invDirection = { 1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z };
+	float t = ray.tMax;
+
+	for (const auto& b : bounds)
+		t = std::min(t, intersectBox(b, ray.origin, invDirection, t));
+
+	return t;
+}
+
+// Queries the tree and brute force agree on, rays by hit distance and boxes by the objects found.
+static bool matchesBruteForce(const Bvh& bvh, const std::vector<Bounds>& bounds, std::mt19937& rng) {
+	for (int i = 0; i < 200; i++) {
+		const Ray ray = randomRay(rng);
+		float t;
+		const uint32_t hit = bvh.raycast(ray, t);
+		const float expected = bruteRay(bounds, ray);
+
+		if ((hit == Bvh::NO_HIT) != (expected == FLT_MAX) || (hit != Bvh::NO_HIT && t != expected))
+			return false;
+	}
+
+	std::vector<uint32_t> found, expected;
+	for (int i = 0; i < 200; i++) {
+		const Bounds query = box(bounds[rng() % bounds.size()].min, vector_make(10, 10, 10));
+		found.clear();
+		expected.clear();
+		bvh.query(query, found);
+
+		for (uint32_t o = 0; o < bounds.size(); o++)
+			if (overlaps(bounds[o], query))
+				expected.push_back(o);
+
+		std::sort(found.begin(), found.end());
+		if (found != expected)
+			return false;
+	}
+
+	return true;
+}
+
+// Levels from the root to the deepest leaf, the traversals' stacks hold 64.
+static uint32_t treeDepth(const Bvh& bvh) {
+	uint32_t deepest = 0;
+	std::vector<std::pair<uint32_t, uint32_t>> stack = { { 0, 1 } };
+
+	while (!stack.empty()) {
+		const auto [node, depth] = stack.back();
+		stack.pop_back();
+		deepest = std::max(deepest, depth);
+
+		const BvhNode& n = bvh.nodes()[node];
+		if (n.count == 0 && n.first != UINT32_MAX) {
+			stack.push_back({ n.first, depth + 1 });
+			stack.push_back({ n.first + 1, depth + 1 });
+		}
+	}
+
+	return deepest;
+}
+
+static void checkEdgeCases(std::mt19937& rng) {
+	Bvh bvh;
+	float t;
+	std::vector<uint32_t> found;
+	bvh.query(box(vector_make(0, 0, 0), vector_make(1, 1, 1)), found);
+	check(bvh.empty() && bvh.raycast(randomRay(rng), t) == Bvh::NO_HIT && found.empty(), "an empty tree finds nothing");
+
+	// Every centroid in one place still splits, down to leaves of at most 8.
+	const std::vector<Bounds> same(10000, box(vector_make(1, 2, 3), vector_make(1, 1, 1)));
+	bvh.build(same.data(), same.size());
+	bool small = true;
+	for (const auto& n : bvh.nodes())
+		small &= n.count <= 8;
+	bvh.query(same[0], found);
+	check(small && found.size() == same.size(), "identical boxes");
+}
+
+int main() {
+	std::mt19937 rng(4321);
+	std::printf("BVH, %u threads\n", parallelThreadCount());
+
+	checkEdgeCases(rng);
+
+	for (const size_t count : { 100000, 250000, 1000000 }) {
+		const std::vector<Bounds> bounds = makeScene(count, rng);
+		Bvh bvh;
+		const double buildMs = measureMs([&] { bvh.build(bounds.data(), bounds.size()); });
+
+		std::printf("  %7zu boxes: built in %6.1f ms, %7zu nodes, SAH cost %.1f\n", count, buildMs, bvh.nodes().size(), bvh.sahCost());
+		check(matchesBruteForce(bvh, bounds, rng), "queries after the build");
+	}
+
+	const std::vector<Bounds> start = makeScene(1000000, rng);
+	std::vector<Bounds> bounds = start;
+	Bvh bvh;
+	bvh.build(bounds.data(), bounds.size());
+
+	// Queries, against testing every box for a few of them.
+	std::vector<Ray> rays(100000);
+	for (auto& ray : rays)
+		ray = randomRay(rng);
+
+	const auto cast = [&](size_t count) {
+		float sum = 0.0f, t;
+		for (size_t i = 0; i < count; i++)
+			if (bvh.raycast(rays[i], t) != Bvh::NO_HIT)
+				sum += t;
+		gSink = sum;
+	};
+	const double rayMs = measureMs([&] { cast(rays.size()); });
+	const double bruteRayMs = measureMs([&] { gSink = bruteRay(bounds, rays[0]); });
+
+	std::vector<Bounds> queries(100000);
+	for (auto& q : queries)
+		q = box(bounds[rng() % bounds.size()].min, vector_make(10, 10, 10));
+
+	std::vector<uint32_t> found;
+	size_t foundCount = 0;
+	const auto queryAll = [&] {
+		foundCount = 0;
+		for (const auto& q : queries) {
+			found.clear();
+			bvh.query(q, found);
+			foundCount += found.size();
+		}
+	};
+	const double queryMs = measureMs(queryAll);
+	const double bruteQueryMs = measureMs([&] {
+		size_t n = 0;
+		for (const auto& b : bounds)
+			n += overlaps(b, queries[0]);
+		gSink = static_cast<float>(n);
+	});
+
+	std::printf("  1M boxes, 100k rays: %.0f ms, %.2f us a ray, %.0fx faster than testing every box\n", rayMs, rayMs / 100, bruteRayMs * 1e5 / rayMs);
+	std::printf("  1M boxes, 100k box queries: %.0f ms, %.2f us a query, %.1f hits each, %.0fx faster than testing every box\n", queryMs, queryMs / 100, foundCount / 1e5, bruteQueryMs * 1e5 / queryMs);
+
+	// 1% of the boxes move a little each frame.
+	std::uniform_real_distribution<float> jitter(-1.0f, 1.0f);
+	std::vector<uint32_t> moved(bounds.size() / 100);
+	for (auto& m : moved)
+		m = static_cast<uint32_t>(rng() % bounds.size());
+
+	const auto moveSome = [&] {
+		for (const uint32_t m : moved) {
+			const float3 step = vector_make(jitter(rng), jitter(rng), jitter(rng));
+			bounds[m] = { bounds[m].min + step, bounds[m].max + step };
+		}
+	};
+
+	const double partialMs = measureMs([&] {
+		moveSome();
+		bvh.refit(bounds.data(), moved.data(), moved.size());
+	});
+	const double fullMs = measureMs([&] {
+		moveSome();
+		bvh.refit(bounds.data());
+	});
+
+	std::printf("  1%% moved: partial refit %.2f ms, full refit %.2f ms\n", partialMs, fullMs);
+	check(matchesBruteForce(bvh, bounds, rng), "queries after refitting");
+
+	// Everything drifts far from where it was built, a refit tree gets loose.
+	const float builtCost = bvh.sahCost();
+	std::normal_distribution<float> drift(0.0f, 60.0f);
+	for (auto& b : bounds) {
+		const float3 step = vector_make(drift(rng), drift(rng), drift(rng));
+		b = { b.min + step, b.max + step };
+	}
+
+	bvh.refit(bounds.data());
+	const float refitCost = bvh.sahCost();
+	// A few rays only, each one visits most of the loose tree.
+	const double looseRayMs = measureMs([&] { cast(1000); }) * 100;
+
+	const auto rebuildStart = std::chrono::steady_clock::now();
+	const size_t rebuilt = bvh.rebuildDegraded(bounds.data());
+	const double rebuildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - rebuildStart).count();
+	const double rebuiltRayMs = measureMs([&] { cast(rays.size()); });
+
+	std::printf("  after a drift: SAH cost %.1f built, %.1f refit, %.1f after rebuildDegraded (%zu boxes, %.0f ms)\n", builtCost, refitCost, bvh.sahCost(), rebuilt, rebuildMs);
+	std::printf("  100k rays: %.0f ms on the refit tree (from 1000 of them), %.0f ms rebuilt\n", looseRayMs, rebuiltRayMs);
+	check(matchesBruteForce(bvh, bounds, rng), "queries after rebuildDegraded");
+
+	// Only one cluster drifts, only its part of the tree is rebuilt.
+	Bvh local;
+	bounds = start;
+	local.build(bounds.data(), bounds.size());
+	const float3 cluster = bounds[0].min;
+	for (auto& b : bounds)
+		if (vector_length(b.min - cluster) < 60.0f)
+			b = { b.min + vector_make(drift(rng), drift(rng), drift(rng)) * 0.5f, b.max };
+
+	for (auto& b : bounds)
+		b.max = vector_make(std::max(b.max.x, b.min.x), std::max(b.max.y, b.min.y), std::max(b.max.z, b.min.z));
+
+	local.refit(bounds.data());
+	const size_t localRebuilt = local.rebuildDegraded(bounds.data());
+	std::printf("  one cluster stretched: rebuildDegraded rebuilt %zu of %zu boxes\n", localRebuilt, bounds.size());
+	check(localRebuilt < bounds.size() / 2, "a local change rebuilds locally");
+	check(matchesBruteForce(local, bounds, rng), "queries after a partial rebuild");
+
+	// Partial rebuilds again reuse the freed node pairs.
+	local.refit(bounds.data());
+	for (int round = 0; round < 3; round++) {
+		for (auto& b : bounds)
+			if (vector_length(b.min - cluster) < 80.0f)
+				b = { b.min + vector_make(drift(rng), drift(rng), drift(rng)) * 0.2f, b.max };
+		for (auto& b : bounds)
+			b.max = vector_make(std::max(b.max.x, b.min.x), std::max(b.max.y, b.min.y), std::max(b.max.z, b.min.z));
+
+		local.refit(bounds.data());
+		local.rebuildDegraded(bounds.data());
+	}
+	check(matchesBruteForce(local, bounds, rng), "queries after repeated partial rebuilds");
+	check(treeDepth(local) < 64, "partial rebuilds keep the tree under 64 levels");
+
+	if (gFailures)
+		std::printf("%d checks failed\n", gFailures);
+
+	return gFailures == 0 ? 0 : 1;
+}
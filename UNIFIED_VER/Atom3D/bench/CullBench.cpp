@@ -0,0 +1,173 @@
+// ReSharper disable CppInconsistentNaming
+// Frustum culling of 1M objects spread around the camera, boxes and spheres, against testing each
+// object's planes one at a time. A wide (90 degree) and a narrow (20 degree) view, single threaded
+// and over parallelFor, and the same boxes through a BVH. Checks every result against the one at
+// a time test, objects within rounding of a plane may come out either way.
+// Build with the same flags as the engine, see UNIFIED_VER/README.md.
+#include "FrustumCulling.hpp"
+#include "ParallelFor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace Atom;
+
+static volatile float gSink;
+static int gFailures = 0;
+
+static void check(bool condition, const char* what) {
+	if (!condition) {
+		std::printf("  FAILED: %s\n", what);
+		gFailures++;
+	}
+}
+
+template<typename F>
+static double measureNs(size_t count, F&& f) {
+	double best = 1e30;
+
+	for (int run = 0; run < 5; run++) {
+		const auto start = std::chrono::steady_clock::now();
+		f();
+		const auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		best = std::min(best, ns / static_cast<double>(count));
+	}
+
+	return best;
+}
+
+// Smallest distance in front of a plane, negative is outside.
+static float boxDistance(const Frustum& f, const Bounds& b) {
+	const float3 c = (b.min + b.max) * 0.5f, e = (b.max - b.min) * 0.5f;
+	float distance = FLT_MAX;
+
+	for (const auto& p : f.planes)
+		distance = std::min(distance, p.x * c.x + p.y * c.y + p.z * c.z + p.w + std::fabs(p.x) * e.x + std::fabs(p.y) * e.y + std::fabs(p.z) * e.z);
+
+	return distance;
+}
+
+static float sphereDistance(const Frustum& f, const float3& c, float radius) {
+	float distance = FLT_MAX;
+
+	for (const auto& p : f.planes)
+		distance = std::min(distance, p.x * c.x + p.y * c.y + p.z * c.z + p.w + radius);
+
+	return distance;
+}
+
+// visible against the objects of distance >= 0, except those within rounding of zero.
+static bool matches(std::vector<uint32_t> visible, const std::vector<float>& distance) {
+	std::sort(visible.begin(), visible.end());
+	size_t v = 0;
+
+	for (uint32_t i = 0; i < distance.size(); i++) {
+		const bool found = v < visible.size() && visible[v] == i;
+		v += found;
+
+		if (found != (distance[i] >= 0.0f) && std::fabs(distance[i]) > 1e-2f)
+			return false;
+	}
+
+	return v == visible.size();
+}
+
+int main() {
+	constexpr size_t count = 1000000;
+	std::mt19937 rng(99);
+	std::uniform_real_distribution<float> position(-1000.0f, 1000.0f), size(0.5f, 5.0f);
+
+	std::vector<Bounds> bounds(count);
+	CullBoxesSoA boxes;
+	CullSpheresSoA spheres;
+	boxes.resize(count);
+	spheres.resize(count);
+
+	for (size_t i = 0; i < count; i++) {
+		const float3 center = vector_make(position(rng), position(rng), position(rng));
+		const float3 half = vector_make(size(rng), size(rng), size(rng));
+		bounds[i] = { center - half, center + half };
+		boxes.set(i, bounds[i]);
+		spheres.set(i, center, vector_length(half));
+	}
+
+	Bvh bvh;
+	bvh.build(bounds.data(), count);
+
+	std::printf("Frustum culling, %zu objects, %s kernels, %u threads\n", count, cullKernelName(), parallelThreadCount());
+
+	const float4x4 view = matrix4x4_translation(0, 0, 2);
+
+	for (const float fovDegrees : { 90.0f, 20.0f }) {
+		const Frustum frustum = extractFrustum(matrix_multiply(matrix_perspective_left_hand(fovDegrees * PI / 180, 16.0f / 9.0f, 0.1f, 1000.0f), view));
+
+		std::vector<float> boxDistances(count), sphereDistances(count);
+		for (size_t i = 0; i < count; i++) {
+			boxDistances[i] = boxDistance(frustum, bounds[i]);
+			sphereDistances[i] = sphereDistance(frustum, (bounds[i].min + bounds[i].max) * 0.5f, spheres.radius[i]);
+		}
+
+		// One object at a time, the way a draw loop would test them.
+		std::vector<uint32_t> visible(count);
+		size_t reference = 0;
+		const double oneNs = measureNs(count, [&] {
+			reference = 0;
+			for (uint32_t i = 0; i < count; i++)
+				if (boxDistance(frustum, bounds[i]) >= 0.0f)
+					visible[reference++] = i;
+		});
+
+		size_t n = 0;
+		const double serialNs = measureNs(count, [&] { n = cullBoxes(frustum, boxes, 0, count, visible.data()); });
+		check(matches({ visible.begin(), visible.begin() + n }, boxDistances), "single threaded boxes");
+		check(std::is_sorted(visible.begin(), visible.begin() + n), "visible list in object order");
+
+		const double parallelNs = measureNs(count, [&] { n = cullBoxes(frustum, boxes, visible.data()); });
+		check(matches({ visible.begin(), visible.begin() + n }, boxDistances), "parallel boxes");
+		check(std::is_sorted(visible.begin(), visible.begin() + n), "parallel list in object order");
+		const size_t boxesVisible = n;
+
+		const double sphereNs = measureNs(count, [&] { n = cullSpheres(frustum, spheres, visible.data()); });
+		check(matches({ visible.begin(), visible.begin() + n }, sphereDistances), "parallel spheres");
+		const size_t spheresVisible = n;
+
+		std::vector<uint32_t> bvhVisible;
+		const double bvhNs = measureNs(count, [&] {
+			bvhVisible.clear();
+			cullBvh(frustum, bvh, bvhVisible);
+		});
+		check(matches(bvhVisible, boxDistances), "BVH boxes");
+
+		std::printf("  %2.0f degrees, %zu boxes visible (%.1f%%), %zu culled, %zu spheres visible\n", fovDegrees, boxesVisible, 100.0 * boxesVisible / count, count - boxesVisible, spheresVisible);
+		std::printf("    one at a time %5.2f ns/object %6.2f ms\n", oneNs, oneNs * count / 1e6);
+		std::printf("    %-13s %5.2f ns/object %6.2f ms %5.1fx\n", cullKernelName(), serialNs, serialNs * count / 1e6, oneNs / serialNs);
+		std::printf("    parallelFor   %5.2f ns/object %6.2f ms %5.1fx\n", parallelNs, parallelNs * count / 1e6, oneNs / parallelNs);
+		std::printf("    spheres       %5.2f ns/object %6.2f ms %5.1fx\n", sphereNs, sphereNs * count / 1e6, oneNs / sphereNs);
+		std::printf("    BVH           %5.2f ns/object %6.2f ms %5.1fx\n", bvhNs, bvhNs * count / 1e6, oneNs / bvhNs);
+		gSink = static_cast<float>(reference);
+	}
+
+	// Tails shorter than a kernel step and ranges not starting on one.
+	{
+		const Frustum frustum = extractFrustum(matrix_multiply(matrix_perspective_left_hand(PI / 2, 1.0f, 0.1f, 1000.0f), view));
+		std::vector<uint32_t> visible(count);
+		const size_t n = cullBoxes(frustum, boxes, 5, 37, visible.data());
+		size_t expected = 0;
+		bool same = true;
+
+		for (uint32_t i = 5; i < 42; i++)
+			if (boxDistance(frustum, bounds[i]) >= 0.0f)
+				same &= expected < n && visible[expected++] == i;
+
+		check(same && n == expected, "ranges with tails");
+	}
+
+	if (gFailures)
+		std::printf("%d checks failed\n", gFailures);
+
+	return gFailures == 0 ? 0 : 1;
+}
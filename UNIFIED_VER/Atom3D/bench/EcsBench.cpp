@@ -0,0 +1,264 @@
+// ReSharper disable CppInconsistentNaming
+// The ECS at 1M entities with Transform, WorldMatrix and Renderable components (a quarter also
+// with a Velocity), against the same scene as heap allocated objects with a virtual update, the
+// usual way before an ECS. Times creating the scene, a read only pass over Renderable, moving the
+// entities that have a Velocity, updateWorldMatrices, and 10% of the entities changing components
+// and dying through an EntityCommandBuffer. Checks the bookkeeping along the way.
+#include "Ecs.hpp"
+#include "SceneComponents.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace Atom;
+
+static volatile float gSink;
+static int gFailures = 0;
+
+struct Velocity {
+	float3 value;
+};
+
+// Tag for the command buffer pass.
+struct Highlighted {
+	uint32_t color;
+};
+
+static void check(bool condition, const char* what) {
+	if (!condition) {
+		std::printf("  FAILED: %s\n", what);
+		gFailures++;
+	}
+}
+
+template<typename F>
+static double measureNs(size_t count, F&& f) {
+	double best = 1e30;
+
+	for (int run = 0; run < 5; run++) {
+		const auto start = std::chrono::steady_clock::now();
+		f();
+		const auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		best = std::min(best, ns / static_cast<double>(count));
+	}
+
+	return best;
+}
+
+// The object oriented scene, one allocation per object.
+class GameObject {
+public:
+	virtual ~GameObject() = default;
+	virtual void update(float dt) = 0;
+
+	Transform transform;
+	WorldMatrix world;
+	Renderable renderable;
+};
+
+class StaticObject : public GameObject {
+public:
+	void update(float) override {}
+};
+
+class MovingObject : public GameObject {
+public:
+	void update(float dt) override {
+		transform.position = transform.position + velocity.value * dt;
+	}
+
+	Velocity velocity;
+};
+
+static void composeWorld(const Transform& t, WorldMatrix& w) {
+	float4x4 m = matrix4x4_from_quaternion(t.rotation);
+	m.columns[0] = m.columns[0] * t.scale.x;
+	m.columns[1] = m.columns[1] * t.scale.y;
+	m.columns[2] = m.columns[2] * t.scale.z;
+	m.columns[3] = { t.position.x, t.position.y, t.position.z, 1.0f };
+	w.matrix = m;
+}
+
+// Structural changes by hand on a few entities.
+static void checkBookkeeping() {
+	World world;
+	const Entity a = world.create(Transform{}, Renderable{ 1, 2 });
+	const Entity b = world.create(Transform{}, Renderable{ 3, 4 });
+	const Entity c = world.create(Renderable{ 5, 6 });
+
+	world.add(a, Velocity{ { 1.0f, 0.0f, 0.0f } });
+	check(world.get<Renderable>(a)->texture == 2 && world.get<Velocity>(a)->value.x == 1.0f && world.has<Transform>(a), "components survive an archetype move");
+	check(world.get<Renderable>(b)->texture == 4, "the entity filling the hole keeps its components");
+
+	world.remove<Transform>(a);
+	check(!world.has<Transform>(a) && world.get<Velocity>(a) && world.count<Renderable>() == 3 && world.count<Transform>() == 1, "remove moves back out");
+
+	world.destroy(b);
+	check(!world.alive(b) && !world.get<Renderable>(b) && world.alive(c) && world.get<Renderable>(c)->mesh == 5, "destroy");
+
+	const Entity d = world.create();
+	check(d.index == b.index && d != b && !world.alive(b), "reused slots get a new generation");
+
+	EntityCommandBuffer commands;
+	const Entity e = commands.create();
+	commands.add(e, Renderable{ 7, 8 });
+	commands.add(e, Highlighted{ 9 });
+	commands.add(c, Highlighted{ 10 });
+	commands.destroy(a);
+	commands.add(a, Highlighted{ 11 });
+	commands.apply(world);
+
+	check(world.size() == 3 && !world.alive(a) && world.get<Highlighted>(c)->color == 10 && world.count<Renderable, Highlighted>() == 2, "command buffer, skipping dead entities");
+
+	size_t seen = 0;
+	world.eachEntity<const Renderable, const Highlighted>([&](Entity entity, const Renderable& r, const Highlighted& h) {
+		seen += (entity == c && r.mesh == 5 && h.color == 10) || (r.mesh == 7 && h.color == 9);
+	});
+	check(seen == 2, "queries see created entities");
+}
+
+int main() {
+	constexpr size_t count = 1000000;
+	constexpr float dt = 1.0f / 60;
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+	checkBookkeeping();
+
+	std::printf("ECS benchmarks, %zu entities, %u threads\n", count, parallelThreadCount());
+
+	std::vector<Transform> transforms(count);
+	for (auto& t : transforms) {
+		t.position = vector_make(dist(rng) * 100, dist(rng) * 100, dist(rng) * 100);
+		t.rotation = quaternion(dist(rng) * PI, vector_make(dist(rng), dist(rng), dist(rng) + 2.0f));
+		t.scale = vector_make(1.5f + dist(rng), 1.5f + dist(rng), 1.5f + dist(rng));
+	}
+
+	const Velocity velocity = { { 1.0f, 2.0f, 3.0f } };
+
+	// Objects, allocated between other allocations so they end up scattered like a long running heap.
+	std::vector<std::unique_ptr<GameObject>> objects;
+	std::vector<std::unique_ptr<char[]>> noise;
+	const auto createObjects = [&] {
+		objects.clear();
+		noise.clear();
+
+		for (size_t i = 0; i < count; i++) {
+			if (i % 4 == 0) {
+				auto moving = std::make_unique<MovingObject>();
+				moving->velocity = velocity;
+				objects.push_back(std::move(moving));
+			} else {
+				objects.push_back(std::make_unique<StaticObject>());
+			}
+
+			objects.back()->transform = transforms[i];
+			objects.back()->renderable = { static_cast<uint32_t>(i % 64), static_cast<uint32_t>(i % 300) };
+			noise.push_back(std::make_unique<char[]>(16 + rng() % 200));
+		}
+
+		std::shuffle(objects.begin(), objects.end(), rng);
+	};
+
+	World world;
+	const auto createEntities = [&] {
+		world.clear();
+
+		for (size_t i = 0; i < count; i++) {
+			const Renderable renderable = { static_cast<uint32_t>(i % 64), static_cast<uint32_t>(i % 300) };
+
+			if (i % 4 == 0)
+				world.create(transforms[i], WorldMatrix{}, renderable, velocity);
+			else
+				world.create(transforms[i], WorldMatrix{}, renderable);
+		}
+	};
+
+	const double objectCreateNs = measureNs(count, createObjects);
+	const double entityCreateNs = measureNs(count, createEntities);
+	check(world.size() == count && world.count<Velocity>() == count / 4, "every entity created");
+	std::printf("  create                 objects %6.2f ns   ecs %6.2f ns   %5.2fx\n", objectCreateNs, entityCreateNs, objectCreateNs / entityCreateNs);
+
+	// Read only: the draw list's texture ids.
+	const double objectReadNs = measureNs(count, [&] {
+		uint64_t sum = 0;
+		for (const auto& object : objects)
+			sum += object->renderable.texture;
+		gSink = static_cast<float>(sum);
+	});
+	uint64_t entitySum = 0;
+	const double entityReadNs = measureNs(count, [&] {
+		entitySum = 0;
+		world.each<const Renderable>([&](const Renderable& r) { entitySum += r.texture; });
+		gSink = static_cast<float>(entitySum);
+	});
+	uint64_t expectedSum = 0;
+	for (size_t i = 0; i < count; i++)
+		expectedSum += i % 300;
+	check(entitySum == expectedSum, "each visits every Renderable once");
+	std::printf("  read Renderable        objects %6.2f ns   ecs %6.2f ns   %5.2fx\n", objectReadNs, entityReadNs, objectReadNs / entityReadNs);
+
+	// Move the quarter with a Velocity, the objects call update on everyone.
+	const double objectMoveNs = measureNs(count, [&] {
+		for (const auto& object : objects)
+			object->update(dt);
+		gSink = objects[0]->transform.position.x;
+	});
+	const double entityMoveNs = measureNs(count, [&] {
+		world.eachChunk<Transform, const Velocity>([&](size_t n, Entity*, Transform* t, const Velocity* v) {
+			for (size_t i = 0; i < n; i++)
+				t[i].position = t[i].position + v[i].value * dt;
+		});
+	});
+	std::printf("  move (25%% moving)      objects %6.2f ns   ecs %6.2f ns   %5.2fx\n", objectMoveNs, entityMoveNs, objectMoveNs / entityMoveNs);
+
+	// World matrices.
+	const double objectWorldNs = measureNs(count, [&] {
+		for (const auto& object : objects)
+			composeWorld(object->transform, object->world);
+		gSink = objects[0]->world.matrix.columns[3].x;
+	});
+	const double entityWorldNs = measureNs(count, [&] { updateWorldMatrices(world); });
+
+	bool matches = true;
+	world.each<const Transform, const WorldMatrix>([&](const Transform& t, const WorldMatrix& w) {
+		WorldMatrix expected;
+		composeWorld(t, expected);
+		matches &= std::fabs(expected.matrix.columns[3].x - w.matrix.columns[3].x) < 1e-4f && std::fabs(expected.matrix.columns[0].y - w.matrix.columns[0].y) < 1e-4f;
+	});
+	check(matches, "updateWorldMatrices composes every entity's matrix");
+	std::printf("  world matrices         objects %6.2f ns   ecs %6.2f ns   %5.2fx\n", objectWorldNs, entityWorldNs, objectWorldNs / entityWorldNs);
+
+	// A tenth of the entities gets a component and another tenth dies, recorded while iterating.
+	EntityCommandBuffer commands;
+	size_t visited = 0;
+	const auto start = std::chrono::steady_clock::now();
+
+	world.eachEntity<const Renderable>([&](Entity entity, const Renderable& r) {
+		if (r.texture % 10 == 0)
+			commands.add(entity, Highlighted{ r.texture });
+		else if (r.texture % 10 == 1)
+			commands.destroy(entity);
+		visited++;
+	});
+	const double recordMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	const size_t commandCount = commands.size();
+
+	const auto applyStart = std::chrono::steady_clock::now();
+	commands.apply(world);
+	const double applyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - applyStart).count();
+
+	check(visited == count && world.size() == count - count / 10 && world.count<Highlighted>() == count / 10 && world.count<Transform, WorldMatrix, Renderable>() == world.size(),
+	      "structural changes through the command buffer");
+	std::printf("  %zu structural changes: recorded in %.1f ms, applied in %.1f ms (%.0f ns each), %zu archetypes\n", commandCount, recordMs, applyMs,
+	            applyMs * 1e6 / static_cast<double>(commandCount), world.archetypeCount());
+
+	if (gFailures)
+		std::printf("%d checks failed\n", gFailures);
+
+	return gFailures == 0 ? 0 : 1;
+}
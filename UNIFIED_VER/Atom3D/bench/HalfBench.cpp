@@ -0,0 +1,118 @@
+// ReSharper disable CppInconsistentNaming
+// Bulk float16 <-> float32 conversion against the one value at a time functions, for a vertex
+// stream sized batch and an HDR texture sized one. memcpy of the float side is printed as the
+// memory bandwidth ceiling. Pass --exhaustive to check all 2^32 floats instead of a sample.
+#include "AtomMath.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace Atom;
+
+static volatile float gSink;
+static int gFailures = 0;
+
+template<typename F>
+static double measureSeconds(F&& f) {
+	// Best of a few runs, the minimum is the most stable number on a busy machine.
+	double best = 1e30;
+
+	for (int run = 0; run < 5; run++) {
+		const auto start = std::chrono::steady_clock::now();
+		f();
+		best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	return best;
+}
+
+// Every half, and every stride'th float bit pattern, against the scalar functions.
+static void checkBitExact(uint64_t stride) {
+	std::vector<uint16_t> halves(65536);
+	std::vector<float> floats(65536);
+
+	for (uint32_t i = 0; i < 65536; i++)
+		halves[i] = static_cast<uint16_t>(i);
+
+	float32_from_float16(halves.data(), floats.data(), halves.size());
+
+	size_t mismatches = 0;
+
+	for (uint32_t i = 0; i < 65536; i++) {
+		const float f = float32_from_float16(static_cast<uint16_t>(i));
+		mismatches += memcmp(&f, &floats[i], sizeof f) != 0;
+	}
+
+	constexpr size_t BATCH = 1 << 20;
+	std::vector<float> src(BATCH);
+	std::vector<uint16_t> dst(BATCH);
+	uint64_t checked = 0;
+
+	for (uint64_t pattern = 0; pattern < (1ull << 32);) {
+		size_t n = 0;
+
+		for (; n < BATCH && pattern < (1ull << 32); n++, pattern += stride) {
+			const auto u = static_cast<uint32_t>(pattern);
+			memcpy(&src[n], &u, sizeof u);
+		}
+
+		float16_from_float32(src.data(), dst.data(), n);
+
+		for (size_t k = 0; k < n; k++)
+			mismatches += float16_from_float32(src[k]) != dst[k];
+
+		checked += n;
+	}
+
+	std::printf("bit exact check: 65536 halves, %llu floats, %zu mismatches%s\n\n",
+	            static_cast<unsigned long long>(checked), mismatches, mismatches ? "  FAILED" : "");
+
+	if (mismatches)
+		gFailures++;
+}
+
+static void run(const char* name, size_t count) {
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+
+	std::vector<float> floats(count), floatsBack(count), copy(count);
+	std::vector<uint16_t> halves(count), halvesRef(count);
+
+	for (auto& f : floats)
+		f = dist(rng);
+
+	const double gb = static_cast<double>(count) * sizeof(float) / 1e9;
+
+	const double scalarTo = measureSeconds([&] { for (size_t i = 0; i < count; i++) halvesRef[i] = float16_from_float32(floats[i]); gSink = halvesRef[count - 1]; });
+	const double bulkTo = measureSeconds([&] { float16_from_float32(floats.data(), halves.data(), count); gSink = halves[count - 1]; });
+	const double scalarFrom = measureSeconds([&] { for (size_t i = 0; i < count; i++) floatsBack[i] = float32_from_float16(halves[i]); gSink = floatsBack[count - 1]; });
+	const double bulkFrom = measureSeconds([&] { float32_from_float16(halves.data(), floatsBack.data(), count); gSink = floatsBack[count - 1]; });
+	const double memcpyTime = measureSeconds([&] { memcpy(copy.data(), floats.data(), count * sizeof(float)); gSink = copy[count - 1]; });
+
+	const bool matches = halves == halvesRef;
+
+	std::printf("%s, %zu floats\n", name, count);
+	std::printf("  float32 -> float16  scalar %7.2f GB/s   bulk %7.2f GB/s  %6.2fx%s\n", gb / scalarTo, gb / bulkTo, scalarTo / bulkTo, matches ? "" : "  FAILED");
+	std::printf("  float16 -> float32  scalar %7.2f GB/s   bulk %7.2f GB/s  %6.2fx\n", gb / scalarFrom, gb / bulkFrom, scalarFrom / bulkFrom);
+	std::printf("  memcpy float32      %7.2f GB/s\n\n", gb / memcpyTime);
+
+	if (!matches)
+		gFailures++;
+}
+
+int main(int argc, char** argv) {
+	const bool exhaustive = argc > 1 && strcmp(argv[1], "--exhaustive") == 0;
+
+	std::printf("float16 conversion benchmarks (%s)\n\n", ATOM_SIMD_NAME);
+
+	checkBitExact(exhaustive ? 1 : 61);
+
+	run("vertex stream", 1u << 20);
+	run("HDR texture 2048x2048 RGBA", 2048u * 2048u * 4u);
+
+	return gFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+// ReSharper disable CppInconsistentNaming
+// Transform hierarchy update cost against how much of the scene moved. 500k nodes under 1000
+// roots (a random tree, ~20 levels deep), frames where 0, 0.01%, 0.1%, 1% and 10% of the nodes
+// get a new local transform, and one where a root with its subtree moves. Compared to recomputing
+// every node each frame, level by level and recursively from the roots. Checks the world matrices
+// against composing each node's parent chain.
+#include "TransformHierarchy.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+using namespace Atom;
+
+static volatile float gSink;
+static int gFailures = 0;
+
+static void check(bool condition, const char* what) {
+	if (!condition) {
+		std::printf("  FAILED: %s\n", what);
+		gFailures++;
+	}
+}
+
+template<typename F>
+static double measureUs(F&& f) {
+	double best = 1e30;
+
+	for (int run = 0; run < 5; run++) {
+		const auto start = std::chrono::steady_clock::now();
+		f();
+		best = std::min(best, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	return best;
+}
+
+static float4x4 chainWorld(const TransformHierarchy& hierarchy, TransformHierarchy::Node node) {
+	const float4x4 local = composeTransform(hierarchy.local(node));
+	const auto parent = hierarchy.parent(node);
+	return parent == TransformHierarchy::NO_NODE ? local : matrix_multiply(chainWorld(hierarchy, parent), local);
+}
+
+static bool matchesChains(const TransformHierarchy& hierarchy, const std::vector<TransformHierarchy::Node>& nodes, std::mt19937& rng) {
+	for (int i = 0; i < 2000; i++) {
+		const auto node = nodes[rng() % nodes.size()];
+
+		if (!hierarchy.valid(node))
+			continue;
+
+		const float4x4 expected = chainWorld(hierarchy, node), actual = hierarchy.world(node);
+
+		for (int c = 0; c < 4; c++)
+			for (int r = 0; r < 4; r++)
+				if (std::fabs(expected.columns[c][r] - actual.columns[c][r]) > 1e-3f * std::max(1.0f, std::fabs(expected.columns[c][r])))
+					return false;
+	}
+
+	return true;
+}
+
+// Reparenting, destroying and the sync into entities, on a few nodes.
+static void checkStructure() {
+	TransformHierarchy hierarchy;
+	World world;
+	const Entity entity = world.create(WorldMatrix{});
+
+	Transform moved;
+	moved.position = vector_make(1.0f, 2.0f, 3.0f);
+
+	const auto a = hierarchy.create(TransformHierarchy::NO_NODE, moved);
+	const auto b = hierarchy.create(a, moved, entity);
+	const auto c = hierarchy.create(b, moved);
+	hierarchy.update();
+	syncWorldMatrices(hierarchy, world);
+	check(hierarchy.world(c).columns[3].x == 3.0f && world.get<WorldMatrix>(entity)->matrix.columns[3].z == 6.0f, "children inherit their parents' transforms");
+
+	hierarchy.setParent(c, TransformHierarchy::NO_NODE);
+	check(hierarchy.update() == 1 && hierarchy.world(c).columns[3].x == 1.0f, "reparenting recomputes only the moved subtree");
+
+	bool threw = false;
+	try {
+		hierarchy.setParent(a, b);
+	} catch (const std::invalid_argument&) {
+		threw = true;
+	}
+	check(threw, "no cycles");
+
+	hierarchy.setParent(c, b);
+	hierarchy.destroy(a);
+	check(!hierarchy.valid(a) && !hierarchy.valid(b) && !hierarchy.valid(c) && hierarchy.size() == 0 && hierarchy.update() == 0, "destroy takes the subtree");
+	check(hierarchy.update() == 0, "nothing dirty, nothing written");
+}
+
+int main() {
+	constexpr size_t count = 500000, roots = 1000;
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+	checkStructure();
+
+	const auto randomTransform = [&] {
+		Transform t;
+		t.position = vector_make(dist(rng) * 10, dist(rng) * 10, dist(rng) * 10);
+		t.rotation = quaternion(dist(rng) * PI, vector_make(dist(rng), dist(rng), dist(rng) + 2.0f));
+		t.scale = vector_make(1.0f + dist(rng) * 0.1f, 1.0f + dist(rng) * 0.1f, 1.0f + dist(rng) * 0.1f);
+		return t;
+	};
+
+	TransformHierarchy hierarchy;
+	std::vector<TransformHierarchy::Node> nodes;
+
+	const auto buildStart = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < count; i++)
+		nodes.push_back(hierarchy.create(i < roots ? TransformHierarchy::NO_NODE : nodes[rng() % i], randomTransform()));
+	hierarchy.update();
+	const double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - buildStart).count();
+
+	std::printf("Transform hierarchy, %zu nodes in %zu levels, built in %.0f ms, %u threads\n", hierarchy.size(), hierarchy.levelCount(), buildMs, parallelThreadCount());
+	check(matchesChains(hierarchy, nodes, rng), "world matrices after the build");
+
+	// Every node each frame, for comparison.
+	const double allLevelsUs = measureUs([&] {
+		for (size_t i = 0; i < roots; i++)
+			hierarchy.setLocal(nodes[i], hierarchy.local(nodes[i]));
+		hierarchy.update();
+	});
+
+	std::vector<std::vector<TransformHierarchy::Node>> children(count);
+	for (size_t i = roots; i < count; i++)
+		children[hierarchy.parent(nodes[i])].push_back(nodes[i]);
+
+	std::vector<float4x4> recursiveWorld(count);
+	const std::function<void(TransformHierarchy::Node, const float4x4*)> recurse = [&](TransformHierarchy::Node node, const float4x4* parent) {
+		const float4x4 local = composeTransform(hierarchy.local(node));
+		recursiveWorld[node] = parent ? matrix_multiply(*parent, local) : local;
+		for (const auto child : children[node])
+			recurse(child, &recursiveWorld[node]);
+	};
+	const double recursiveUs = measureUs([&] {
+		for (size_t i = 0; i < roots; i++)
+			recurse(nodes[i], nullptr);
+		gSink = recursiveWorld[count - 1].columns[3].x;
+	});
+
+	std::printf("  everything each frame: %.0f us by level, %.0f us recursively\n", allLevelsUs, recursiveUs);
+
+	for (const double fraction : { 0.0, 0.0001, 0.001, 0.01, 0.1 }) {
+		const auto moved = static_cast<size_t>(count * fraction);
+		std::vector<std::pair<TransformHierarchy::Node, Transform>> moves;
+		for (size_t i = 0; i < moved; i++)
+			moves.emplace_back(nodes[rng() % count], randomTransform());
+
+		size_t written = 0;
+		const double us = measureUs([&] {
+			for (const auto& [node, local] : moves)
+				hierarchy.setLocal(node, local);
+			written = hierarchy.update();
+		});
+
+		std::printf("  %6.2f%% moved (%6zu nodes): %7zu matrices, %8.1f us, %6.1fx faster than everything\n", fraction * 100, moved, written, us, allLevelsUs / us);
+	}
+
+	check(matchesChains(hierarchy, nodes, rng), "world matrices after the moves");
+
+	// One root and its subtree.
+	size_t written = 0;
+	const double rootUs = measureUs([&] {
+		hierarchy.setLocal(nodes[7], randomTransform());
+		written = hierarchy.update();
+	});
+	std::printf("  one root moved: %zu matrices, %.1f us\n", written, rootUs);
+
+	// A reparent re-sorts the arrays.
+	const double reparentUs = measureUs([&] {
+		hierarchy.setParent(nodes[count - 1], nodes[rng() % roots]);
+		hierarchy.update();
+	});
+	std::printf("  one reparent: %.0f us\n", reparentUs);
+	check(matchesChains(hierarchy, nodes, rng), "world matrices after reparenting");
+
+	if (gFailures)
+		std::printf("%d checks failed\n", gFailures);
+
+	return gFailures == 0 ? 0 : 1;
+}
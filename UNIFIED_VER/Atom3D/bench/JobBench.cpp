@@ -0,0 +1,216 @@
+// ReSharper disable CppInconsistentNaming
+// Job system scaling from 1 to 64 threads: a compute bound parallelFor over 1M items, culling 1M
+// boxes in blocks like cullBoxes does, a fork/join tree of 130k small jobs made by the jobs
+// themselves, and 100k empty jobs made and run by the main thread (the scheduler's own overhead).
+// Checks every item runs exactly once, nested parallelFor, and threads outside the system using it.
+// Build with the same flags as the engine, see UNIFIED_VER/README.md.
+#include "FrustumCulling.hpp"
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace Atom;
+
+static std::atomic<float> gSink;
+static int gFailures = 0;
+
+static void check(bool condition, const char* what) {
+	if (!condition) {
+		std::printf("  FAILED: %s\n", what);
+		gFailures++;
+	}
+}
+
+template<typename F>
+static double measureMs(F&& f) {
+	double best = 1e30;
+
+	for (int run = 0; run < 5; run++) {
+		const auto start = std::chrono::steady_clock::now();
+		f();
+		best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	return best;
+}
+
+// A few hundred cycles of dependent math per item.
+static float work(size_t i) {
+	float x = static_cast<float>(i & 1023) * 0.001f;
+
+	for (int k = 0; k < 64; k++)
+		x = x * 0.999f + std::sqrt(x + 1.0f) * 0.001f;
+
+	return x;
+}
+
+// Binary tree of jobs, each one makes its two children and returns, leaves do a little work.
+static void spawnTree(JobSystem& jobs, uint32_t depth, std::atomic<uint32_t>& leaves) {
+	if (depth == 0) {
+		gSink.store(work(leaves.fetch_add(1, std::memory_order_relaxed)), std::memory_order_relaxed);
+		return;
+	}
+
+	Job* self = JobSystem::currentJob();
+	jobs.run(jobs.createChild(self, [&jobs, depth, &leaves] { spawnTree(jobs, depth - 1, leaves); }));
+	jobs.run(jobs.createChild(self, [&jobs, depth, &leaves] { spawnTree(jobs, depth - 1, leaves); }));
+}
+
+static void checkCorrectness(JobSystem& jobs) {
+	// Every item once, with chunks of at least minChunk.
+	std::vector<uint8_t> visits(1000003);
+	std::atomic<bool> smallChunk{ false };
+	jobs.parallelFor(visits.size(), 7, [&](size_t begin, size_t end) {
+		smallChunk = smallChunk || end - begin < 7;
+		for (size_t i = begin; i < end; i++)
+			visits[i]++;
+	});
+	check(std::all_of(visits.begin(), visits.end(), [](uint8_t v) { return v == 1; }) && !smallChunk, "parallelFor visits every item once");
+
+	// parallelFor inside parallelFor.
+	std::atomic<size_t> nested{ 0 };
+	jobs.parallelFor(64, 1, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+			jobs.parallelFor(1000, 10, [&](size_t b, size_t e) { nested += e - b; });
+	});
+	check(nested == 64000, "nested parallelFor");
+
+	// A parent waits for its whole tree.
+	std::atomic<uint32_t> leaves{ 0 };
+	Job* root = jobs.create([&] { spawnTree(jobs, 12, leaves); });
+	jobs.run(root);
+	jobs.wait(root);
+	check(leaves == 4096, "parent done after every child");
+
+	// Threads that aren't the system's own.
+	std::atomic<size_t> outside{ 0 };
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; t++)
+		threads.emplace_back([&] {
+			for (int round = 0; round < 20; round++)
+				jobs.parallelFor(10000, 100, [&](size_t begin, size_t end) { outside += end - begin; });
+		});
+	for (auto& thread : threads)
+		thread.join();
+	check(outside == 4 * 20 * 10000, "parallelFor from outside threads");
+
+	// An outside thread's loop is shared out, not run by the caller alone (asset decode's mip
+	// generation). Chunks sleep so the workers get to run even on a single core.
+	if (jobs.threadCount() > 1) {
+		std::vector<std::thread::id> ranOn(256);
+		std::thread([&] {
+			jobs.parallelFor(65536, 256, [&](size_t begin, size_t end) {
+				for (size_t c = begin / 256; c < (end + 255) / 256; c++)
+					ranOn[c] = std::this_thread::get_id();
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+			});
+		}).join();
+		std::sort(ranOn.begin(), ranOn.end());
+		check(std::unique(ranOn.begin(), ranOn.end()) - ranOn.begin() > 1, "outside thread's parallelFor runs on the workers");
+	}
+}
+
+int main() {
+	std::printf("Job system, %u hardware threads\n", std::max(1u, std::thread::hardware_concurrency()));
+
+	// Cull input, 1M boxes around the camera.
+	constexpr size_t boxCount = 1000000, block = 4096;
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> position(-1000.0f, 1000.0f), size(0.5f, 5.0f);
+	CullBoxesSoA boxes;
+	boxes.resize(boxCount);
+	for (size_t i = 0; i < boxCount; i++) {
+		const float3 center = vector_make(position(rng), position(rng), position(rng));
+		const float3 half = vector_make(size(rng), size(rng), size(rng));
+		boxes.set(i, { center - half, center + half });
+	}
+
+	const Frustum frustum = extractFrustum(matrix_multiply(matrix_perspective_left_hand(PI / 2, 16.0f / 9.0f, 0.1f, 1000.0f), matrix4x4_translation(0, 0, 2)));
+	std::vector<uint32_t> visible(boxCount);
+	const size_t expectedVisible = cullBoxes(frustum, boxes, 0, boxCount, visible.data());
+
+	constexpr size_t items = 1 << 20;
+	float expectedSum = 0.0f;
+	for (size_t i = 0; i < 1024; i++)
+		expectedSum += work(i);
+	expectedSum *= items / 1024;
+
+	std::printf("  threads  parallelFor 1M   cull 1M boxes   job tree 130k   100k empty jobs\n");
+	double base[3] = {};
+
+	for (const uint32_t threadCount : { 1u, 2u, 4u, 8u, 16u, 32u, 64u }) {
+		JobSystem jobs(threadCount);
+		checkCorrectness(jobs);
+
+		// Per thread partial sums, a slot per chunk start so nothing is shared.
+		std::vector<float> partial(items / 1024);
+		const double forMs = measureMs([&] {
+			jobs.parallelFor(items / 1024, 4, [&](size_t begin, size_t end) {
+				for (size_t c = begin; c < end; c++) {
+					float sum = 0.0f;
+					for (size_t i = c * 1024; i < c * 1024 + 1024; i++)
+						sum += work(i);
+					partial[c] = sum;
+				}
+			});
+		});
+		float sum = 0.0f;
+		for (const float p : partial)
+			sum += p;
+		check(std::fabs(sum - expectedSum) < expectedSum * 1e-3f, "parallelFor sum");
+
+		std::vector<uint32_t> counts(boxCount / block + 1);
+		const double cullMs = measureMs([&] {
+			jobs.parallelFor(counts.size(), 8, [&](size_t begin, size_t end) {
+				for (size_t b = begin; b < end; b++) {
+					const size_t first = b * block;
+					counts[b] = static_cast<uint32_t>(cullBoxes(frustum, boxes, first, std::min(block, boxCount - first), visible.data() + first));
+				}
+			});
+		});
+		size_t culled = 0;
+		for (const uint32_t c : counts)
+			culled += c;
+		check(culled == expectedVisible, "culling blocks");
+
+		std::atomic<uint32_t> leaves{ 0 };
+		const double treeMs = measureMs([&] {
+			leaves = 0;
+			Job* root = jobs.create([&] { spawnTree(jobs, 16, leaves); });
+			jobs.run(root);
+			jobs.wait(root);
+		});
+		check(leaves == 1u << 16, "job tree leaves");
+
+		std::atomic<uint32_t> ran{ 0 };
+		const double emptyMs = measureMs([&] {
+			ran = 0;
+			Job* root = jobs.create([] {});
+			for (int i = 0; i < 100000; i++)
+				jobs.run(jobs.createChild(root, [&ran] { ran.fetch_add(1, std::memory_order_relaxed); }));
+			jobs.run(root);
+			jobs.wait(root);
+		});
+		check(ran == 100000, "empty jobs");
+
+		if (threadCount == 1) {
+			base[0] = forMs;
+			base[1] = cullMs;
+			base[2] = treeMs;
+		}
+
+		std::printf("  %7u  %6.1f ms %4.1fx  %6.2f ms %4.1fx  %6.2f ms %4.1fx  %6.2f ms (%3.0f ns a job)\n", threadCount, forMs, base[0] / forMs, cullMs, base[1] / cullMs, treeMs,
+			base[2] / treeMs, emptyMs, emptyMs * 1e6 / 100000);
+	}
+
+	if (gFailures)
+		std::printf("%d checks failed\n", gFailures);
+
+	return gFailures == 0 ? 0 : 1;
+}
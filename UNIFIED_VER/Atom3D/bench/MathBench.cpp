@@ -0,0 +1,360 @@
+// ReSharper disable CppInconsistentNaming
+// Micro-benchmarks for AtomMath against a plain scalar reference and, on Apple platforms, the simd
+// library AAPLMathUtilities was built on. Build with the same flags as the engine, see UNIFIED_VER/README.md.
+#include "AtomMath.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#ifdef __APPLE__
+#include <simd/simd.h>
+#endif
+
+using namespace Atom;
+
+namespace Reference {
+
+// Textbook scalar versions, what the compiler gets with no help.
+
+static float4x4 multiply(const float4x4& a, const float4x4& b) {
+	float4x4 r;
+
+	for (int c = 0; c < 4; c++)
+		for (int row = 0; row < 4; row++) {
+			float s = 0;
+
+			for (int k = 0; k < 4; k++)
+				s += a.columns[k][row] * b.columns[c][k];
+
+			r.columns[c][row] = s;
+		}
+
+	return r;
+}
+
+// Cofactor expansion, as in the classic MESA gluInvertMatrix.
+static float4x4 invert(const float4x4& mat) {
+	const float* m = &mat.columns[0].x;
+	float inv[16];
+
+	inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+	inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+	inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+	inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+	inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+	inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+	inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+	inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+	inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+	inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+	inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+	inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+	inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+	inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+	inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+	inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+	const float invDet = 1.0f / (m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12]);
+
+	float4x4 r;
+	float* o = &r.columns[0].x;
+
+	for (int i = 0; i < 16; i++)
+		o[i] = inv[i] * invDet;
+
+	return r;
+}
+
+static float3x3 invert(const float3x3& m) {
+	const float a = m.columns[0].x, b = m.columns[1].x, c = m.columns[2].x;
+	const float d = m.columns[0].y, e = m.columns[1].y, f = m.columns[2].y;
+	const float g = m.columns[0].z, h = m.columns[1].z, i = m.columns[2].z;
+
+	const float A = e * i - f * h, B = -(d * i - f * g), C = d * h - e * g;
+	const float invDet = 1.0f / (a * A + b * B + c * C);
+
+	return matrix_make_rows(A * invDet, -(b * i - c * h) * invDet, (b * f - c * e) * invDet,
+	                        B * invDet, (a * i - c * g) * invDet, -(a * f - c * d) * invDet,
+	                        C * invDet, -(a * h - b * g) * invDet, (a * e - b * d) * invDet);
+}
+
+static quaternion_float multiply(const quaternion_float& q0, const quaternion_float& q1) {
+	quaternion_float q;
+
+	q.x = q0.w * q1.x + q0.x * q1.w + q0.y * q1.z - q0.z * q1.y;
+	q.y = q0.w * q1.y - q0.x * q1.z + q0.y * q1.w + q0.z * q1.x;
+	q.z = q0.w * q1.z + q0.x * q1.y - q0.y * q1.x + q0.z * q1.w;
+	q.w = q0.w * q1.w - q0.x * q1.x - q0.y * q1.y - q0.z * q1.z;
+
+	return q;
+}
+
+// Same weights and special cases as quaternion_slerp, no shortest path flip.
+static quaternion_float slerp(const quaternion_float& q0, const quaternion_float& q1, float t) {
+	const float cosHalfTheta = q0.x * q1.x + q0.y * q1.y + q0.z * q1.z + q0.w * q1.w;
+
+	if (std::fabs(cosHalfTheta) >= 1.0f)
+		return q0;
+
+	const float halfTheta = std::acos(cosHalfTheta);
+	const float sinHalfTheta = std::sqrt(1.0f - cosHalfTheta * cosHalfTheta);
+
+	if (std::fabs(sinHalfTheta) < 0.001f)
+		return { (q0.x + q1.x) * 0.5f, (q0.y + q1.y) * 0.5f, (q0.z + q1.z) * 0.5f, (q0.w + q1.w) * 0.5f };
+
+	const float a = std::sin((1 - t) * halfTheta) / sinHalfTheta;
+	const float b = std::sin(t * halfTheta) / sinHalfTheta;
+
+	return { q0.x * a + q1.x * b, q0.y * a + q1.y * b, q0.z * a + q1.z * b, q0.w * a + q1.w * b };
+}
+
+static float3 rotate(const quaternion_float& q, const float3& v) {
+	const float3 qp = { q.x, q.y, q.z };
+	const float w = q.w;
+
+	const float d = qp.x * v.x + qp.y * v.y + qp.z * v.z;
+	const float qq = qp.x * qp.x + qp.y * qp.y + qp.z * qp.z;
+	const float3 c = { qp.y * v.z - qp.z * v.y, qp.z * v.x - qp.x * v.z, qp.x * v.y - qp.y * v.x };
+
+	return { 2 * d * qp.x + (w * w - qq) * v.x + 2 * w * c.x,
+	         2 * d * qp.y + (w * w - qq) * v.y + 2 * w * c.y,
+	         2 * d * qp.z + (w * w - qq) * v.z + 2 * w * c.z };
+}
+
+}
+
+// Inputs are large enough to defeat constant folding but stay in L1/L2.
+static constexpr size_t COUNT = 1024;
+static constexpr int ITERATIONS = 2000;
+
+static volatile float gSink;
+
+template<typename F>
+static double measureNs(F&& f) {
+	// Best of a few runs, the minimum is the most stable number on a busy machine.
+	double best = 1e30;
+
+	for (int run = 0; run < 5; run++) {
+		const auto start = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < ITERATIONS; i++)
+			f();
+
+		const auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		best = std::min(best, ns / (static_cast<double>(ITERATIONS) * COUNT));
+	}
+
+	return best;
+}
+
+static float maxError(const float* a, const float* b, size_t n) {
+	float e = 0;
+
+	for (size_t i = 0; i < n; i++)
+		e = std::max(e, std::fabs(a[i] - b[i]) / std::max(1.0f, std::fabs(b[i])));
+
+	return e;
+}
+
+static int gFailures = 0;
+
+static void report(const char* name, double atomNs, double refNs, float error, float tolerance, double appleNs = 0) {
+	std::printf("%-24s %8.2f ns %8.2f ns %7.2fx", name, atomNs, refNs, refNs / atomNs);
+
+	if (appleNs > 0)
+		std::printf(" %8.2f ns %7.2fx", appleNs, appleNs / atomNs);
+
+	std::printf("   err %.2e%s\n", error, error > tolerance ? "  FAILED" : "");
+
+	if (error > tolerance)
+		gFailures++;
+}
+
+int main() {
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+	std::vector<float4x4> a(COUNT), b(COUNT), outAtom(COUNT), outRef(COUNT);
+	std::vector<float3x3> a3(COUNT), out3Atom(COUNT), out3Ref(COUNT);
+	std::vector<quaternion_float> qa(COUNT), qb(COUNT), qAtom(COUNT), qRef(COUNT);
+	std::vector<float3> v(COUNT), vAtom(COUNT), vRef(COUNT);
+
+	// Well conditioned inputs: rotation * scale + translation, like real transforms.
+	for (size_t i = 0; i < COUNT; i++) {
+		const float3 axis = vector_make(dist(rng), dist(rng), dist(rng) + 2.0f);
+		const float3 s = vector_make(1.5f + dist(rng), 1.5f + dist(rng), 1.5f + dist(rng));
+		const float3 t = vector_make(dist(rng) * 10, dist(rng) * 10, dist(rng) * 10);
+
+		a[i] = matrix_multiply(matrix4x4_translation(t), matrix_multiply(matrix4x4_rotation(dist(rng) * PI, axis), matrix4x4_scale(s)));
+		a[i].columns[0].w = dist(rng) * 0.1f; // Keep the projective row general
+		b[i] = matrix4x4_rotation(dist(rng) * PI, vector_make(dist(rng), 1.0f, dist(rng)));
+		a3[i] = matrix3x3_upper_left(a[i]);
+
+		qa[i] = quaternion(dist(rng) * PI, axis);
+		qb[i] = quaternion(dist(rng) * PI, vector_make(dist(rng), 1.0f, dist(rng)));
+		v[i] = vector_make(dist(rng), dist(rng), dist(rng));
+	}
+
+	std::printf("AtomMath micro-benchmarks (%s)\n\n", ATOM_SIMD_NAME);
+	std::printf("%-24s %11s %11s %8s", "", "AtomMath", "scalar", "speedup");
+#ifdef __APPLE__
+	std::printf(" %11s %8s", "simd", "speedup");
+#endif
+	std::printf("\n");
+
+	// matrix * matrix
+	{
+		const double atomNs = measureNs([&] { for (size_t i = 0; i < COUNT; i++) outAtom[i] = matrix_multiply(a[i], b[i]); gSink = outAtom[COUNT - 1].columns[3].w; });
+		const double refNs = measureNs([&] { for (size_t i = 0; i < COUNT; i++) outRef[i] = Reference::multiply(a[i], b[i]); gSink = outRef[COUNT - 1].columns[3].w; });
+		double appleNs = 0;
+#ifdef __APPLE__
+		std::vector<simd_float4x4> sa(COUNT), sb(COUNT), so(COUNT);
+		memcpy(sa.data(), a.data(), COUNT * sizeof(float4x4));
+		memcpy(sb.data(), b.data(), COUNT * sizeof(float4x4));
+		appleNs = measureNs([&] { for (size_t i = 0; i < COUNT; i++) so[i] = simd_mul(sa[i], sb[i]); gSink = so[COUNT - 1].columns[3].w; });
+#endif
+		report("float4x4 * float4x4", atomNs, refNs, maxError(&outAtom[0].columns[0].x, &outRef[0].columns[0].x, COUNT * 16), 1e-5f, appleNs);
+	}
+
+	// matrix * vector
+	{
+		std::vector<float4> v4(COUNT), o4Atom(COUNT), o4Ref(COUNT);
+
+		for (size_t i = 0; i < COUNT; i++)
+			v4[i] = { v[i].x, v[i].y, v[i].z, 1.0f };
+
+		const double atomNs = measureNs([&] { for (size_t i = 0; i < COUNT; i++) o4Atom[i] = matrix_multiply(a[i], v4[i]); gSink = o4Atom[COUNT - 1].w; });
+		const double refNs = measureNs([&] {
+			for (size_t i = 0; i < COUNT; i++) {
+				float4 r = {};
+				for (int row = 0; row < 4; row++)
+					r[row] = a[i].columns[0][row] * v4[i].x + a[i].columns[1][row] * v4[i].y + a[i].columns[2][row] * v4[i].z + a[i].columns[3][row] * v4[i].w;
+				o4Ref[i] = r;
+			}
+			gSink = o4Ref[COUNT - 1].w;
+		});
+		double appleNs = 0;
+#ifdef __APPLE__
+		std::vector<simd_float4x4> sa(COUNT);
+		std::vector<simd_float4> sv(COUNT), so(COUNT);
+		memcpy(sa.data(), a.data(), COUNT * sizeof(float4x4));
+		memcpy(sv.data(), v4.data(), COUNT * sizeof(float4));
+		appleNs = measureNs([&] { for (size_t i = 0; i < COUNT; i++) so[i] = simd_mul(sa[i], sv[i]); gSink = so[COUNT - 1].w; });
+#endif
+		report("float4x4 * float4", atomNs, refNs, maxError(&o4Atom[0].x, &o4Ref[0].x, COUNT * 4), 1e-5f, appleNs);
+	}
+
+	// 4x4 inverse
+	{
+		const double atomNs = measureNs([&] { for (size_t i = 0; i < COUNT; i++) outAtom[i] = matrix_invert(a[i]); gSink = outAtom[COUNT - 1].columns[3].w; });
+		const double refNs = measureNs([&] { for (size_t i = 0; i < COUNT; i++) outRef[i] = Reference::invert(a[i]); gSink = outRef[COUNT - 1].columns[3].w; });
+		double appleNs = 0;
+#ifdef __APPLE__
+		std::vector<simd_float4x4> sa(COUNT), so(COUNT);
+		memcpy(sa.data(), a.data(), COUNT * sizeof(float4x4));
+		appleNs = measureNs([&] { for (size_t i = 0; i < COUNT; i++) so[i] = simd_inverse(sa[i]); gSink = so[COUNT - 1].columns[3].w; });
+#endif
+		report("float4x4 inverse", atomNs, refNs, maxError(&outAtom[0].columns[0].x, &outRef[0].columns[0].x, COUNT * 16), 1e-4f, appleNs);
+	}
+
+	// 3x3 inverse
+	{
+		const double atomNs = measureNs([&] { for (size_t i = 0; i < COUNT; i++) out3Atom[i] = matrix_invert(a3[i]); gSink = out3Atom[COUNT - 1].columns[2].z; });
+		const double refNs = measureNs([&] { for (size_t i = 0; i < COUNT; i++) out3Ref[i] = Reference::invert(a3[i]); gSink = out3Ref[COUNT - 1].columns[2].z; });
+		double appleNs = 0;
+#ifdef __APPLE__
+		std::vector<simd_float3x3> sa(COUNT), so(COUNT);
+		memcpy(sa.data(), a3.data(), COUNT * sizeof(float3x3));
+		appleNs = measureNs([&] { for (size_t i = 0; i < COUNT; i++) so[i] = simd_inverse(sa[i]); gSink = so[COUNT - 1].columns[2].z; });
+#endif
+		float error = 0;
+
+		for (size_t i = 0; i < COUNT; i++)
+			for (int c = 0; c < 3; c++)
+				error = std::max(error, maxError(&out3Atom[i].columns[c].x, &out3Ref[i].columns[c].x, 3));
+
+		report("float3x3 inverse", atomNs, refNs, error, 1e-4f, appleNs);
+	}
+
+	// quaternion * quaternion
+	{
+		const double atomNs = measureNs([&] { for (size_t i = 0; i < COUNT; i++) qAtom[i] = quaternion_multiply(qa[i], qb[i]); gSink = qAtom[COUNT - 1].w; });
+		const double refNs = measureNs([&] { for (size_t i = 0; i < COUNT; i++) qRef[i] = Reference::multiply(qa[i], qb[i]); gSink = qRef[COUNT - 1].w; });
+		double appleNs = 0;
+#ifdef __APPLE__
+		std::vector<simd_quatf> sa(COUNT), sb(COUNT), so(COUNT);
+		memcpy(sa.data(), qa.data(), COUNT * sizeof(float4));
+		memcpy(sb.data(), qb.data(), COUNT * sizeof(float4));
+		appleNs = measureNs([&] { for (size_t i = 0; i < COUNT; i++) so[i] = simd_mul(sa[i], sb[i]); gSink = so[COUNT - 1].vector.w; });
+#endif
+		report("quaternion multiply", atomNs, refNs, maxError(&qAtom[0].x, &qRef[0].x, COUNT * 4), 1e-5f, appleNs);
+	}
+
+	// quaternion rotate
+	{
+		const double atomNs = measureNs([&] { for (size_t i = 0; i < COUNT; i++) vAtom[i] = quaternion_rotate_vector(qa[i], v[i]); gSink = vAtom[COUNT - 1].z; });
+		const double refNs = measureNs([&] { for (size_t i = 0; i < COUNT; i++) vRef[i] = Reference::rotate(qa[i], v[i]); gSink = vRef[COUNT - 1].z; });
+		double appleNs = 0;
+#ifdef __APPLE__
+		std::vector<simd_quatf> sq(COUNT);
+		std::vector<simd_float3> sv(COUNT), so(COUNT);
+		memcpy(sq.data(), qa.data(), COUNT * sizeof(float4));
+		memcpy(sv.data(), v.data(), COUNT * sizeof(float3));
+		appleNs = measureNs([&] { for (size_t i = 0; i < COUNT; i++) so[i] = simd_act(sq[i], sv[i]); gSink = so[COUNT - 1].z; });
+#endif
+		float error = 0;
+
+		for (size_t i = 0; i < COUNT; i++)
+			error = std::max(error, maxError(&vAtom[i].x, &vRef[i].x, 3));
+
+		report("quaternion rotate", atomNs, refNs, error, 1e-5f, appleNs);
+	}
+
+	// quaternion slerp
+	{
+		const double atomNs = measureNs([&] { for (size_t i = 0; i < COUNT; i++) qAtom[i] = quaternion_slerp(qa[i], qb[i], 0.3f); gSink = qAtom[COUNT - 1].w; });
+		const double refNs = measureNs([&] { for (size_t i = 0; i < COUNT; i++) qRef[i] = Reference::slerp(qa[i], qb[i], 0.3f); gSink = qRef[COUNT - 1].w; });
+		double appleNs = 0;
+#ifdef __APPLE__
+		std::vector<simd_quatf> sa(COUNT), sb(COUNT), so(COUNT);
+		memcpy(sa.data(), qa.data(), COUNT * sizeof(float4));
+		memcpy(sb.data(), qb.data(), COUNT * sizeof(float4));
+		appleNs = measureNs([&] { for (size_t i = 0; i < COUNT; i++) so[i] = simd_slerp(sa[i], sb[i], 0.3f); gSink = so[COUNT - 1].vector.w; });
+#endif
+		report("quaternion slerp", atomNs, refNs, maxError(&qAtom[0].x, &qRef[0].x, COUNT * 4), 1e-5f, appleNs);
+	}
+
+	// Sanity checks on the rest of the surface.
+	{
+		float error = 0;
+
+		for (size_t i = 0; i < COUNT; i++) {
+			const auto m = matrix_multiply(a[i], matrix_invert(a[i]));
+			error = std::max(error, maxError(&m.columns[0].x, &matrix_identity_float4x4.columns[0].x, 16));
+
+			const auto t = matrix_transpose(matrix_transpose(a[i]));
+			error = std::max(error, maxError(&t.columns[0].x, &a[i].columns[0].x, 16));
+
+			// Rotating by q and by its matrix must agree.
+			const auto r = matrix_multiply(matrix4x4_from_quaternion(qa[i]), float4 { v[i].x, v[i].y, v[i].z, 0.0f });
+			const auto rq = quaternion_rotate_vector(qa[i], v[i]);
+			error = std::max(error, maxError(&r.x, &rq.x, 3));
+
+			const auto back = quaternion(matrix3x3_from_quaternion(qa[i]));
+			const float sign = vector_dot(back, qa[i]) < 0 ? -1.0f : 1.0f;
+			const auto backSigned = back * sign;
+			error = std::max(error, maxError(&backSigned.x, &qa[i].x, 4));
+		}
+
+		std::printf("\nround trips (inverse, transpose, quaternion <-> matrix) max error %.2e%s\n", error, error > 1e-4f ? "  FAILED" : "");
+
+		if (error > 1e-4f)
+			gFailures++;
+	}
+
+	return gFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,325 @@
+// ReSharper disable CppInconsistentNaming
+// Vertex welding with MeshBuilder and reordering with MeshOptimizer: memory of unindexed triangle
+// soups against the welded mesh, then ACMR/ATVR and overdraw before and after optimizeMesh. Runs a
+// few generated meshes, and any .obj files given on the command line. Vertex shader runs are
+// estimated with a FIFO post transform cache, 16 entries is the classic size, 32 is closer to
+// current GPUs.
+#include "MeshBuilder.hpp"
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Atom;
+
+struct BenchVertex {
+	float position[3];
+	float normal[3];
+	float uv[2];
+
+	bool operator==(const BenchVertex& other) const { return memcmp(this, &other, sizeof *this) == 0; }
+};
+
+namespace std {
+
+template<>
+struct hash<BenchVertex> {
+	size_t operator()(const BenchVertex& v) const noexcept { return static_cast<size_t>(hashBytes(&v, sizeof v)); }
+};
+
+}
+
+static int gFailures = 0;
+
+static constexpr float PI_F = 3.14159265358979323846f;
+
+// Each quad of a (columns x rows) parametric grid as two triangles, 6 corners, like an exporter
+// writing flat triangle lists.
+template<typename F>
+static std::vector<BenchVertex> parametricSoup(int columns, int rows, F&& vertexAt) {
+	std::vector<BenchVertex> soup;
+	soup.reserve(static_cast<size_t>(columns) * rows * 6);
+
+	for (int r = 0; r < rows; r++)
+		for (int c = 0; c < columns; c++) {
+			const BenchVertex a = vertexAt(c, r), b = vertexAt(c + 1, r), d = vertexAt(c, r + 1), e = vertexAt(c + 1, r + 1);
+			soup.insert(soup.end(), { a, b, d, b, e, d });
+		}
+
+	return soup;
+}
+
+static std::vector<BenchVertex> sphereSoup(int segments, int rings) {
+	return parametricSoup(segments, rings, [&](int s, int r) {
+		const float theta = 2 * PI_F * static_cast<float>(s % segments) / static_cast<float>(segments);
+		const float phi = PI_F * static_cast<float>(r) / static_cast<float>(rings);
+		const float n[3] = { std::sin(phi) * std::cos(theta), std::cos(phi), std::sin(phi) * std::sin(theta) };
+
+		return BenchVertex{ { n[0], n[1], n[2] }, { n[0], n[1], n[2] }, { static_cast<float>(s) / segments, static_cast<float>(r) / rings } };
+	});
+}
+
+static std::vector<BenchVertex> torusSoup(int segments, int sides) {
+	return parametricSoup(segments, sides, [&](int s, int t) {
+		const float u = 2 * PI_F * static_cast<float>(s % segments) / static_cast<float>(segments);
+		const float v = 2 * PI_F * static_cast<float>(t % sides) / static_cast<float>(sides);
+		const float n[3] = { std::cos(v) * std::cos(u), std::sin(v), std::cos(v) * std::sin(u) };
+
+		return BenchVertex{ { (1 + 0.3f * std::cos(v)) * std::cos(u), 0.3f * std::sin(v), (1 + 0.3f * std::cos(v)) * std::sin(u) },
+		                    { n[0], n[1], n[2] }, { static_cast<float>(s) / segments, static_cast<float>(t) / sides } };
+	});
+}
+
+static std::vector<BenchVertex> terrainSoup(int size) {
+	return parametricSoup(size, size, [&](int x, int z) {
+		const float h = 0.1f * std::sin(static_cast<float>(x) * 0.3f) * std::cos(static_cast<float>(z) * 0.2f);
+
+		return BenchVertex{ { static_cast<float>(x), h, static_cast<float>(z) }, { 0, 1, 0 }, { static_cast<float>(x) / size, static_cast<float>(z) / size } };
+	});
+}
+
+// v/vt/vn/f only, polygons are fanned. Every face corner becomes its own soup vertex.
+static std::vector<BenchVertex> objSoup(const std::string& path) {
+	std::ifstream file(path);
+	std::vector<float> positions, normals, uvs;
+	std::vector<BenchVertex> soup;
+	std::string line;
+
+	while (std::getline(file, line)) {
+		std::istringstream in(line);
+		std::string tag;
+		in >> tag;
+
+		if (tag == "v" || tag == "vn") {
+			float x, y, z;
+			in >> x >> y >> z;
+			auto& target = tag == "v" ? positions : normals;
+			target.insert(target.end(), { x, y, z });
+		} else if (tag == "vt") {
+			float u, v;
+			in >> u >> v;
+			uvs.insert(uvs.end(), { u, v });
+		} else if (tag == "f") {
+			std::vector<BenchVertex> corners;
+			std::string corner;
+
+			while (in >> corner) {
+				BenchVertex v = {};
+				int p = 0, t = 0, n = 0;
+
+				if (sscanf(corner.c_str(), "%d/%d/%d", &p, &t, &n) < 3 && sscanf(corner.c_str(), "%d//%d", &p, &n) < 2)
+					sscanf(corner.c_str(), "%d/%d", &p, &t);
+
+				if (p < 0) p += static_cast<int>(positions.size() / 3) + 1;
+				if (t < 0) t += static_cast<int>(uvs.size() / 2) + 1;
+				if (n < 0) n += static_cast<int>(normals.size() / 3) + 1;
+
+				if (p > 0) memcpy(v.position, &positions[(p - 1) * 3], sizeof v.position);
+				if (t > 0) memcpy(v.uv, &uvs[(t - 1) * 2], sizeof v.uv);
+				if (n > 0) memcpy(v.normal, &normals[(n - 1) * 3], sizeof v.normal);
+
+				corners.push_back(v);
+			}
+
+			for (size_t i = 2; i < corners.size(); i++)
+				soup.insert(soup.end(), { corners[0], corners[i - 1], corners[i] });
+		}
+	}
+
+	return soup;
+}
+
+// Overdraw estimate, pixels shaded / pixels covered with a depth test, rasterized in draw order
+// from both sides of each axis. Triangles go to the view they face, so winding doesn't matter.
+static float estimateOverdraw(const IndexedMesh<BenchVertex>& mesh) {
+	constexpr int SIZE = 256;
+
+	float minP[3] = { 1e30f, 1e30f, 1e30f }, maxP[3] = { -1e30f, -1e30f, -1e30f };
+
+	for (const auto& v : mesh.vertices)
+		for (int k = 0; k < 3; k++) {
+			minP[k] = std::min(minP[k], v.position[k]);
+			maxP[k] = std::max(maxP[k], v.position[k]);
+		}
+
+	const float extent = std::max({ maxP[0] - minP[0], maxP[1] - minP[1], maxP[2] - minP[2], 1e-6f });
+	size_t shaded = 0, covered = 0;
+
+	// Which way is out, from the sign of the volume. Generated and exported meshes differ in winding.
+	double signedVolume = 0;
+
+	for (size_t t = 0; t + 2 < mesh.indexCount; t += 3) {
+		const float* a = mesh.vertices[mesh.index(t)].position;
+		const float* b = mesh.vertices[mesh.index(t + 1)].position;
+		const float* c = mesh.vertices[mesh.index(t + 2)].position;
+
+		signedVolume += a[0] * (b[1] * c[2] - b[2] * c[1]) + a[1] * (b[2] * c[0] - b[0] * c[2]) + a[2] * (b[0] * c[1] - b[1] * c[0]);
+	}
+
+	const float outwards = signedVolume < 0 ? -1.0f : 1.0f;
+
+	for (int axis = 0; axis < 3; axis++) {
+		const int ua = (axis + 1) % 3, va = (axis + 2) % 3;
+		std::vector<float> depth[2] = { std::vector<float>(SIZE * SIZE, 1e30f), std::vector<float>(SIZE * SIZE, 1e30f) };
+
+		for (size_t t = 0; t + 2 < mesh.indexCount; t += 3) {
+			float x[3], y[3], z[3];
+
+			for (int k = 0; k < 3; k++) {
+				const float* p = mesh.vertices[mesh.index(t + k)].position;
+				x[k] = (p[ua] - minP[ua]) / extent * SIZE;
+				y[k] = (p[va] - minP[va]) / extent * SIZE;
+				z[k] = (p[axis] - minP[axis]) / extent;
+			}
+
+			const float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+
+			if (area == 0)
+				continue;
+
+			// Each side of the axis is its own view, nearer is further along the direction it looks from.
+			const int side = area > 0 ? 0 : 1;
+			auto& buffer = depth[side];
+
+			const int x0 = std::max(0, static_cast<int>(std::floor(std::min({ x[0], x[1], x[2] }))));
+			const int x1 = std::min(SIZE - 1, static_cast<int>(std::ceil(std::max({ x[0], x[1], x[2] }))));
+			const int y0 = std::max(0, static_cast<int>(std::floor(std::min({ y[0], y[1], y[2] }))));
+			const int y1 = std::min(SIZE - 1, static_cast<int>(std::ceil(std::max({ y[0], y[1], y[2] }))));
+
+			for (int py = y0; py <= y1; py++)
+				for (int px = x0; px <= x1; px++) {
+					const float cx = static_cast<float>(px) + 0.5f, cy = static_cast<float>(py) + 0.5f;
+					const float w0 = ((x[1] - cx) * (y[2] - cy) - (x[2] - cx) * (y[1] - cy)) / area;
+					const float w1 = ((x[2] - cx) * (y[0] - cy) - (x[0] - cx) * (y[2] - cy)) / area;
+					const float w2 = 1 - w0 - w1;
+
+					if (w0 < 0 || w1 < 0 || w2 < 0)
+						continue;
+
+					const float d = (w0 * z[0] + w1 * z[1] + w2 * z[2]) * (side == 0 ? -outwards : outwards);
+					float& stored = buffer[py * SIZE + px];
+
+					if (stored == 1e30f)
+						covered++;
+
+					if (d < stored) {
+						stored = d;
+						shaded++;
+					}
+				}
+		}
+	}
+
+	return covered ? static_cast<float>(shaded) / static_cast<float>(covered) : 0.0f;
+}
+
+static void printCacheStats(const char* label, const IndexedMesh<BenchVertex>& mesh) {
+	const auto indices = mesh.indices();
+	const auto fifo16 = analyzeVertexCache(indices.data(), indices.size(), mesh.vertices.size(), 16);
+	const auto fifo32 = analyzeVertexCache(indices.data(), indices.size(), mesh.vertices.size(), 32);
+
+	std::printf("  %-9s FIFO 16 ACMR %.3f ATVR %.3f   FIFO 32 ACMR %.3f ATVR %.3f   overdraw %.3f\n",
+	            label, fifo16.acmr, fifo16.atvr, fifo32.acmr, fifo32.atvr, estimateOverdraw(mesh));
+}
+
+// Triangles in random order, like an exporter that doesn't care. Worst case for the post transform cache.
+static std::vector<BenchVertex> shuffleTriangles(std::vector<BenchVertex> soup) {
+	std::mt19937 rng(1234);
+
+	for (size_t t = soup.size() / 3; t > 1; t--) {
+		const size_t other = rng() % t;
+		std::swap_ranges(soup.begin() + (t - 1) * 3, soup.begin() + t * 3, soup.begin() + other * 3);
+	}
+
+	return soup;
+}
+
+static void run(const char* name, const std::vector<BenchVertex>& soup) {
+	if (soup.empty()) {
+		std::printf("%s: no triangles\n\n", name);
+		return;
+	}
+
+	// Best of a few runs, the minimum is the most stable number on a busy machine.
+	double bestSeconds = 1e30;
+	IndexedMesh<BenchVertex> mesh;
+
+	for (int run = 0; run < 5; run++) {
+		const auto start = std::chrono::steady_clock::now();
+
+		MeshBuilder<BenchVertex> builder(soup.size() / 4);
+		builder.addTriangles(soup.data(), soup.size());
+		mesh = builder.build();
+
+		bestSeconds = std::min(bestSeconds, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	// Every welded triangle has to read back as the soup triangle it came from.
+	bool matches = mesh.indexCount == soup.size();
+
+	for (size_t i = 0; matches && i < soup.size(); i++)
+		matches = mesh.vertices[mesh.index(i)] == soup[i];
+
+	const size_t soupBytes = soup.size() * sizeof(BenchVertex);
+	const size_t indexedBytes = mesh.vertexBytes() + mesh.indexBytes();
+
+	std::printf("%s: %zu triangles%s\n", name, soup.size() / 3, matches ? "" : "  FAILED");
+
+	if (!matches)
+		gFailures++;
+
+	std::printf("  vertices        %9zu -> %9zu unique, %s indices\n", soup.size(), mesh.vertices.size(), mesh.indexFormat == IndexFormat::UInt16 ? "16 bit" : "32 bit");
+	std::printf("  memory          %9.2f -> %9.2f KB  (%.1f%% saved)\n", soupBytes / 1024.0, indexedBytes / 1024.0, 100.0 * (1.0 - static_cast<double>(indexedBytes) / soupBytes));
+	std::printf("  weld            %9.1f M input vertices/s\n", soup.size() / bestSeconds / 1e6);
+
+	// Reordering must keep every triangle, with its winding, just at a different position.
+	const auto triangleSet = [](const IndexedMesh<BenchVertex>& m) {
+		std::vector<std::array<BenchVertex, 3>> triangles(m.indexCount / 3);
+
+		for (size_t t = 0; t < triangles.size(); t++) {
+			std::array<BenchVertex, 3> corners = { m.vertices[m.index(t * 3)], m.vertices[m.index(t * 3 + 1)], m.vertices[m.index(t * 3 + 2)] };
+			const auto first = std::min_element(corners.begin(), corners.end(), [](const BenchVertex& a, const BenchVertex& b) { return memcmp(&a, &b, sizeof a) < 0; });
+			std::rotate(corners.begin(), first, corners.end());
+			triangles[t] = corners;
+		}
+
+		std::sort(triangles.begin(), triangles.end(), [](const auto& a, const auto& b) { return memcmp(a.data(), b.data(), sizeof a) < 0; });
+		return triangles;
+	};
+
+	IndexedMesh<BenchVertex> optimized = mesh;
+	const auto start = std::chrono::steady_clock::now();
+	optimizeMesh(optimized, offsetof(BenchVertex, position));
+	const double optimizeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	const bool sameTriangles = memcmp(triangleSet(mesh).data(), triangleSet(optimized).data(), mesh.indexCount / 3 * sizeof(std::array<BenchVertex, 3>)) == 0;
+
+	if (!sameTriangles)
+		gFailures++;
+
+	printCacheStats("welded", mesh);
+	printCacheStats("optimized", optimized);
+	std::printf("  optimize        %9.1f M triangles/s%s\n\n", mesh.indexCount / 3 / optimizeSeconds / 1e6, sameTriangles ? "" : "  FAILED");
+}
+
+int main(int argc, char** argv) {
+	run("UV sphere 64x32", sphereSoup(64, 32));
+	run("torus 128x48", torusSoup(128, 48));
+	run("terrain 512x512", terrainSoup(512));
+	run("torus 128x48, shuffled triangles", shuffleTriangles(torusSoup(128, 48)));
+
+	for (int i = 1; i < argc; i++)
+		run(argv[i], objSoup(argv[i]));
+
+	return gFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,260 @@
+// ReSharper disable CppInconsistentNaming
+// Mip chain generation speed and correctness, then what the chain saves when sampling a minified
+// surface. The sampling part walks a textured ground plane receding to the horizon in 8x8 pixel
+// tiles like a GPU rasterizer, fetching texels through a simulated texture cache (16KB, 4 way, 64
+// byte lines holding 4x4 texel blocks). Memory traffic is the lines it misses, level 0 only
+// against trilinear over the chain.
+#include "AtomSimd.hpp"
+#include "MipChain.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace Atom;
+
+static int gFailures = 0;
+
+static void check(bool condition, const char* what) {
+	if (!condition) {
+		std::printf("  FAILED: %s\n", what);
+		gFailures++;
+	}
+}
+
+template<typename F>
+static double measureSeconds(F&& f) {
+	double best = 1e30;
+
+	for (int run = 0; run < 3; run++) {
+		const auto start = std::chrono::steady_clock::now();
+		f();
+		best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	return best;
+}
+
+// Smooth color noise with some fine detail, an image that minifies badly without filtering.
+static std::vector<uint8_t> testImage(uint32_t size) {
+	std::vector<uint8_t> image(static_cast<size_t>(size) * size * 4);
+
+	for (uint32_t y = 0; y < size; y++)
+		for (uint32_t x = 0; x < size; x++) {
+			uint8_t* p = &image[(static_cast<size_t>(y) * size + x) * 4];
+			const float fx = static_cast<float>(x) / size, fy = static_cast<float>(y) / size;
+			const bool fine = ((x >> 1) ^ (y >> 1)) & 1;
+
+			p[0] = static_cast<uint8_t>(127 + 100 * std::sin(fx * 13) * std::cos(fy * 7) + (fine ? 25 : -25));
+			p[1] = static_cast<uint8_t>(127 + 120 * std::sin(fx * 5 + fy * 9));
+			p[2] = static_cast<uint8_t>(fine ? 220 : 30);
+			p[3] = 255;
+		}
+
+	return image;
+}
+
+static void checkCorrectness() {
+	// 1 pixel black/white checker. Averaged in linear light it is 0.5, sRGB 188, naively 128.
+	const uint32_t size = 64;
+	std::vector<uint8_t> checker(size * size * 4);
+
+	for (uint32_t i = 0; i < size * size; i++) {
+		const uint8_t v = ((i % size + i / size) & 1) ? 255 : 0;
+		checker[i * 4 + 0] = checker[i * 4 + 1] = checker[i * 4 + 2] = v;
+		checker[i * 4 + 3] = v;
+	}
+
+	for (MipFilter filter : { MipFilter::Box, MipFilter::Kaiser }) {
+		const MipChain srgb = generateMipChain(checker.data(), size, size, true, filter);
+		const MipChain linear = generateMipChain(checker.data(), size, size, false, filter);
+
+		check(srgb.levels.size() == 7 && srgb.levels.back().width == 1 && srgb.data.size() == 4 * (64 * 64 + 32 * 32 + 16 * 16 + 8 * 8 + 4 * 4 + 2 * 2 + 1), "chain layout");
+
+		// Kaiser taps reach past the edges, where clamping breaks the pattern, so only its inner pixels.
+		for (size_t level = 1; level < srgb.levels.size(); level++) {
+			const MipLevel& l = srgb.levels[level];
+			const uint32_t border = filter == MipFilter::Kaiser ? 2 : 0;
+
+			for (uint32_t y = border; y + border < l.height; y++)
+				for (uint32_t x = border; x + border < l.width; x++)
+					for (uint32_t c = 0; c < 4; c++) {
+						const size_t i = (static_cast<size_t>(y) * l.width + x) * 4 + c;
+						check(std::abs(srgb.level(level)[i] - (c == 3 ? 128 : 188)) <= 1, "sRGB checker averages to 188, alpha to 128");
+						check(std::abs(linear.level(level)[i] - 128) <= 1, "linear checker averages to 128");
+
+						if (gFailures)
+							return;
+					}
+		}
+	}
+
+	// Odd sizes round down and constant images stay constant under both filters.
+	std::vector<uint8_t> flat(37 * 11 * 4, 77);
+	const MipChain odd = generateMipChain(flat.data(), 37, 11, true, MipFilter::Kaiser);
+	check(odd.levels.size() == 6 && odd.levels[1].width == 18 && odd.levels[1].height == 5 && odd.levels[5].width == 1, "odd sizes");
+	check(std::all_of(odd.data.begin(), odd.data.end(), [](uint8_t v) { return v == 77; }), "flat image stays flat");
+
+	std::printf("  sRGB checker -> 188 per level (not 128), odd sizes, flat images: %s\n\n", gFailures ? "FAILED" : "ok");
+}
+
+// Set associative LRU cache of 64 byte lines.
+class TextureCache {
+public:
+	TextureCache(uint32_t sets, uint32_t ways) : mSets(sets), mWays(ways), mTags(static_cast<size_t>(sets) * ways, ~0ull), mAges(mTags.size(), 0) {}
+
+	void access(uint64_t line) {
+		const size_t set = static_cast<size_t>(line % mSets) * mWays;
+		mClock++;
+
+		size_t oldest = set;
+
+		for (size_t i = set; i < set + mWays; i++) {
+			if (mTags[i] == line) {
+				mAges[i] = mClock;
+				return;
+			}
+
+			if (mAges[i] < mAges[oldest])
+				oldest = i;
+		}
+
+		mTags[oldest] = line;
+		mAges[oldest] = mClock;
+		misses++;
+	}
+
+	uint64_t misses = 0;
+
+private:
+	uint32_t mSets, mWays;
+	std::vector<uint64_t> mTags, mAges;
+	uint64_t mClock = 0;
+};
+
+struct SampleStats {
+	uint64_t texels = 0;
+	uint64_t bytes = 0;
+	uint64_t pixels = 0;
+};
+
+// Ground plane at y = -1 under a camera pitched down a little, 8 UV repeats every 10 units.
+static SampleStats renderPlane(const MipChain& chain, bool mipmapped, uint32_t screenWidth, uint32_t screenHeight) {
+	TextureCache cache(64, 4);
+	SampleStats stats;
+
+	// Cache line index of each level's first 4x4 block, blocks row major within a level.
+	std::vector<uint64_t> base;
+	uint64_t lines = 0;
+
+	for (const auto& level : chain.levels) {
+		base.push_back(lines);
+		lines += static_cast<uint64_t>((level.width + 3) / 4) * ((level.height + 3) / 4);
+	}
+
+	const float tanHalfFov = std::tan(45.0f * 3.14159265f / 180), aspect = static_cast<float>(screenWidth) / screenHeight;
+	const float pitch = 0.15f, cp = std::cos(pitch), sp = std::sin(pitch);
+
+	const auto uvAt = [&](float px, float py, float& u, float& v) {
+		const float x = (2 * px / screenWidth - 1) * tanHalfFov * aspect;
+		const float y = (1 - 2 * py / screenHeight) * tanHalfFov;
+
+		// Camera looks down +z, tilted by pitch around x.
+		const float dy = y * cp - sp;
+		const float dz = y * sp + cp;
+
+		if (dy > -1e-3f)
+			return false;
+
+		const float t = -1 / dy;
+		u = x * t * 0.8f;
+		v = dz * t * 0.8f;
+		return t < 400;
+	};
+
+	const auto fetch = [&](uint32_t level, int tx, int ty) {
+		const MipLevel& l = chain.levels[level];
+		tx = ((tx % static_cast<int>(l.width)) + l.width) % l.width;
+		ty = ((ty % static_cast<int>(l.height)) + l.height) % l.height;
+
+		cache.access(base[level] + static_cast<uint64_t>(ty / 4) * ((l.width + 3) / 4) + tx / 4);
+		stats.texels++;
+	};
+
+	const auto bilinear = [&](uint32_t level, float u, float v) {
+		const float x = u * chain.levels[level].width - 0.5f, y = v * chain.levels[level].height - 0.5f;
+		const int tx = static_cast<int>(std::floor(x)), ty = static_cast<int>(std::floor(y));
+
+		fetch(level, tx, ty);
+		fetch(level, tx + 1, ty);
+		fetch(level, tx, ty + 1);
+		fetch(level, tx + 1, ty + 1);
+	};
+
+	const float size = static_cast<float>(chain.levels[0].width);
+	const auto maxLevel = static_cast<float>(chain.levels.size() - 1);
+
+	for (uint32_t tileY = 0; tileY < screenHeight; tileY += 8)
+		for (uint32_t tileX = 0; tileX < screenWidth; tileX += 8)
+			for (uint32_t py = tileY; py < std::min(tileY + 8, screenHeight); py++)
+				for (uint32_t px = tileX; px < std::min(tileX + 8, screenWidth); px++) {
+					float u, v, ux, vx, uy, vy;
+
+					if (!uvAt(px + 0.5f, py + 0.5f, u, v) || !uvAt(px + 1.5f, py + 0.5f, ux, vx) || !uvAt(px + 0.5f, py + 1.5f, uy, vy))
+						continue;
+
+					stats.pixels++;
+
+					if (!mipmapped) {
+						bilinear(0, u, v);
+						continue;
+					}
+
+					// Level of detail from the screen space derivatives, like the GPU's.
+					const float footprint = std::max(std::hypot(ux - u, vx - v), std::hypot(uy - u, vy - v)) * size;
+					const float lod = std::clamp(std::log2(std::max(footprint, 1e-6f)), 0.0f, maxLevel);
+					const auto level = static_cast<uint32_t>(lod);
+
+					bilinear(level, u, v);
+
+					if (lod > level && level < maxLevel)
+						bilinear(level + 1, u, v);
+				}
+
+	stats.bytes = cache.misses * 64;
+	return stats;
+}
+
+int main() {
+	std::printf("Mip chain benchmarks (%s)\n\n", ATOM_SIMD_NAME);
+
+	checkCorrectness();
+
+	const uint32_t size = 2048;
+	const auto image = testImage(size);
+
+	for (MipFilter filter : { MipFilter::Box, MipFilter::Kaiser }) {
+		MipChain chain;
+		const double seconds = measureSeconds([&] { chain = generateMipChain(image.data(), size, size, true, filter); });
+
+		std::printf("  %-6s  %ux%u sRGB, %zu levels in %7.1f ms  (%.0f MPixels/s of level 0)\n", filter == MipFilter::Box ? "box" : "kaiser", size, size, chain.levels.size(), seconds * 1e3, size * size / seconds / 1e6);
+	}
+
+	const MipChain chain = generateMipChain(image.data(), size, size, true, MipFilter::Box);
+	std::printf("  memory  %.1f MB -> %.1f MB with the chain\n\n", chain.levels[0].bytes() / 1048576.0, chain.data.size() / 1048576.0);
+
+	const SampleStats flat = renderPlane(chain, false, 1280, 720);
+	const SampleStats mipped = renderPlane(chain, true, 1280, 720);
+
+	std::printf("  ground plane, 1280x720, %llu textured pixels\n", static_cast<unsigned long long>(flat.pixels));
+	std::printf("  level 0 only  %8.2f MB fetched, %6.1f bytes per pixel\n", flat.bytes / 1048576.0, static_cast<double>(flat.bytes) / flat.pixels);
+	std::printf("  trilinear     %8.2f MB fetched, %6.1f bytes per pixel (%.2f texels per pixel)  %.1fx less\n",
+	            mipped.bytes / 1048576.0, static_cast<double>(mipped.bytes) / mipped.pixels, static_cast<double>(mipped.texels) / mipped.pixels, static_cast<double>(flat.bytes) / mipped.bytes);
+
+	check(mipped.bytes < flat.bytes, "mips reduce texture traffic");
+
+	return gFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,235 @@
+// ReSharper disable CppInconsistentNaming
+// Loose files against an asset pack. Writes a few thousand small assets (text like shaders, BC like
+// blocks and noise like JPEGs), packs them, checks every entry reads back byte for byte and times
+// reading all of them: one ifstream each (what AtomCore::readFile did), the VirtualFileSystem on the
+// loose directory and on the pack. On Linux the cold numbers drop the files from the page cache first
+// (posix_fadvise, no root needed), so they include the disk. Also times LZ4 on its own.
+#include "AssetPack.hpp"
+#include "Lz4.hpp"
+#include "ParallelFor.hpp"
+#include "VirtualFileSystem.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace Atom;
+
+static int gFailures = 0;
+static volatile uint64_t gSink;
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void check(bool condition, const char* what) {
+	if (!condition) {
+		std::printf("  FAILED: %s\n", what);
+		gFailures++;
+	}
+}
+
+static std::vector<uint8_t> makeAsset(std::mt19937& rng, int kind, size_t size) {
+	static const char* words[] = { "float4 ", "position", " = ", "in.", "texCoord", ";\n", "uniforms", "sampler", "(", ")", "vertex ", "return " };
+	std::vector<uint8_t> data;
+	data.reserve(size);
+
+	if (kind == 0) {
+		while (data.size() < size) {
+			const char* w = words[rng() % 12];
+			data.insert(data.end(), w, w + strlen(w));
+		}
+	} else if (kind == 1) {
+		// Smooth endpoints, random indices, about what BC7 blocks of a photo look like to LZ4.
+		for (uint32_t block = 0; data.size() < size; block++)
+			for (int i = 0; i < 16; i++)
+				data.push_back(static_cast<uint8_t>(i < 6 ? block / 64 + i : rng()));
+	} else {
+		while (data.size() < size)
+			data.push_back(static_cast<uint8_t>(rng()));
+	}
+
+	data.resize(size);
+	return data;
+}
+
+// Drops a file from the page cache so the next read goes to the disk. Does nothing elsewhere.
+static void evict(const std::string& path) {
+#if defined(__linux__)
+	const int fd = open(path.c_str(), O_RDONLY);
+
+	if (fd >= 0) {
+		fdatasync(fd);
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		close(fd);
+	}
+#else
+	(void)path;
+#endif
+}
+
+static std::vector<char> readWithStream(const std::string& path) {
+	std::ifstream file(path, std::ios::ate | std::ios::binary);
+	std::vector<char> buffer(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+	return buffer;
+}
+
+int main() {
+	std::printf("Asset pack vs loose files (%u threads)\n\n", parallelThreadCount());
+
+	const std::filesystem::path directory = std::filesystem::temp_directory_path() / "atom_pack_bench";
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory / "assets");
+
+	std::mt19937 rng(99);
+	std::vector<std::string> names;
+	std::vector<std::vector<uint8_t>> contents;
+	std::vector<AssetPackInput> inputs;
+	uint64_t totalBytes = 0;
+
+	// 3000 assets of 1-64KB, a third of each kind.
+	for (int i = 0; i < 3000; i++) {
+		const int kind = i % 3;
+		const size_t size = 1024 + rng() % (63 * 1024);
+		const std::string name = "assets/" + std::string(kind == 0 ? "shader" : kind == 1 ? "texture" : "image") + std::to_string(i) + (kind == 0 ? ".metal" : kind == 1 ? ".dds" : ".jpeg");
+
+		contents.push_back(makeAsset(rng, kind, size));
+		std::ofstream((directory / name).string(), std::ios::binary).write(reinterpret_cast<const char*>(contents.back().data()), static_cast<std::streamsize>(size));
+
+		names.push_back(name);
+		inputs.push_back({ name, (directory / name).string() });
+		totalBytes += size;
+	}
+
+	const std::string packPath = (directory / "assets.apak").string();
+
+	try {
+		auto start = std::chrono::steady_clock::now();
+		writeAssetPack(packPath, inputs);
+		const double packSeconds = secondsSince(start);
+
+		AssetPack pack;
+		check(pack.open(packPath), "pack opens");
+
+		size_t compressed = 0;
+
+		for (size_t i = 0; i < pack.entryCount(); i++)
+			compressed += pack.entry(i).compression != static_cast<uint32_t>(AssetCompression::None);
+
+		std::printf("%zu assets, %.1f MB -> %.1f MB pack (%zu compressed), packed in %.0f ms\n\n", names.size(), totalBytes / 1048576.0,
+		            std::filesystem::file_size(packPath) / 1048576.0, compressed, packSeconds * 1e3);
+
+		VirtualFileSystem looseFiles, packed;
+		looseFiles.mountDirectory(directory.string());
+
+		// Every asset back byte for byte, from both, and the misses miss.
+		check(packed.mountPack(packPath), "pack mounts");
+
+		bool same = true;
+
+		for (size_t i = 0; i < names.size(); i++) {
+			AssetFile a, b;
+			same &= looseFiles.open(names[i], a) && packed.open("./" + names[i], b) && a.size() == contents[i].size() && b.size() == contents[i].size() &&
+			        std::equal(a.data(), a.data() + a.size(), contents[i].begin()) && std::equal(b.data(), b.data() + b.size(), contents[i].begin());
+		}
+
+		check(same, "pack and loose files read back the same");
+		check(!packed.exists("assets/missing.png") && !looseFiles.exists("assets/missing.png"), "missing assets miss");
+		packed.unmountAll();
+
+		for (int cold = 0; cold < 2; cold++) {
+			auto evictAll = [&] {
+				if (!cold)
+					return;
+
+				for (const auto& name : names)
+					evict((directory / name).string());
+
+				evict(packPath);
+			};
+
+			// Warm runs read everything once before timing.
+			double seconds[3];
+
+			for (int method = 0; method < 3; method++) {
+				evictAll();
+
+				if (!cold)
+					for (const auto& name : names)
+						gSink += readWithStream((directory / name).string()).size();
+
+				uint64_t sum = 0;
+				start = std::chrono::steady_clock::now();
+
+				if (method == 0) {
+					for (const auto& name : names) {
+						const std::vector<char> data = readWithStream((directory / name).string());
+						sum += data.size() + static_cast<uint8_t>(data.back());
+					}
+				} else {
+					VirtualFileSystem files;
+
+					if (method == 1)
+						files.mountDirectory(directory.string());
+					else
+						files.mountPack(packPath);
+
+					// Touch the data like an upload would.
+					for (const auto& name : names) {
+						AssetFile file;
+						files.open(name, file);
+
+						for (size_t i = 0; i < file.size(); i += 4096)
+							sum += file.data()[i];
+
+						sum += file.size();
+					}
+				}
+
+				seconds[method] = secondsSince(start);
+				gSink += sum;
+			}
+
+			std::printf("%s  ifstream %7.1f ms   vfs loose %7.1f ms   vfs pack %7.1f ms   %.1fx\n", cold ? "cold" : "warm", seconds[0] * 1e3, seconds[1] * 1e3, seconds[2] * 1e3, seconds[0] / seconds[2]);
+		}
+
+		// LZ4 alone on the text like assets.
+		std::vector<uint8_t> text;
+
+		for (size_t i = 0; i < contents.size(); i += 3)
+			text.insert(text.end(), contents[i].begin(), contents[i].end());
+
+		std::vector<uint8_t> compressedText(lz4CompressBound(text.size())), decompressed(text.size());
+
+		start = std::chrono::steady_clock::now();
+		const size_t compressedSize = lz4Compress(text.data(), text.size(), compressedText.data(), compressedText.size());
+		const double compressSeconds = secondsSince(start);
+
+		start = std::chrono::steady_clock::now();
+		check(lz4Decompress(compressedText.data(), compressedSize, decompressed.data(), decompressed.size()) && decompressed == text, "lz4 round trip");
+		const double decompressSeconds = secondsSince(start);
+
+		std::printf("\nlz4 on %.1f MB of text: ratio %.2f, compress %.0f MB/s, decompress %.0f MB/s\n", text.size() / 1048576.0,
+		            static_cast<double>(text.size()) / compressedSize, text.size() / 1048576.0 / compressSeconds, text.size() / 1048576.0 / decompressSeconds);
+	} catch (const std::exception& e) {
+		std::printf("FAILED: %s", e.what());
+		return 1;
+	}
+
+	std::filesystem::remove_all(directory);
+
+	return gFailures == 0 ? 0 : 1;
+}
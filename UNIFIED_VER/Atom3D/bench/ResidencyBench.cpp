@@ -0,0 +1,161 @@
+// ReSharper disable CppInconsistentNaming
+// Texture streaming under a budget. A 64x64 grid of objects, each with its own 2048x2048 BC7
+// texture (21GB with every level resident), seen by a camera flying over them. Every frame requests
+// the level each object in range needs from its screen footprint, and TextureResidency streams and
+// evicts under a 256MB and a 32MB budget with a 32MB per frame upload cap. Prints how close residency gets to
+// what was asked for, the loads and evictions per frame and the cost of update().
+#include "BlockCompression.hpp"
+#include "MipChain.hpp"
+#include "TextureResidency.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+using namespace Atom;
+
+static int gFailures = 0;
+
+static void check(bool condition, const char* what) {
+	if (!condition) {
+		std::printf("  FAILED: %s\n", what);
+		gFailures++;
+	}
+}
+
+// Eviction order and the tail on a tiny budget, by hand.
+static void checkPolicy() {
+	TextureResidency residency;
+	const std::vector<uint64_t> levels = { 64, 16, 4, 1 };
+
+	const auto a = residency.add(levels, 2), b = residency.add(levels, 2);
+	residency.setBudget(5 + 5 + 16 + 64);
+
+	residency.request(a, 0);
+	auto changes = residency.update();
+	check(changes.size() == 1 && residency.stats(a).residentMip == 0, "streams a texture fully in");
+
+	// b wants its top level too, a isn't used any more and gives its levels up, oldest first.
+	residency.request(b, 0);
+	changes = residency.update();
+	check(residency.stats(b).residentMip == 0 && residency.stats(a).residentMip == 2 && residency.totals().residentBytes <= residency.totals().budgetBytes, "evicts the least recently used levels");
+
+	// Both wanted, only one fits, the one in place keeps its levels.
+	residency.request(a, 0);
+	residency.request(b, 0);
+	residency.update();
+	check(residency.stats(b).residentMip == 0 && residency.stats(a).residentMip == 2 && residency.totals().overBudget, "keeps levels in use");
+
+	// Lowering the budget evicts even what's in use, never the tail.
+	residency.setBudget(1);
+	residency.update();
+	check(residency.stats(a).residentMip == 2 && residency.stats(b).residentMip == 2, "tail stays resident");
+}
+
+static void run(uint64_t budget) {
+	constexpr int grid = 64;
+	constexpr float spacing = 8, objectSize = 8, fovY = 60 * 3.14159265f / 180, viewportHeight = 1440, range = 120;
+	constexpr uint32_t size = 2048;
+
+	std::vector<uint64_t> levelBytes;
+
+	for (uint32_t i = 0, s = size; i < mipLevelCount(size, size); i++, s = std::max(1u, s / 2))
+		levelBytes.push_back(textureLevelBytes(TextureFormat::BC7, s, s));
+
+	// Levels of 64x64 and down stay, 5.5KB per texture.
+	const auto tailMip = static_cast<uint32_t>(std::log2(size / 64));
+
+	TextureResidency residency;
+	residency.setBudget(budget);
+	residency.setUploadLimit(32 << 20);
+
+	std::vector<TextureResidency::Id> ids;
+	uint64_t fullBytes = 0;
+
+	for (int i = 0; i < grid * grid; i++) {
+		ids.push_back(residency.add(levelBytes, tailMip));
+		fullBytes += residency.stats(ids.back()).fullBytes;
+	}
+
+	std::printf("%d textures, %.1f GB with every level, %.1f MB tail, %.0f MB budget\n\n", grid * grid, fullBytes / 1073741824.0,
+	            residency.totals().residentBytes / 1048576.0, budget / 1048576.0);
+
+	constexpr int frames = 3000;
+	double updateSeconds = 0, worstUpdate = 0, deficit = 0;
+	uint64_t requests = 0, satisfied = 0, loads = 0, evictions = 0, uploadBytes = 0, peakUpload = 0, peakWanted = 0;
+	bool withinBudget = true;
+
+	std::vector<float> wanted(ids.size());
+
+	for (int frame = 0; frame < frames; frame++) {
+		// Lissajous flight over the grid at 2 units up.
+		const float t = frame * 0.004f;
+		const float cx = (0.5f + 0.45f * std::sin(t * 1.3f)) * grid * spacing, cz = (0.5f + 0.45f * std::sin(t * 0.7f + 1)) * grid * spacing;
+
+		for (int z = 0; z < grid; z++)
+			for (int x = 0; x < grid; x++) {
+				const float dx = x * spacing - cx, dz = z * spacing - cz;
+				const float distance = std::sqrt(dx * dx + dz * dz + 4);
+				const size_t i = static_cast<size_t>(z * grid + x);
+
+				wanted[i] = -1;
+
+				if (distance > range)
+					continue;
+
+				wanted[i] = mipForFootprint(size, size, screenFootprint(objectSize, distance, fovY, viewportHeight));
+				residency.request(ids[i], wanted[i]);
+			}
+
+		const auto start = std::chrono::steady_clock::now();
+		const auto changes = residency.update();
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		updateSeconds += seconds;
+		worstUpdate = std::max(worstUpdate, seconds);
+
+		const TextureResidencyTotals& totals = residency.totals();
+		loads += totals.loads;
+		evictions += totals.evictions;
+		uploadBytes += totals.uploadBytes;
+		peakUpload = std::max(peakUpload, totals.uploadBytes);
+		peakWanted = std::max(peakWanted, totals.wantedBytes);
+		withinBudget &= totals.residentBytes <= budget;
+
+		// Skip the first second, everything starts at the tail.
+		if (frame < 60)
+			continue;
+
+		for (size_t i = 0; i < ids.size(); i++) {
+			if (wanted[i] < 0)
+				continue;
+
+			const TextureResidencyStats stats = residency.stats(ids[i]);
+			requests++;
+			satisfied += stats.residentMip <= stats.wantedMip;
+			deficit += stats.residentMip - std::min(stats.residentMip, stats.wantedMip);
+		}
+
+		(void)changes;
+	}
+
+	check(withinBudget, "resident bytes stay within the budget");
+
+	std::printf("%d frames: up to %.0f MB wanted at once, %.1f%% of requests at their level, %.3f levels short on average\n", frames, peakWanted / 1048576.0, 100.0 * satisfied / requests, deficit / requests);
+	std::printf("per frame: %.1f loads, %.1f evictions, %.2f MB uploaded (peak %.1f MB)\n", static_cast<double>(loads) / frames,
+	            static_cast<double>(evictions) / frames, uploadBytes / 1048576.0 / frames, peakUpload / 1048576.0);
+	std::printf("update(): %.1f us average, %.1f us worst\n\n", updateSeconds / frames * 1e6, worstUpdate * 1e6);
+}
+
+int main() {
+	std::printf("Texture residency streaming\n\n");
+	checkPolicy();
+
+	// Room for everything in view, then a quarter of that.
+	run(256ull << 20);
+	run(32ull << 20);
+
+	return gFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+// ReSharper disable CppInconsistentNaming
+// Startup with many textures: decoding them one after another on the calling thread, the way Texture
+// used to in Core::init, against handing each to runAsync like the Metal TextureLoader does. Decodes
+// the Metal sample's assets (or the images given on the command line) 256 times over, upload is left
+// out since it needs a device. Also checks a missing file fails without taking the process down.
+#include "AsyncTasks.hpp"
+
+#include "stb_image.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace Atom;
+
+static int gFailures = 0;
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Pixel bytes of one decode, 0 when it failed.
+static size_t decode(const std::string& path) {
+	stbi_set_flip_vertically_on_load_thread(false);
+
+	int width, height, channels;
+	unsigned char* image = stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+
+	if (!image)
+		return 0;
+
+	stbi_image_free(image);
+	return static_cast<size_t>(width) * height * 4;
+}
+
+int main(int argc, char** argv) {
+	std::vector<std::string> files;
+
+	for (int i = 1; i < argc; i++)
+		files.emplace_back(argv[i]);
+
+	if (files.empty())
+		files = { "../../AAPL_VER/Atom3D/engine/assets/NickWiz.png", "../../AAPL_VER/Atom3D/engine/assets/mc_grass.jpeg" };
+
+	constexpr size_t loads = 256;
+
+	std::printf("Texture loading benchmark, %zu loads over %zu files, %u background threads\n\n", loads, files.size(), asyncThreadCount());
+
+	size_t serialBytes = 0;
+	const auto serialStart = std::chrono::steady_clock::now();
+
+	for (size_t i = 0; i < loads; i++)
+		serialBytes += decode(files[i % files.size()]);
+
+	const double serialSeconds = secondsSince(serialStart);
+
+	// Same completion counting as TextureLoader: jobs report under a mutex, the caller waits at the end.
+	std::mutex mutex;
+	std::condition_variable done;
+	size_t finished = 0, asyncBytes = 0;
+
+	const auto asyncStart = std::chrono::steady_clock::now();
+
+	for (size_t i = 0; i < loads; i++)
+		runAsync([&, i] {
+			const size_t bytes = decode(files[i % files.size()]);
+
+			std::lock_guard<std::mutex> lock(mutex);
+			asyncBytes += bytes;
+			finished++;
+			done.notify_one();
+		});
+
+	const double queueSeconds = secondsSince(asyncStart);
+
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		done.wait(lock, [&] { return finished == loads; });
+	}
+
+	const double asyncSeconds = secondsSince(asyncStart);
+
+	if (serialBytes == 0 || asyncBytes != serialBytes) {
+		std::printf("  FAILED: decoded %zu bytes on the caller, %zu in the background\n", serialBytes, asyncBytes);
+		gFailures++;
+	}
+
+	std::printf("  decoded     %8.1f MB\n", serialBytes / 1048576.0);
+	std::printf("  caller      %8.1f ms   (blocking, one after another)\n", serialSeconds * 1e3);
+	std::printf("  runAsync    %8.1f ms   until all finished, %.2fx\n", asyncSeconds * 1e3, serialSeconds / asyncSeconds);
+	std::printf("  caller free %8.3f ms   after queueing all %zu\n\n", queueSeconds * 1e3, loads);
+
+	bool failed = false;
+	std::string reason;
+	runAsync([&] {
+		const bool missing = decode("does/not/exist.png") == 0;
+		const char* why = stbi_failure_reason();
+
+		std::lock_guard<std::mutex> lock(mutex);
+		failed = missing;
+		reason = why ? why : "";
+		finished++;
+		done.notify_one();
+	});
+
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		done.wait(lock, [&] { return finished == loads + 1; });
+	}
+
+	if (!failed) {
+		std::printf("  FAILED: missing file decoded\n");
+		gFailures++;
+	}
+
+	std::printf("  missing file reported: %s\n", reason.c_str());
+
+	return gFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+// ReSharper disable CppInconsistentNaming
+// Batched SoA transforms against composing each object's matrices one at a time, the way
+// Core::encodeRenderCommand does it today. Build with the same flags as the engine, see UNIFIED_VER/README.md.
+#include "TransformBatch.hpp"
+#include "ParallelFor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace Atom;
+
+static volatile float gSink;
+
+// 64 byte aligned like a mapped GPU buffer, so large batches take the streaming store path.
+struct alignas(64) AlignedMatrix {
+	float4x4 m;
+};
+
+static int gFailures = 0;
+
+template<typename F>
+static double measureNs(size_t count, F&& f) {
+	// Best of a few runs, the minimum is the most stable number on a busy machine.
+	double best = 1e30;
+
+	for (int run = 0; run < 5; run++) {
+		const auto start = std::chrono::steady_clock::now();
+		f();
+		const auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		best = std::min(best, ns / static_cast<double>(count));
+	}
+
+	return best;
+}
+
+static float maxError(const std::vector<AlignedMatrix>& a, const std::vector<float4x4>& b) {
+	const float* pa = &a[0].m.columns[0].x;
+	const float* pb = &b[0].columns[0].x;
+	float e = 0;
+
+	for (size_t i = 0; i < a.size() * 16; i++)
+		e = std::max(e, std::fabs(pa[i] - pb[i]) / std::max(1.0f, std::fabs(pb[i])));
+
+	return e;
+}
+
+static void report(const char* name, double ns, double baseNs, float error) {
+	std::printf("  %-22s %8.2f ns/object %7.2fx   err %.2e%s\n", name, ns, baseNs / ns, error, error > 1e-5f ? "  FAILED" : "");
+
+	if (error > 1e-5f)
+		gFailures++;
+}
+
+int main() {
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+	const float4x4 viewProj = matrix_multiply(matrix_perspective_left_hand(PI / 2, 16.0f / 9.0f, 0.1f, 1000.0f), matrix4x4_translation(0, 0, 2));
+
+	std::printf("Transform batch benchmarks (%s kernels, %u threads)\n", transformBatchKernelName(), parallelThreadCount());
+
+	// Odd count on purpose so the scalar tail is exercised.
+	for (const size_t count : { size_t(10000) + 3, size_t(100000), size_t(1000000) }) {
+		TransformSoA transforms;
+		transforms.resize(count);
+
+		for (size_t i = 0; i < count; i++)
+			transforms.set(i,
+			               vector_make(dist(rng) * 100, dist(rng) * 100, dist(rng) * 100),
+			               quaternion(dist(rng) * PI, vector_make(dist(rng), dist(rng), dist(rng) + 2.0f)),
+			               vector_make(1.5f + dist(rng), 1.5f + dist(rng), 1.5f + dist(rng)));
+
+		std::vector<float4x4> worldRef(count), mvpRef(count);
+		std::vector<AlignedMatrix> world(count), mvp(count);
+
+		std::printf("\n%zu objects\n", count);
+
+		// World matrices
+		const double refNs = measureNs(count, [&] {
+			for (size_t i = 0; i < count; i++) {
+				const float4x4 t = matrix4x4_translation(transforms.positionX[i], transforms.positionY[i], transforms.positionZ[i]);
+				const float4x4 r = matrix4x4_from_quaternion(quaternion(transforms.rotationX[i], transforms.rotationY[i], transforms.rotationZ[i], transforms.rotationW[i]));
+				const float4x4 s = matrix4x4_scale(transforms.scaleX[i], transforms.scaleY[i], transforms.scaleZ[i]);
+				worldRef[i] = matrix_multiply(t, matrix_multiply(r, s));
+			}
+			gSink = worldRef[count - 1].columns[3].x;
+		});
+		report("per object world", refNs, refNs, 0);
+
+		const double batchNs = measureNs(count, [&] { composeWorldMatrices(transforms, 0, count, &world[0].m); gSink = world[count - 1].m.columns[3].x; });
+		report("batch world", batchNs, refNs, maxError(world, worldRef));
+
+		const double parallelNs = measureNs(count, [&] { composeWorldMatrices(transforms, &world[0].m); gSink = world[count - 1].m.columns[3].x; });
+		report("batch world parallel", parallelNs, refNs, maxError(world, worldRef));
+
+		// World and MVP
+		const double refMvpNs = measureNs(count, [&] {
+			for (size_t i = 0; i < count; i++) {
+				const float4x4 t = matrix4x4_translation(transforms.positionX[i], transforms.positionY[i], transforms.positionZ[i]);
+				const float4x4 r = matrix4x4_from_quaternion(quaternion(transforms.rotationX[i], transforms.rotationY[i], transforms.rotationZ[i], transforms.rotationW[i]));
+				const float4x4 s = matrix4x4_scale(transforms.scaleX[i], transforms.scaleY[i], transforms.scaleZ[i]);
+				worldRef[i] = matrix_multiply(t, matrix_multiply(r, s));
+				mvpRef[i] = matrix_multiply(viewProj, worldRef[i]);
+			}
+			gSink = mvpRef[count - 1].columns[3].x;
+		});
+		report("per object world+mvp", refMvpNs, refMvpNs, 0);
+
+		const double batchMvpNs = measureNs(count, [&] { composeMVPMatrices(transforms, 0, count, viewProj, &world[0].m, &mvp[0].m); gSink = mvp[count - 1].m.columns[3].x; });
+		report("batch world+mvp", batchMvpNs, refMvpNs, std::max(maxError(world, worldRef), maxError(mvp, mvpRef)));
+
+		const double parallelMvpNs = measureNs(count, [&] { composeMVPMatrices(transforms, viewProj, &world[0].m, &mvp[0].m); gSink = mvp[count - 1].m.columns[3].x; });
+		report("batch world+mvp par.", parallelMvpNs, refMvpNs, std::max(maxError(world, worldRef), maxError(mvp, mvpRef)));
+	}
+
+	return gFailures == 0 ? 0 : 1;
+}
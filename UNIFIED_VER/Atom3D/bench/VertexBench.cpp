@@ -0,0 +1,183 @@
+// ReSharper disable CppInconsistentNaming
+// Packed 16 byte vertices (unorm16 position, half/unorm16 UV, octahedral normal) against the 32 byte
+// float4 + float2 layout. Prints the precision lost and a vertex fetch stand in: a pass over a vertex
+// buffer far bigger than the caches that decodes every vertex like the vertex shaders do, which is
+// bound by memory bandwidth the same way vertex fetch on a big scene is.
+#include "VertexQuantization.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace Atom;
+
+// Same layout as Atom::VertexData in the Metal backend, PackedVertex is what both backends draw.
+struct FullVertex {
+	float4 position;
+	float2 textureCoords;
+};
+
+static_assert(sizeof(FullVertex) == 32, "Layout must match VertexData.hpp");
+
+static volatile float gSink;
+static int gFailures = 0;
+
+template<typename F>
+static double measureSeconds(F&& f) {
+	// Best of a few runs, the minimum is the most stable number on a busy machine.
+	double best = 1e30;
+
+	for (int run = 0; run < 5; run++) {
+		const auto start = std::chrono::steady_clock::now();
+		f();
+		best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	return best;
+}
+
+static void run(UVFormat uvFormat, size_t count) {
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	// Points of a 50 unit blob with unit normals and 0..4 tiling UVs.
+	std::vector<FullVertex> full(count);
+	std::vector<float3> normals(count);
+
+	for (size_t i = 0; i < count; i++) {
+		float3 n = { unit(rng), unit(rng), unit(rng) };
+		const float length = std::max(std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z), 1e-3f);
+		n = { n.x / length, n.y / length, n.z / length };
+
+		normals[i] = n;
+		full[i].position = { n.x * 50 + unit(rng), n.y * 50 + unit(rng), n.z * 50 + unit(rng), 1.0f };
+		full[i].textureCoords = { 2 + 2 * unit(rng), 2 + 2 * unit(rng) };
+	}
+
+	std::vector<PackedVertex> packed(count);
+	const PositionQuantization pq = positionQuantization(&full[0].position.x, count, sizeof(FullVertex));
+	const UVQuantization uq = uvQuantization(&full[0].textureCoords.x, count, sizeof(FullVertex), uvFormat);
+
+	const double encodeSeconds = measureSeconds([&] {
+		for (size_t i = 0; i < count; i++) {
+			packed[i].position = quantizePosition(pq, full[i].position.x, full[i].position.y, full[i].position.z);
+			packed[i].textureCoords = quantizeUV(uq, full[i].textureCoords.x, full[i].textureCoords.y);
+			packed[i].normal = octEncode(normals[i].x, normals[i].y, normals[i].z);
+		}
+	});
+
+	// Precision, position relative to the biggest extent, normal in degrees.
+	const float extent = std::max({ pq.scale.x, pq.scale.y, pq.scale.z });
+	float positionError = 0, uvError = 0, normalError = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		const float3 p = dequantizePosition(pq, packed[i].position);
+		const float2 uv = dequantizeUV(uq, packed[i].textureCoords);
+		const float3 n = octDecode(packed[i].normal);
+
+		positionError = std::max({ positionError, std::fabs(p.x - full[i].position.x), std::fabs(p.y - full[i].position.y), std::fabs(p.z - full[i].position.z) });
+		uvError = std::max({ uvError, std::fabs(uv.x - full[i].textureCoords.x), std::fabs(uv.y - full[i].textureCoords.y) });
+
+		// atan2 of |cross| and dot, acos of a float dot product can't resolve angles this small.
+		const double cx = static_cast<double>(n.y) * normals[i].z - static_cast<double>(n.z) * normals[i].y;
+		const double cy = static_cast<double>(n.z) * normals[i].x - static_cast<double>(n.x) * normals[i].z;
+		const double cz = static_cast<double>(n.x) * normals[i].y - static_cast<double>(n.y) * normals[i].x;
+		const double dot = static_cast<double>(n.x) * normals[i].x + static_cast<double>(n.y) * normals[i].y + static_cast<double>(n.z) * normals[i].z;
+		normalError = std::max(normalError, static_cast<float>(std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), dot) * 180 / PI));
+	}
+
+	// Vertex fetch stand in, both layouts produce the same shader inputs. The packed one widens and
+	// scales them the way the GPU's vertex fetch converts formats, one SSE register per vertex.
+	// Several sums so the adds don't serialize and memory bandwidth is the limit.
+	// Half UVs convert for free in GPU vertex fetch, the stand in decodes unorm16 either way.
+	const UVQuantization unormUV = uvQuantization(&full[0].textureCoords.x, count, sizeof(FullVertex), UVFormat::Unorm16);
+
+#if defined(ATOM_SIMD_AVX2)
+	const double fullSeconds = measureSeconds([&] {
+		__m128 sum[4] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+
+		for (size_t i = 0; i + 1 < count; i += 2) {
+			const float* v = &full[i].position.x;
+			sum[0] = _mm_add_ps(sum[0], _mm_load_ps(v));
+			sum[1] = _mm_add_ps(sum[1], _mm_load_ps(v + 4));
+			sum[2] = _mm_add_ps(sum[2], _mm_load_ps(v + 8));
+			sum[3] = _mm_add_ps(sum[3], _mm_load_ps(v + 12));
+		}
+
+		gSink = _mm_cvtss_f32(_mm_add_ps(_mm_add_ps(sum[0], sum[1]), _mm_add_ps(sum[2], sum[3])));
+	});
+
+	// Lanes: position xyzw, uv, normal. Normals are snorm16, sign extended by the xor/subtract.
+	const __m256 scale = _mm256_setr_ps(pq.scale.x / 65535, pq.scale.y / 65535, pq.scale.z / 65535, 0, unormUV.scale.x / 65535, unormUV.scale.y / 65535, 1.0f / 32767, 1.0f / 32767);
+	const __m256 bias = _mm256_setr_ps(pq.offset.x, pq.offset.y, pq.offset.z, 1, unormUV.offset.x, unormUV.offset.y, 0, 0);
+	const __m256i signBit = _mm256_setr_epi32(0, 0, 0, 0, 0, 0, 0x8000, 0x8000);
+
+	const double packedSeconds = measureSeconds([&] {
+		__m256 sum[4] = { _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps() };
+
+		for (size_t i = 0; i + 3 < count; i += 4)
+			for (size_t k = 0; k < 4; k++) {
+				const __m256i widened = _mm256_cvtepu16_epi32(_mm_load_si128(reinterpret_cast<const __m128i*>(&packed[i + k])));
+				const __m256i signExtended = _mm256_sub_epi32(_mm256_xor_si256(widened, signBit), signBit);
+
+				sum[k] = _mm256_add_ps(sum[k], _mm256_fmadd_ps(_mm256_cvtepi32_ps(signExtended), scale, bias));
+			}
+
+		const __m256 total = _mm256_add_ps(_mm256_add_ps(sum[0], sum[1]), _mm256_add_ps(sum[2], sum[3]));
+		gSink = _mm_cvtss_f32(_mm_add_ps(_mm256_castps256_ps128(total), _mm256_extractf128_ps(total, 1)));
+	});
+#else
+	const double fullSeconds = measureSeconds([&] {
+		float sum[4] = { 0, 0, 0, 0 };
+
+		for (size_t i = 0; i + 3 < count; i += 4)
+			for (size_t k = 0; k < 4; k++) {
+				const FullVertex& v = full[i + k];
+				sum[k] += v.position.x + v.position.y + v.position.z + v.textureCoords.x + v.textureCoords.y;
+			}
+
+		gSink = sum[0] + sum[1] + sum[2] + sum[3];
+	});
+
+	const float sx = pq.scale.x / 65535, sy = pq.scale.y / 65535, sz = pq.scale.z / 65535;
+	const float su = unormUV.scale.x / 65535, sv = unormUV.scale.y / 65535;
+	const float offset = pq.offset.x + pq.offset.y + pq.offset.z + unormUV.offset.x + unormUV.offset.y;
+
+	const double packedSeconds = measureSeconds([&] {
+		float sum[4] = { 0, 0, 0, 0 };
+
+		for (size_t i = 0; i + 3 < count; i += 4)
+			for (size_t k = 0; k < 4; k++) {
+				const PackedVertex& v = packed[i + k];
+				sum[k] += offset + sx * v.position.x + sy * v.position.y + sz * v.position.z + su * v.textureCoords.x + sv * v.textureCoords.y;
+			}
+
+		gSink = sum[0] + sum[1] + sum[2] + sum[3];
+	});
+#endif
+
+	const double fullMB = static_cast<double>(count * sizeof(FullVertex)) / (1 << 20);
+	const double packedMB = static_cast<double>(count * sizeof(PackedVertex)) / (1 << 20);
+	const bool precise = positionError <= extent / 65535 && normalError < 0.01f;
+
+	std::printf("%zu vertices, %s UVs\n", count, uvFormat == UVFormat::Half ? "half" : "unorm16");
+	std::printf("  buffer      %8.1f MB -> %8.1f MB  (%zu -> %zu bytes per vertex, normals included)\n", fullMB, packedMB, sizeof(FullVertex), sizeof(PackedVertex));
+	std::printf("  fetch       %8.2f ns -> %8.2f ns per vertex  %5.2fx   (%.1f -> %.1f GB/s)\n",
+	            fullSeconds / count * 1e9, packedSeconds / count * 1e9, fullSeconds / packedSeconds, fullMB / 1024 / fullSeconds, packedMB / 1024 / packedSeconds);
+	std::printf("  encode      %8.1f M vertices/s\n", count / encodeSeconds / 1e6);
+	std::printf("  max error   position %.2e (extent %.0f), uv %.2e, normal %.4f deg%s\n\n", positionError, extent, uvError, normalError, precise ? "" : "  FAILED");
+
+	if (!precise)
+		gFailures++;
+}
+
+int main() {
+	std::printf("Vertex quantization benchmarks (%s)\n\n", ATOM_SIMD_NAME);
+
+	run(UVFormat::Half, 8u << 20);
+	run(UVFormat::Unorm16, 8u << 20);
+
+	return gFailures == 0 ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_ASSET_PACK_HPP
+#define ATOM_ASSET_PACK_HPP
+
+// .apak asset archives. A header, the table of contents sorted by name hash, the names, then every
+// entry's data aligned on its own, so opening a pack reads its first few pages and uncompressed
+// entries are used in place straight from the mapping. Entries that shrink under LZ4 are stored
+// compressed and decompressed when read.
+
+#include "MappedFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Atom {
+
+constexpr uint32_t ASSET_PACK_MAGIC = 0x4B415041; // "APAK"
+constexpr uint32_t ASSET_PACK_VERSION = 1;
+
+// Default entry alignment, same as the cooked meshes' blobs.
+constexpr uint32_t ASSET_PACK_ALIGNMENT = 256;
+
+enum class AssetCompression : uint32_t {
+	None = 0,
+	LZ4 = 1
+};
+
+// Little endian, fixed size fields only, written and mapped as is.
+struct AssetPackHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t entryCount;
+	uint32_t reserved;
+	uint64_t tocOffset;   // entryCount AssetPackEntries
+	uint64_t namesOffset; // Names back to back, not terminated
+	uint64_t namesBytes;
+	uint64_t dataBytes;   // Everything from the end of the names on, for checks and prefetching
+};
+
+struct AssetPackEntry {
+	uint64_t nameHash;    // assetNameHash of the name
+	uint64_t offset;      // From the start of the file
+	uint64_t storedSize;  // Bytes in the file
+	uint64_t size;        // Bytes once decompressed
+	uint32_t nameOffset;  // Into the names
+	uint32_t nameLength;
+	uint32_t compression; // AssetCompression
+	uint32_t alignment;
+};
+
+static_assert(sizeof(AssetPackHeader) == 48 && sizeof(AssetPackEntry) == 48, "Asset pack layout changed, bump ASSET_PACK_VERSION");
+
+// 64 bit FNV-1a, written into packs so it must never change.
+[[nodiscard]] inline uint64_t assetNameHash(std::string_view name) {
+	uint64_t h = 0xCBF29CE484222325ull;
+
+	for (const char c : name)
+		h = (h ^ static_cast<uint8_t>(c)) * 0x100000001B3ull;
+
+	return h;
+}
+
+// Names use forward slashes and no leading "./", "engine\\assets\\a.png" and "./engine/assets/a.png"
+// both become "engine/assets/a.png".
+[[nodiscard]] std::string normalizeAssetName(std::string_view name);
+
+// A mapped pack. Entry, name and data pointers stay valid as long as the AssetPack does. Reading is
+// const and safe from any number of threads.
+class AssetPack {
+public:
+	// False if the file is missing, not a pack, from another version or truncated.
+	bool open(const std::string& path);
+	void close();
+
+	[[nodiscard]] bool isOpen() const { return mFile.isOpen(); }
+	[[nodiscard]] size_t entryCount() const { return mHeader.entryCount; }
+	[[nodiscard]] const AssetPackEntry& entry(size_t i) const { return mEntries[i]; }
+	[[nodiscard]] std::string_view name(const AssetPackEntry&) const;
+
+	// Binary search on the hash. Takes a normalized name, nullptr if the pack doesn't have it.
+	[[nodiscard]] const AssetPackEntry* find(std::string_view name) const;
+
+	// The bytes as stored, the asset itself when it isn't compressed.
+	[[nodiscard]] const uint8_t* storedData(const AssetPackEntry& e) const { return mFile.data() + e.offset; }
+
+	// Decompresses (or copies) entry into out, which holds entry.size bytes. False if it's corrupt.
+	bool read(const AssetPackEntry&, uint8_t* out) const;
+
+	// Reads all entry data in ahead of use, see MappedFile::prefetch.
+	void prefetch() const;
+
+private:
+	MappedFile mFile;
+	AssetPackHeader mHeader = {};
+	const AssetPackEntry* mEntries = nullptr;
+};
+
+struct AssetPackInput {
+	std::string name;   // Normalized when written
+	std::string source; // File the data comes from
+	bool compress = true; // Tried, kept only if it saves at least an eighth
+	uint32_t alignment = ASSET_PACK_ALIGNMENT; // Power of two
+};
+
+// Reads every source (compressing them over parallelFor) and writes the pack through a temporary
+// file renamed over path. Throws std::runtime_error if a source can't be read, two entries have the
+// same name or the pack can't be written.
+void writeAssetPack(const std::string& path, const std::vector<AssetPackInput>& inputs);
+
+}
+
+#endif
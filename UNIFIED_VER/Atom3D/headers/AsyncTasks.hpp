@@ -0,0 +1,24 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_ASYNC_TASKS_HPP
+#define ATOM_ASYNC_TASKS_HPP
+
+#include <cstdint>
+#include <functional>
+
+namespace Atom {
+
+// Fire and forget jobs for work nobody waits on right away, asset decoding mostly. They start in
+// submission order on hardware_concurrency() background threads, a pool separate from parallelFor's
+// so a long decode never holds up a frame's fork/join. Jobs may call parallelFor themselves.
+// Jobs report their own errors, an exception escaping one terminates like it would on a std::thread.
+// Jobs still queued when the process exits are dropped.
+void runAsync(std::function<void()> job);
+
+// Background threads runAsync spreads over.
+[[nodiscard]] uint32_t asyncThreadCount();
+
+}
+
+#endif
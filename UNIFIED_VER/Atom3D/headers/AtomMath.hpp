@@ -0,0 +1,992 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_MATH_HPP
+#define ATOM_MATH_HPP
+
+// Vector, matrix and quaternion math for both backends. Same function surface as Apple's
+// AAPLMathUtilities (matrix4x4_rotation, matrix_perspective_left_hand, quaternion_multiply...) and
+// the simd_ types it used, but built on AtomSimd so it compiles anywhere.
+//
+// Layouts match Metal/simd: float3 is padded to 16 bytes, matrices are column major with
+// column vector inputs, so these types can be copied straight into shader buffers.
+//
+// linearIndex     cr              example with reference elements
+//  0  4  8 12     00 10 20 30     sx  10  20   tx
+//  1  5  9 13 --> 01 11 21 31 --> 01  sy  21   ty
+//  2  6 10 14     02 12 22 32     02  12  sz   tz
+//  3  7 11 15     03 13 23 33     03  13  1/d  33
+
+#include "AtomSimd.hpp"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+namespace Atom {
+
+constexpr float PI = 3.14159265358979323846f;
+
+struct alignas(8) float2 {
+	float x, y;
+
+	float& operator[](int i) { return (&x)[i]; }
+	float operator[](int i) const { return (&x)[i]; }
+};
+
+// 16 bytes like simd's vector_float3, the 4th lane is padding and never read as a value.
+struct alignas(16) float3 {
+	float x, y, z;
+
+	float& operator[](int i) { return (&x)[i]; }
+	float operator[](int i) const { return (&x)[i]; }
+};
+
+struct alignas(16) float4 {
+	float x, y, z, w;
+
+	float& operator[](int i) { return (&x)[i]; }
+	float operator[](int i) const { return (&x)[i]; }
+
+	[[nodiscard]] float3 xyz() const { return { x, y, z }; }
+};
+
+struct float3x3 {
+	float3 columns[3];
+};
+
+struct float4x4 {
+	float4 columns[4];
+};
+
+// Integer vectors for packed vertex data, same size and alignment as the Metal/simd ones.
+struct alignas(4) ushort2 {
+	uint16_t x, y;
+};
+
+struct alignas(8) ushort4 {
+	uint16_t x, y, z, w;
+};
+
+struct alignas(4) short2 {
+	int16_t x, y;
+};
+
+static_assert(sizeof(float3) == 16 && sizeof(float3x3) == 48 && sizeof(float4x4) == 64, "Layout must match Metal/simd");
+
+// AAPLMathUtilities/simd names.
+using vector_float2 = float2;
+using vector_float3 = float3;
+using vector_float4 = float4;
+using matrix_float3x3 = float3x3;
+using matrix_float4x4 = float4x4;
+
+/// A single-precision quaternion type, (x, y, z) imaginary and w real.
+using quaternion_float = float4;
+
+inline constexpr float3x3 matrix_identity_float3x3 = { { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } } };
+inline constexpr float4x4 matrix_identity_float4x4 = { { { 1, 0, 0, 0 }, { 0, 1, 0, 0 }, { 0, 0, 1, 0 }, { 0, 0, 0, 1 } } };
+
+
+/****************SIMD LOAD/STORE*******************/
+namespace Simd {
+
+ATOM_INLINE Vec load(const float4& v) { return load(&v.x); }
+ATOM_INLINE Vec load(const float3& v) { return load(&v.x); }
+
+ATOM_INLINE float4 toFloat4(Vec v) {
+	float4 r;
+	store(&r.x, v);
+	return r;
+}
+
+ATOM_INLINE float3 toFloat3(Vec v) {
+	float3 r;
+	store(&r.x, v);
+	return r;
+}
+
+}
+
+
+/****************VECTORS*******************/
+ATOM_INLINE float2 operator+(float2 a, float2 b) { return { a.x + b.x, a.y + b.y }; }
+ATOM_INLINE float2 operator-(float2 a, float2 b) { return { a.x - b.x, a.y - b.y }; }
+ATOM_INLINE float2 operator*(float2 a, float2 b) { return { a.x * b.x, a.y * b.y }; }
+ATOM_INLINE float2 operator*(float2 a, float s) { return { a.x * s, a.y * s }; }
+ATOM_INLINE float2 operator*(float s, float2 a) { return { a.x * s, a.y * s }; }
+ATOM_INLINE float2 operator/(float2 a, float s) { return { a.x / s, a.y / s }; }
+ATOM_INLINE float2 operator-(float2 a) { return { -a.x, -a.y }; }
+
+#define ATOM_MATH_VECTOR_OPS(T, toT)                                                                                   \
+	ATOM_INLINE T operator+(const T& a, const T& b) { return Simd::toT(Simd::add(Simd::load(a), Simd::load(b))); }    \
+	ATOM_INLINE T operator-(const T& a, const T& b) { return Simd::toT(Simd::sub(Simd::load(a), Simd::load(b))); }    \
+	ATOM_INLINE T operator*(const T& a, const T& b) { return Simd::toT(Simd::mul(Simd::load(a), Simd::load(b))); }    \
+	ATOM_INLINE T operator/(const T& a, const T& b) { return Simd::toT(Simd::div(Simd::load(a), Simd::load(b))); }    \
+	ATOM_INLINE T operator*(const T& a, float s) { return Simd::toT(Simd::mul(Simd::load(a), Simd::splat(s))); }      \
+	ATOM_INLINE T operator*(float s, const T& a) { return Simd::toT(Simd::mul(Simd::load(a), Simd::splat(s))); }      \
+	ATOM_INLINE T operator/(const T& a, float s) { return Simd::toT(Simd::div(Simd::load(a), Simd::splat(s))); }      \
+	ATOM_INLINE T operator-(const T& a) { return Simd::toT(Simd::neg(Simd::load(a))); }                               \
+	ATOM_INLINE T& operator+=(T& a, const T& b) { return a = a + b; }                                                 \
+	ATOM_INLINE T& operator-=(T& a, const T& b) { return a = a - b; }                                                 \
+	ATOM_INLINE T& operator*=(T& a, float s) { return a = a * s; }
+
+ATOM_MATH_VECTOR_OPS(float3, toFloat3)
+ATOM_MATH_VECTOR_OPS(float4, toFloat4)
+
+#undef ATOM_MATH_VECTOR_OPS
+
+ATOM_INLINE float3 vector_make(float x, float y, float z) { return { x, y, z }; }
+
+ATOM_INLINE float vector_dot(const float3& a, const float3& b) { return Simd::first(Simd::dot3(Simd::load(a), Simd::load(b))); }
+ATOM_INLINE float vector_dot(const float4& a, const float4& b) { return Simd::first(Simd::dot4(Simd::load(a), Simd::load(b))); }
+
+ATOM_INLINE float3 vector_cross(const float3& a, const float3& b) { return Simd::toFloat3(Simd::cross3(Simd::load(a), Simd::load(b))); }
+
+ATOM_INLINE float vector_length_squared(const float3& v) { return vector_dot(v, v); }
+ATOM_INLINE float vector_length_squared(const float4& v) { return vector_dot(v, v); }
+ATOM_INLINE float vector_length(const float3& v) { return std::sqrt(vector_dot(v, v)); }
+ATOM_INLINE float vector_length(const float4& v) { return std::sqrt(vector_dot(v, v)); }
+
+ATOM_INLINE float3 vector_normalize(const float3& v) {
+	const auto x = Simd::load(v);
+	return Simd::toFloat3(Simd::div(x, Simd::sqrt(Simd::dot3(x, x))));
+}
+
+ATOM_INLINE float4 vector_normalize(const float4& v) {
+	const auto x = Simd::load(v);
+	return Simd::toFloat4(Simd::div(x, Simd::sqrt(Simd::dot4(x, x))));
+}
+
+/// Returns a vector that is linearly interpolated between the two given vectors.
+ATOM_INLINE float3 vector_lerp(const float3& v0, const float3& v1, float t) {
+	const auto a = Simd::load(v0);
+	return Simd::toFloat3(Simd::madd(Simd::sub(Simd::load(v1), a), Simd::splat(t), a));
+}
+
+/// Returns a vector that is linearly interpolated between the two given vectors.
+ATOM_INLINE float4 vector_lerp(const float4& v0, const float4& v1, float t) {
+	const auto a = Simd::load(v0);
+	return Simd::toFloat4(Simd::madd(Simd::sub(Simd::load(v1), a), Simd::splat(t), a));
+}
+
+
+/****************MATRICES*******************/
+namespace Simd {
+
+// m * v for a column major matrix given as columns.
+ATOM_INLINE Vec transform(Vec c0, Vec c1, Vec c2, Vec c3, Vec v) {
+	Vec r = mul(c0, lane<0>(v));
+	r = madd(c1, lane<1>(v), r);
+	r = madd(c2, lane<2>(v), r);
+	return madd(c3, lane<3>(v), r);
+}
+
+ATOM_INLINE Vec transform(Vec c0, Vec c1, Vec c2, Vec v) {
+	Vec r = mul(c0, lane<0>(v));
+	r = madd(c1, lane<1>(v), r);
+	return madd(c2, lane<2>(v), r);
+}
+
+}
+
+/// Returns the product of two matrices, a * b.
+ATOM_INLINE float4x4 matrix_multiply(const float4x4& a, const float4x4& b) {
+	float4x4 r;
+
+#if defined(ATOM_SIMD_AVX2)
+	// Two result columns per iteration, a's columns are broadcast into both 128 bit halves.
+	const __m256 a0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a.columns[0]));
+	const __m256 a1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a.columns[1]));
+	const __m256 a2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a.columns[2]));
+	const __m256 a3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&a.columns[3]));
+
+	for (int i = 0; i < 4; i += 2) {
+		const __m256 bc = _mm256_loadu_ps(&b.columns[i].x);
+		__m256 c = _mm256_mul_ps(a0, _mm256_shuffle_ps(bc, bc, 0x00));
+#if defined(ATOM_SIMD_FMA)
+		c = _mm256_fmadd_ps(a1, _mm256_shuffle_ps(bc, bc, 0x55), c);
+		c = _mm256_fmadd_ps(a2, _mm256_shuffle_ps(bc, bc, 0xAA), c);
+		c = _mm256_fmadd_ps(a3, _mm256_shuffle_ps(bc, bc, 0xFF), c);
+#else
+		c = _mm256_add_ps(_mm256_mul_ps(a1, _mm256_shuffle_ps(bc, bc, 0x55)), c);
+		c = _mm256_add_ps(_mm256_mul_ps(a2, _mm256_shuffle_ps(bc, bc, 0xAA)), c);
+		c = _mm256_add_ps(_mm256_mul_ps(a3, _mm256_shuffle_ps(bc, bc, 0xFF)), c);
+#endif
+		_mm256_storeu_ps(&r.columns[i].x, c);
+	}
+#else
+	const auto a0 = Simd::load(a.columns[0]);
+	const auto a1 = Simd::load(a.columns[1]);
+	const auto a2 = Simd::load(a.columns[2]);
+	const auto a3 = Simd::load(a.columns[3]);
+
+	for (int i = 0; i < 4; i++)
+		Simd::store(&r.columns[i].x, Simd::transform(a0, a1, a2, a3, Simd::load(b.columns[i])));
+#endif
+
+	return r;
+}
+
+/// Returns the product of two matrices, a * b.
+ATOM_INLINE float3x3 matrix_multiply(const float3x3& a, const float3x3& b) {
+	const auto a0 = Simd::load(a.columns[0]);
+	const auto a1 = Simd::load(a.columns[1]);
+	const auto a2 = Simd::load(a.columns[2]);
+
+	float3x3 r;
+
+	for (int i = 0; i < 3; i++)
+		Simd::store(&r.columns[i].x, Simd::transform(a0, a1, a2, Simd::load(b.columns[i])));
+
+	return r;
+}
+
+/// Transforms a column vector, m * v.
+ATOM_INLINE float4 matrix_multiply(const float4x4& m, const float4& v) {
+#if defined(ATOM_SIMD_AVX2)
+	// Two columns per 256 bit register, 3 loads where the 128 bit form (and what compilers make of
+	// the scalar loop) takes 8 and is bound by them.
+	const __m256 vv = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&v));
+	const __m256 xy = _mm256_permutevar_ps(vv, _mm256_setr_epi32(0, 0, 0, 0, 1, 1, 1, 1));
+	const __m256 zw = _mm256_permutevar_ps(vv, _mm256_setr_epi32(2, 2, 2, 2, 3, 3, 3, 3));
+	__m256 r = _mm256_mul_ps(_mm256_loadu_ps(&m.columns[0].x), xy);
+#if defined(ATOM_SIMD_FMA)
+	r = _mm256_fmadd_ps(_mm256_loadu_ps(&m.columns[2].x), zw, r);
+#else
+	r = _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(&m.columns[2].x), zw), r);
+#endif
+	return Simd::toFloat4(_mm_add_ps(_mm256_castps256_ps128(r), _mm256_extractf128_ps(r, 1)));
+#else
+	return Simd::toFloat4(Simd::transform(Simd::load(m.columns[0]), Simd::load(m.columns[1]),
+	                                      Simd::load(m.columns[2]), Simd::load(m.columns[3]), Simd::load(v)));
+#endif
+}
+
+/// Transforms a column vector, m * v.
+ATOM_INLINE float3 matrix_multiply(const float3x3& m, const float3& v) {
+	return Simd::toFloat3(Simd::transform(Simd::load(m.columns[0]), Simd::load(m.columns[1]),
+	                                      Simd::load(m.columns[2]), Simd::load(v)));
+}
+
+ATOM_INLINE float4x4 operator*(const float4x4& a, const float4x4& b) { return matrix_multiply(a, b); }
+ATOM_INLINE float3x3 operator*(const float3x3& a, const float3x3& b) { return matrix_multiply(a, b); }
+ATOM_INLINE float4 operator*(const float4x4& m, const float4& v) { return matrix_multiply(m, v); }
+ATOM_INLINE float3 operator*(const float3x3& m, const float3& v) { return matrix_multiply(m, v); }
+
+ATOM_INLINE float4x4 matrix_transpose(const float4x4& m) {
+	auto c0 = Simd::load(m.columns[0]);
+	auto c1 = Simd::load(m.columns[1]);
+	auto c2 = Simd::load(m.columns[2]);
+	auto c3 = Simd::load(m.columns[3]);
+
+	Simd::transpose(c0, c1, c2, c3);
+
+	return { { Simd::toFloat4(c0), Simd::toFloat4(c1), Simd::toFloat4(c2), Simd::toFloat4(c3) } };
+}
+
+ATOM_INLINE float3x3 matrix_transpose(const float3x3& m) {
+	auto c0 = Simd::load(m.columns[0]);
+	auto c1 = Simd::load(m.columns[1]);
+	auto c2 = Simd::load(m.columns[2]);
+	auto c3 = Simd::zero();
+
+	Simd::transpose(c0, c1, c2, c3);
+
+	return { { Simd::toFloat3(c0), Simd::toFloat3(c1), Simd::toFloat3(c2) } };
+}
+
+/// Returns the inverse of a 3x3 matrix. The rows of the inverse are the cross products of pairs of
+/// columns divided by the determinant.
+ATOM_INLINE float3x3 matrix_invert(const float3x3& m) {
+#if defined(ATOM_SIMD_SCALAR)
+	// The register formulation below is a lot slower than plain cofactors once Vec is a struct.
+	const float3& a = m.columns[0];
+	const float3& b = m.columns[1];
+	const float3& c = m.columns[2];
+	const float3 r0 = { b.y * c.z - b.z * c.y, b.z * c.x - b.x * c.z, b.x * c.y - b.y * c.x };
+	const float invDet = 1.0f / (a.x * r0.x + a.y * r0.y + a.z * r0.z);
+
+	return { {
+		{ r0.x * invDet, (c.y * a.z - c.z * a.y) * invDet, (a.y * b.z - a.z * b.y) * invDet },
+		{ r0.y * invDet, (c.z * a.x - c.x * a.z) * invDet, (a.z * b.x - a.x * b.z) * invDet },
+		{ r0.z * invDet, (c.x * a.y - c.y * a.x) * invDet, (a.x * b.y - a.y * b.x) * invDet }
+	} };
+#else
+	const auto c0 = Simd::maskXYZ(Simd::load(m.columns[0]));
+	const auto c1 = Simd::maskXYZ(Simd::load(m.columns[1]));
+	const auto c2 = Simd::maskXYZ(Simd::load(m.columns[2]));
+	const auto s0 = Simd::swizzle<1, 2, 0, 3>(c0);
+	const auto s1 = Simd::swizzle<1, 2, 0, 3>(c1);
+	const auto s2 = Simd::swizzle<1, 2, 0, 3>(c2);
+
+	// The cross products without cross3's last swizzle, in (z, x, y, 0) order. The transpose below
+	// picks the lanes in the right order instead, 5 shuffles where cross3 and a 4x4 transpose take 11.
+	const auto r0 = Simd::sub(Simd::mul(c1, s2), Simd::mul(s1, c2));
+	const auto r1 = Simd::sub(Simd::mul(c2, s0), Simd::mul(s2, c0));
+	const auto r2 = Simd::sub(Simd::mul(c0, s1), Simd::mul(s0, c1));
+
+	const auto invDet = Simd::div(Simd::splat(1.0f), Simd::sum(Simd::mul(Simd::swizzle<2, 0, 1, 3>(c0), r0)));
+
+	const auto xy = Simd::shuffle<1, 2, 1, 2>(r0, r1);
+	const auto zz = Simd::shuffle<0, 0, 0, 0>(r0, r1);
+
+	return { { Simd::toFloat3(Simd::mul(Simd::shuffle<0, 2, 1, 3>(xy, r2), invDet)),
+	           Simd::toFloat3(Simd::mul(Simd::shuffle<1, 3, 2, 3>(xy, r2), invDet)),
+	           Simd::toFloat3(Simd::mul(Simd::shuffle<0, 2, 0, 3>(zz, r2), invDet)) } };
+#endif
+}
+
+namespace Simd {
+
+// 2x2 matrices packed in one register as (m00, m01, m10, m11), "#" is the adjugate.
+
+// a * b
+ATOM_INLINE Vec mat2Mul(Vec a, Vec b) {
+	return madd(a, swizzle<0, 3, 0, 3>(b), mul(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+}
+
+// a# * b
+ATOM_INLINE Vec mat2AdjMul(Vec a, Vec b) {
+	return sub(mul(swizzle<3, 3, 0, 0>(a), b), mul(swizzle<1, 1, 2, 2>(a), swizzle<2, 3, 0, 1>(b)));
+}
+
+// a * b#
+ATOM_INLINE Vec mat2MulAdj(Vec a, Vec b) {
+	return sub(mul(a, swizzle<3, 0, 3, 0>(b)), mul(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+}
+
+}
+
+/// Returns the inverse of a general 4x4 matrix, using 2x2 block inversion. The same code works on
+/// rows or columns since inverse(transpose(m)) == transpose(inverse(m)).
+ATOM_INLINE float4x4 matrix_invert(const float4x4& m) {
+	using namespace Simd;
+
+	const auto c0 = load(m.columns[0]);
+	const auto c1 = load(m.columns[1]);
+	const auto c2 = load(m.columns[2]);
+	const auto c3 = load(m.columns[3]);
+
+	// m = | A B |
+	//     | C D |
+	const auto A = shuffle<0, 1, 0, 1>(c0, c1);
+	const auto B = shuffle<2, 3, 2, 3>(c0, c1);
+	const auto C = shuffle<0, 1, 0, 1>(c2, c3);
+	const auto D = shuffle<2, 3, 2, 3>(c2, c3);
+
+	// (|A|, |B|, |C|, |D|)
+	const auto detSub = sub(mul(shuffle<0, 2, 0, 2>(c0, c2), shuffle<1, 3, 1, 3>(c1, c3)),
+	                        mul(shuffle<1, 3, 1, 3>(c0, c2), shuffle<0, 2, 0, 2>(c1, c3)));
+
+	const auto detA = lane<0>(detSub);
+	const auto detB = lane<1>(detSub);
+	const auto detC = lane<2>(detSub);
+	const auto detD = lane<3>(detSub);
+
+	const auto D_C = mat2AdjMul(D, C);
+	const auto A_B = mat2AdjMul(A, B);
+
+	// inverse(m) = 1/|m| * | X# Y# |
+	//                      | Z# W# |
+	auto X_ = sub(mul(detD, A), mat2Mul(B, D_C));
+	auto W_ = sub(mul(detA, D), mat2Mul(C, A_B));
+	auto Y_ = sub(mul(detB, C), mat2MulAdj(D, A_B));
+	auto Z_ = sub(mul(detC, B), mat2MulAdj(A, D_C));
+
+	// |m| = |A||D| + |B||C| - tr((A#B)(D#C))
+	auto detM = madd(detB, detC, mul(detA, detD));
+	detM = sub(detM, sum(mul(A_B, swizzle<0, 2, 1, 3>(D_C))));
+
+	const auto rDetM = div(set(1.0f, -1.0f, -1.0f, 1.0f), detM);
+
+	X_ = mul(X_, rDetM);
+	Y_ = mul(Y_, rDetM);
+	Z_ = mul(Z_, rDetM);
+	W_ = mul(W_, rDetM);
+
+	// Adjugate and unpack in one shuffle.
+	return { {
+		toFloat4(shuffle<3, 1, 3, 1>(X_, Y_)),
+		toFloat4(shuffle<2, 0, 2, 0>(X_, Y_)),
+		toFloat4(shuffle<3, 1, 3, 1>(Z_, W_)),
+		toFloat4(shuffle<2, 0, 2, 0>(Z_, W_))
+	} };
+}
+
+
+/****************AAPLMathUtilities SURFACE*******************/
+
+/// Given a uint16_t encoded as a 16-bit float, returns a 32-bit float.
+float float32_from_float16(uint16_t i);
+
+/// Given a 32-bit float, returns a uint16_t encoded as a 16-bit float.
+uint16_t float16_from_float32(float f);
+
+/// Converts count 16-bit floats in src to 32-bit floats in dst, bit for bit the same as the
+/// single value version. Uses F16C/AVX-512 or NEON conversion instructions when built for them.
+void float32_from_float16(const uint16_t* src, float* dst, size_t count);
+
+/// Converts count 32-bit floats in src to 16-bit floats in dst, rounding to nearest even like the
+/// single value version.
+void float16_from_float32(const float* src, uint16_t* dst, size_t count);
+
+/// Returns the number of degrees in the specified number of radians.
+inline float degrees_from_radians(float radians) {
+	return (radians / PI) * 180;
+}
+
+/// Returns the number of radians in the specified number of degrees.
+inline float radians_from_degrees(float degrees) {
+	return (degrees / 180) * PI;
+}
+
+/// Generates a random float value inside the given range.
+inline float random_float(float min, float max) {
+	return (static_cast<float>(std::rand()) / RAND_MAX) * (max - min) + min;
+}
+
+/// Generate a random three-component vector with values between min and max.
+float3 generate_random_vector(float min, float max);
+
+/// Fast random seed.
+void seedRand(uint32_t seed);
+
+/// Fast integer random.
+int32_t randi();
+
+/// Fast floating-point random.
+float randf(float x);
+
+/// Constructs a float3x3 from three rows of three columns with float values.
+/// Indices are m<column><row>.
+inline float3x3 matrix_make_rows(float m00, float m10, float m20,
+                                 float m01, float m11, float m21,
+                                 float m02, float m12, float m22) {
+	return { {
+		{ m00, m01, m02 }, // each line here provides column data
+		{ m10, m11, m12 },
+		{ m20, m21, m22 } } };
+}
+
+/// Constructs a float4x4 from four rows of four columns with float values.
+/// Indices are m<column><row>.
+inline float4x4 matrix_make_rows(float m00, float m10, float m20, float m30,
+                                 float m01, float m11, float m21, float m31,
+                                 float m02, float m12, float m22, float m32,
+                                 float m03, float m13, float m23, float m33) {
+	return { {
+		{ m00, m01, m02, m03 }, // each line here provides column data
+		{ m10, m11, m12, m13 },
+		{ m20, m21, m22, m23 },
+		{ m30, m31, m32, m33 } } };
+}
+
+/// Constructs a float3x3 from 3 float3 column vectors.
+inline float3x3 matrix_make_columns(const float3& col0, const float3& col1, const float3& col2) {
+	return { { col0, col1, col2 } };
+}
+
+/// Constructs a float4x4 from 4 float4 column vectors.
+inline float4x4 matrix_make_columns(const float4& col0, const float4& col1, const float4& col2, const float4& col3) {
+	return { { col0, col1, col2, col3 } };
+}
+
+/// Converts a unit-norm quaternion into its corresponding rotation matrix.
+inline float3x3 matrix3x3_from_quaternion(const quaternion_float& q) {
+	const float xx = q.x * q.x;
+	const float xy = q.x * q.y;
+	const float xz = q.x * q.z;
+	const float xw = q.x * q.w;
+	const float yy = q.y * q.y;
+	const float yz = q.y * q.z;
+	const float yw = q.y * q.w;
+	const float zz = q.z * q.z;
+	const float zw = q.z * q.w;
+
+	return matrix_make_rows(1 - 2 * (yy + zz),     2 * (xy - zw),     2 * (xz + yw),
+	                            2 * (xy + zw), 1 - 2 * (xx + zz),     2 * (yz - xw),
+	                            2 * (xz - yw),     2 * (yz + xw), 1 - 2 * (xx + yy));
+}
+
+/// Constructs a rotation matrix from the given angle and axis.
+inline float3x3 matrix3x3_rotation(float radians, float3 axis) {
+	axis = vector_normalize(axis);
+	const float ct = std::cos(radians);
+	const float st = std::sin(radians);
+	const float ci = 1 - ct;
+	const float x = axis.x, y = axis.y, z = axis.z;
+
+	return matrix_make_rows(    ct + x * x * ci, x * y * ci - z * st, x * z * ci + y * st,
+	                        y * x * ci + z * st,     ct + y * y * ci, y * z * ci - x * st,
+	                        z * x * ci - y * st, z * y * ci + x * st,     ct + z * z * ci);
+}
+
+/// Constructs a rotation matrix from the given angle and axis.
+inline float3x3 matrix3x3_rotation(float radians, float x, float y, float z) {
+	return matrix3x3_rotation(radians, vector_make(x, y, z));
+}
+
+/// Constructs a scaling matrix with the specified scaling factors.
+inline float3x3 matrix3x3_scale(float sx, float sy, float sz) {
+	return matrix_make_rows(sx,  0,  0,
+	                         0, sy,  0,
+	                         0,  0, sz);
+}
+
+/// Constructs a scaling matrix, using the given vector as an array of scaling factors.
+inline float3x3 matrix3x3_scale(const float3& s) {
+	return matrix3x3_scale(s.x, s.y, s.z);
+}
+
+/// Extracts the upper-left 3x3 submatrix of the given 4x4 matrix.
+inline float3x3 matrix3x3_upper_left(const float4x4& m) {
+	return matrix_make_columns(m.columns[0].xyz(), m.columns[1].xyz(), m.columns[2].xyz());
+}
+
+/// Returns the inverse of the transpose of the given matrix.
+inline float3x3 matrix_inverse_transpose(const float3x3& m) {
+	return matrix_invert(matrix_transpose(m));
+}
+
+/// Constructs a homogeneous rotation matrix from the given quaternion.
+inline float4x4 matrix4x4_from_quaternion(const quaternion_float& q) {
+	const float xx = q.x * q.x;
+	const float xy = q.x * q.y;
+	const float xz = q.x * q.z;
+	const float xw = q.x * q.w;
+	const float yy = q.y * q.y;
+	const float yz = q.y * q.z;
+	const float yw = q.y * q.w;
+	const float zz = q.z * q.z;
+	const float zw = q.z * q.w;
+
+	return matrix_make_rows(1 - 2 * (yy + zz),     2 * (xy - zw),     2 * (xz + yw), 0,
+	                            2 * (xy + zw), 1 - 2 * (xx + zz),     2 * (yz - xw), 0,
+	                            2 * (xz - yw),     2 * (yz + xw), 1 - 2 * (xx + yy), 0,
+	                                        0,                 0,                 0, 1);
+}
+
+/// Constructs a rotation matrix from the provided angle and axis.
+inline float4x4 matrix4x4_rotation(float radians, float3 axis) {
+	axis = vector_normalize(axis);
+	const float ct = std::cos(radians);
+	const float st = std::sin(radians);
+	const float ci = 1 - ct;
+	const float x = axis.x, y = axis.y, z = axis.z;
+
+	return matrix_make_rows(    ct + x * x * ci, x * y * ci - z * st, x * z * ci + y * st, 0,
+	                        y * x * ci + z * st,     ct + y * y * ci, y * z * ci - x * st, 0,
+	                        z * x * ci - y * st, z * y * ci + x * st,     ct + z * z * ci, 0,
+	                                          0,                   0,                   0, 1);
+}
+
+/// Constructs a rotation matrix from the given angle and axis.
+inline float4x4 matrix4x4_rotation(float radians, float x, float y, float z) {
+	return matrix4x4_rotation(radians, vector_make(x, y, z));
+}
+
+/// Constructs an identity matrix.
+inline float4x4 matrix4x4_identity() {
+	return matrix_identity_float4x4;
+}
+
+/// Constructs a scaling matrix with the given scaling factors.
+inline float4x4 matrix4x4_scale(float sx, float sy, float sz) {
+	return matrix_make_rows(sx,  0,  0, 0,
+	                         0, sy,  0, 0,
+	                         0,  0, sz, 0,
+	                         0,  0,  0, 1);
+}
+
+/// Constructs a scaling matrix, using the given vector as an array of scaling factors.
+inline float4x4 matrix4x4_scale(const float3& s) {
+	return matrix4x4_scale(s.x, s.y, s.z);
+}
+
+/// Constructs a translation matrix that translates by the vector (tx, ty, tz).
+inline float4x4 matrix4x4_translation(float tx, float ty, float tz) {
+	return matrix_make_rows(1, 0, 0, tx,
+	                        0, 1, 0, ty,
+	                        0, 0, 1, tz,
+	                        0, 0, 0,  1);
+}
+
+/// Constructs a translation matrix that translates by the vector (t.x, t.y, t.z).
+inline float4x4 matrix4x4_translation(const float3& t) {
+	return matrix4x4_translation(t.x, t.y, t.z);
+}
+
+/// Constructs a translation matrix that scales by the vector (s.x, s.y, s.z)
+/// and translates by the vector (t.x, t.y, t.z).
+inline float4x4 matrix4x4_scale_translation(const float3& s, const float3& t) {
+	return matrix_make_rows(s.x,   0,   0, t.x,
+	                          0, s.y,   0, t.y,
+	                          0,   0, s.z, t.z,
+	                          0,   0,   0,   1);
+}
+
+/// Starting with left-hand world coordinates, constructs a view matrix that is
+/// positioned at (eye) and looks toward (target), with the vector (up) pointing
+/// up for a left-hand coordinate system.
+inline float4x4 matrix_look_at_left_hand(const float3& eye, const float3& target, const float3& up) {
+	const float3 z = vector_normalize(target - eye);
+	const float3 x = vector_normalize(vector_cross(up, z));
+	const float3 y = vector_cross(z, x);
+	const float3 t = vector_make(-vector_dot(x, eye), -vector_dot(y, eye), -vector_dot(z, eye));
+
+	return matrix_make_rows(x.x, x.y, x.z, t.x,
+	                        y.x, y.y, y.z, t.y,
+	                        z.x, z.y, z.z, t.z,
+	                          0,   0,   0,   1);
+}
+
+/// Starting with left-hand world coordinates, constructs a view matrix that is
+/// positioned at (eyeX, eyeY, eyeZ) and looks toward (centerX, centerY, centerZ),
+/// with the vector (upX, upY, upZ) pointing up for a left-hand coordinate system.
+inline float4x4 matrix_look_at_left_hand(float eyeX, float eyeY, float eyeZ,
+                                         float centerX, float centerY, float centerZ,
+                                         float upX, float upY, float upZ) {
+	return matrix_look_at_left_hand(vector_make(eyeX, eyeY, eyeZ), vector_make(centerX, centerY, centerZ), vector_make(upX, upY, upZ));
+}
+
+/// Starting with right-hand world coordinates, constructs a view matrix that is
+/// positioned at (eye) and looks toward (target), with the vector (up) pointing
+/// up for a right-hand coordinate system.
+inline float4x4 matrix_look_at_right_hand(const float3& eye, const float3& target, const float3& up) {
+	const float3 z = vector_normalize(eye - target);
+	const float3 x = vector_normalize(vector_cross(up, z));
+	const float3 y = vector_cross(z, x);
+	const float3 t = vector_make(-vector_dot(x, eye), -vector_dot(y, eye), -vector_dot(z, eye));
+
+	return matrix_make_rows(x.x, x.y, x.z, t.x,
+	                        y.x, y.y, y.z, t.y,
+	                        z.x, z.y, z.z, t.z,
+	                          0,   0,   0,   1);
+}
+
+/// Starting with right-hand world coordinates, constructs a view matrix that is
+/// positioned at (eyeX, eyeY, eyeZ) and looks toward (centerX, centerY, centerZ),
+/// with the vector (upX, upY, upZ) pointing up for a right-hand coordinate system.
+inline float4x4 matrix_look_at_right_hand(float eyeX, float eyeY, float eyeZ,
+                                          float centerX, float centerY, float centerZ,
+                                          float upX, float upY, float upZ) {
+	return matrix_look_at_right_hand(vector_make(eyeX, eyeY, eyeZ), vector_make(centerX, centerY, centerZ), vector_make(upX, upY, upZ));
+}
+
+/// Constructs a symmetric orthographic projection matrix, from left-hand eye
+/// coordinates to left-hand clip coordinates.
+/// That maps (left, top) to (-1, 1), (right, bottom) to (1, -1), and (nearZ, farZ) to (0, 1).
+/// The first four arguments are signed eye coordinates.
+/// nearZ and farZ are absolute distances from the eye to the near and far clip planes.
+inline float4x4 matrix_ortho_left_hand(float left, float right, float bottom, float top, float nearZ, float farZ) {
+	return matrix_make_rows(2 / (right - left),                  0,                  0, (left + right) / (left - right),
+	                                         0, 2 / (top - bottom),                  0, (top + bottom) / (bottom - top),
+	                                         0,                  0, 1 / (farZ - nearZ),          nearZ / (nearZ - farZ),
+	                                         0,                  0,                  0,                               1);
+}
+
+/// Constructs a symmetric orthographic projection matrix, from right-hand eye
+/// coordinates to right-hand clip coordinates.
+/// That maps (left, top) to (-1, 1), (right, bottom) to (1, -1), and (nearZ, farZ) to (0, 1).
+/// The first four arguments are signed eye coordinates.
+/// nearZ and farZ are absolute distances from the eye to the near and far clip planes.
+inline float4x4 matrix_ortho_right_hand(float left, float right, float bottom, float top, float nearZ, float farZ) {
+	return matrix_make_rows(2 / (right - left),                  0,                   0, (left + right) / (left - right),
+	                                         0, 2 / (top - bottom),                   0, (top + bottom) / (bottom - top),
+	                                         0,                  0, -1 / (farZ - nearZ),          nearZ / (nearZ - farZ),
+	                                         0,                  0,                   0,                               1);
+}
+
+/// Constructs a symmetric perspective projection matrix, from left-hand eye
+/// coordinates to left-hand clip coordinates, with a vertical viewing angle of
+/// fovyRadians, the given aspect ratio, and the given absolute near and far
+/// z distances from the eye.
+inline float4x4 matrix_perspective_left_hand(float fovyRadians, float aspect, float nearZ, float farZ) {
+	const float ys = 1 / std::tan(fovyRadians * 0.5f);
+	const float xs = ys / aspect;
+	const float zs = farZ / (farZ - nearZ);
+
+	return matrix_make_rows(xs,  0,  0,           0,
+	                         0, ys,  0,           0,
+	                         0,  0, zs, -nearZ * zs,
+	                         0,  0,  1,           0);
+}
+
+/// Constructs a symmetric perspective projection matrix, from right-hand eye
+/// coordinates to right-hand clip coordinates, with a vertical viewing angle of
+/// fovyRadians, the given aspect ratio, and the given absolute near and far
+/// z distances from the eye.
+inline float4x4 matrix_perspective_right_hand(float fovyRadians, float aspect, float nearZ, float farZ) {
+	const float ys = 1 / std::tan(fovyRadians * 0.5f);
+	const float xs = ys / aspect;
+	const float zs = farZ / (nearZ - farZ);
+
+	return matrix_make_rows(xs,  0,  0,          0,
+	                         0, ys,  0,          0,
+	                         0,  0, zs, nearZ * zs,
+	                         0,  0, -1,          0);
+}
+
+/// Construct a general frustum projection matrix, from right-hand eye
+/// coordinates to left-hand clip coordinates.
+/// The bounds left, right, bottom, and top, define the visible frustum at the near clip plane.
+/// The first four arguments are signed eye coordinates.
+/// nearZ and farZ are absolute distances from the eye to the near and far clip planes.
+inline float4x4 matrix_perspective_frustum_right_hand(float l, float r, float b, float t, float n, float f) {
+	return matrix_make_rows(2 * n / (r - l),               0, (r + l) / (r - l),                0,
+	                                      0, 2 * n / (t - b), (t + b) / (t - b),                0,
+	                                      0,               0,      -f / (f - n), -f * n / (f - n),
+	                                      0,               0,                -1,                0);
+}
+
+/// Returns the inverse of the transpose of the given matrix.
+inline float4x4 matrix_inverse_transpose(const float4x4& m) {
+	return matrix_invert(matrix_transpose(m));
+}
+
+/// Constructs a quaternion of the form w + xi + yj + zk.
+inline quaternion_float quaternion(float x, float y, float z, float w) {
+	return { x, y, z, w };
+}
+
+/// Constructs a quaternion of the form w + v.x*i + v.y*j + v.z*k.
+inline quaternion_float quaternion(const float3& v, float w) {
+	return { v.x, v.y, v.z, w };
+}
+
+/// Constructs an identity quaternion.
+inline quaternion_float quaternion_identity() {
+	return quaternion(0, 0, 0, 1);
+}
+
+/// Returns a quaternion from the given rotation axis and angle, in radians.
+inline quaternion_float quaternion_from_axis_angle(const float3& axis, float radians) {
+	const float t = radians * 0.5f;
+	const float s = std::sin(t);
+
+	return quaternion(axis.x * s, axis.y * s, axis.z * s, std::cos(t));
+}
+
+/// Constructs a unit-norm quaternion that represents rotation by the given angle about the specified axis.
+inline quaternion_float quaternion(float radians, const float3& axis) {
+	return quaternion_from_axis_angle(vector_normalize(axis), radians);
+}
+
+/// Returns a quaternion from the given Euler angle, in radians.
+inline quaternion_float quaternion_from_euler(const float3& euler) {
+	const float cx = std::cos(euler.x / 2.f);
+	const float cy = std::cos(euler.y / 2.f);
+	const float cz = std::cos(euler.z / 2.f);
+	const float sx = std::sin(euler.x / 2.f);
+	const float sy = std::sin(euler.y / 2.f);
+	const float sz = std::sin(euler.z / 2.f);
+
+	return quaternion(sx * cy * cz - cx * sy * sz,
+	                  cx * sy * cz + sx * cy * sz,
+	                  cx * cy * sz - sx * sy * cz,
+	                  cx * cy * cz + sx * sy * sz);
+}
+
+/// Returns the length of the given quaternion.
+inline float quaternion_length(const quaternion_float& q) {
+	return vector_length(q);
+}
+
+inline float quaternion_length_squared(const quaternion_float& q) {
+	return vector_length_squared(q);
+}
+
+/// Returns a unit-norm quaternion.
+inline quaternion_float quaternion_normalize(const quaternion_float& q) {
+	return vector_normalize(q);
+}
+
+/// Returns the conjugate quaternion of the given quaternion.
+inline quaternion_float quaternion_conjugate(const quaternion_float& q) {
+	return Simd::toFloat4(Simd::mul(Simd::load(q), Simd::set(-1, -1, -1, 1)));
+}
+
+/// Returns the inverse quaternion of the given quaternion.
+inline quaternion_float quaternion_inverse(const quaternion_float& q) {
+	const auto v = Simd::load(q);
+	return Simd::toFloat4(Simd::div(Simd::mul(v, Simd::set(-1, -1, -1, 1)), Simd::dot4(v, v)));
+}
+
+/// Returns the rotation axis of the given unit-norm quaternion.
+inline float3 quaternion_axis(quaternion_float q) {
+	// This query doesn't make sense if w > 1, but we do our best by
+	// forcing q to be a unit quaternion if it obviously isn't
+	if (q.w > 1.0f)
+		q = quaternion_normalize(q);
+
+	const float axisLen = std::sqrt(1 - q.w * q.w);
+
+	// At lengths this small, direction is arbitrary
+	if (axisLen < 1e-5f)
+		return vector_make(1, 0, 0);
+
+	return vector_make(q.x / axisLen, q.y / axisLen, q.z / axisLen);
+}
+
+/// Returns the rotation angle of the given unit-norm quaternion.
+inline float quaternion_angle(const quaternion_float& q) {
+	return 2 * std::acos(q.w);
+}
+
+/// Returns the product of the two given quaternions.
+inline quaternion_float quaternion_multiply(const quaternion_float& q0, const quaternion_float& q1) {
+	using namespace Simd;
+
+	const auto a = load(q0);
+	const auto b = load(q1);
+
+	// q0.w * q1 + q0.x * q1.wzyx * (+-+-) + q0.y * q1.zwxy * (++--) + q0.z * q1.yxwz * (-++-)
+	auto r = mul(lane<3>(a), b);
+	r = madd(mul(lane<0>(a), swizzle<3, 2, 1, 0>(b)), set(1, -1, 1, -1), r);
+	r = madd(mul(lane<1>(a), swizzle<2, 3, 0, 1>(b)), set(1, 1, -1, -1), r);
+	r = madd(mul(lane<2>(a), swizzle<1, 0, 3, 2>(b)), set(-1, 1, 1, -1), r);
+
+	return toFloat4(r);
+}
+
+/// Returns the quaternion that results from spherically interpolating between the two given quaternions.
+inline quaternion_float quaternion_slerp(const quaternion_float& q0, const quaternion_float& q1, float t) {
+	const float cosHalfTheta = vector_dot(q0, q1);
+
+	// q0 == q1 or q0 == -q1
+	if (std::fabs(cosHalfTheta) >= 1.f)
+		return q0;
+
+	const float halfTheta = std::acos(cosHalfTheta);
+	const float sinHalfTheta = std::sqrt(1.f - cosHalfTheta * cosHalfTheta);
+
+	// q0 & q1 180 degrees not defined
+	if (std::fabs(sinHalfTheta) < 0.001f)
+		return q0 * 0.5f + q1 * 0.5f;
+
+	const float srcWeight = std::sin((1 - t) * halfTheta) / sinHalfTheta;
+	const float dstWeight = std::sin(t * halfTheta) / sinHalfTheta;
+
+	return Simd::toFloat4(Simd::madd(Simd::load(q0), Simd::splat(srcWeight), Simd::mul(Simd::load(q1), Simd::splat(dstWeight))));
+}
+
+/// Returns the vector that results from rotating the given vector by the given unit-norm quaternion.
+inline float3 quaternion_rotate_vector(const quaternion_float& q, const float3& v) {
+	using namespace Simd;
+
+	// t = 2 * cross(q.xyz, v), v' = v + q.w * t + cross(q.xyz, t)
+	const auto qv = load(q);
+	const auto x = load(v);
+	const auto t = add(cross3(qv, x), cross3(qv, x));
+
+	return toFloat3(add(madd(lane<3>(qv), t, x), cross3(qv, t)));
+}
+
+/// Returns a quaternion from the given 3x3 rotation matrix.
+/// Like AAPLMathUtilities this is the rotation of the transposed matrix, the inverse of
+/// matrix3x3_from_quaternion, which the direction vector helpers below rely on.
+inline quaternion_float quaternion_from_matrix3x3(const float3x3& m) {
+	quaternion_float q;
+
+	const float trace = m.columns[0][0] + m.columns[1][1] + m.columns[2][2];
+
+	// AAPLMathUtilities tested 1 + trace > 0, which takes this branch for angles near 180 degrees
+	// where w is tiny and loses precision, the largest diagonal term is the stable pivot there.
+	if (trace > 0) {
+		const float diagonal = std::sqrt(1.0f + trace) * 2.0f;
+
+		q.x = (m.columns[2][1] - m.columns[1][2]) / diagonal;
+		q.y = (m.columns[0][2] - m.columns[2][0]) / diagonal;
+		q.z = (m.columns[1][0] - m.columns[0][1]) / diagonal;
+		q.w = diagonal / 4.0f;
+	} else if (m.columns[0][0] > m.columns[1][1] && m.columns[0][0] > m.columns[2][2]) {
+		const float diagonal = std::sqrt(1.0f + m.columns[0][0] - m.columns[1][1] - m.columns[2][2]) * 2.0f;
+
+		q.x = diagonal / 4.0f;
+		q.y = (m.columns[0][1] + m.columns[1][0]) / diagonal;
+		q.z = (m.columns[0][2] + m.columns[2][0]) / diagonal;
+		q.w = (m.columns[2][1] - m.columns[1][2]) / diagonal;
+	} else if (m.columns[1][1] > m.columns[2][2]) {
+		const float diagonal = std::sqrt(1.0f + m.columns[1][1] - m.columns[0][0] - m.columns[2][2]) * 2.0f;
+
+		q.x = (m.columns[0][1] + m.columns[1][0]) / diagonal;
+		q.y = diagonal / 4.0f;
+		q.z = (m.columns[1][2] + m.columns[2][1]) / diagonal;
+		q.w = (m.columns[0][2] - m.columns[2][0]) / diagonal;
+	} else {
+		const float diagonal = std::sqrt(1.0f + m.columns[2][2] - m.columns[0][0] - m.columns[1][1]) * 2.0f;
+
+		q.x = (m.columns[0][2] + m.columns[2][0]) / diagonal;
+		q.y = (m.columns[1][2] + m.columns[2][1]) / diagonal;
+		q.z = diagonal / 4.0f;
+		q.w = (m.columns[1][0] - m.columns[0][1]) / diagonal;
+	}
+
+	return quaternion_normalize(q);
+}
+
+/// Constructs a unit-norm quaternion from the given matrix, so that matrix3x3_from_quaternion gives it back.
+/// The result is undefined if the matrix does not represent a pure rotation.
+inline quaternion_float quaternion(const float3x3& m) {
+	return quaternion_conjugate(quaternion_from_matrix3x3(m));
+}
+
+/// Constructs a unit-norm quaternion from the given matrix, so that matrix4x4_from_quaternion gives it back.
+/// The result is undefined if the matrix does not represent a pure rotation.
+inline quaternion_float quaternion(const float4x4& m) {
+	return quaternion(matrix3x3_upper_left(m));
+}
+
+inline quaternion_float quaternion_from_direction_vectors(float3 forward, float3 up, bool rightHanded) {
+	forward = vector_normalize(forward);
+	up = vector_normalize(up);
+
+	const float3 side = vector_normalize(vector_cross(up, forward));
+
+	quaternion_float q = quaternion_from_matrix3x3(matrix_make_columns(side, up, forward));
+
+	// q.yxwz with x and w negated
+	if (rightHanded)
+		q = { -q.y, q.x, -q.w, q.z };
+
+	return vector_normalize(q);
+}
+
+/// Returns the quaternion for the given forward and up vectors for right-hand coordinate systems.
+inline quaternion_float quaternion_from_direction_vectors_right_hand(const float3& forward, const float3& up) {
+	return quaternion_from_direction_vectors(forward, up, true);
+}
+
+/// Returns the quaternion for the given forward and up vectors for left-hand coordinate systems.
+inline quaternion_float quaternion_from_direction_vectors_left_hand(const float3& forward, const float3& up) {
+	return quaternion_from_direction_vectors(forward, up, false);
+}
+
+/// Returns a vector in the +Z direction for the given quaternion.
+inline float3 forward_direction_vector_from_quaternion(const quaternion_float& q) {
+	return vector_normalize(vector_make(2.0f * (q.x * q.z - q.w * q.y),
+	                                    2.0f * (q.y * q.z + q.w * q.x),
+	                                    1.0f - 2.0f * (q.x * q.x + q.y * q.y)));
+}
+
+/// Returns a vector in the +Y direction for the given quaternion (for a left-handed coordinate system,
+///   negate for a right-hand coordinate system).
+inline float3 up_direction_vector_from_quaternion(const quaternion_float& q) {
+	return vector_normalize(vector_make(2.0f * (q.x * q.y + q.w * q.z),
+	                                    1.0f - 2.0f * (q.x * q.x + q.z * q.z),
+	                                    2.0f * (q.y * q.z - q.w * q.x)));
+}
+
+/// Returns a vector in the +X direction for the given quaternion (for a left-hand coordinate system,
+///   negate for a right-hand coordinate system).
+inline float3 right_direction_vector_from_quaternion(const quaternion_float& q) {
+	return vector_normalize(vector_make(1.0f - 2.0f * (q.y * q.y + q.z * q.z),
+	                                    2.0f * (q.x * q.y - q.w * q.z),
+	                                    2.0f * (q.x * q.z + q.w * q.y)));
+}
+
+}
+
+#endif
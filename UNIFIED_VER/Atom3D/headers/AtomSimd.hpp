@@ -0,0 +1,247 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_SIMD_HPP
+#define ATOM_SIMD_HPP
+
+// 4 wide float vector layer under AtomMath. The instruction set is picked at compile time from the
+// compiler's target flags (-mavx2 -mfma, /arch:AVX2, aarch64...), define ATOM_MATH_SCALAR to force
+// the plain C++ fallback, e.g. to compare against it.
+
+#if defined(ATOM_MATH_SCALAR)
+#define ATOM_SIMD_SCALAR 1
+#elif defined(__AVX2__)
+#define ATOM_SIMD_AVX2 1
+#define ATOM_SIMD_SSE2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ATOM_SIMD_SSE2 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define ATOM_SIMD_NEON 1
+#else
+#define ATOM_SIMD_SCALAR 1
+#endif
+
+#if defined(ATOM_SIMD_AVX2) && (defined(__FMA__) || defined(_MSC_VER))
+#define ATOM_SIMD_FMA 1
+#endif
+
+#if defined(ATOM_SIMD_AVX2)
+#include <immintrin.h>
+#define ATOM_SIMD_NAME "AVX2"
+#elif defined(ATOM_SIMD_SSE2)
+#include <emmintrin.h>
+#define ATOM_SIMD_NAME "SSE2"
+#elif defined(ATOM_SIMD_NEON)
+#include <arm_neon.h>
+#define ATOM_SIMD_NAME "NEON"
+#else
+#include <cmath>
+#define ATOM_SIMD_NAME "scalar"
+#endif
+
+#if defined(_MSC_VER)
+#define ATOM_INLINE __forceinline
+#else
+#define ATOM_INLINE inline __attribute__((always_inline))
+#endif
+
+namespace Atom::Simd {
+
+#if defined(ATOM_SIMD_SSE2)
+
+using Vec = __m128;
+
+ATOM_INLINE Vec load(const float* p) { return _mm_load_ps(p); }
+ATOM_INLINE Vec loadu(const float* p) { return _mm_loadu_ps(p); }
+ATOM_INLINE void store(float* p, Vec v) { _mm_store_ps(p, v); }
+ATOM_INLINE void storeu(float* p, Vec v) { _mm_storeu_ps(p, v); }
+ATOM_INLINE Vec set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+ATOM_INLINE Vec splat(float s) { return _mm_set1_ps(s); }
+ATOM_INLINE Vec zero() { return _mm_setzero_ps(); }
+ATOM_INLINE float first(Vec v) { return _mm_cvtss_f32(v); }
+
+ATOM_INLINE Vec add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+ATOM_INLINE Vec sub(Vec a, Vec b) { return _mm_sub_ps(a, b); }
+ATOM_INLINE Vec mul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+ATOM_INLINE Vec div(Vec a, Vec b) { return _mm_div_ps(a, b); }
+ATOM_INLINE Vec min(Vec a, Vec b) { return _mm_min_ps(a, b); }
+ATOM_INLINE Vec max(Vec a, Vec b) { return _mm_max_ps(a, b); }
+ATOM_INLINE Vec sqrt(Vec v) { return _mm_sqrt_ps(v); }
+ATOM_INLINE Vec neg(Vec v) { return _mm_xor_ps(v, _mm_set1_ps(-0.0f)); }
+ATOM_INLINE Vec abs(Vec v) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+
+// a * b + c and c - a * b
+#if defined(ATOM_SIMD_FMA)
+ATOM_INLINE Vec madd(Vec a, Vec b, Vec c) { return _mm_fmadd_ps(a, b, c); }
+ATOM_INLINE Vec nmadd(Vec a, Vec b, Vec c) { return _mm_fnmadd_ps(a, b, c); }
+#else
+ATOM_INLINE Vec madd(Vec a, Vec b, Vec c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+ATOM_INLINE Vec nmadd(Vec a, Vec b, Vec c) { return _mm_sub_ps(c, _mm_mul_ps(a, b)); }
+#endif
+
+// (v1[a], v1[b], v2[c], v2[d])
+template<int a, int b, int c, int d>
+ATOM_INLINE Vec shuffle(Vec v1, Vec v2) { return _mm_shuffle_ps(v1, v2, _MM_SHUFFLE(d, c, b, a)); }
+
+template<>
+ATOM_INLINE Vec shuffle<0, 1, 0, 1>(Vec v1, Vec v2) { return _mm_movelh_ps(v1, v2); }
+
+template<>
+ATOM_INLINE Vec shuffle<2, 3, 2, 3>(Vec v1, Vec v2) { return _mm_movehl_ps(v2, v1); }
+
+// (v[a], v[b], v[c], v[d])
+template<int a, int b, int c, int d>
+ATOM_INLINE Vec swizzle(Vec v) {
+#if defined(ATOM_SIMD_AVX2)
+	return _mm_permute_ps(v, _MM_SHUFFLE(d, c, b, a));
+#else
+	return _mm_shuffle_ps(v, v, _MM_SHUFFLE(d, c, b, a));
+#endif
+}
+
+ATOM_INLINE Vec maskXYZ(Vec v) { return _mm_and_ps(v, _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0))); }
+
+ATOM_INLINE void transpose(Vec& r0, Vec& r1, Vec& r2, Vec& r3) { _MM_TRANSPOSE4_PS(r0, r1, r2, r3); }
+
+// Horizontal sum in every lane.
+ATOM_INLINE Vec sum(Vec v) {
+	const Vec s = _mm_add_ps(v, swizzle<1, 0, 3, 2>(v));
+	return _mm_add_ps(s, swizzle<2, 3, 0, 1>(s));
+}
+
+#elif defined(ATOM_SIMD_NEON)
+
+using Vec = float32x4_t;
+
+ATOM_INLINE Vec load(const float* p) { return vld1q_f32(p); }
+ATOM_INLINE Vec loadu(const float* p) { return vld1q_f32(p); }
+ATOM_INLINE void store(float* p, Vec v) { vst1q_f32(p, v); }
+ATOM_INLINE void storeu(float* p, Vec v) { vst1q_f32(p, v); }
+ATOM_INLINE Vec set(float x, float y, float z, float w) { const float v[4] = { x, y, z, w }; return vld1q_f32(v); }
+ATOM_INLINE Vec splat(float s) { return vdupq_n_f32(s); }
+ATOM_INLINE Vec zero() { return vdupq_n_f32(0.0f); }
+ATOM_INLINE float first(Vec v) { return vgetq_lane_f32(v, 0); }
+
+ATOM_INLINE Vec add(Vec a, Vec b) { return vaddq_f32(a, b); }
+ATOM_INLINE Vec sub(Vec a, Vec b) { return vsubq_f32(a, b); }
+ATOM_INLINE Vec mul(Vec a, Vec b) { return vmulq_f32(a, b); }
+ATOM_INLINE Vec div(Vec a, Vec b) { return vdivq_f32(a, b); }
+ATOM_INLINE Vec min(Vec a, Vec b) { return vminq_f32(a, b); }
+ATOM_INLINE Vec max(Vec a, Vec b) { return vmaxq_f32(a, b); }
+ATOM_INLINE Vec sqrt(Vec v) { return vsqrtq_f32(v); }
+ATOM_INLINE Vec neg(Vec v) { return vnegq_f32(v); }
+ATOM_INLINE Vec abs(Vec v) { return vabsq_f32(v); }
+
+ATOM_INLINE Vec madd(Vec a, Vec b, Vec c) { return vfmaq_f32(c, a, b); }
+ATOM_INLINE Vec nmadd(Vec a, Vec b, Vec c) { return vfmsq_f32(c, a, b); }
+
+template<int a, int b, int c, int d>
+ATOM_INLINE Vec shuffle(Vec v1, Vec v2) {
+#if defined(__clang__) || defined(__GNUC__)
+	return __builtin_shufflevector(v1, v2, a, b, c + 4, d + 4);
+#else
+	return set(vgetq_lane_f32(v1, a), vgetq_lane_f32(v1, b), vgetq_lane_f32(v2, c), vgetq_lane_f32(v2, d));
+#endif
+}
+
+template<int a, int b, int c, int d>
+ATOM_INLINE Vec swizzle(Vec v) { return shuffle<a, b, c, d>(v, v); }
+
+template<>
+ATOM_INLINE Vec swizzle<0, 0, 0, 0>(Vec v) { return vdupq_laneq_f32(v, 0); }
+
+template<>
+ATOM_INLINE Vec swizzle<1, 1, 1, 1>(Vec v) { return vdupq_laneq_f32(v, 1); }
+
+template<>
+ATOM_INLINE Vec swizzle<2, 2, 2, 2>(Vec v) { return vdupq_laneq_f32(v, 2); }
+
+template<>
+ATOM_INLINE Vec swizzle<3, 3, 3, 3>(Vec v) { return vdupq_laneq_f32(v, 3); }
+
+ATOM_INLINE Vec maskXYZ(Vec v) { return vsetq_lane_f32(0.0f, v, 3); }
+
+ATOM_INLINE void transpose(Vec& r0, Vec& r1, Vec& r2, Vec& r3) {
+	const float32x4x2_t t01 = vtrnq_f32(r0, r1);
+	const float32x4x2_t t23 = vtrnq_f32(r2, r3);
+
+	r0 = vcombine_f32(vget_low_f32(t01.val[0]), vget_low_f32(t23.val[0]));
+	r1 = vcombine_f32(vget_low_f32(t01.val[1]), vget_low_f32(t23.val[1]));
+	r2 = vcombine_f32(vget_high_f32(t01.val[0]), vget_high_f32(t23.val[0]));
+	r3 = vcombine_f32(vget_high_f32(t01.val[1]), vget_high_f32(t23.val[1]));
+}
+
+ATOM_INLINE Vec sum(Vec v) { return vdupq_n_f32(vaddvq_f32(v)); }
+
+#else
+
+struct Vec {
+	float v[4];
+};
+
+ATOM_INLINE Vec load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+ATOM_INLINE Vec loadu(const float* p) { return load(p); }
+ATOM_INLINE void store(float* p, Vec v) { for (int i = 0; i < 4; i++) p[i] = v.v[i]; }
+ATOM_INLINE void storeu(float* p, Vec v) { store(p, v); }
+ATOM_INLINE Vec set(float x, float y, float z, float w) { return { { x, y, z, w } }; }
+ATOM_INLINE Vec splat(float s) { return { { s, s, s, s } }; }
+ATOM_INLINE Vec zero() { return splat(0.0f); }
+ATOM_INLINE float first(Vec v) { return v.v[0]; }
+
+#define ATOM_SIMD_SCALAR_OP(name, expr) \
+	ATOM_INLINE Vec name(Vec a, Vec b) { Vec r; for (int i = 0; i < 4; i++) r.v[i] = (expr); return r; }
+
+ATOM_SIMD_SCALAR_OP(add, a.v[i] + b.v[i])
+ATOM_SIMD_SCALAR_OP(sub, a.v[i] - b.v[i])
+ATOM_SIMD_SCALAR_OP(mul, a.v[i] * b.v[i])
+ATOM_SIMD_SCALAR_OP(div, a.v[i] / b.v[i])
+ATOM_SIMD_SCALAR_OP(min, a.v[i] < b.v[i] ? a.v[i] : b.v[i])
+ATOM_SIMD_SCALAR_OP(max, a.v[i] > b.v[i] ? a.v[i] : b.v[i])
+
+#undef ATOM_SIMD_SCALAR_OP
+
+ATOM_INLINE Vec sqrt(Vec v) { for (float& f : v.v) f = std::sqrt(f); return v; }
+ATOM_INLINE Vec neg(Vec v) { for (float& f : v.v) f = -f; return v; }
+ATOM_INLINE Vec abs(Vec v) { for (float& f : v.v) f = f < 0.0f ? -f : f; return v; }
+
+ATOM_INLINE Vec madd(Vec a, Vec b, Vec c) { return add(mul(a, b), c); }
+ATOM_INLINE Vec nmadd(Vec a, Vec b, Vec c) { return sub(c, mul(a, b)); }
+
+template<int a, int b, int c, int d>
+ATOM_INLINE Vec shuffle(Vec v1, Vec v2) { return { { v1.v[a], v1.v[b], v2.v[c], v2.v[d] } }; }
+
+template<int a, int b, int c, int d>
+ATOM_INLINE Vec swizzle(Vec v) { return { { v.v[a], v.v[b], v.v[c], v.v[d] } }; }
+
+ATOM_INLINE Vec maskXYZ(Vec v) { v.v[3] = 0.0f; return v; }
+
+ATOM_INLINE void transpose(Vec& r0, Vec& r1, Vec& r2, Vec& r3) {
+	const Vec c0 = r0, c1 = r1, c2 = r2, c3 = r3;
+
+	r0 = { { c0.v[0], c1.v[0], c2.v[0], c3.v[0] } };
+	r1 = { { c0.v[1], c1.v[1], c2.v[1], c3.v[1] } };
+	r2 = { { c0.v[2], c1.v[2], c2.v[2], c3.v[2] } };
+	r3 = { { c0.v[3], c1.v[3], c2.v[3], c3.v[3] } };
+}
+
+ATOM_INLINE Vec sum(Vec v) { return splat(v.v[0] + v.v[1] + v.v[2] + v.v[3]); }
+
+#endif
+
+// Shared on top of the per ISA primitives.
+
+template<int i>
+ATOM_INLINE Vec lane(Vec v) { return swizzle<i, i, i, i>(v); }
+
+ATOM_INLINE Vec dot4(Vec a, Vec b) { return sum(mul(a, b)); }
+ATOM_INLINE Vec dot3(Vec a, Vec b) { return sum(maskXYZ(mul(a, b))); }
+
+// w of the result is 0 for finite inputs.
+ATOM_INLINE Vec cross3(Vec a, Vec b) {
+	const Vec t = sub(mul(a, swizzle<1, 2, 0, 3>(b)), mul(swizzle<1, 2, 0, 3>(a), b));
+	return swizzle<1, 2, 0, 3>(t);
+}
+
+}
+
+#endif
@@ -0,0 +1,89 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_BLOCK_COMPRESSION_HPP
+#define ATOM_BLOCK_COMPRESSION_HPP
+
+// BCn texture encoders for cooking. Every 4x4 block is fitted along the principal axis of its colors
+// (AtomSimd, four pixels of a channel per register), indices come from projecting onto the quantized
+// endpoints and one least squares pass refines the endpoints. Images are split over parallelFor by
+// rows of blocks. Decoders are for tools and checks, GPUs sample the blocks directly.
+
+#include "MipChain.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Atom {
+
+enum class TextureFormat : uint32_t {
+	RGBA8 = 0, // Uncompressed, 4 bytes per pixel
+	BC1 = 1,   // RGB, 8 bytes per block (0.5 bytes per pixel). Alpha is dropped
+	BC3 = 2,   // BC1 color plus BC4 alpha, 16 bytes per block
+	BC5 = 3,   // Two BC4 channels (red, green), 16 bytes per block, for normal maps
+	BC7 = 4    // RGBA, 16 bytes per block, best quality. Mode 6 only, one subset with 4 bit indices
+};
+
+[[nodiscard]] const char* textureFormatName(TextureFormat);
+
+[[nodiscard]] inline bool isBlockCompressed(TextureFormat format) {
+	return format != TextureFormat::RGBA8;
+}
+
+// Bytes per 4x4 block, per pixel for RGBA8.
+[[nodiscard]] inline uint32_t blockBytes(TextureFormat format) {
+	return format == TextureFormat::RGBA8 ? 4 : format == TextureFormat::BC1 ? 8 : 16;
+}
+
+// Bytes of one row of pixels, or of one row of blocks for BCn. What uploads take as bytesPerRow.
+[[nodiscard]] inline size_t textureRowBytes(TextureFormat format, uint32_t width) {
+	return static_cast<size_t>(isBlockCompressed(format) ? (width + 3) / 4 : width) * blockBytes(format);
+}
+
+[[nodiscard]] inline size_t textureLevelBytes(TextureFormat format, uint32_t width, uint32_t height) {
+	return textureRowBytes(format, width) * (isBlockCompressed(format) ? (height + 3) / 4 : height);
+}
+
+// Single blocks. Pixels are 16 RGBA8 values in row order.
+void encodeBC1(const uint8_t* rgba, uint8_t* out);
+void encodeBC3(const uint8_t* rgba, uint8_t* out);
+void encodeBC5(const uint8_t* rgba, uint8_t* out);
+void encodeBC7(const uint8_t* rgba, uint8_t* out);
+
+// Back to 16 RGBA8 pixels. BC5 decodes to (red, green, 0, 255). False for BC7 modes other than 6.
+bool decodeBlock(TextureFormat, const uint8_t* block, uint8_t* rgba);
+
+// Whole images, partial blocks at the right and bottom edges repeat the edge pixels. out holds
+// textureLevelBytes(format, width, height).
+void compressImage(const uint8_t* rgba, uint32_t width, uint32_t height, TextureFormat, uint8_t* out);
+void decompressImage(const uint8_t* data, uint32_t width, uint32_t height, TextureFormat, uint8_t* rgba);
+
+struct TextureLevel {
+	uint32_t width;
+	uint32_t height;
+	size_t offset; // Into TextureImage::data
+	size_t bytes;
+};
+
+// A texture ready for upload, every level packed after the one before it. Array textures repeat
+// that once per layer, levels describes the first.
+struct TextureImage {
+	TextureFormat format = TextureFormat::RGBA8;
+	bool srgb = true;
+	uint32_t layers = 1;
+	std::vector<TextureLevel> levels;
+	std::vector<uint8_t> data;
+
+	[[nodiscard]] size_t layerBytes() const { return data.size() / layers; }
+	[[nodiscard]] const uint8_t* level(size_t i, uint32_t layer = 0) const { return data.data() + layer * layerBytes() + levels[i].offset; }
+};
+
+// Compresses (or copies, for RGBA8) every level of chain.
+[[nodiscard]] TextureImage compressMipChain(const MipChain& chain, TextureFormat, bool srgb);
+// Same for the layers of an array texture, the chains all have the same size.
+[[nodiscard]] TextureImage compressMipChains(const std::vector<MipChain>& layers, TextureFormat, bool srgb);
+
+}
+
+#endif
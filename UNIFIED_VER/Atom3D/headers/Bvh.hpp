@@ -0,0 +1,197 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_BVH_HPP
+#define ATOM_BVH_HPP
+
+// Bounding volume hierarchy over object AABBs, for "what overlaps this box" and "what does this
+// ray hit" over large object sets. Built top down with binned SAH: the top levels bin over
+// parallelFor, then the subtrees below them build on the workers in parallel. Nodes are 32 bytes,
+// two to a cache line, siblings next to each other.
+//
+// Objects that move keep the tree valid with refit(), which only grows and shrinks boxes, so the
+// tree gets looser the further things move from where they were built. rebuildDegraded() rebuilds
+// the subtrees whose boxes grew past a factor of their built size, call it every few frames.
+
+#include "AtomMath.hpp"
+
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace Atom {
+
+struct Bounds {
+	float3 min;
+	float3 max;
+};
+
+// Empty bounds, the identity for growing.
+inline Bounds emptyBounds() {
+	return { { FLT_MAX, FLT_MAX, FLT_MAX }, { -FLT_MAX, -FLT_MAX, -FLT_MAX } };
+}
+
+struct Ray {
+	float3 origin;
+	float3 direction;
+	float tMax = FLT_MAX;
+};
+
+// count > 0 is a leaf of count objects from first in Bvh::indices(), 0 an interior node whose
+// children are nodes first and first + 1.
+struct BvhNode {
+	float minX, minY, minZ;
+	uint32_t first;
+	float maxX, maxY, maxZ;
+	uint32_t count;
+};
+
+static_assert(sizeof(BvhNode) == 32, "Two nodes per cache line");
+
+class Bvh {
+public:
+	static constexpr uint32_t NO_HIT = UINT32_MAX;
+
+	// Objects are identified by their index in bounds. Keeps a copy of the bounds.
+	void build(const Bounds* bounds, size_t count);
+	void clear();
+
+	// Every box resized to bounds (same objects, same order as build), the tree keeps its shape.
+	void refit(const Bounds* bounds);
+	// Only the leaves of the objects in moved and the nodes above them, for when few things moved.
+	void refit(const Bounds* bounds, const uint32_t* moved, size_t movedCount);
+	// Rebuilds the topmost subtrees whose surface area grew past maxGrowth times what it was when they
+	// were built. Returns how many objects they held.
+	size_t rebuildDegraded(const Bounds* bounds, float maxGrowth = 1.5f);
+
+	// Appends the objects whose bounds overlap box.
+	void query(const Bounds& box, std::vector<uint32_t>& objects) const;
+	// Nearest object whose bounds the ray enters within tMax, NO_HIT if none. t is where it enters.
+	uint32_t raycast(const Ray&, float& t) const;
+	// Same with an exact test, intersect(object, ray, tMax) returns the hit distance or FLT_MAX.
+	template<class F>
+	uint32_t raycast(const Ray&, float& t, F&& intersect) const;
+
+	// As of the last build or refit.
+	[[nodiscard]] const Bounds& objectBounds(uint32_t object) const { return mObjectBounds[object]; }
+
+	[[nodiscard]] bool empty() const { return mNodes.empty(); }
+	[[nodiscard]] size_t objectCount() const { return mIndices.size(); }
+	[[nodiscard]] const std::vector<BvhNode>& nodes() const { return mNodes; }
+	[[nodiscard]] const std::vector<uint32_t>& indices() const { return mIndices; }
+	// Sum of node surface areas relative to the root's, times the traversal cost. Lower is better.
+	[[nodiscard]] float sahCost() const;
+
+private:
+	// The node's objects are mIndices[first, first + count).
+	void rebuildSubtree(uint32_t node, uint32_t first, uint32_t count);
+	void refitLeaf(uint32_t node);
+	void refitInterior(uint32_t node);
+	void setLeafMap(uint32_t first, size_t count);
+	[[nodiscard]] float nodeArea(uint32_t node) const;
+
+	std::vector<BvhNode> mNodes;
+	std::vector<uint32_t> mIndices;
+	std::vector<Bounds> mObjectBounds;
+	std::vector<uint32_t> mParents;
+	// Leaf of every object, for the partial refit.
+	std::vector<uint32_t> mLeafOf;
+	// Surface area of every node when its subtree was last built.
+	std::vector<float> mBuiltArea;
+	// Sibling pairs partial rebuilds left unused, by their first node.
+	std::vector<uint32_t> mFreePairs;
+};
+
+// Ray against a box, the entry distance or FLT_MAX. invDirection is 1 / direction.
+inline float intersectBox(float minX, float minY, float minZ, float maxX, float maxY, float maxZ, const float3& origin, const float3& invDirection, float tMax) {
+	const float tx1 = (minX - origin.x) * invDirection.x, tx2 = (maxX - origin.x) * invDirection.x;
+	float tMin = std::fmin(tx1, tx2), tFar = std::fmax(tx1, tx2);
+	const float ty1 = (minY - origin.y) * invDirection.y, ty2 = (maxY - origin.y) * invDirection.y;
+	tMin = std::fmax(tMin, std::fmin(ty1, ty2));
+	tFar = std::fmin(tFar, std::fmax(ty1, ty2));
+	const float tz1 = (minZ - origin.z) * invDirection.z, tz2 = (maxZ - origin.z) * invDirection.z;
+	tMin = std::fmax(tMin, std::fmin(tz1, tz2));
+	tFar = std::fmin(tFar, std::fmax(tz1, tz2));
+
+	return tFar >= tMin && tFar >= 0.0f && tMin < tMax ? std::fmax(tMin, 0.0f) : FLT_MAX;
+}
+
+inline float intersectBox(const BvhNode& n, const float3& origin, const float3& invDirection, float tMax) {
+	return intersectBox(n.minX, n.minY, n.minZ, n.maxX, n.maxY, n.maxZ, origin, invDirection, tMax);
+}
+
+inline float intersectBox(const Bounds& b, const float3& origin, const float3& invDirection, float tMax) {
+	return intersectBox(b.min.x, b.min.y, b.min.z, b.max.x, b.max.y, b.max.z, origin, invDirection, tMax);
+}
+
+template<class F>
+uint32_t Bvh::raycast(const Ray& ray, float& t, F&& intersect) const {
+	t = ray.tMax;
+	uint32_t hit = NO_HIT;
+
+	if (mNodes.empty())
+		return hit;
+
+	const float3 invDirection = { 1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z };
+
+	if (intersectBox(mNodes[0], ray.origin, invDirection, t) == FLT_MAX)
+		return hit;
+
+	// Nearer child first, the other one only if it still starts before the closest hit so far.
+	uint32_t stack[64];
+	float stackT[64];
+	uint32_t size = 0, node = 0;
+
+	for (;;) {
+		const BvhNode& n = mNodes[node];
+
+		if (n.count) {
+			for (uint32_t i = n.first; i < n.first + n.count; i++) {
+				const float objectT = intersect(mIndices[i], ray, t);
+
+				if (objectT < t) {
+					t = objectT;
+					hit = mIndices[i];
+				}
+			}
+		} else {
+			float nearT = intersectBox(mNodes[n.first], ray.origin, invDirection, t);
+			float farT = intersectBox(mNodes[n.first + 1], ray.origin, invDirection, t);
+			uint32_t nearNode = n.first, farNode = n.first + 1;
+
+			if (farT < nearT) {
+				std::swap(nearT, farT);
+				std::swap(nearNode, farNode);
+			}
+
+			if (nearT != FLT_MAX) {
+				if (farT != FLT_MAX) {
+					stack[size] = farNode;
+					stackT[size++] = farT;
+				}
+
+				node = nearNode;
+				continue;
+			}
+		}
+
+		// Pop until a node that can still beat the closest hit.
+		for (;;) {
+			if (size == 0)
+				return hit;
+
+			size--;
+			if (stackT[size] < t)
+				break;
+		}
+
+		node = stack[size];
+	}
+}
+
+}
+
+#endif
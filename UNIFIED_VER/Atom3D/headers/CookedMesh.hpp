@@ -0,0 +1,75 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_COOKED_MESH_HPP
+#define ATOM_COOKED_MESH_HPP
+
+// Binary mesh cache. A cooked file is a fixed header followed by the PackedVertex buffer and the
+// index buffer, byte for byte what gets uploaded, so loading one is a mmap and two copies.
+
+#include "MappedFile.hpp"
+#include "MeshBuilder.hpp"
+#include "VertexQuantization.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Atom {
+
+constexpr uint32_t COOKED_MESH_MAGIC = 0x48534D41; // "AMSH"
+constexpr uint32_t COOKED_MESH_VERSION = 1;
+
+// Blob offsets are aligned to this, enough for any GPU copy offset and the cache lines.
+constexpr uint64_t COOKED_MESH_ALIGNMENT = 256;
+
+// Little endian, fixed size fields only, written and mapped as is.
+struct CookedMeshHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t sourceSize;    // Size and modification time of the source file when cooked, a
+	int64_t sourceTime;     // mismatch means the cache is stale
+	uint32_t vertexCount;
+	uint32_t vertexStride;  // sizeof(PackedVertex)
+	uint32_t indexCount;
+	uint32_t indexFormat;   // IndexFormat
+	uint64_t vertexOffset;
+	uint64_t vertexBytes;
+	uint64_t indexOffset;
+	uint64_t indexBytes;
+	MeshQuantization quantization;
+};
+
+static_assert(sizeof(CookedMeshHeader) == 144, "Cooked mesh header layout changed, bump COOKED_MESH_VERSION");
+
+// A mapped cooked mesh. The pointers stay valid as long as the CookedMesh does.
+class CookedMesh {
+public:
+	// False if the file is missing, not a cooked mesh, from another version or truncated.
+	bool open(const std::string& path);
+	void close();
+
+	[[nodiscard]] bool isOpen() const { return mFile.isOpen(); }
+	[[nodiscard]] const CookedMeshHeader& header() const { return *reinterpret_cast<const CookedMeshHeader*>(mFile.data()); }
+	[[nodiscard]] const MeshQuantization& quantization() const { return header().quantization; }
+
+	[[nodiscard]] const PackedVertex* vertices() const { return reinterpret_cast<const PackedVertex*>(mFile.data() + header().vertexOffset); }
+	[[nodiscard]] const void* indexData() const { return mFile.data() + header().indexOffset; }
+	[[nodiscard]] uint32_t vertexCount() const { return header().vertexCount; }
+	[[nodiscard]] uint32_t indexCount() const { return header().indexCount; }
+	[[nodiscard]] IndexFormat indexFormat() const { return static_cast<IndexFormat>(header().indexFormat); }
+	[[nodiscard]] size_t vertexBytes() const { return static_cast<size_t>(header().vertexBytes); }
+	[[nodiscard]] size_t indexBytes() const { return static_cast<size_t>(header().indexBytes); }
+
+private:
+	MappedFile mFile;
+};
+
+// Packs a welded mesh and writes it to path, through a temporary file that is renamed over path so a
+// reader never maps a half written one. sourceSize/sourceTime are what CookedMeshHeader compares
+// against. Throws std::runtime_error if the file can't be written.
+void writeCookedMesh(const std::string& path, const IndexedMesh<MeshVertex>&, UVFormat, uint64_t sourceSize, int64_t sourceTime);
+
+}
+
+#endif
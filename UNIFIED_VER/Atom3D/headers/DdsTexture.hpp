@@ -0,0 +1,58 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_DDS_TEXTURE_HPP
+#define ATOM_DDS_TEXTURE_HPP
+
+// DDS container for cooked textures: the standard header plus the DX10 extension, then every mip
+// level packed one after another (and again for every layer of arrays), so the level data uploads
+// straight out of a mapping. Rows are top first as the format defines them, like every image the
+// engine loads, so UV (0, 0) is the top left texel.
+
+#include "BlockCompression.hpp"
+#include "MappedFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Atom {
+
+// A mapped (or borrowed) DDS file. The level pointers stay valid as long as the DdsTexture does, or
+// as long as the memory given to parse() for borrowed ones.
+class DdsTexture {
+public:
+	// False if the file is missing, not a DDS in one of the TextureFormats, not 2D (or a 2D array) or
+	// truncated.
+	bool open(const std::string& path);
+	// Same checks on a DDS already in memory, which the caller keeps alive.
+	bool parse(const uint8_t* data, size_t size);
+	void close();
+
+	[[nodiscard]] bool isOpen() const { return mData != nullptr; }
+	[[nodiscard]] TextureFormat format() const { return mFormat; }
+	[[nodiscard]] bool srgb() const { return mSrgb; }
+	[[nodiscard]] uint32_t width() const { return mLevels[0].width; }
+	[[nodiscard]] uint32_t height() const { return mLevels[0].height; }
+	[[nodiscard]] size_t levelCount() const { return mLevels.size(); }
+	[[nodiscard]] uint32_t layerCount() const { return mLayers; }
+	[[nodiscard]] const TextureLevel& level(size_t i) const { return mLevels[i]; }
+	[[nodiscard]] const uint8_t* levelData(size_t i, uint32_t layer = 0) const { return mData + mLevels[i].offset + layer * mLayerBytes; }
+
+private:
+	MappedFile mFile;
+	const uint8_t* mData = nullptr;
+	TextureFormat mFormat = TextureFormat::RGBA8;
+	bool mSrgb = false;
+	uint32_t mLayers = 1;
+	size_t mLayerBytes = 0;
+	std::vector<TextureLevel> mLevels;
+};
+
+// Writes image (every layer, for arrays) as a DDS with the DX10 header. Throws std::runtime_error if the file can't be written.
+void writeDds(const std::string& path, const TextureImage& image);
+
+}
+
+#endif
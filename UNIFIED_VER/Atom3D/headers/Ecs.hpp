@@ -0,0 +1,310 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_ECS_HPP
+#define ATOM_ECS_HPP
+
+// Archetype based entity component system. Entities with the same set of components share an
+// archetype, which stores them in 16KB chunks: one array per component (plus one of Entity ids)
+// per chunk, so a query that reads two components streams through exactly those two arrays.
+// Components are plain data (trivially copyable, moved with memcpy), registered the first time a
+// type is used, at most MAX_COMPONENTS kinds.
+//
+// Adding or removing entities and components moves entities between archetypes and chunks, which
+// isn't allowed while a query runs. Record those in an EntityCommandBuffer and apply it afterwards.
+// A World is single threaded apart from parallelEachChunk.
+
+#include "ParallelFor.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace Atom {
+
+// Index into the World's entity table plus the generation of that slot, so ids of destroyed
+// entities stay dead when the slot is reused.
+struct Entity {
+	uint32_t index = UINT32_MAX;
+	uint32_t generation = 0;
+
+	bool operator==(const Entity& other) const { return index == other.index && generation == other.generation; }
+	bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+constexpr Entity NULL_ENTITY = {};
+
+using ComponentId = uint32_t;
+using ComponentMask = uint64_t;
+
+constexpr uint32_t MAX_COMPONENTS = 64;
+constexpr size_t ECS_CHUNK_BYTES = 16 * 1024;
+
+struct ComponentInfo {
+	size_t size;
+	size_t alignment;
+};
+
+// Throws std::length_error past MAX_COMPONENTS. componentId<T>() calls it once per type.
+ComponentId registerComponent(size_t size, size_t alignment);
+[[nodiscard]] const ComponentInfo& componentInfo(ComponentId);
+
+template<class T>
+ComponentId componentId() {
+	static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "Components are plain data");
+	static const ComponentId id = registerComponent(sizeof(T), alignof(T));
+	return id;
+}
+
+template<class... Ts>
+ComponentMask componentMask() {
+	return ((ComponentMask(1) << componentId<std::remove_const_t<Ts>>()) | ... | ComponentMask(0));
+}
+
+// The entities with one set of components. Chunks before the last are always full.
+class Archetype {
+public:
+	struct Chunk {
+		uint8_t* data;
+		uint32_t count;
+	};
+
+	explicit Archetype(ComponentMask);
+	~Archetype();
+	Archetype(const Archetype&) = delete;
+	Archetype& operator=(const Archetype&) = delete;
+
+	[[nodiscard]] ComponentMask mask() const { return mMask; }
+	[[nodiscard]] const std::vector<ComponentId>& components() const { return mComponents; }
+	[[nodiscard]] uint32_t chunkCapacity() const { return mCapacity; }
+	[[nodiscard]] size_t size() const { return mSize; }
+	[[nodiscard]] std::vector<Chunk>& chunks() { return mChunks; }
+	[[nodiscard]] const std::vector<Chunk>& chunks() const { return mChunks; }
+
+	// The component's array in chunk, the archetype must have it.
+	template<class T>
+	[[nodiscard]] T* array(const Chunk& chunk) const { return reinterpret_cast<T*>(chunk.data + mOffsets[componentId<std::remove_const_t<T>>()]); }
+	[[nodiscard]] void* array(const Chunk& chunk, ComponentId id) const { return chunk.data + mOffsets[id]; }
+	[[nodiscard]] Entity* entities(const Chunk& chunk) const { return reinterpret_cast<Entity*>(chunk.data); }
+
+private:
+	friend class World;
+
+	// A row at the end for entity, its components left for the caller to fill.
+	void push(Entity entity, uint32_t& chunk, uint32_t& row);
+	// Fills the row with the last entity and returns it, NULL_ENTITY if the row was the last.
+	Entity erase(uint32_t chunk, uint32_t row);
+
+	ComponentMask mMask;
+	std::vector<ComponentId> mComponents;
+	std::array<uint32_t, MAX_COMPONENTS> mOffsets = {};
+	uint32_t mCapacity = 0;
+	size_t mChunkBytes = 0;
+	size_t mSize = 0;
+	std::vector<Chunk> mChunks;
+	// The last chunk emptied, kept so an entity going back and forth doesn't allocate every time.
+	uint8_t* mSpare = nullptr;
+	// Archetype with one component added/removed, UINT32_MAX until first needed.
+	std::array<uint32_t, MAX_COMPONENTS> mAddEdges;
+	std::array<uint32_t, MAX_COMPONENTS> mRemoveEdges;
+};
+
+class World {
+public:
+	World();
+	World(const World&) = delete;
+	World& operator=(const World&) = delete;
+
+	// An entity without components, or with these.
+	Entity create();
+	template<class... Ts>
+	Entity create(const Ts&... components);
+	// Ignores dead entities.
+	void destroy(Entity);
+	[[nodiscard]] bool alive(Entity) const;
+
+	// Sets the component, adding it first if the entity doesn't have it.
+	template<class T>
+	void add(Entity entity, const T& component = {}) { addComponent(entity, componentId<T>(), &component); }
+	template<class T>
+	void remove(Entity entity) { removeComponent(entity, componentId<T>()); }
+	// nullptr if the entity is dead or doesn't have it. Valid until the next structural change.
+	template<class T>
+	[[nodiscard]] T* get(Entity entity) { return static_cast<T*>(component(entity, componentId<T>())); }
+	template<class T>
+	[[nodiscard]] bool has(Entity entity) const { return alive(entity) && (mArchetypes[mRecords[entity.index].archetype]->mask() & componentMask<T>()); }
+
+	// Untyped versions, for EntityCommandBuffer and tools that only know ids.
+	Entity create(ComponentMask);
+	void addComponent(Entity, ComponentId, const void* data);
+	void removeComponent(Entity, ComponentId);
+	[[nodiscard]] void* component(Entity, ComponentId);
+
+	// Live entities.
+	[[nodiscard]] size_t size() const { return mSize; }
+	[[nodiscard]] size_t archetypeCount() const { return mArchetypes.size(); }
+	// Destroys every entity, archetypes stay.
+	void clear();
+
+	// f(Ts&... components) for every entity that has all of Ts, const Ts for read only access.
+	template<class... Ts, class F>
+	void each(F&& f);
+	// f(Entity, Ts&... components).
+	template<class... Ts, class F>
+	void eachEntity(F&& f);
+	// f(count, Entity*, Ts*... arrays) once per chunk, each array count long. Loops over the arrays
+	// are what the compiler vectorizes.
+	template<class... Ts, class F>
+	void eachChunk(F&& f);
+	// eachChunk with the chunks spread over parallelFor. f runs concurrently and must only write
+	// the arrays it was given.
+	template<class... Ts, class F>
+	void parallelEachChunk(F&& f);
+	// Entities that have all of Ts.
+	template<class... Ts>
+	[[nodiscard]] size_t count() const;
+
+private:
+	struct Record {
+		uint32_t archetype;
+		uint32_t chunk;
+		uint32_t row;
+		uint32_t generation;
+	};
+
+	// Counts running queries, structural changes assert there are none.
+	struct IterationScope {
+		explicit IterationScope(World& world) : world(world) { world.mIterating++; }
+		~IterationScope() { world.mIterating--; }
+		World& world;
+	};
+
+	uint32_t archetypeFor(ComponentMask);
+	// Moves the entity's row into archetype to, copying the components both have.
+	void move(Entity, uint32_t to);
+	void erase(const Record&);
+
+	std::vector<std::unique_ptr<Archetype>> mArchetypes;
+	std::unordered_map<ComponentMask, uint32_t> mArchetypeIndex;
+	std::vector<Record> mRecords;
+	std::vector<uint32_t> mFreeRecords;
+	size_t mSize = 0;
+	uint32_t mIterating = 0;
+};
+
+// Structural changes recorded during a query (or on other threads, one buffer each) and applied
+// in order later. Entities it creates get placeholder ids that the buffer's later commands can
+// use, they become real entities on apply.
+class EntityCommandBuffer {
+public:
+	Entity create();
+	void destroy(Entity);
+	template<class T>
+	void add(Entity entity, const T& component = {}) { record(Op::Add, entity, componentId<T>(), &component, sizeof(T)); }
+	template<class T>
+	void remove(Entity entity) { record(Op::Remove, entity, componentId<T>(), nullptr, 0); }
+
+	// Runs every command and clears the buffer. Commands on entities that died before them are skipped.
+	// A create directly followed by adds to it goes straight into its final archetype.
+	void apply(World&);
+	void clear();
+	[[nodiscard]] bool empty() const { return mCommands.empty(); }
+	[[nodiscard]] size_t size() const { return mCommands.size(); }
+
+private:
+	enum class Op : uint8_t {
+		Create,
+		Destroy,
+		Add,
+		Remove
+	};
+
+	struct Command {
+		Op op;
+		ComponentId component;
+		Entity entity;
+		size_t data;
+	};
+
+	void record(Op, Entity, ComponentId, const void* data, size_t size);
+
+	std::vector<Command> mCommands;
+	// Component values, unaligned, copied in with memcpy.
+	std::vector<uint8_t> mData;
+	uint32_t mCreated = 0;
+};
+
+template<class... Ts>
+Entity World::create(const Ts&... components) {
+	const Entity entity = create(componentMask<Ts...>());
+	((*get<Ts>(entity) = components), ...);
+	return entity;
+}
+
+template<class... Ts, class F>
+void World::eachChunk(F&& f) {
+	const ComponentMask mask = componentMask<Ts...>();
+	IterationScope scope(*this);
+
+	for (const auto& archetype : mArchetypes)
+		if ((archetype->mask() & mask) == mask)
+			for (const auto& chunk : archetype->chunks())
+				f(static_cast<size_t>(chunk.count), archetype->entities(chunk), archetype->template array<Ts>(chunk)...);
+}
+
+template<class... Ts, class F>
+void World::each(F&& f) {
+	eachChunk<Ts...>([&f](size_t count, Entity*, Ts*... arrays) {
+		for (size_t i = 0; i < count; i++)
+			f(arrays[i]...);
+	});
+}
+
+template<class... Ts, class F>
+void World::eachEntity(F&& f) {
+	eachChunk<Ts...>([&f](size_t count, Entity* entities, Ts*... arrays) {
+		for (size_t i = 0; i < count; i++)
+			f(entities[i], arrays[i]...);
+	});
+}
+
+template<class... Ts, class F>
+void World::parallelEachChunk(F&& f) {
+	const ComponentMask mask = componentMask<Ts...>();
+	std::vector<std::pair<const Archetype*, const Archetype::Chunk*>> chunks;
+
+	for (const auto& archetype : mArchetypes)
+		if ((archetype->mask() & mask) == mask)
+			for (const auto& chunk : archetype->chunks())
+				chunks.emplace_back(archetype.get(), &chunk);
+
+	IterationScope scope(*this);
+
+	parallelFor(chunks.size(), 4, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			const auto& [archetype, chunk] = chunks[i];
+			f(static_cast<size_t>(chunk->count), archetype->entities(*chunk), archetype->template array<Ts>(*chunk)...);
+		}
+	});
+}
+
+template<class... Ts>
+size_t World::count() const {
+	const ComponentMask mask = componentMask<Ts...>();
+	size_t total = 0;
+
+	for (const auto& archetype : mArchetypes)
+		if ((archetype->mask() & mask) == mask)
+			total += archetype->size();
+
+	return total;
+}
+
+}
+
+#endif
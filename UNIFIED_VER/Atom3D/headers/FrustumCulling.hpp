@@ -0,0 +1,85 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_FRUSTUM_CULLING_HPP
+#define ATOM_FRUSTUM_CULLING_HPP
+
+// View frustum culling before draw submission. The planes come out of the view-projection matrix,
+// objects are tested 8 (AVX2) or 16 (AVX-512, -mavx512f) at a time out of SoA bounds and the
+// indices of the visible ones are packed into a list, in parallel blocks over parallelFor.
+//
+// The box test is the usual conservative one: a box is culled when it is entirely behind one
+// plane, so a few boxes near the frustum's edges and corners are kept although they're outside.
+
+#include "AtomMath.hpp"
+#include "Bvh.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Atom {
+
+// Left, right, bottom, top, near and far. xyz is the plane's normal pointing into the frustum, p is
+// in front of it when dot(xyz, p) + w >= 0.
+struct Frustum {
+	float4 planes[6];
+};
+
+// The clip volume -w <= x, y <= w, 0 <= z <= w (Metal and Vulkan depth, as built by
+// matrix_perspective_left_hand) of viewProj, in the space viewProj transforms from. Normalized.
+Frustum extractFrustum(const float4x4& viewProj);
+
+// Box around local under a transform, still axis aligned.
+Bounds transformBounds(const Bounds& local, const float4x4& transform);
+
+// Object boxes as centres and half extents, one array per component like TransformSoA.
+struct CullBoxesSoA {
+	std::vector<float> centerX, centerY, centerZ;
+	std::vector<float> extentX, extentY, extentZ;
+
+	[[nodiscard]] size_t size() const { return centerX.size(); }
+
+	void resize(size_t);
+	void set(size_t, const Bounds&);
+	size_t push(const Bounds&);
+};
+
+struct CullSpheresSoA {
+	std::vector<float> centerX, centerY, centerZ;
+	std::vector<float> radius;
+
+	[[nodiscard]] size_t size() const { return centerX.size(); }
+
+	void resize(size_t);
+	void set(size_t, const float3& center, float radius);
+	size_t push(const float3& center, float radius);
+};
+
+// Writes the indices of the visible objects of [first, first + count) to visible in order and
+// returns how many there are. visible needs room for count indices.
+size_t cullBoxes(const Frustum&, const CullBoxesSoA&, size_t first, size_t count, uint32_t* visible);
+size_t cullSpheres(const Frustum&, const CullSpheresSoA&, size_t first, size_t count, uint32_t* visible);
+
+// Whole set, spread over the worker threads with parallelFor. visible needs room for size() indices.
+size_t cullBoxes(const Frustum&, const CullBoxesSoA&, uint32_t* visible);
+size_t cullSpheres(const Frustum&, const CullSpheresSoA&, uint32_t* visible);
+
+// Appends the BVH's objects whose bounds pass the box test. Subtrees entirely inside the frustum
+// are taken whole, subtrees entirely outside skipped, so the cost follows what's near the edges.
+// Not in object order.
+void cullBvh(const Frustum&, const Bvh&, std::vector<uint32_t>& visible);
+
+// What a frame's culling found, for the engines to report.
+struct CullStats {
+	size_t visible = 0;
+	size_t culled = 0;
+	double ms = 0;
+};
+
+// Instruction set the cull kernels were built for, "AVX-512", "AVX2" or ATOM_SIMD_NAME.
+[[nodiscard]] const char* cullKernelName();
+
+}
+
+#endif
@@ -0,0 +1,204 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_JOB_SYSTEM_HPP
+#define ATOM_JOB_SYSTEM_HPP
+
+// Work stealing job scheduler. Every thread of a JobSystem (the one that made it plus threadCount - 1
+// workers) has a Chase-Lev deque: it pushes and pops its own jobs at the bottom, idle threads steal
+// from the top of the others'. Jobs come out of a per thread ring, allocating one is an increment.
+//
+// A job counts itself and its children as unfinished, it's done once its function returned and
+// every child is done, so waiting on a parent waits on the whole tree. wait() runs other jobs while
+// it waits, the main thread helps instead of blocking. Threads outside the system may use it too,
+// their jobs go through a shared queue instead of a deque.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Atom {
+
+// Bytes a job's callable may take, a lambda capturing five pointers or references.
+constexpr size_t JOB_PAYLOAD_BYTES = 40;
+
+struct alignas(64) Job {
+	// Calls the callable in payload and destroys it.
+	void (*function)(void* payload) = nullptr;
+	Job* parent = nullptr;
+	// This job plus its unfinished children, 0 once done.
+	std::atomic<int32_t> unfinished{ 0 };
+	alignas(8) unsigned char payload[JOB_PAYLOAD_BYTES];
+};
+
+class JobDeque;
+struct JobRing;
+
+class JobSystem {
+public:
+	// threadCount threads including the constructing one, 0 for hardware_concurrency().
+	explicit JobSystem(uint32_t threadCount = 0);
+	// Jobs that haven't started are dropped.
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+
+	// A job calling f() once run. Every created job has to be run. A thread has up to JOBS_PER_THREAD
+	// jobs in flight, creating more runs other jobs until one is done. A Job* can be waited on until
+	// its thread created JOBS_PER_THREAD more.
+	template<typename F>
+	Job* create(F&& f) {
+		return createChild(nullptr, std::forward<F>(f));
+	}
+
+	// Same, parent isn't done until this job is. Create children before parent finishes, from inside
+	// it (currentJob()) or before running it.
+	template<typename F>
+	Job* createChild(Job* parent, F&& f) {
+		using Callable = std::decay_t<F>;
+		static_assert(sizeof(Callable) <= JOB_PAYLOAD_BYTES, "Job callable too big, capture by reference or through a pointer");
+		static_assert(alignof(Callable) <= 8, "Job callable over aligned");
+
+		Job* job = allocate(parent);
+		new (job->payload) Callable(std::forward<F>(f));
+		job->function = [](void* payload) {
+			Callable& callable = *static_cast<Callable*>(payload);
+			callable();
+			callable.~Callable();
+		};
+
+		return job;
+	}
+
+	// Queues job on the calling thread's deque, where it's the next one this thread picks up and the
+	// last one others steal. A thread with a full deque runs the job right away.
+	void run(Job*);
+
+	// Returns once job is done, running other jobs meanwhile.
+	void wait(const Job*);
+
+	[[nodiscard]] static bool done(const Job* job) {
+		return job->unfinished.load(std::memory_order_acquire) == 0;
+	}
+
+	// body(begin, end) over chunks of [0, count), at least minChunk items each (unless count is less).
+	// Ranges split in halves, one half queued for stealing, only while the calling thread's deque is
+	// empty: as long as nobody steals, a thread works through its range minChunk items at a time
+	// without making more jobs. Nested calls are fine.
+	//
+	// A thread outside the system has no deque to split into, so its range is cut up front into a
+	// piece per thread, which the workers that pick them up keep splitting.
+	template<typename F>
+	void parallelFor(size_t count, size_t minChunk, F&& body) {
+		minChunk = std::max<size_t>(minChunk, 1);
+
+		if (count < minChunk * 2 || mThreadCount == 1) {
+			if (count)
+				body(size_t(0), count);
+			return;
+		}
+
+		if (threadIndex() == NO_THREAD) {
+			const size_t pieces = std::min<size_t>(mThreadCount, count / minChunk);
+			Job* root = create([] {});
+
+			for (size_t p = 0; p < pieces; p++) {
+				const size_t begin = count * p / pieces, end = count * (p + 1) / pieces;
+				run(createChild(root, [this, &body, begin, end, minChunk] { runRange(body, begin, end, minChunk); }));
+			}
+
+			run(root);
+			wait(root);
+			return;
+		}
+
+		Job* root = create([this, &body, count, minChunk] { runRange(body, 0, count, minChunk); });
+		run(root);
+		wait(root);
+	}
+
+	[[nodiscard]] uint32_t threadCount() const {
+		return mThreadCount;
+	}
+
+	// Job the calling thread is running, nullptr outside jobs.
+	[[nodiscard]] static Job* currentJob();
+
+	static constexpr uint32_t JOBS_PER_THREAD = 4096;
+
+private:
+	template<typename F>
+	void runRange(F& body, size_t begin, size_t end, size_t minChunk) {
+		while (end - begin >= minChunk * 2) {
+			if (wantsWork()) {
+				const size_t middle = begin + (end - begin) / 2;
+				run(createChild(currentJob(), [this, &body, middle, end, minChunk] { runRange(body, middle, end, minChunk); }));
+				end = middle;
+			} else {
+				body(begin, begin + minChunk);
+				begin += minChunk;
+			}
+		}
+
+		body(begin, end);
+	}
+
+	Job* allocate(Job* parent);
+	void execute(Job*);
+	void finish(Job*);
+
+	// Own deque first, then the shared queue, then the other threads' deques.
+	Job* findWork();
+	// True on a thread of this system whose deque is empty, so a split off half may get stolen. Always
+	// false outside the system, parallelFor splits those callers' ranges itself.
+	bool wantsWork() const;
+	void wake();
+	void workerLoop(uint32_t index);
+
+	// Index of the calling thread's deque, or NO_THREAD for threads outside the system.
+	uint32_t threadIndex() const;
+	JobRing& ring();
+
+	static constexpr uint32_t NO_THREAD = UINT32_MAX;
+
+	uint64_t mId;
+	uint32_t mThreadCount;
+	// What the constructing thread belonged to before, given back on destruction.
+	uint64_t mOwnerPreviousId;
+	uint32_t mOwnerPreviousIndex;
+	std::vector<std::unique_ptr<JobDeque>> mDeques;
+	std::vector<std::unique_ptr<JobRing>> mRings;
+	std::vector<std::thread> mThreads;
+
+	// Jobs run by threads outside the system, and their rings.
+	std::mutex mSharedMutex;
+	std::deque<Job*> mShared;
+	std::atomic<size_t> mSharedCount{ 0 };
+	std::vector<std::unique_ptr<JobRing>> mExternalRings;
+
+	// Idle workers sleep until mEpoch moves.
+	std::mutex mSleepMutex;
+	std::condition_variable mWake;
+	std::atomic<uint32_t> mSleepers{ 0 };
+	std::atomic<uint64_t> mEpoch{ 0 };
+	std::atomic<bool> mStop{ false };
+};
+
+// The engine wide system, hardware_concurrency() threads. The thread calling it first becomes its
+// main thread, both Cores call it on startup.
+JobSystem& jobSystem();
+
+}
+
+#endif
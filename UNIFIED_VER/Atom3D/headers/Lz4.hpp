@@ -0,0 +1,30 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_LZ4_HPP
+#define ATOM_LZ4_HPP
+
+// LZ4 block format (no frame header or checksums), compatible with the reference LZ4_compress_default
+// and LZ4_decompress_safe. Greedy matching on a 64K entry hash table, incompressible data is skipped
+// through faster and faster. Decoding runs at a few GB/s, which is why asset packs use it over deflate.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Atom {
+
+// Worst case compressed size of size bytes.
+[[nodiscard]] inline size_t lz4CompressBound(size_t size) {
+	return size + size / 255 + 16;
+}
+
+// Compresses src into dst. Returns the compressed size, or 0 if it doesn't fit in capacity, which
+// makes a capacity below size a cheap "only if it pays off" check. Sources of 4GB and up return 0.
+size_t lz4Compress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity);
+
+// Decompresses exactly dstSize bytes. False for corrupt input, never reads or writes out of bounds.
+bool lz4Decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize);
+
+}
+
+#endif
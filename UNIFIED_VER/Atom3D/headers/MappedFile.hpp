@@ -0,0 +1,47 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_MAPPED_FILE_HPP
+#define ATOM_MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Atom {
+
+// Read only memory mapping of a whole file, mmap on POSIX and a file mapping on Windows. Pages are
+// read in as they are touched, so opening is cheap whatever the size. Move only.
+class MappedFile {
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(MappedFile&&) noexcept;
+	MappedFile& operator=(MappedFile&&) noexcept;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// False if the file doesn't exist, can't be read or is empty.
+	bool open(const std::string& path);
+	void close();
+
+	[[nodiscard]] bool isOpen() const { return mData != nullptr; }
+	[[nodiscard]] const uint8_t* data() const { return mData; }
+	[[nodiscard]] size_t size() const { return mSize; }
+
+	// Asks the OS to start reading [offset, offset + size) in now, in big sequential reads, instead of
+	// a page fault at a time on first touch. Only a hint, returns straight away.
+	void prefetch(size_t offset, size_t size) const;
+
+private:
+	const uint8_t* mData = nullptr;
+	size_t mSize = 0;
+#ifdef _WIN32
+	void* mMapping = nullptr;
+#endif
+};
+
+}
+
+#endif
@@ -0,0 +1,224 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_MESH_BUILDER_HPP
+#define ATOM_MESH_BUILDER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+namespace Atom {
+
+enum class IndexFormat : uint8_t {
+	UInt16,
+	UInt32
+};
+
+// 16 bit indices whenever every vertex fits, 0xFFFF is kept free for primitive restart.
+inline IndexFormat indexFormatFor(size_t vertexCount) {
+	return vertexCount < 0xFFFF ? IndexFormat::UInt16 : IndexFormat::UInt32;
+}
+
+// Final mix of MurmurHash3, spreads any input over all 64 bits.
+inline uint64_t hashMix(uint64_t k) {
+	k ^= k >> 33;
+	k *= 0xFF51AFD7ED558CCDull;
+	k ^= k >> 33;
+	k *= 0xC4CEB9FE1A85EC53ull;
+	k ^= k >> 33;
+
+	return k;
+}
+
+// Good enough hash for vertex sized byte runs, for std::hash specializations of vertex types.
+// Padding bytes are hashed too, so hash the members of types that have any.
+inline uint64_t hashBytes(const void* data, size_t size) {
+	const auto* bytes = static_cast<const uint8_t*>(data);
+	uint64_t h = hashMix(size);
+
+	for (; size >= 8; size -= 8, bytes += 8) {
+		uint64_t word;
+		memcpy(&word, bytes, 8);
+		h = hashMix(h ^ word);
+	}
+
+	if (size) {
+		uint64_t word = 0;
+		memcpy(&word, bytes, size);
+		h = hashMix(h ^ word);
+	}
+
+	return h;
+}
+
+// Welded vertices and an index buffer, ready to upload. indexData holds indexCount 16 or 32 bit
+// indices, see indexFormat.
+template<typename Vertex>
+struct IndexedMesh {
+	std::vector<Vertex> vertices;
+	std::vector<uint8_t> indexData;
+	IndexFormat indexFormat = IndexFormat::UInt16;
+	uint32_t indexCount = 0;
+
+	[[nodiscard]] uint32_t index(size_t i) const {
+		if (indexFormat == IndexFormat::UInt16) {
+			uint16_t index;
+			memcpy(&index, indexData.data() + i * sizeof index, sizeof index);
+			return index;
+		}
+
+		uint32_t index;
+		memcpy(&index, indexData.data() + i * sizeof index, sizeof index);
+		return index;
+	}
+
+	// All indices widened to 32 bit, for processing.
+	[[nodiscard]] std::vector<uint32_t> indices() const {
+		std::vector<uint32_t> out(indexCount);
+
+		for (size_t i = 0; i < out.size(); i++)
+			out[i] = index(i);
+
+		return out;
+	}
+
+	// Replaces the index buffer, narrowing to 16 bit if the vertex count allows.
+	void setIndices(const uint32_t* indices, size_t count) {
+		indexFormat = indexFormatFor(vertices.size());
+		indexCount = static_cast<uint32_t>(count);
+
+		if (indexFormat == IndexFormat::UInt16) {
+			indexData.resize(count * sizeof(uint16_t));
+
+			for (size_t i = 0; i < count; i++) {
+				const auto index = static_cast<uint16_t>(indices[i]);
+				memcpy(indexData.data() + i * sizeof index, &index, sizeof index);
+			}
+		} else {
+			indexData.resize(count * sizeof(uint32_t));
+			memcpy(indexData.data(), indices, indexData.size());
+		}
+	}
+
+	[[nodiscard]] size_t vertexBytes() const { return vertices.size() * sizeof(Vertex); }
+	[[nodiscard]] size_t indexBytes() const { return indexData.size(); }
+};
+
+// Assembles an indexed triangle list, welding vertices that compare equal so each is stored (and
+// shaded) once. Lookup is an open addressing table of indices into the unique vertices, so vertices
+// aren't copied into the table and come out in first seen order.
+// Vertex needs Hash and Equal, by default a std::hash specialization and operator==.
+template<typename Vertex, typename Hash = std::hash<Vertex>, typename Equal = std::equal_to<Vertex>>
+class MeshBuilder {
+public:
+	explicit MeshBuilder(size_t expectedVertices = 0) {
+		reserve(expectedVertices);
+	}
+
+	void reserve(size_t uniqueVertices) {
+		mVertices.reserve(uniqueVertices);
+
+		if (uniqueVertices * 2 > mSlots.size())
+			rehash(uniqueVertices * 2);
+	}
+
+	// Appends one triangle corner, returns the index it was welded to.
+	uint32_t addVertex(const Vertex& vertex) {
+		// Keep the table at most half full, probe sequences stay a slot or two long.
+		if ((mVertices.size() + 1) * 2 > mSlots.size())
+			rehash(mSlots.size() * 2);
+
+		const size_t mask = mSlots.size() - 1;
+		size_t slot = hashMix(mHash(vertex)) & mask;
+
+		for (;;) {
+			const uint32_t candidate = mSlots[slot];
+
+			if (candidate == EMPTY_SLOT) {
+				const auto index = static_cast<uint32_t>(mVertices.size());
+				mVertices.push_back(vertex);
+				mSlots[slot] = index;
+				mIndices.push_back(index);
+
+				return index;
+			}
+
+			if (mEqual(mVertices[candidate], vertex)) {
+				mIndices.push_back(candidate);
+				return candidate;
+			}
+
+			slot = (slot + 1) & mask;
+		}
+	}
+
+	void addTriangle(const Vertex& a, const Vertex& b, const Vertex& c) {
+		addVertex(a);
+		addVertex(b);
+		addVertex(c);
+	}
+
+	// Unindexed triangle list, count is a multiple of 3.
+	void addTriangles(const Vertex* vertices, size_t count) {
+		for (size_t i = 0; i < count; i++)
+			addVertex(vertices[i]);
+	}
+
+	// Already indexed geometry that may still contain duplicates, e.g. one vertex per face corner.
+	void addIndexed(const Vertex* vertices, const uint32_t* indices, size_t indexCount) {
+		for (size_t i = 0; i < indexCount; i++)
+			addVertex(vertices[indices[i]]);
+	}
+
+	[[nodiscard]] size_t uniqueVertexCount() const { return mVertices.size(); }
+	[[nodiscard]] size_t indexCount() const { return mIndices.size(); }
+
+	// Moves the result out, the builder is empty afterwards.
+	IndexedMesh<Vertex> build() {
+		IndexedMesh<Vertex> mesh;
+		mesh.vertices = std::move(mVertices);
+		mesh.setIndices(mIndices.data(), mIndices.size());
+
+		mVertices.clear();
+		mIndices.clear();
+		mSlots.clear();
+
+		return mesh;
+	}
+
+private:
+	void rehash(size_t minSlots) {
+		size_t slots = 64;
+
+		while (slots < minSlots)
+			slots *= 2;
+
+		mSlots.assign(slots, EMPTY_SLOT);
+
+		const size_t mask = slots - 1;
+
+		for (uint32_t i = 0; i < mVertices.size(); i++) {
+			size_t slot = hashMix(mHash(mVertices[i])) & mask;
+
+			while (mSlots[slot] != EMPTY_SLOT)
+				slot = (slot + 1) & mask;
+
+			mSlots[slot] = i;
+		}
+	}
+
+	static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+
+	std::vector<Vertex> mVertices;
+	std::vector<uint32_t> mIndices;
+	std::vector<uint32_t> mSlots;
+	Hash mHash;
+	Equal mEqual;
+};
+
+}
+
+#endif
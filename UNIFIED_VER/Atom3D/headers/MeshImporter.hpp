@@ -0,0 +1,45 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_MESH_IMPORTER_HPP
+#define ATOM_MESH_IMPORTER_HPP
+
+#include "CookedMesh.hpp"
+#include "MeshBuilder.hpp"
+#include "VertexQuantization.hpp"
+
+#include <string>
+#include <vector>
+
+namespace Atom {
+
+// Importers return one welded, optimizeMesh'd triangle mesh and throw std::runtime_error on files
+// they can't read. Normals are computed (smooth) when the file has none.
+
+// v/vt/vn/f, polygons are fanned, groups and materials ignored. The file is cut into chunks that
+// are parsed and welded on parallelFor's workers.
+[[nodiscard]] IndexedMesh<MeshVertex> importObj(const std::string& path);
+
+// .gltf with external or data URI buffers, or .glb. Triangle primitives of the default scene are
+// flattened into one mesh with their node transforms applied, each primitive read and welded on a
+// worker. POSITION, NORMAL and TEXCOORD_0 of any component type, no sparse accessors or
+// compression extensions.
+[[nodiscard]] IndexedMesh<MeshVertex> importGltf(const std::string& path);
+
+// Picks the importer by extension.
+[[nodiscard]] IndexedMesh<MeshVertex> importMesh(const std::string& path);
+
+// Where loadMesh caches source, named after the file plus a hash of its full path.
+[[nodiscard]] std::string cookedMeshPath(const std::string& source, const std::string& cacheDirectory);
+
+// Maps the cooked cache of source, importing and cooking it first if the cache is missing, older
+// than the source or cooked with another UVFormat. Only the source file itself is checked, touch a
+// .gltf after editing its .bin.
+[[nodiscard]] CookedMesh loadMesh(const std::string& source, const std::string& cacheDirectory, UVFormat = UVFormat::Half);
+
+// Several at once, the imports run in parallel.
+[[nodiscard]] std::vector<CookedMesh> loadMeshes(const std::vector<std::string>& sources, const std::string& cacheDirectory, UVFormat = UVFormat::Half);
+
+}
+
+#endif
@@ -0,0 +1,58 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_MESH_OPTIMIZER_HPP
+#define ATOM_MESH_OPTIMIZER_HPP
+
+#include "MeshBuilder.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Atom {
+
+// Post transform cache size the optimizers target. 16 is a safe guess, bigger real caches still
+// profit from the ordering.
+constexpr uint32_t DEFAULT_VERTEX_CACHE_SIZE = 16;
+
+struct VertexCacheStats {
+	uint32_t vertexTransforms = 0; // Vertex shader runs
+	float acmr = 0; // Average cache miss ratio, transforms per triangle. 0.5 is ideal, 3 is no reuse.
+	float atvr = 0; // Average transform to vertex ratio, transforms per referenced vertex. 1 is ideal.
+};
+
+// Simulates a FIFO post transform cache of cacheSize entries over a triangle list.
+[[nodiscard]] VertexCacheStats analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = DEFAULT_VERTEX_CACHE_SIZE);
+
+// Reorders triangles for post transform cache hits, Tipsify (Sander et al. 2007). Linear time, runs
+// fine at load time.
+void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = DEFAULT_VERTEX_CACHE_SIZE);
+
+// Reorders clusters of an already cache optimized list so triangles facing away from the mesh
+// center, which usually end up in front, come first and the depth test rejects more of the rest.
+// Clusters are split where the cache restarts anyway, or where splitting keeps ACMR within
+// threshold times the cluster's own. positions points at the first vertex's x, y, z floats.
+void optimizeOverdraw(uint32_t* indices, size_t indexCount, const float* positions, size_t vertexCount, size_t positionStride, uint32_t cacheSize = DEFAULT_VERTEX_CACHE_SIZE, float threshold = 1.05f);
+
+// Orders vertices by first use in the index buffer so vertex fetch walks memory forwards, rewriting
+// the indices to match. Vertices nothing references are dropped, returns the new vertex count.
+size_t optimizeVertexFetch(void* vertices, uint32_t* indices, size_t indexCount, size_t vertexCount, size_t vertexSize);
+
+// All three passes, in the order they have to run. positionOffset is offsetof(Vertex, position),
+// the position has to start with 3 floats.
+template<typename Vertex>
+void optimizeMesh(IndexedMesh<Vertex>& mesh, size_t positionOffset, uint32_t cacheSize = DEFAULT_VERTEX_CACHE_SIZE) {
+	std::vector<uint32_t> indices = mesh.indices();
+	const auto* positions = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(mesh.vertices.data()) + positionOffset);
+
+	optimizeVertexCache(indices.data(), indices.size(), mesh.vertices.size(), cacheSize);
+	optimizeOverdraw(indices.data(), indices.size(), positions, mesh.vertices.size(), sizeof(Vertex), cacheSize);
+	mesh.vertices.resize(optimizeVertexFetch(mesh.vertices.data(), indices.data(), indices.size(), mesh.vertices.size(), sizeof(Vertex)));
+
+	mesh.setIndices(indices.data(), indices.size());
+}
+
+}
+
+#endif
@@ -0,0 +1,46 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_MIP_CHAIN_HPP
+#define ATOM_MIP_CHAIN_HPP
+
+// CPU mip chain generation for RGBA8 images. Every level is filtered from a float copy of the one
+// above it, sRGB colors in linear light so the chain doesn't darken, alpha always as is. Pixels are one
+// AtomSimd vector each, rows are split over parallelFor.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Atom {
+
+enum class MipFilter : uint32_t {
+	Box = 0,   // Average of the source pixels under each destination pixel, cheap, a little blurry
+	Kaiser = 1 // Kaiser windowed sinc, 4 destination pixels wide, keeps detail sharper
+};
+
+struct MipLevel {
+	uint32_t width;
+	uint32_t height;
+	size_t offset; // Into MipChain::data
+
+	[[nodiscard]] size_t bytes() const { return static_cast<size_t>(width) * height * 4; }
+};
+
+// Levels down to 1x1, level 0 first, packed one after another with 4 bytes per pixel.
+struct MipChain {
+	std::vector<MipLevel> levels;
+	std::vector<uint8_t> data;
+
+	[[nodiscard]] const uint8_t* level(size_t i) const { return data.data() + levels[i].offset; }
+};
+
+// floor(log2(max(width, height))) + 1, what a full chain has.
+[[nodiscard]] uint32_t mipLevelCount(uint32_t width, uint32_t height);
+
+// Full chain of a width x height RGBA8 image, level 0 is a copy of it. Odd sizes round down.
+[[nodiscard]] MipChain generateMipChain(const uint8_t* rgba, uint32_t width, uint32_t height, bool srgb, MipFilter = MipFilter::Kaiser);
+
+}
+
+#endif
@@ -0,0 +1,24 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_PARALLEL_FOR_HPP
+#define ATOM_PARALLEL_FOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace Atom {
+
+// Fork/join on jobSystem()'s threads, the calling thread works too. [0, count) is cut into chunks of
+// at least minChunk items and body(begin, end) is called once per chunk, returning when all of them
+// are done. Ranges are split as threads run out of work (JobSystem::parallelFor), calls from inside
+// a body or from several threads at once share the same threads.
+void parallelFor(size_t count, size_t minChunk, const std::function<void(size_t, size_t)>& body);
+
+// Threads parallelFor can spread over, including the caller.
+[[nodiscard]] uint32_t parallelThreadCount();
+
+}
+
+#endif
@@ -0,0 +1,76 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_RECT_PACKER_HPP
+#define ATOM_RECT_PACKER_HPP
+
+// 2D bin packing for texture atlases. Skyline keeps only the top edge of what's placed, fast and
+// good for similar heights. MaxRects keeps every free rectangle, slower but fills mixed sizes
+// tighter. Both place with best short side fit, no rotation (UVs would have to rotate too).
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Atom {
+
+enum class PackAlgorithm {
+	Skyline,
+	MaxRects
+};
+
+struct PackRect {
+	uint32_t x;
+	uint32_t y;
+	uint32_t width;
+	uint32_t height;
+};
+
+class SkylinePacker {
+public:
+	void reset(uint32_t width, uint32_t height);
+	// False if w x h doesn't fit anywhere.
+	bool insert(uint32_t w, uint32_t h, PackRect& placed);
+	[[nodiscard]] double occupancy() const;
+
+private:
+	struct Segment {
+		uint32_t x;
+		uint32_t y;
+		uint32_t width;
+	};
+
+	std::vector<Segment> mSkyline;
+	uint32_t mWidth = 0;
+	uint32_t mHeight = 0;
+	uint64_t mUsed = 0;
+};
+
+class MaxRectsPacker {
+public:
+	void reset(uint32_t width, uint32_t height);
+	bool insert(uint32_t w, uint32_t h, PackRect& placed);
+	[[nodiscard]] double occupancy() const;
+
+private:
+	void split(const PackRect& used);
+	void prune();
+
+	std::vector<PackRect> mFree;
+	uint32_t mWidth = 0;
+	uint32_t mHeight = 0;
+	uint64_t mUsed = 0;
+};
+
+struct PackPlacement {
+	PackRect rect;
+	uint32_t page;
+};
+
+// Packs every size into as many width x height pages as it takes, biggest first. Sizes that don't
+// fit an empty page get page UINT32_MAX.
+[[nodiscard]] std::vector<PackPlacement> packRects(const std::vector<PackRect>& sizes, uint32_t width, uint32_t height, PackAlgorithm, uint32_t* pageCount = nullptr);
+
+}
+
+#endif
@@ -0,0 +1,79 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_RING_ALLOCATOR_HPP
+#define ATOM_RING_ALLOCATOR_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace Atom {
+
+// Offset bookkeeping for a persistently mapped upload buffer shared by N frames in flight.
+// Allocations are a bump of the head, and a whole frame's worth of space is reclaimed at once in
+// beginFrame(slot), once the caller has waited on that slot's fence. Frames retire in order, so the
+// free space is always the single range from head around to the oldest live frame.
+// Backend agnostic, AtomCore wraps it in StagingRing and Core in UploadRing.
+class RingAllocator {
+public:
+	static constexpr uint64_t INVALID_OFFSET = UINT64_MAX;
+
+	RingAllocator() = default;
+
+	void init(uint64_t capacity, uint32_t frameSlots) {
+		mCapacity = capacity;
+		mSlotBytes.assign(frameSlots, 0);
+		mHead = 0;
+		mUsed = 0;
+		mCurrentSlot = 0;
+		mPeakFrameBytes = 0;
+	}
+
+	// Call once per frame, after the fence/semaphore guarding this slot has signalled.
+	void beginFrame(uint32_t slot) {
+		mUsed -= mSlotBytes[slot];
+		mSlotBytes[slot] = 0;
+		mCurrentSlot = slot;
+	}
+
+	// Returns INVALID_OFFSET when the ring is full. alignment must be a power of two.
+	uint64_t allocate(uint64_t size, uint64_t alignment) {
+		uint64_t offset = (mHead + alignment - 1) & ~(alignment - 1);
+		uint64_t consumed = offset + size - mHead;
+
+		// Doesn't fit before the end, the tail padding is burned and we start over at 0.
+		if (offset + size > mCapacity) {
+			offset = 0;
+			consumed = mCapacity - mHead + size;
+		}
+
+		if (size > mCapacity || mUsed + consumed > mCapacity)
+			return INVALID_OFFSET;
+
+		mHead = offset + size;
+		mUsed += consumed;
+		mSlotBytes[mCurrentSlot] += consumed;
+
+		if (mSlotBytes[mCurrentSlot] > mPeakFrameBytes)
+			mPeakFrameBytes = mSlotBytes[mCurrentSlot];
+
+		return offset;
+	}
+
+	[[nodiscard]] uint64_t capacity() const { return mCapacity; }
+	[[nodiscard]] uint64_t usedBytes() const { return mUsed; }
+	[[nodiscard]] uint64_t frameBytes() const { return mSlotBytes.empty() ? 0 : mSlotBytes[mCurrentSlot]; }
+	[[nodiscard]] uint64_t peakFrameBytes() const { return mPeakFrameBytes; }
+
+private:
+	uint64_t mCapacity = 0;
+	uint64_t mHead = 0;
+	uint64_t mUsed = 0;
+	uint64_t mPeakFrameBytes = 0;
+	uint32_t mCurrentSlot = 0;
+	std::vector<uint64_t> mSlotBytes;
+};
+
+}
+
+#endif
@@ -0,0 +1,50 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_SCENE_COMPONENTS_HPP
+#define ATOM_SCENE_COMPONENTS_HPP
+
+// The components both backends build scenes from, see Ecs.hpp.
+
+#include "AtomMath.hpp"
+#include "Ecs.hpp"
+
+#include <cstdint>
+
+namespace Atom {
+
+// Local position, rotation (unit quaternion) and scale.
+struct Transform {
+	float3 position = { 0.0f, 0.0f, 0.0f };
+	quaternion_float rotation = { 0.0f, 0.0f, 0.0f, 1.0f };
+	float3 scale = { 1.0f, 1.0f, 1.0f };
+};
+
+// translation * rotation * scale of the Transform, written by updateWorldMatrices.
+struct WorldMatrix {
+	float4x4 matrix;
+};
+
+// What the renderer draws the entity with, ids are the backend's (TextureHandle for Metal).
+struct Renderable {
+	uint32_t mesh = 0;
+	uint32_t texture = 0;
+};
+
+// translation * rotation * scale.
+inline float4x4 composeTransform(const Transform& t) {
+	float4x4 m = matrix4x4_from_quaternion(t.rotation);
+	m.columns[0] = m.columns[0] * t.scale.x;
+	m.columns[1] = m.columns[1] * t.scale.y;
+	m.columns[2] = m.columns[2] * t.scale.z;
+	m.columns[3] = { t.position.x, t.position.y, t.position.z, 1.0f };
+	return m;
+}
+
+// WorldMatrix of every entity that has both, chunks spread over parallelFor. Entities in a
+// TransformHierarchy get theirs from syncWorldMatrices instead.
+void updateWorldMatrices(World&);
+
+}
+
+#endif
@@ -0,0 +1,80 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_TEXTURE_ATLAS_HPP
+#define ATOM_TEXTURE_ATLAS_HPP
+
+// Merges small textures into the layers of one array texture at cook time, so draws that use any of
+// them share a binding and only differ in a layer index and a UV scale/offset. buildAtlas packs
+// many images per layer (RectPacker), buildTextureArray puts one image in each. The regions go
+// into a text .atlas file next to the cooked .dds, see the cookatlas tool.
+
+#include "AtomMath.hpp"
+#include "RectPacker.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Atom {
+
+// RGBA8 pixels, top row first like every image the engine loads.
+struct AtlasImage {
+	std::string name;
+	const uint8_t* rgba;
+	uint32_t width;
+	uint32_t height;
+};
+
+// Where an image ended up, x and y in pixels from the layer's top left. UVs of the image map to
+// uv * uvScale + uvOffset on layer, both from the top left like mesh UVs.
+struct AtlasRegion {
+	std::string name;
+	uint32_t layer;
+	uint32_t x;
+	uint32_t y;
+	uint32_t width;
+	uint32_t height;
+	float2 uvScale;
+	float2 uvOffset;
+};
+
+struct AtlasOptions {
+	uint32_t width = 2048;
+	uint32_t height = 2048;
+	// Edge pixels repeated around every image, so bilinear filtering and the first mips don't
+	// bleed neighbours in. Each padded image also starts and ends on a 4x4 block.
+	uint32_t padding = 4;
+	PackAlgorithm packer = PackAlgorithm::MaxRects;
+};
+
+struct TextureAtlas {
+	uint32_t width = 0;
+	uint32_t height = 0;
+	std::vector<std::vector<uint8_t>> layers; // RGBA8, width x height each
+	std::vector<AtlasRegion> regions;
+
+	[[nodiscard]] const AtlasRegion* find(std::string_view name) const;
+};
+
+// Packs images into as few layers as it takes. Throws std::invalid_argument if one doesn't fit a
+// layer even with nothing else in it.
+[[nodiscard]] TextureAtlas buildAtlas(const std::vector<AtlasImage>&, const AtlasOptions& = {});
+
+// One image per layer, layers the size of the biggest image. Smaller ones sit in the corner with
+// their edges repeated over the rest, which is fine for clamped UVs but not for repeating ones.
+[[nodiscard]] TextureAtlas buildTextureArray(const std::vector<AtlasImage>&);
+
+// Moves UVs (pairs of floats, stride bytes apart) into region, for meshes merged at cook time.
+void remapUVs(float* uvs, size_t count, size_t stride, const AtlasRegion&);
+
+// The .atlas text: an "atlas width height layers" line, then "name layer x y width height" per
+// region. Names can't have spaces. parseAtlas fills width, height and regions, false if it's malformed.
+[[nodiscard]] std::string atlasDescription(const TextureAtlas&);
+bool parseAtlas(const char* text, size_t size, TextureAtlas&);
+
+}
+
+#endif
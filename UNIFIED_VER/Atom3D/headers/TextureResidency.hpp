@@ -0,0 +1,111 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_TEXTURE_RESIDENCY_HPP
+#define ATOM_TEXTURE_RESIDENCY_HPP
+
+// Which mip levels of which textures are in GPU memory, under a byte budget. Every texture keeps a
+// range of levels resident, from its residentMip down to the smallest, and a tail of small levels
+// that never leaves. Each frame the renderer requests the finest level it needs per texture from the
+// screen footprint (mipForFootprint), update() then streams finer levels in and evicts the least
+// recently used levels elsewhere to make room. The backend only applies the Changes, rebuilding the
+// GPU texture from the residentMip on, so the policy is the same for Metal and Vulkan.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Atom {
+
+// Texels across the longer side against the pixels an object covers, log2 of it is the level that
+// samples about 1:1. Pass width * tiling for UVs that repeat. Never below 0.
+[[nodiscard]] float mipForFootprint(uint32_t width, uint32_t height, float footprintPixels);
+
+// Pixels covered by an object worldSize across at distance from the camera, for a vertical field of
+// view (radians) and a viewport height in pixels.
+[[nodiscard]] float screenFootprint(float worldSize, float distance, float fovY, float viewportHeight);
+
+struct TextureResidencyStats {
+	uint32_t levelCount;
+	uint32_t tailMip;       // First level that stays resident no matter what
+	uint32_t residentMip;   // First (finest) resident level
+	uint32_t wantedMip;     // Finest level requested in the last update, levelCount when not requested
+	uint64_t residentBytes;
+	uint64_t fullBytes;     // With every level resident
+	uint64_t lastUsedFrame;
+	uint32_t loads;         // Levels streamed in, over the texture's lifetime
+	uint32_t evictions;     // Levels evicted
+};
+
+struct TextureResidencyTotals {
+	uint64_t budgetBytes;
+	uint64_t residentBytes;
+	uint64_t wantedBytes;   // What every texture at its wanted level would take
+	uint32_t textureCount;
+	uint32_t loads;         // Levels streamed in by the last update
+	uint32_t evictions;     // Levels evicted by the last update
+	uint64_t uploadBytes;   // Bytes those loads added
+	bool overBudget;        // The last update couldn't fit everything that was requested
+};
+
+class TextureResidency {
+public:
+	using Id = uint32_t;
+
+	// A texture whose residentMip changed in update(). Levels residentMip.. are what it should hold now.
+	struct Change {
+		Id id;
+		uint32_t residentMip;
+	};
+
+	// 0 for no budget. Lowering it evicts on the next update.
+	void setBudget(uint64_t bytes) { mBudget = mTotals.budgetBytes = bytes; }
+	// Caps the bytes one update streams in, so a camera cut doesn't stall one frame on uploads.
+	// 0 for no cap.
+	void setUploadLimit(uint64_t bytes) { mUploadLimit = bytes; }
+
+	// levelBytes holds the GPU size of every level, finest first. Levels tailMip.. start resident and
+	// stay, tailMip 0 pins the whole texture. Ids of removed textures are reused.
+	Id add(const std::vector<uint64_t>& levelBytes, uint32_t tailMip);
+	void remove(Id);
+
+	// This frame needs levels mip.. of id. Fractional mips want the finer level, trilinear blends
+	// it in. Requests count until the next update.
+	void request(Id, float mip);
+
+	// Streams in and evicts, returns the textures to rebuild. Call once per frame.
+	std::vector<Change> update();
+
+	[[nodiscard]] TextureResidencyStats stats(Id) const;
+	[[nodiscard]] const TextureResidencyTotals& totals() const { return mTotals; }
+	[[nodiscard]] uint64_t frame() const { return mFrame; }
+
+private:
+	struct Entry {
+		std::vector<uint64_t> levelBytes;
+		std::vector<uint64_t> levelUsed; // Frame each level was last requested in
+		uint32_t tailMip = 0;
+		uint32_t residentMip = 0;
+		uint32_t wantedMip = 0;
+		uint64_t requestFrame = 0;
+		uint32_t loads = 0;
+		uint32_t evictions = 0;
+		bool alive = false;
+	};
+
+	// Evicts least recently used levels until residentBytes + bytes fits the budget. Levels used this
+	// frame only go when evictCurrent. False if it couldn't make the room.
+	bool makeRoom(uint64_t bytes, bool evictCurrent, std::vector<uint32_t>& startMips);
+
+	std::vector<Entry> mEntries;
+	std::vector<Id> mFree;
+	uint64_t mBudget = 0;
+	uint64_t mUploadLimit = 0;
+	uint64_t mResident = 0;
+	uint64_t mFrame = 1;
+	TextureResidencyTotals mTotals = {};
+};
+
+}
+
+#endif
@@ -0,0 +1,46 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_TRANSFORM_BATCH_HPP
+#define ATOM_TRANSFORM_BATCH_HPP
+
+#include "AtomMath.hpp"
+
+#include <cstddef>
+#include <vector>
+
+namespace Atom {
+
+// Position/rotation/scale of many objects, one array per component so the batch kernels can load
+// 8 (AVX2) or 16 (AVX-512) objects' worth of a component with a single instruction.
+// Rotations are unit quaternions.
+struct TransformSoA {
+	std::vector<float> positionX, positionY, positionZ;
+	std::vector<float> rotationX, rotationY, rotationZ, rotationW;
+	std::vector<float> scaleX, scaleY, scaleZ;
+
+	[[nodiscard]] size_t size() const { return positionX.size(); }
+
+	void resize(size_t);
+	void set(size_t, const float3& position, const quaternion_float& rotation, const float3& scale);
+	size_t push(const float3& position, const quaternion_float& rotation, const float3& scale);
+};
+
+// world[i] = translation * rotation * scale, the same matrix as
+// matrix_multiply(matrix4x4_translation(p), matrix_multiply(matrix4x4_from_quaternion(q), matrix4x4_scale(s))).
+// Output arrays are indexed by object, so ranges [first, first + count) can be filled independently.
+void composeWorldMatrices(const TransformSoA&, size_t first, size_t count, float4x4* world);
+
+// Also writes mvp[i] = viewProj * world[i]. world may be null when only the MVPs are needed.
+void composeMVPMatrices(const TransformSoA&, size_t first, size_t count, const float4x4& viewProj, float4x4* world, float4x4* mvp);
+
+// Whole batch, spread over the worker threads with parallelFor.
+void composeWorldMatrices(const TransformSoA&, float4x4* world);
+void composeMVPMatrices(const TransformSoA&, const float4x4& viewProj, float4x4* world, float4x4* mvp);
+
+// Instruction set the batch kernels were built for, "AVX-512", "AVX2" or ATOM_SIMD_NAME.
+[[nodiscard]] const char* transformBatchKernelName();
+
+}
+
+#endif
@@ -0,0 +1,92 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_TRANSFORM_HIERARCHY_HPP
+#define ATOM_TRANSFORM_HIERARCHY_HPP
+
+// Parent/child transforms. Nodes live in flat arrays in breadth first order: level by level,
+// parents before their children and every node's children next to each other. setLocal marks a
+// node dirty and update() recomputes the world matrices of the dirty nodes and everything under
+// them, one level at a time (each level over parallelFor, since it only reads the level above).
+// Nodes nobody moved are never touched, so a frame costs what moved rather than the scene size.
+//
+// create, destroy and setParent only record the change, the next update() re-sorts the arrays,
+// which is O(nodes). Fine for loading and the odd reparent, not for every frame.
+
+#include "AtomMath.hpp"
+#include "Ecs.hpp"
+#include "SceneComponents.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Atom {
+
+class TransformHierarchy {
+public:
+	// Stable handle, the node's place in the arrays changes with the structure.
+	using Node = uint32_t;
+	static constexpr Node NO_NODE = UINT32_MAX;
+
+	// entity is whose WorldMatrix syncWorldMatrices writes, if any.
+	Node create(Node parent = NO_NODE, const Transform& local = {}, Entity entity = NULL_ENTITY);
+	// The node and everything under it.
+	void destroy(Node);
+	// NO_NODE makes it a root. Throws std::invalid_argument if parent is in the node's own subtree.
+	void setParent(Node, Node parent);
+	void setLocal(Node, const Transform&);
+
+	[[nodiscard]] bool valid(Node) const;
+	[[nodiscard]] Node parent(Node node) const { return mParentNode[mIndexOf[node]]; }
+	[[nodiscard]] const Transform& local(Node node) const { return mLocal[mIndexOf[node]]; }
+	[[nodiscard]] Entity entity(Node node) const { return mEntity[mIndexOf[node]]; }
+	// As of the last update().
+	[[nodiscard]] const float4x4& world(Node node) const { return mWorld[mIndexOf[node]]; }
+
+	// Recomputes the dirty subtrees and returns how many world matrices it wrote.
+	size_t update();
+	// The nodes the last update() recomputed, parents before children.
+	[[nodiscard]] const std::vector<Node>& changed() const { return mChanged; }
+
+	[[nodiscard]] size_t size() const { return mSize; }
+	// Depth of the deepest node plus one, as of the last update().
+	[[nodiscard]] size_t levelCount() const { return mDirty.size(); }
+
+private:
+	static constexpr uint32_t NO_INDEX = UINT32_MAX;
+
+	void markDirty(uint32_t index);
+	void rebuild();
+
+	// By handle.
+	std::vector<uint32_t> mIndexOf;
+	std::vector<Node> mFreeNodes;
+
+	// By index, breadth first after a rebuild, new nodes at the end until the next one. Destroyed
+	// nodes leave a hole (mNode NO_NODE) until then.
+	std::vector<Transform> mLocal;
+	std::vector<float4x4> mWorld;
+	std::vector<Node> mNode;
+	std::vector<Node> mParentNode;
+	std::vector<Entity> mEntity;
+	std::vector<uint8_t> mDirtyFlag;
+	// Only valid while the structure is current.
+	std::vector<uint32_t> mParent;
+	std::vector<uint32_t> mFirstChild;
+	std::vector<uint32_t> mChildCount;
+	std::vector<uint32_t> mLevel;
+
+	// Dirty indices per level, for the next update().
+	std::vector<std::vector<uint32_t>> mDirty;
+	std::vector<Node> mChanged;
+	size_t mSize = 0;
+	bool mStructureChanged = false;
+};
+
+// Writes the world matrices the last update() changed into the WorldMatrix of their nodes' entities.
+void syncWorldMatrices(const TransformHierarchy&, World&);
+
+}
+
+#endif
@@ -0,0 +1,168 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_VERTEX_QUANTIZATION_HPP
+#define ATOM_VERTEX_QUANTIZATION_HPP
+
+// Encoders for compact vertex attributes. Positions become unorm16 inside the mesh's bounds, UVs
+// half floats or unorm16 inside their own bounds, normals two octahedral snorm16s. The shaders undo
+// it with the scale/offset pairs computed here, decode functions are for tools and checks.
+
+#include "AtomMath.hpp"
+#include "MeshBuilder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace Atom {
+
+enum class UVFormat : uint32_t {
+	Half = 0, // Exact for 0..1 UVs up to 2048 texels, keeps tiling UVs that go far outside
+	Unorm16 = 1 // Uniform precision over the mesh's UV bounds
+};
+
+// Decoded position = offset + scale * unorm.
+struct PositionQuantization {
+	float3 scale;
+	float3 offset;
+};
+
+// Decoded UV = offset + scale * unorm for Unorm16, scale/offset unused for Half.
+struct UVQuantization {
+	float2 scale;
+	float2 offset;
+	UVFormat format = UVFormat::Half;
+};
+
+inline uint16_t unorm16(float v) {
+	return static_cast<uint16_t>(std::lround(std::clamp(v, 0.0f, 1.0f) * 65535.0f));
+}
+
+inline int16_t snorm16(float v) {
+	return static_cast<int16_t>(std::lround(std::clamp(v, -1.0f, 1.0f) * 32767.0f));
+}
+
+// Bounds of count positions, 3 floats each, stride bytes apart.
+[[nodiscard]] PositionQuantization positionQuantization(const float* positions, size_t count, size_t stride);
+[[nodiscard]] UVQuantization uvQuantization(const float* uvs, size_t count, size_t stride, UVFormat);
+
+inline ushort4 quantizePosition(const PositionQuantization& q, float x, float y, float z) {
+	const auto axis = [](float v, float scale, float offset) { return unorm16(scale > 0 ? (v - offset) / scale : 0.0f); };
+
+	return { axis(x, q.scale.x, q.offset.x), axis(y, q.scale.y, q.offset.y), axis(z, q.scale.z, q.offset.z), 0 };
+}
+
+inline float3 dequantizePosition(const PositionQuantization& q, ushort4 p) {
+	return {
+		q.offset.x + q.scale.x * (p.x / 65535.0f),
+		q.offset.y + q.scale.y * (p.y / 65535.0f),
+		q.offset.z + q.scale.z * (p.z / 65535.0f)
+	};
+}
+
+inline ushort2 quantizeUV(const UVQuantization& q, float u, float v) {
+	if (q.format == UVFormat::Half)
+		return { float16_from_float32(u), float16_from_float32(v) };
+
+	return {
+		unorm16(q.scale.x > 0 ? (u - q.offset.x) / q.scale.x : 0.0f),
+		unorm16(q.scale.y > 0 ? (v - q.offset.y) / q.scale.y : 0.0f)
+	};
+}
+
+inline float2 dequantizeUV(const UVQuantization& q, ushort2 uv) {
+	if (q.format == UVFormat::Half)
+		return { float32_from_float16(uv.x), float32_from_float16(uv.y) };
+
+	return { q.offset.x + q.scale.x * (uv.x / 65535.0f), q.offset.y + q.scale.y * (uv.y / 65535.0f) };
+}
+
+// Unit vector onto the octahedron, the lower half folded over the upper.
+inline short2 octEncode(float x, float y, float z) {
+	const float l1 = std::fabs(x) + std::fabs(y) + std::fabs(z);
+
+	if (l1 == 0)
+		return { 0, 0 };
+
+	float u = x / l1, v = y / l1;
+
+	if (z < 0) {
+		const float fu = (1 - std::fabs(v)) * (u >= 0 ? 1.0f : -1.0f);
+		const float fv = (1 - std::fabs(u)) * (v >= 0 ? 1.0f : -1.0f);
+		u = fu;
+		v = fv;
+	}
+
+	return { snorm16(u), snorm16(v) };
+}
+
+inline float3 octDecode(short2 n) {
+	float x = std::max(n.x / 32767.0f, -1.0f), y = std::max(n.y / 32767.0f, -1.0f);
+	const float z = 1 - std::fabs(x) - std::fabs(y);
+	const float t = std::max(-z, 0.0f);
+
+	x += x >= 0 ? -t : t;
+	y += y >= 0 ? -t : t;
+
+	const float length = std::sqrt(x * x + y * y + z * z);
+
+	return { x / length, y / length, z / length };
+}
+
+// Area weighted vertex normals of an indexed triangle list, for meshes that come without any.
+[[nodiscard]] std::vector<float3> computeVertexNormals(const float* positions, size_t vertexCount, size_t stride, const uint32_t* indices, size_t indexCount);
+
+// Full precision vertex of imported meshes, welded and optimized in this form before it is packed.
+// UV origin is the top left, like glTF and both APIs.
+struct MeshVertex {
+	float position[3];
+	float normal[3];
+	float uv[2];
+};
+
+// Bitwise, so welding never merges vertices the shaders could tell apart. No padding.
+inline bool operator==(const MeshVertex& a, const MeshVertex& b) {
+	return memcmp(&a, &b, sizeof(MeshVertex)) == 0;
+}
+
+// 16 byte vertex both backends draw, the layout of the Metal PackedVertexData and of cooked mesh files.
+struct PackedVertex {
+	ushort4 position;      // xyz unorm16 inside the mesh bounds, w unused
+	ushort2 textureCoords; // Half floats or unorm16, see MeshQuantization::uvFormat
+	short2 normal;         // Octahedral, snorm16
+};
+
+// How to decode a PackedVertex buffer, position = positionOffset + positionScale * unorm in 0..1,
+// UVs the same for Unorm16. Fixed size, it is stored in cooked mesh files as is.
+struct MeshQuantization {
+	float4 positionScale = {};
+	float4 positionOffset = {};
+	float2 uvScale = {};
+	float2 uvOffset = {};
+	uint32_t uvFormat = 0; // UVFormat
+	uint32_t reserved[3] = { 0, 0, 0 };
+};
+
+static_assert(sizeof(PackedVertex) == 16 && sizeof(MeshQuantization) == 64, "Stored in cooked mesh files");
+
+// Quantizes count vertices into out, returns what decodes them.
+MeshQuantization packVertices(const MeshVertex* vertices, size_t count, UVFormat, PackedVertex* out);
+
+}
+
+namespace std {
+
+template<>
+struct hash<Atom::MeshVertex> {
+	size_t operator()(const Atom::MeshVertex& v) const noexcept {
+		return static_cast<size_t>(Atom::hashBytes(&v, sizeof v));
+	}
+};
+
+}
+
+#endif
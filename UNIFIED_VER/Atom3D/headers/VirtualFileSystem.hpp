@@ -0,0 +1,72 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_VIRTUAL_FILE_SYSTEM_HPP
+#define ATOM_VIRTUAL_FILE_SYSTEM_HPP
+
+// Resolves asset names ("engine/assets/mc_grass.jpeg", "GLSL/vert.spv") to entries of mounted asset
+// packs or to loose files under mounted directories. Shipping builds mount a pack and a cold start
+// reads it in a few large sequential reads, development builds can keep working on loose files.
+
+#include "AssetPack.hpp"
+#include "MappedFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Atom {
+
+// The contents of one asset. Points into a pack's mapping for uncompressed entries, owns the
+// decompressed bytes or the mapping of a loose file otherwise. Move only.
+class AssetFile {
+public:
+	[[nodiscard]] bool isOpen() const { return mOpen; }
+	[[nodiscard]] const uint8_t* data() const { return mData; }
+	[[nodiscard]] size_t size() const { return mSize; }
+
+private:
+	friend class VirtualFileSystem;
+
+	const uint8_t* mData = nullptr;
+	size_t mSize = 0;
+	bool mOpen = false;
+	MappedFile mFile;
+	std::vector<uint8_t> mBuffer;
+};
+
+// Mount everything first, lookups are const and safe from any number of threads after that but
+// mounting isn't. The most recently mounted pack or directory that has a name wins.
+class VirtualFileSystem {
+public:
+	// Maps the pack and prefetches its data. False if it's missing or invalid, nothing is mounted then.
+	bool mountPack(const std::string& path);
+	// Names resolve to directory/name. The directory doesn't have to exist.
+	void mountDirectory(const std::string& directory);
+	void unmountAll();
+
+	[[nodiscard]] bool exists(std::string_view name) const;
+
+	// False if no mount has name, a loose file can't be read or a pack entry fails to decompress.
+	bool open(std::string_view name, AssetFile& file) const;
+
+	// Copy of the contents, for APIs that want their own buffer. Throws std::runtime_error if open fails.
+	[[nodiscard]] std::vector<uint8_t> read(std::string_view name) const;
+
+	[[nodiscard]] size_t packCount() const;
+
+private:
+	struct Mount {
+		std::unique_ptr<AssetPack> pack;
+		std::string directory;
+	};
+
+	std::vector<Mount> mMounts;
+};
+
+}
+
+#endif
@@ -0,0 +1,247 @@
+// ReSharper disable CppInconsistentNaming
+#include "AssetPack.hpp"
+
+#include "Lz4.hpp"
+#include "ParallelFor.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+
+namespace Atom {
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment) {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+std::string normalizeAssetName(std::string_view name) {
+	std::string normalized(name);
+	std::replace(normalized.begin(), normalized.end(), '\\', '/');
+
+	size_t start = 0;
+
+	while (normalized.compare(start, 2, "./") == 0)
+		start += 2;
+
+	return normalized.substr(start);
+}
+
+bool AssetPack::open(const std::string& path) {
+	close();
+
+	if (!mFile.open(path) || mFile.size() < sizeof(AssetPackHeader)) {
+		close();
+		return false;
+	}
+
+	memcpy(&mHeader, mFile.data(), sizeof mHeader);
+
+	const uint64_t size = mFile.size();
+	const uint64_t tocBytes = static_cast<uint64_t>(mHeader.entryCount) * sizeof(AssetPackEntry);
+
+	bool valid = mHeader.magic == ASSET_PACK_MAGIC && mHeader.version == ASSET_PACK_VERSION &&
+	             mHeader.tocOffset % alignof(AssetPackEntry) == 0 &&
+	             mHeader.tocOffset <= size && tocBytes <= size - mHeader.tocOffset &&
+	             mHeader.namesOffset <= size && mHeader.namesBytes <= size - mHeader.namesOffset;
+
+	if (valid) {
+		mEntries = reinterpret_cast<const AssetPackEntry*>(mFile.data() + mHeader.tocOffset);
+
+		// Every entry in bounds, find() relies on the order.
+		for (uint32_t i = 0; i < mHeader.entryCount && valid; i++) {
+			const AssetPackEntry& e = mEntries[i];
+
+			valid = e.offset <= size && e.storedSize <= size - e.offset &&
+			        static_cast<uint64_t>(e.nameOffset) + e.nameLength <= mHeader.namesBytes &&
+			        (e.compression == static_cast<uint32_t>(AssetCompression::None) ? e.storedSize == e.size : e.compression == static_cast<uint32_t>(AssetCompression::LZ4)) &&
+			        (i == 0 || mEntries[i - 1].nameHash <= e.nameHash);
+		}
+	}
+
+	if (!valid) {
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void AssetPack::close() {
+	mFile.close();
+	mHeader = {};
+	mEntries = nullptr;
+}
+
+std::string_view AssetPack::name(const AssetPackEntry& e) const {
+	return { reinterpret_cast<const char*>(mFile.data() + mHeader.namesOffset + e.nameOffset), e.nameLength };
+}
+
+const AssetPackEntry* AssetPack::find(std::string_view name) const {
+	const uint64_t hash = assetNameHash(name);
+	const AssetPackEntry* end = mEntries + mHeader.entryCount;
+
+	// Equal hashes sit next to each other, the names tell them apart.
+	for (auto e = std::lower_bound(mEntries, end, hash, [](const AssetPackEntry& a, uint64_t h) { return a.nameHash < h; });
+	     e != end && e->nameHash == hash; ++e)
+		if (this->name(*e) == name)
+			return e;
+
+	return nullptr;
+}
+
+bool AssetPack::read(const AssetPackEntry& e, uint8_t* out) const {
+	if (e.compression == static_cast<uint32_t>(AssetCompression::LZ4))
+		return lz4Decompress(storedData(e), static_cast<size_t>(e.storedSize), out, static_cast<size_t>(e.size));
+
+	memcpy(out, storedData(e), static_cast<size_t>(e.size));
+	return true;
+}
+
+void AssetPack::prefetch() const {
+	mFile.prefetch(static_cast<size_t>(mHeader.namesOffset + mHeader.namesBytes), static_cast<size_t>(mHeader.dataBytes));
+}
+
+void writeAssetPack(const std::string& path, const std::vector<AssetPackInput>& inputs) {
+	const size_t count = inputs.size();
+	std::vector<std::string> names(count);
+	std::vector<uint32_t> order(count);
+
+	for (size_t i = 0; i < count; i++) {
+		names[i] = normalizeAssetName(inputs[i].name);
+
+		if (inputs[i].alignment & (inputs[i].alignment - 1))
+			throw std::runtime_error("Asset " + names[i] + " has an alignment that isn't a power of two\n");
+	}
+
+	// TOC order, by hash and then name so duplicates end up next to each other.
+	std::iota(order.begin(), order.end(), 0u);
+	std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+		const uint64_t ha = assetNameHash(names[a]), hb = assetNameHash(names[b]);
+		return ha != hb ? ha < hb : names[a] < names[b];
+	});
+
+	for (size_t i = 1; i < count; i++)
+		if (names[order[i]] == names[order[i - 1]])
+			throw std::runtime_error("Asset " + names[order[i]] + " is in the pack twice\n");
+
+	// Stored bytes of each input, compressed ones only when they pay off.
+	std::vector<std::vector<uint8_t>> stored(count);
+	std::vector<AssetPackEntry> entries(count);
+	std::vector<std::string> failed(count);
+
+	parallelFor(count, 1, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			const AssetPackInput& input = inputs[i];
+			AssetPackEntry& e = entries[i];
+			MappedFile source;
+
+			if (!source.open(input.source) && !(std::filesystem::exists(input.source) && std::filesystem::file_size(input.source) == 0)) {
+				failed[i] = input.source;
+				continue;
+			}
+
+			e.size = source.size();
+			e.alignment = input.alignment ? input.alignment : ASSET_PACK_ALIGNMENT;
+			e.compression = static_cast<uint32_t>(AssetCompression::None);
+
+			if (input.compress && source.size() >= 64) {
+				stored[i].resize(source.size() - source.size() / 8);
+
+				if (const size_t compressed = lz4Compress(source.data(), source.size(), stored[i].data(), stored[i].size())) {
+					stored[i].resize(compressed);
+					e.compression = static_cast<uint32_t>(AssetCompression::LZ4);
+				}
+			}
+
+			if (e.compression == static_cast<uint32_t>(AssetCompression::None))
+				stored[i].assign(source.data(), source.data() + source.size());
+
+			e.storedSize = stored[i].size();
+		}
+	});
+
+	for (const auto& source : failed)
+		if (!source.empty())
+			throw std::runtime_error("Failed to read asset " + source + "\n");
+
+	// Layout: header, TOC, names, then the data in TOC order.
+	AssetPackHeader header = {};
+	header.magic = ASSET_PACK_MAGIC;
+	header.version = ASSET_PACK_VERSION;
+	header.entryCount = static_cast<uint32_t>(count);
+	header.tocOffset = sizeof(AssetPackHeader);
+	header.namesOffset = header.tocOffset + count * sizeof(AssetPackEntry);
+
+	std::vector<AssetPackEntry> toc(count);
+	std::string nameData;
+
+	for (size_t i = 0; i < count; i++) {
+		toc[i] = entries[order[i]];
+		toc[i].nameHash = assetNameHash(names[order[i]]);
+		toc[i].nameOffset = static_cast<uint32_t>(nameData.size());
+		toc[i].nameLength = static_cast<uint32_t>(names[order[i]].size());
+		nameData += names[order[i]];
+	}
+
+	header.namesBytes = nameData.size();
+
+	uint64_t offset = header.namesOffset + header.namesBytes;
+
+	for (auto& e : toc) {
+		offset = alignUp(offset, e.alignment);
+		e.offset = offset;
+		offset += e.storedSize;
+	}
+
+	header.dataBytes = offset - (header.namesOffset + header.namesBytes);
+
+	const std::filesystem::path target(path);
+
+	if (target.has_parent_path())
+		std::filesystem::create_directories(target.parent_path());
+
+	const std::string temporary = path + ".tmp";
+	{
+		std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+
+		if (!out)
+			throw std::runtime_error("Failed to create asset pack " + temporary + "\n");
+
+		out.write(reinterpret_cast<const char*>(&header), sizeof header);
+		out.write(reinterpret_cast<const char*>(toc.data()), static_cast<std::streamsize>(toc.size() * sizeof(AssetPackEntry)));
+		out.write(nameData.data(), static_cast<std::streamsize>(nameData.size()));
+
+		uint64_t written = header.namesOffset + header.namesBytes;
+		const char padding[ASSET_PACK_ALIGNMENT] = {};
+
+		for (size_t i = 0; i < count; i++) {
+			// Alignments above the default pad in several writes.
+			for (; written < toc[i].offset; written += std::min<uint64_t>(toc[i].offset - written, sizeof padding))
+				out.write(padding, static_cast<std::streamsize>(std::min<uint64_t>(toc[i].offset - written, sizeof padding)));
+
+			const std::vector<uint8_t>& data = stored[order[i]];
+			out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+			written += data.size();
+		}
+
+		out.close();
+
+		if (!out) {
+			std::filesystem::remove(temporary);
+			throw std::runtime_error("Failed to write asset pack " + temporary + "\n");
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporary, target, error);
+
+	if (error) {
+		std::filesystem::remove(temporary, error);
+		throw std::runtime_error("Failed to replace asset pack " + path + "\n");
+	}
+}
+
+}
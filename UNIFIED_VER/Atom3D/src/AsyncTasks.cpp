@@ -0,0 +1,93 @@
+// ReSharper disable CppInconsistentNaming
+#include "AsyncTasks.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Atom {
+
+namespace {
+
+class AsyncPool {
+public:
+	AsyncPool() {
+		const uint32_t hardware = std::max(1u, std::thread::hardware_concurrency());
+
+		for (uint32_t i = 0; i < hardware; i++)
+			mThreads.emplace_back([this] { workerLoop(); });
+	}
+
+	~AsyncPool() {
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mStop = true;
+		}
+
+		mWake.notify_all();
+
+		for (auto& thread : mThreads)
+			thread.join();
+	}
+
+	[[nodiscard]] uint32_t threadCount() const {
+		return static_cast<uint32_t>(mThreads.size());
+	}
+
+	void push(std::function<void()> job) {
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mJobs.push_back(std::move(job));
+		}
+
+		mWake.notify_one();
+	}
+
+private:
+	void workerLoop() {
+		std::unique_lock<std::mutex> lock(mMutex);
+
+		for (;;) {
+			mWake.wait(lock, [this] { return mStop || !mJobs.empty(); });
+
+			if (mStop)
+				return;
+
+			const std::function<void()> job = std::move(mJobs.front());
+			mJobs.pop_front();
+			lock.unlock();
+
+			job();
+
+			lock.lock();
+		}
+	}
+
+	std::vector<std::thread> mThreads;
+
+	std::mutex mMutex;
+	std::condition_variable mWake;
+	std::deque<std::function<void()>> mJobs;
+	bool mStop = false;
+};
+
+AsyncPool& asyncPool() {
+	static AsyncPool pool;
+	return pool;
+}
+
+}
+
+
+void runAsync(std::function<void()> job) {
+	asyncPool().push(std::move(job));
+}
+
+uint32_t asyncThreadCount() {
+	return asyncPool().threadCount();
+}
+
+}
@@ -0,0 +1,163 @@
+// ReSharper disable CppInconsistentNaming
+#include "AtomMath.hpp"
+
+#include <cstring>
+
+// Hardware half conversion. F16C comes with every AVX2 CPU but has its own compiler flag (-mf16c),
+// MSVC has no macro for it and allows it with /arch:AVX2. AVX-512F has 16 wide versions.
+#if !defined(ATOM_MATH_SCALAR)
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define ATOM_HALF_F16C 1
+#include <immintrin.h>
+#endif
+#if defined(__AVX512F__)
+#define ATOM_HALF_AVX512 1
+#endif
+#endif
+
+namespace Atom {
+
+static uint32_t seedLo, seedHi;
+
+
+// Round to nearest even, overflow goes to infinity. NaNs are quieted and keep the top of their
+// payload, which is what the conversion instructions do, so the bulk paths match bit for bit.
+uint16_t float16_from_float32(float f) {
+	constexpr uint32_t F32_INFINITY = 255u << 23;
+	constexpr uint32_t F16_MAX = (127u + 16u) << 23;
+	constexpr uint32_t DENORM_MAGIC = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+	uint32_t u;
+	memcpy(&u, &f, sizeof u);
+
+	const uint32_t sign = u & 0x80000000u;
+	u ^= sign;
+
+	uint16_t h;
+
+	if (u >= F16_MAX) {
+		h = u > F32_INFINITY ? static_cast<uint16_t>(0x7E00 | ((u >> 13) & 0x3FF)) : 0x7C00;
+	} else if (u < (113u << 23)) {
+		// Subnormal or zero, adding the magic number lines the 10 mantissa bits up at the bottom and
+		// the FPU does the rounding.
+		float magic;
+		memcpy(&magic, &DENORM_MAGIC, sizeof magic);
+
+		float tmp;
+		memcpy(&tmp, &u, sizeof tmp);
+		tmp += magic;
+		memcpy(&u, &tmp, sizeof u);
+
+		h = static_cast<uint16_t>(u - DENORM_MAGIC);
+	} else {
+		const uint32_t mantissaOdd = (u >> 13) & 1;
+
+		u += ((15u - 127u) << 23) + 0xFFF;
+		u += mantissaOdd;
+
+		h = static_cast<uint16_t>(u >> 13);
+	}
+
+	return static_cast<uint16_t>(h | (sign >> 16));
+}
+
+
+float float32_from_float16(uint16_t h) {
+	constexpr uint32_t SHIFTED_EXP = 0x7C00u << 13;
+	constexpr uint32_t MAGIC = 113u << 23;
+
+	uint32_t u = (h & 0x7FFFu) << 13;
+	const uint32_t exp = u & SHIFTED_EXP;
+	u += (127u - 15u) << 23;
+
+	if (exp == SHIFTED_EXP) {
+		// Inf/NaN, NaNs come out quiet like they do from the conversion instructions
+		u += (128u - 16u) << 23;
+
+		if (h & 0x3FFu)
+			u |= 0x400000u;
+	} else if (exp == 0) {
+		// Zero/subnormal, renormalize
+		u += 1u << 23;
+
+		float f, magic;
+		memcpy(&f, &u, sizeof f);
+		memcpy(&magic, &MAGIC, sizeof magic);
+		f -= magic;
+		memcpy(&u, &f, sizeof u);
+	}
+
+	u |= static_cast<uint32_t>(h & 0x8000u) << 16;
+
+	float f;
+	memcpy(&f, &u, sizeof f);
+
+	return f;
+}
+
+
+void float32_from_float16(const uint16_t* src, float* dst, size_t count) {
+	size_t i = 0;
+
+#if defined(ATOM_HALF_AVX512)
+	for (; i + 16 <= count; i += 16)
+		_mm512_storeu_ps(dst + i, _mm512_cvtph_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i))));
+#endif
+#if defined(ATOM_HALF_F16C)
+	for (; i + 8 <= count; i += 8)
+		_mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))));
+#elif defined(ATOM_SIMD_NEON)
+	for (; i + 4 <= count; i += 4)
+		vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src + i))));
+#endif
+
+	for (; i < count; i++)
+		dst[i] = float32_from_float16(src[i]);
+}
+
+
+void float16_from_float32(const float* src, uint16_t* dst, size_t count) {
+	size_t i = 0;
+
+#if defined(ATOM_HALF_AVX512)
+	for (; i + 16 <= count; i += 16)
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm512_cvtps_ph(_mm512_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+#endif
+#if defined(ATOM_HALF_F16C)
+	for (; i + 8 <= count; i += 8)
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT));
+#elif defined(ATOM_SIMD_NEON)
+	for (; i + 4 <= count; i += 4)
+		vst1_u16(dst + i, vreinterpret_u16_f16(vcvt_f16_f32(vld1q_f32(src + i))));
+#endif
+
+	for (; i < count; i++)
+		dst[i] = float16_from_float32(src[i]);
+}
+
+
+float3 generate_random_vector(float min, float max) {
+	return vector_make(random_float(min, max), random_float(min, max), random_float(min, max));
+}
+
+
+void seedRand(uint32_t seed) {
+	seedLo = seed;
+	seedHi = ~seed;
+}
+
+
+int32_t randi() {
+	seedHi = (seedHi << 16) + (seedHi >> 16);
+	seedHi += seedLo;
+	seedLo += seedHi;
+
+	return static_cast<int32_t>(seedHi);
+}
+
+
+float randf(float x) {
+	return x * static_cast<float>(randi()) / static_cast<float>(0x7FFFFFFF);
+}
+
+}
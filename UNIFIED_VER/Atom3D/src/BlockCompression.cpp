@@ -0,0 +1,704 @@
+// ReSharper disable CppInconsistentNaming
+#include "BlockCompression.hpp"
+#include "AtomSimd.hpp"
+#include "ParallelFor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace Atom {
+
+using namespace Simd;
+
+namespace {
+
+// One 4x4 block, channel major so four pixels of a channel are one Simd::Vec.
+struct BlockPixels {
+	alignas(16) float c[4][16];
+};
+
+BlockPixels blockPixels(const uint8_t* rgba) {
+	BlockPixels b;
+
+	for (int i = 0; i < 16; i++)
+		for (int ch = 0; ch < 4; ch++)
+			b.c[ch][i] = rgba[i * 4 + ch];
+
+	return b;
+}
+
+// Mean and unit length principal direction of the first channels of a block.
+struct Axis {
+	float mean[4] = { 0, 0, 0, 0 };
+	float direction[4] = { 0, 0, 0, 0 };
+};
+
+Axis principalAxis(const BlockPixels& b, int channels) {
+	Axis axis;
+
+	for (int ch = 0; ch < channels; ch++) {
+		Vec s = zero();
+
+		for (int g = 0; g < 16; g += 4)
+			s = add(s, load(&b.c[ch][g]));
+
+		axis.mean[ch] = first(sum(s)) / 16;
+	}
+
+	float covariance[4][4] = {};
+
+	for (int i = 0; i < channels; i++)
+		for (int j = i; j < channels; j++) {
+			Vec s = zero();
+
+			for (int g = 0; g < 16; g += 4)
+				s = madd(sub(load(&b.c[i][g]), splat(axis.mean[i])), sub(load(&b.c[j][g]), splat(axis.mean[j])), s);
+
+			covariance[i][j] = covariance[j][i] = first(sum(s));
+		}
+
+	// Power iteration, starting from the channel that varies most.
+	int largest = 0;
+
+	for (int ch = 1; ch < channels; ch++)
+		if (covariance[ch][ch] > covariance[largest][largest])
+			largest = ch;
+
+	float v[4] = { 0, 0, 0, 0 };
+
+	for (int ch = 0; ch < channels; ch++)
+		v[ch] = covariance[largest][ch];
+
+	for (int iteration = 0; iteration < 8; iteration++) {
+		float w[4] = { 0, 0, 0, 0 }, peak = 0;
+
+		for (int i = 0; i < channels; i++) {
+			for (int j = 0; j < channels; j++)
+				w[i] += covariance[i][j] * v[j];
+
+			peak = std::max(peak, std::fabs(w[i]));
+		}
+
+		if (peak == 0)
+			return axis;
+
+		for (int i = 0; i < channels; i++)
+			v[i] = w[i] / peak;
+	}
+
+	float length = 0;
+
+	for (int ch = 0; ch < channels; ch++)
+		length += v[ch] * v[ch];
+
+	length = std::sqrt(length);
+
+	if (length > 0)
+		for (int ch = 0; ch < channels; ch++)
+			axis.direction[ch] = v[ch] / length;
+
+	return axis;
+}
+
+// Projects every pixel onto origin + t * direction, writes t to out (16 floats).
+void project(const BlockPixels& b, const float* origin, const float* direction, int channels, float scale, float* out) {
+	for (int g = 0; g < 16; g += 4) {
+		Vec t = zero();
+
+		for (int ch = 0; ch < channels; ch++)
+			t = madd(sub(load(&b.c[ch][g]), splat(origin[ch])), splat(direction[ch] * scale), t);
+
+		storeu(out + g, t);
+	}
+}
+
+// Endpoints along the principal axis through the extreme projections.
+void axisEndpoints(const BlockPixels& b, int channels, float* low, float* high) {
+	const Axis axis = principalAxis(b, channels);
+	alignas(16) float t[16];
+
+	project(b, axis.mean, axis.direction, channels, 1.0f, t);
+
+	const float tMin = *std::min_element(t, t + 16), tMax = *std::max_element(t, t + 16);
+
+	for (int ch = 0; ch < channels; ch++) {
+		low[ch] = std::clamp(axis.mean[ch] + axis.direction[ch] * tMin, 0.0f, 255.0f);
+		high[ch] = std::clamp(axis.mean[ch] + axis.direction[ch] * tMax, 0.0f, 255.0f);
+	}
+}
+
+// Least squares endpoints for fixed interpolation weights (0 = a, 1 = b). False if the weights don't
+// pin both down, every pixel on the same weight.
+bool leastSquaresEndpoints(const BlockPixels& b, int channels, const float* weights, float* a, float* bOut) {
+	float aa = 0, ab = 0, bb = 0;
+	float ax[4] = { 0, 0, 0, 0 }, bx[4] = { 0, 0, 0, 0 };
+
+	for (int i = 0; i < 16; i++) {
+		const float w = weights[i], u = 1 - w;
+		aa += u * u;
+		ab += u * w;
+		bb += w * w;
+
+		for (int ch = 0; ch < channels; ch++) {
+			ax[ch] += u * b.c[ch][i];
+			bx[ch] += w * b.c[ch][i];
+		}
+	}
+
+	const float determinant = aa * bb - ab * ab;
+
+	if (std::fabs(determinant) < 1e-6f)
+		return false;
+
+	for (int ch = 0; ch < channels; ch++) {
+		a[ch] = std::clamp((ax[ch] * bb - bx[ch] * ab) / determinant, 0.0f, 255.0f);
+		bOut[ch] = std::clamp((bx[ch] * aa - ax[ch] * ab) / determinant, 0.0f, 255.0f);
+	}
+
+	return true;
+}
+
+// Clamps to [0, high] and rounds to nearest, without the library call std::lround is.
+int roundClamped(float v, float high) {
+	return static_cast<int>(std::clamp(v, 0.0f, high) + 0.5f);
+}
+
+void writeLE16(uint8_t* out, uint32_t v) {
+	out[0] = static_cast<uint8_t>(v);
+	out[1] = static_cast<uint8_t>(v >> 8);
+}
+
+// BC1 ----------------------------------------------------------------------------------------------
+
+uint16_t to565(const float* c) {
+	const auto r = static_cast<uint32_t>(roundClamped(c[0] * 31 / 255, 31));
+	const auto g = static_cast<uint32_t>(roundClamped(c[1] * 63 / 255, 63));
+	const auto b = static_cast<uint32_t>(roundClamped(c[2] * 31 / 255, 31));
+	return static_cast<uint16_t>(r << 11 | g << 5 | b);
+}
+
+void from565(uint16_t c, int* rgb) {
+	const int r = c >> 11 & 31, g = c >> 5 & 63, b = c & 31;
+	rgb[0] = r << 3 | r >> 2;
+	rgb[1] = g << 2 | g >> 4;
+	rgb[2] = b << 3 | b >> 2;
+}
+
+// 4 color palette in index order: c0, c1, 2/3 c0 + 1/3 c1, 1/3 c0 + 2/3 c1.
+void bc1Palette(uint16_t c0, uint16_t c1, int palette[4][3]) {
+	from565(c0, palette[0]);
+	from565(c1, palette[1]);
+
+	for (int ch = 0; ch < 3; ch++) {
+		palette[2][ch] = (2 * palette[0][ch] + palette[1][ch]) / 3;
+		palette[3][ch] = (palette[0][ch] + 2 * palette[1][ch]) / 3;
+	}
+}
+
+// Indices for endpoints c0/c1, returns the squared error.
+float fitBC1(const BlockPixels& b, uint16_t c0, uint16_t c1, uint8_t* indices) {
+	int palette[4][3];
+	bc1Palette(c0, c1, palette);
+
+	const float origin[3] = { static_cast<float>(palette[0][0]), static_cast<float>(palette[0][1]), static_cast<float>(palette[0][2]) };
+	const float direction[3] = { static_cast<float>(palette[1][0] - palette[0][0]), static_cast<float>(palette[1][1] - palette[0][1]), static_cast<float>(palette[1][2] - palette[0][2]) };
+	const float length2 = direction[0] * direction[0] + direction[1] * direction[1] + direction[2] * direction[2];
+
+	alignas(16) float t[16];
+	project(b, origin, direction, 3, length2 > 0 ? 3 / length2 : 0.0f, t);
+
+	// Position along c0 -> c1 in thirds to index.
+	static const uint8_t order[4] = { 0, 2, 3, 1 };
+	float error = 0;
+
+	for (int i = 0; i < 16; i++) {
+		const uint8_t index = order[roundClamped(t[i], 3)];
+		indices[i] = index;
+
+		for (int ch = 0; ch < 3; ch++) {
+			const float d = b.c[ch][i] - palette[index][ch];
+			error += d * d;
+		}
+	}
+
+	return error;
+}
+
+void encodeBC1Color(const BlockPixels& b, uint8_t* out) {
+	float low[3], high[3];
+	axisEndpoints(b, 3, low, high);
+
+	uint16_t c0 = to565(high), c1 = to565(low);
+	uint8_t indices[16];
+	float error = fitBC1(b, c0, c1, indices);
+
+	// Refit the endpoints to the pixels' weights, keep it if it helps.
+	static const float weights[4] = { 0.0f, 1.0f, 1.0f / 3, 2.0f / 3 };
+	float w[16], a[3], bEnd[3];
+
+	for (int i = 0; i < 16; i++)
+		w[i] = weights[indices[i]];
+
+	if (leastSquaresEndpoints(b, 3, w, a, bEnd)) {
+		const uint16_t r0 = to565(a), r1 = to565(bEnd);
+		uint8_t refined[16];
+		const float refinedError = fitBC1(b, r0, r1, refined);
+
+		if (refinedError < error) {
+			c0 = r0;
+			c1 = r1;
+			error = refinedError;
+			memcpy(indices, refined, sizeof indices);
+		}
+	}
+
+	// c0 > c1 selects the 4 color mode. Equal endpoints only need index 0.
+	if (c0 < c1) {
+		std::swap(c0, c1);
+
+		// Swaps 0 with 1 and 2 with 3.
+		for (auto& index : indices)
+			index ^= 1;
+	} else if (c0 == c1) {
+		memset(indices, 0, sizeof indices);
+	}
+
+	uint32_t bits = 0;
+
+	for (int i = 0; i < 16; i++)
+		bits |= static_cast<uint32_t>(indices[i]) << (2 * i);
+
+	writeLE16(out, c0);
+	writeLE16(out + 2, c1);
+	writeLE16(out + 4, bits & 0xFFFF);
+	writeLE16(out + 6, bits >> 16);
+}
+
+void decodeBC1Color(const uint8_t* block, uint8_t* rgba, bool alwaysFourColors) {
+	const uint16_t c0 = static_cast<uint16_t>(block[0] | block[1] << 8);
+	const uint16_t c1 = static_cast<uint16_t>(block[2] | block[3] << 8);
+	const uint32_t bits = block[4] | block[5] << 8 | block[6] << 16 | static_cast<uint32_t>(block[7]) << 24;
+
+	int palette[4][3];
+	bc1Palette(c0, c1, palette);
+	int alpha[4] = { 255, 255, 255, 255 };
+
+	if (c0 <= c1 && !alwaysFourColors) {
+		for (int ch = 0; ch < 3; ch++) {
+			palette[2][ch] = (palette[0][ch] + palette[1][ch]) / 2;
+			palette[3][ch] = 0;
+		}
+
+		alpha[3] = 0;
+	}
+
+	for (int i = 0; i < 16; i++) {
+		const uint32_t index = bits >> (2 * i) & 3;
+
+		for (int ch = 0; ch < 3; ch++)
+			rgba[i * 4 + ch] = static_cast<uint8_t>(palette[index][ch]);
+
+		rgba[i * 4 + 3] = static_cast<uint8_t>(alpha[index]);
+	}
+}
+
+// BC4 ----------------------------------------------------------------------------------------------
+
+// 8 value mode between the channel's min and max, index k of the 8 steps from max to min maps to
+// 0 (max), 2..7, 1 (min).
+void encodeBC4(const float* values, uint8_t* out) {
+	const float lowest = *std::min_element(values, values + 16), highest = *std::max_element(values, values + 16);
+	const int a0 = roundClamped(highest, 255), a1 = roundClamped(lowest, 255);
+
+	out[0] = static_cast<uint8_t>(a0);
+	out[1] = static_cast<uint8_t>(a1);
+
+	uint64_t bits = 0;
+
+	if (a0 != a1) {
+		const float scale = 7.0f / (a0 - a1);
+
+		for (int i = 0; i < 16; i++) {
+			const int k = roundClamped((a0 - values[i]) * scale, 7);
+			const uint64_t index = k == 0 ? 0 : k == 7 ? 1 : k + 1;
+			bits |= index << (3 * i);
+		}
+	}
+
+	for (int i = 0; i < 6; i++)
+		out[2 + i] = static_cast<uint8_t>(bits >> (8 * i));
+}
+
+void decodeBC4(const uint8_t* block, uint8_t* out, int stride) {
+	const int a0 = block[0], a1 = block[1];
+	int palette[8] = { a0, a1 };
+
+	if (a0 > a1) {
+		for (int k = 1; k < 7; k++)
+			palette[k + 1] = ((7 - k) * a0 + k * a1) / 7;
+	} else {
+		for (int k = 1; k < 5; k++)
+			palette[k + 1] = ((5 - k) * a0 + k * a1) / 5;
+
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+
+	uint64_t bits = 0;
+
+	for (int i = 0; i < 6; i++)
+		bits |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+
+	for (int i = 0; i < 16; i++)
+		out[i * stride] = static_cast<uint8_t>(palette[bits >> (3 * i) & 7]);
+}
+
+// BC7 mode 6 ---------------------------------------------------------------------------------------
+
+constexpr int BC7_WEIGHTS[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// 7 bit endpoint plus a p-bit shared by its channels, 8 bits in total. Picks the p-bit that lands
+// closest to e.
+struct BC7Endpoint {
+	int value[4]; // (q << 1) | p
+	int q[4];
+	int p;
+};
+
+BC7Endpoint quantizeBC7(const float* e) {
+	BC7Endpoint best = {};
+	float bestError = 1e30f;
+
+	for (int p = 0; p < 2; p++) {
+		BC7Endpoint candidate = {};
+		candidate.p = p;
+		float error = 0;
+
+		for (int ch = 0; ch < 4; ch++) {
+			candidate.q[ch] = roundClamped((e[ch] - p) / 2, 127);
+			candidate.value[ch] = candidate.q[ch] << 1 | p;
+			error += (candidate.value[ch] - e[ch]) * (candidate.value[ch] - e[ch]);
+		}
+
+		if (error < bestError) {
+			bestError = error;
+			best = candidate;
+		}
+	}
+
+	return best;
+}
+
+float fitBC7(const BlockPixels& b, const BC7Endpoint& e0, const BC7Endpoint& e1, uint8_t* indices) {
+	int palette[16][4];
+
+	for (int k = 0; k < 16; k++)
+		for (int ch = 0; ch < 4; ch++)
+			palette[k][ch] = ((64 - BC7_WEIGHTS[k]) * e0.value[ch] + BC7_WEIGHTS[k] * e1.value[ch] + 32) >> 6;
+
+	float origin[4], direction[4], length2 = 0;
+
+	for (int ch = 0; ch < 4; ch++) {
+		origin[ch] = static_cast<float>(e0.value[ch]);
+		direction[ch] = static_cast<float>(e1.value[ch] - e0.value[ch]);
+		length2 += direction[ch] * direction[ch];
+	}
+
+	alignas(16) float t[16];
+	project(b, origin, direction, 4, length2 > 0 ? 15 / length2 : 0.0f, t);
+
+	// The weights aren't evenly spaced, so the rounded projection and its neighbours compete.
+	float error = 0;
+
+	for (int i = 0; i < 16; i++) {
+		const int guess = roundClamped(t[i], 15);
+		float best = 1e30f;
+
+		for (int k = std::max(guess - 1, 0); k <= std::min(guess + 1, 15); k++) {
+			float e = 0;
+
+			for (int ch = 0; ch < 4; ch++) {
+				const float d = b.c[ch][i] - palette[k][ch];
+				e += d * d;
+			}
+
+			if (e < best) {
+				best = e;
+				indices[i] = static_cast<uint8_t>(k);
+			}
+		}
+
+		error += best;
+	}
+
+	return error;
+}
+
+// LSB first bit packing of a 128 bit block.
+class BitWriter {
+public:
+	explicit BitWriter(uint8_t* out) : mOut(out) {
+		memset(mOut, 0, 16);
+	}
+
+	void put(uint32_t value, int bits) {
+		for (int i = 0; i < bits; i++, mPosition++)
+			mOut[mPosition >> 3] |= static_cast<uint8_t>((value >> i & 1) << (mPosition & 7));
+	}
+
+private:
+	uint8_t* mOut;
+	int mPosition = 0;
+};
+
+class BitReader {
+public:
+	explicit BitReader(const uint8_t* in) : mIn(in) {}
+
+	uint32_t get(int bits) {
+		uint32_t value = 0;
+
+		for (int i = 0; i < bits; i++, mPosition++)
+			value |= static_cast<uint32_t>(mIn[mPosition >> 3] >> (mPosition & 7) & 1) << i;
+
+		return value;
+	}
+
+private:
+	const uint8_t* mIn;
+	int mPosition = 0;
+};
+
+void encodeBC7Block(const BlockPixels& b, uint8_t* out) {
+	float low[4], high[4];
+	axisEndpoints(b, 4, low, high);
+
+	BC7Endpoint e0 = quantizeBC7(low), e1 = quantizeBC7(high);
+	uint8_t indices[16];
+	float error = fitBC7(b, e0, e1, indices);
+
+	float w[16], a[4], bEnd[4];
+
+	for (int i = 0; i < 16; i++)
+		w[i] = BC7_WEIGHTS[indices[i]] / 64.0f;
+
+	if (leastSquaresEndpoints(b, 4, w, a, bEnd)) {
+		const BC7Endpoint r0 = quantizeBC7(a), r1 = quantizeBC7(bEnd);
+		uint8_t refined[16];
+		const float refinedError = fitBC7(b, r0, r1, refined);
+
+		if (refinedError < error) {
+			e0 = r0;
+			e1 = r1;
+			memcpy(indices, refined, sizeof indices);
+		}
+	}
+
+	// The first pixel's index is stored with 3 bits, its top bit has to be 0.
+	if (indices[0] >= 8) {
+		std::swap(e0, e1);
+
+		for (auto& index : indices)
+			index = static_cast<uint8_t>(15 - index);
+	}
+
+	BitWriter bits(out);
+	bits.put(1 << 6, 7); // Mode 6
+
+	for (int ch = 0; ch < 4; ch++) {
+		bits.put(static_cast<uint32_t>(e0.q[ch]), 7);
+		bits.put(static_cast<uint32_t>(e1.q[ch]), 7);
+	}
+
+	bits.put(static_cast<uint32_t>(e0.p), 1);
+	bits.put(static_cast<uint32_t>(e1.p), 1);
+
+	for (int i = 0; i < 16; i++)
+		bits.put(indices[i], i == 0 ? 3 : 4);
+}
+
+bool decodeBC7Block(const uint8_t* block, uint8_t* rgba) {
+	BitReader bits(block);
+
+	if (bits.get(7) != 1 << 6)
+		return false;
+
+	int e0[4], e1[4];
+
+	for (int ch = 0; ch < 4; ch++) {
+		e0[ch] = static_cast<int>(bits.get(7)) << 1;
+		e1[ch] = static_cast<int>(bits.get(7)) << 1;
+	}
+
+	const int p0 = static_cast<int>(bits.get(1)), p1 = static_cast<int>(bits.get(1));
+
+	for (int ch = 0; ch < 4; ch++) {
+		e0[ch] |= p0;
+		e1[ch] |= p1;
+	}
+
+	for (int i = 0; i < 16; i++) {
+		const int w = BC7_WEIGHTS[bits.get(i == 0 ? 3 : 4)];
+
+		for (int ch = 0; ch < 4; ch++)
+			rgba[i * 4 + ch] = static_cast<uint8_t>(((64 - w) * e0[ch] + w * e1[ch] + 32) >> 6);
+	}
+
+	return true;
+}
+
+}
+
+
+const char* textureFormatName(TextureFormat format) {
+	switch (format) {
+		case TextureFormat::RGBA8: return "RGBA8";
+		case TextureFormat::BC1: return "BC1";
+		case TextureFormat::BC3: return "BC3";
+		case TextureFormat::BC5: return "BC5";
+		case TextureFormat::BC7: return "BC7";
+	}
+
+	return "unknown";
+}
+
+void encodeBC1(const uint8_t* rgba, uint8_t* out) {
+	encodeBC1Color(blockPixels(rgba), out);
+}
+
+void encodeBC3(const uint8_t* rgba, uint8_t* out) {
+	const BlockPixels b = blockPixels(rgba);
+	encodeBC4(b.c[3], out);
+	encodeBC1Color(b, out + 8);
+}
+
+void encodeBC5(const uint8_t* rgba, uint8_t* out) {
+	const BlockPixels b = blockPixels(rgba);
+	encodeBC4(b.c[0], out);
+	encodeBC4(b.c[1], out + 8);
+}
+
+void encodeBC7(const uint8_t* rgba, uint8_t* out) {
+	encodeBC7Block(blockPixels(rgba), out);
+}
+
+bool decodeBlock(TextureFormat format, const uint8_t* block, uint8_t* rgba) {
+	switch (format) {
+		case TextureFormat::RGBA8:
+			memcpy(rgba, block, 64);
+			return true;
+		case TextureFormat::BC1:
+			decodeBC1Color(block, rgba, false);
+			return true;
+		case TextureFormat::BC3:
+			decodeBC1Color(block + 8, rgba, true);
+			decodeBC4(block, rgba + 3, 4);
+			return true;
+		case TextureFormat::BC5:
+			decodeBC4(block, rgba, 4);
+			decodeBC4(block + 8, rgba + 1, 4);
+
+			for (int i = 0; i < 16; i++) {
+				rgba[i * 4 + 2] = 0;
+				rgba[i * 4 + 3] = 255;
+			}
+
+			return true;
+		case TextureFormat::BC7:
+			return decodeBC7Block(block, rgba);
+	}
+
+	return false;
+}
+
+void compressImage(const uint8_t* rgba, uint32_t width, uint32_t height, TextureFormat format, uint8_t* out) {
+	if (format == TextureFormat::RGBA8) {
+		memcpy(out, rgba, textureLevelBytes(format, width, height));
+		return;
+	}
+
+	const uint32_t blocksWide = (width + 3) / 4, blocksHigh = (height + 3) / 4;
+	const size_t rowBytes = textureRowBytes(format, width);
+
+	void (*encode)(const uint8_t*, uint8_t*) = format == TextureFormat::BC1 ? encodeBC1 : format == TextureFormat::BC3 ? encodeBC3 : format == TextureFormat::BC5 ? encodeBC5 : encodeBC7;
+
+	parallelFor(blocksHigh, 4, [&](size_t begin, size_t end) {
+		uint8_t block[64];
+
+		for (size_t by = begin; by < end; by++)
+			for (uint32_t bx = 0; bx < blocksWide; bx++) {
+				for (uint32_t i = 0; i < 16; i++) {
+					const uint32_t x = std::min(bx * 4 + i % 4, width - 1);
+					const uint32_t y = std::min(static_cast<uint32_t>(by) * 4 + i / 4, height - 1);
+					memcpy(block + i * 4, rgba + (static_cast<size_t>(y) * width + x) * 4, 4);
+				}
+
+				encode(block, out + by * rowBytes + bx * blockBytes(format));
+			}
+	});
+}
+
+void decompressImage(const uint8_t* data, uint32_t width, uint32_t height, TextureFormat format, uint8_t* rgba) {
+	if (format == TextureFormat::RGBA8) {
+		memcpy(rgba, data, textureLevelBytes(format, width, height));
+		return;
+	}
+
+	const uint32_t blocksWide = (width + 3) / 4, blocksHigh = (height + 3) / 4;
+	const size_t rowBytes = textureRowBytes(format, width);
+	uint8_t block[64];
+
+	for (uint32_t by = 0; by < blocksHigh; by++)
+		for (uint32_t bx = 0; bx < blocksWide; bx++) {
+			if (!decodeBlock(format, data + by * rowBytes + bx * blockBytes(format), block))
+				memset(block, 0, sizeof block);
+
+			for (uint32_t i = 0; i < 16; i++) {
+				const uint32_t x = bx * 4 + i % 4, y = by * 4 + i / 4;
+
+				if (x < width && y < height)
+					memcpy(rgba + (static_cast<size_t>(y) * width + x) * 4, block + i * 4, 4);
+			}
+		}
+}
+
+TextureImage compressMipChain(const MipChain& chain, TextureFormat format, bool srgb) {
+	TextureImage image;
+	image.format = format;
+	image.srgb = srgb;
+
+	size_t bytes = 0;
+
+	for (const auto& level : chain.levels) {
+		image.levels.push_back({ level.width, level.height, bytes, textureLevelBytes(format, level.width, level.height) });
+		bytes += image.levels.back().bytes;
+	}
+
+	image.data.resize(bytes);
+
+	for (size_t i = 0; i < chain.levels.size(); i++)
+		compressImage(chain.level(i), chain.levels[i].width, chain.levels[i].height, format, image.data.data() + image.levels[i].offset);
+
+	return image;
+}
+
+TextureImage compressMipChains(const std::vector<MipChain>& layers, TextureFormat format, bool srgb) {
+	TextureImage image = compressMipChain(layers.at(0), format, srgb);
+	const size_t layerBytes = image.data.size();
+	image.layers = static_cast<uint32_t>(layers.size());
+
+	for (size_t i = 1; i < layers.size(); i++) {
+		const TextureImage layer = compressMipChain(layers[i], format, srgb);
+
+		if (layer.data.size() != layerBytes)
+			throw std::invalid_argument("Array texture layers differ in size\n");
+
+		image.data.insert(image.data.end(), layer.data.begin(), layer.data.end());
+	}
+
+	return image;
+}
+
+}
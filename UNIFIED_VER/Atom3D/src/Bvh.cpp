@@ -0,0 +1,593 @@
+// ReSharper disable CppInconsistentNaming
+#include "Bvh.hpp"
+#include "ParallelFor.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+
+namespace Atom {
+
+namespace {
+
+constexpr uint32_t BINS = 16;
+constexpr uint32_t MAX_LEAF = 8;
+// Deeper nodes split at the median, which keeps the tree under 64 levels (the traversal stacks)
+// for anything up to 2^31 objects.
+constexpr uint32_t MAX_SAH_DEPTH = 32;
+// Ranges this big bin over parallelFor.
+constexpr size_t PARALLEL_BINNING = 1 << 16;
+// Centroid spread below which an axis can't be binned, BINS / extent would overflow.
+constexpr float MIN_EXTENT = FLT_MIN * BINS;
+// Parent of the root, and the first of a sibling pair nobody uses.
+constexpr uint32_t NO_NODE = UINT32_MAX;
+
+struct Bin {
+	Bounds bounds = emptyBounds();
+	uint32_t count = 0;
+};
+
+// Objects are sorted as copies of their bounds, the splits then read memory in order.
+struct Item {
+	Bounds bounds;
+	uint32_t object;
+};
+
+struct Task {
+	uint32_t node;
+	uint32_t first;
+	uint32_t count;
+	uint32_t depth;
+};
+
+// Nodes of a build, the root first. Interior nodes' first are indices into the same arrays.
+struct NodeArrays {
+	std::vector<BvhNode> nodes;
+	std::vector<uint32_t> parents;
+	std::vector<float> area;
+};
+
+void grow(Bounds& b, const Bounds& other) {
+	b.min = Simd::toFloat3(Simd::min(Simd::load(b.min), Simd::load(other.min)));
+	b.max = Simd::toFloat3(Simd::max(Simd::load(b.max), Simd::load(other.max)));
+}
+
+void grow(Bounds& b, const float3& point) {
+	b.min = Simd::toFloat3(Simd::min(Simd::load(b.min), Simd::load(point)));
+	b.max = Simd::toFloat3(Simd::max(Simd::load(b.max), Simd::load(point)));
+}
+
+float area(const Bounds& b) {
+	const float dx = b.max.x - b.min.x, dy = b.max.y - b.min.y, dz = b.max.z - b.min.z;
+	return dx < 0.0f ? 0.0f : 2.0f * (dx * dy + dy * dz + dz * dx);
+}
+
+float3 centroid(const Bounds& b) {
+	return Simd::toFloat3(Simd::mul(Simd::add(Simd::load(b.min), Simd::load(b.max)), Simd::splat(0.5f)));
+}
+
+BvhNode makeNode(const Bounds& b, uint32_t first, uint32_t count) {
+	return { b.min.x, b.min.y, b.min.z, first, b.max.x, b.max.y, b.max.z, count };
+}
+
+Bounds nodeBounds(const BvhNode& n) {
+	return { { n.minX, n.minY, n.minZ }, { n.maxX, n.maxY, n.maxZ } };
+}
+
+// Runs body(begin, end) over [first, first + count), on the workers for big ranges.
+template<typename F>
+void forRange(uint32_t first, uint32_t count, F&& body) {
+	if (count < PARALLEL_BINNING)
+		body(first, first + count);
+	else
+		parallelFor(count, PARALLEL_BINNING / 4, [&](size_t begin, size_t end) { body(first + static_cast<uint32_t>(begin), first + static_cast<uint32_t>(end)); });
+}
+
+class Builder {
+public:
+	// Builds over indices[first, first + count), which writeIndices() reorders to the leaves.
+	Builder(const std::vector<Bounds>& bounds, std::vector<uint32_t>& indices, uint32_t first, uint32_t count)
+		: mIndices(indices), mFirst(first), mItems(count) {
+		for (uint32_t i = 0; i < count; i++)
+			mItems[i] = { bounds[indices[first + i]], indices[first + i] };
+	}
+
+	void writeIndices() const {
+		for (size_t i = 0; i < mItems.size(); i++)
+			mIndices[mFirst + i] = mItems[i].object;
+	}
+
+	// Makes the task's node a leaf, or an interior node with two new children queued. task is a copy,
+	// queue grows under it.
+	void split(const Task task, NodeArrays& out, std::vector<Task>& queue) {
+		Bounds box = emptyBounds(), centroidBox = emptyBounds();
+		std::mutex mutex;
+
+		forRange(task.first, task.count, [&](uint32_t begin, uint32_t end) {
+			Bounds localBox = emptyBounds(), localCentroids = emptyBounds();
+
+			for (uint32_t i = begin; i < end; i++) {
+				grow(localBox, item(i).bounds);
+				grow(localCentroids, centroid(item(i).bounds));
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+			grow(box, localBox);
+			grow(centroidBox, localCentroids);
+		});
+
+		out.nodes[task.node] = makeNode(box, task.first, task.count);
+		out.area[task.node] = area(box);
+
+		if (task.count <= 2)
+			return;
+
+		int axis = -1;
+		uint32_t splitBin = 0;
+		float splitCost = FLT_MAX;
+
+		if (task.depth < MAX_SAH_DEPTH)
+			findSplit(task, centroidBox, axis, splitBin, splitCost);
+
+		uint32_t middle;
+
+		if (axis >= 0) {
+			// Leaf unless splitting is cheaper, traversal costs as much as one object test.
+			if (task.count <= MAX_LEAF && splitCost / area(box) + 1.0f >= static_cast<float>(task.count))
+				return;
+
+			const float minimum = centroidBox.min[axis], scale = BINS / (centroidBox.max[axis] - centroidBox.min[axis]);
+			Item* begin = &item(task.first);
+			middle = task.first + static_cast<uint32_t>(std::partition(begin, begin + task.count, [&](const Item& i) {
+				return std::min(BINS - 1, static_cast<uint32_t>((centroid(i.bounds)[axis] - minimum) * scale)) < splitBin;
+			}) - begin);
+		} else {
+			if (task.count <= MAX_LEAF)
+				return;
+
+			// All centroids in one place, or too deep: halves along the longest axis.
+			const float3 extent = centroidBox.max - centroidBox.min;
+			const int longest = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+			Item* begin = &item(task.first);
+			middle = task.first + task.count / 2;
+			std::nth_element(begin, begin + task.count / 2, begin + task.count, [&](const Item& a, const Item& b) {
+				return a.bounds.min[longest] + a.bounds.max[longest] < b.bounds.min[longest] + b.bounds.max[longest];
+			});
+		}
+
+		const auto left = static_cast<uint32_t>(out.nodes.size());
+		out.nodes.resize(left + 2);
+		out.parents.resize(left + 2, task.node);
+		out.area.resize(left + 2);
+		out.nodes[task.node] = makeNode(box, left, 0);
+
+		queue.push_back({ left, task.first, middle - task.first, task.depth + 1 });
+		queue.push_back({ left + 1, middle, task.first + task.count - middle, task.depth + 1 });
+	}
+
+private:
+	// Cheapest bin boundary over all three axes, axis -1 if the centroids don't spread.
+	void findSplit(const Task& task, const Bounds& centroidBox, int& axis, uint32_t& splitBin, float& splitCost) const {
+		Bin bins[3][BINS];
+		std::mutex mutex;
+
+		forRange(task.first, task.count, [&](uint32_t begin, uint32_t end) {
+			Bin local[3][BINS];
+
+			// Axes that can't be binned count everything into bin 0, never picked below.
+			float scale[3];
+			for (int a = 0; a < 3; a++) {
+				const float extent = centroidBox.max[a] - centroidBox.min[a];
+				scale[a] = extent <= MIN_EXTENT ? 0.0f : BINS / extent;
+			}
+
+			for (uint32_t i = begin; i < end; i++) {
+				const Bounds& b = item(i).bounds;
+				const float3 c = centroid(b);
+
+				for (int a = 0; a < 3; a++) {
+					Bin& bin = local[a][std::min(BINS - 1, static_cast<uint32_t>((c[a] - centroidBox.min[a]) * scale[a]))];
+					grow(bin.bounds, b);
+					bin.count++;
+				}
+			}
+
+			std::lock_guard<std::mutex> lock(mutex);
+			for (int a = 0; a < 3; a++)
+				for (uint32_t b = 0; b < BINS; b++) {
+					grow(bins[a][b].bounds, local[a][b].bounds);
+					bins[a][b].count += local[a][b].count;
+				}
+		});
+
+		for (int a = 0; a < 3; a++) {
+			if (centroidBox.max[a] - centroidBox.min[a] <= MIN_EXTENT)
+				continue;
+
+			// Area and count left of every boundary, then sweep from the right.
+			float leftArea[BINS];
+			uint32_t leftCount[BINS];
+			Bounds running = emptyBounds();
+			uint32_t count = 0;
+
+			for (uint32_t b = 0; b < BINS - 1; b++) {
+				grow(running, bins[a][b].bounds);
+				count += bins[a][b].count;
+				leftArea[b + 1] = area(running);
+				leftCount[b + 1] = count;
+			}
+
+			running = emptyBounds();
+			count = 0;
+
+			for (uint32_t b = BINS - 1; b > 0; b--) {
+				grow(running, bins[a][b].bounds);
+				count += bins[a][b].count;
+
+				if (count == 0 || leftCount[b] == 0)
+					continue;
+
+				const float cost = leftArea[b] * static_cast<float>(leftCount[b]) + area(running) * static_cast<float>(count);
+
+				if (cost < splitCost) {
+					splitCost = cost;
+					axis = a;
+					splitBin = b;
+				}
+			}
+		}
+	}
+
+	Item& item(uint32_t i) { return mItems[i - mFirst]; }
+	const Item& item(uint32_t i) const { return mItems[i - mFirst]; }
+
+	std::vector<uint32_t>& mIndices;
+	uint32_t mFirst;
+	std::vector<Item> mItems;
+};
+
+// Everything below root into its own arrays, breadth first.
+NodeArrays buildLocal(Builder& builder, const Task& root) {
+	NodeArrays out;
+	out.nodes.resize(1);
+	out.parents.push_back(NO_NODE);
+	out.area.resize(1);
+
+	std::vector<Task> queue = { { 0, root.first, root.count, root.depth } };
+
+	for (size_t head = 0; head < queue.size(); head++)
+		builder.split(queue[head], out, queue);
+
+	return out;
+}
+
+}
+
+void Bvh::clear() {
+	mNodes.clear();
+	mIndices.clear();
+	mObjectBounds.clear();
+	mParents.clear();
+	mLeafOf.clear();
+	mBuiltArea.clear();
+	mFreePairs.clear();
+}
+
+void Bvh::build(const Bounds* bounds, size_t count) {
+	clear();
+
+	if (count == 0)
+		return;
+
+	mObjectBounds.assign(bounds, bounds + count);
+	mIndices.resize(count);
+	for (uint32_t i = 0; i < count; i++)
+		mIndices[i] = i;
+
+	Builder builder(mObjectBounds, mIndices, 0, static_cast<uint32_t>(count));
+
+	// The top levels here, binning big nodes over parallelFor, until there are enough subtrees
+	// to keep every worker busy. Those are built in parallel and appended after.
+	const uint32_t threads = parallelThreadCount();
+	const size_t subtreeObjects = threads == 1 ? count : std::max<size_t>(count / (threads * 16), 1024);
+
+	NodeArrays top;
+	top.nodes.resize(1);
+	top.parents.push_back(NO_NODE);
+	top.area.resize(1);
+
+	std::vector<Task> queue = { { 0, 0, static_cast<uint32_t>(count), 0 } }, subtrees;
+
+	for (size_t head = 0; head < queue.size(); head++) {
+		if (queue[head].count <= subtreeObjects)
+			subtrees.push_back(queue[head]);
+		else
+			builder.split(queue[head], top, queue);
+	}
+
+	std::vector<NodeArrays> built(subtrees.size());
+	parallelFor(subtrees.size(), 1, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++)
+			built[i] = buildLocal(builder, subtrees[i]);
+	});
+
+	builder.writeIndices();
+	mNodes = std::move(top.nodes);
+	mParents = std::move(top.parents);
+	mBuiltArea = std::move(top.area);
+
+	// A subtree's root replaces the node it was built for, the rest goes at the end.
+	for (size_t s = 0; s < subtrees.size(); s++) {
+		const NodeArrays& local = built[s];
+		const uint32_t root = subtrees[s].node, base = static_cast<uint32_t>(mNodes.size()) - 1;
+		const auto map = [&](uint32_t i) { return i == 0 ? root : base + i; };
+
+		for (uint32_t i = 0; i < local.nodes.size(); i++) {
+			BvhNode node = local.nodes[i];
+			if (node.count == 0)
+				node.first = map(node.first);
+
+			if (i == 0) {
+				mNodes[root] = node;
+				mBuiltArea[root] = local.area[0];
+			} else {
+				mNodes.push_back(node);
+				mParents.push_back(map(local.parents[i]));
+				mBuiltArea.push_back(local.area[i]);
+			}
+		}
+	}
+
+	mLeafOf.resize(count);
+	setLeafMap(0, mNodes.size());
+}
+
+// Leaf of the objects under nodes [first, first + count) that are leaves.
+void Bvh::setLeafMap(uint32_t first, size_t count) {
+	for (size_t n = first; n < first + count; n++)
+		if (mNodes[n].count)
+			for (uint32_t i = mNodes[n].first; i < mNodes[n].first + mNodes[n].count; i++)
+				mLeafOf[mIndices[i]] = static_cast<uint32_t>(n);
+}
+
+void Bvh::refitLeaf(uint32_t node) {
+	BvhNode& n = mNodes[node];
+	Bounds box = emptyBounds();
+
+	for (uint32_t i = n.first; i < n.first + n.count; i++)
+		grow(box, mObjectBounds[mIndices[i]]);
+
+	n = makeNode(box, n.first, n.count);
+}
+
+void Bvh::refitInterior(uint32_t node) {
+	BvhNode& n = mNodes[node];
+	Bounds box = nodeBounds(mNodes[n.first]);
+	grow(box, nodeBounds(mNodes[n.first + 1]));
+
+	n = makeNode(box, n.first, 0);
+}
+
+void Bvh::refit(const Bounds* bounds) {
+	mObjectBounds.assign(bounds, bounds + mObjectBounds.size());
+
+	// Children always come after their parents.
+	for (size_t i = mNodes.size(); i-- > 0;) {
+		if (mNodes[i].count)
+			refitLeaf(static_cast<uint32_t>(i));
+		else if (mNodes[i].first != NO_NODE)
+			refitInterior(static_cast<uint32_t>(i));
+	}
+}
+
+void Bvh::refit(const Bounds* bounds, const uint32_t* moved, size_t movedCount) {
+	for (size_t m = 0; m < movedCount; m++) {
+		mObjectBounds[moved[m]] = bounds[moved[m]];
+		uint32_t node = mLeafOf[moved[m]];
+		refitLeaf(node);
+
+		// Up until a node comes out the same, everything above it is then too.
+		while (mParents[node] != NO_NODE) {
+			node = mParents[node];
+			const BvhNode before = mNodes[node];
+			refitInterior(node);
+
+			if (std::memcmp(&before, &mNodes[node], sizeof before) == 0)
+				break;
+		}
+	}
+}
+
+float Bvh::nodeArea(uint32_t node) const {
+	return area(nodeBounds(mNodes[node]));
+}
+
+size_t Bvh::rebuildDegraded(const Bounds* bounds, float maxGrowth) {
+	if (mNodes.empty())
+		return 0;
+
+	mObjectBounds.assign(bounds, bounds + mObjectBounds.size());
+
+	if (nodeArea(0) > maxGrowth * mBuiltArea[0]) {
+		const size_t count = mObjectBounds.size();
+		std::vector<Bounds> copy = std::move(mObjectBounds);
+		build(copy.data(), count);
+		return count;
+	}
+
+	size_t rebuilt = 0;
+	std::vector<uint32_t> stack = { 0 };
+
+	while (!stack.empty()) {
+		const uint32_t node = stack.back();
+		stack.pop_back();
+
+		if (mNodes[node].count)
+			continue;
+
+		if (nodeArea(node) <= maxGrowth * mBuiltArea[node]) {
+			stack.push_back(mNodes[node].first);
+			stack.push_back(mNodes[node].first + 1);
+			continue;
+		}
+
+		// Its objects are one range, from its leftmost leaf to its rightmost.
+		uint32_t leftmost = node, rightmost = node;
+		while (!mNodes[leftmost].count)
+			leftmost = mNodes[leftmost].first;
+		while (!mNodes[rightmost].count)
+			rightmost = mNodes[rightmost].first + 1;
+
+		const uint32_t first = mNodes[leftmost].first, count = mNodes[rightmost].first + mNodes[rightmost].count - first;
+		rebuildSubtree(node, first, count);
+		rebuilt += count;
+	}
+
+	return rebuilt;
+}
+
+void Bvh::rebuildSubtree(uint32_t root, uint32_t first, uint32_t count) {
+	// Sibling pairs the old subtree used, plus free ones after root, lowest first. The new nodes are
+	// breadth first, so giving them out in order keeps children after their parents.
+	std::vector<uint32_t> slots, stack = { root };
+
+	while (!stack.empty()) {
+		const BvhNode& n = mNodes[stack.back()];
+		stack.pop_back();
+
+		if (n.count == 0) {
+			slots.push_back(n.first);
+			stack.push_back(n.first);
+			stack.push_back(n.first + 1);
+		}
+	}
+
+	const auto firstFree = std::partition(mFreePairs.begin(), mFreePairs.end(), [root](uint32_t pair) { return pair < root; });
+	slots.insert(slots.end(), firstFree, mFreePairs.end());
+	mFreePairs.erase(firstFree, mFreePairs.end());
+	std::sort(slots.begin(), slots.end());
+
+	// Its real depth, MAX_SAH_DEPTH counts from the tree's root or the traversal stacks could overflow.
+	uint32_t depth = 0;
+	for (uint32_t node = root; mParents[node] != NO_NODE; node = mParents[node])
+		depth++;
+
+	Builder builder(mObjectBounds, mIndices, first, count);
+	const NodeArrays local = buildLocal(builder, { 0, first, count, depth });
+	builder.writeIndices();
+
+	// Local pair j (nodes 2j + 1 and 2j + 2) goes to the j-th slot, or the end once they run out.
+	std::vector<uint32_t> map(local.nodes.size());
+	map[0] = root;
+
+	for (uint32_t j = 0; 2 * j + 1 < local.nodes.size(); j++) {
+		uint32_t pair;
+
+		if (j < slots.size()) {
+			pair = slots[j];
+		} else {
+			pair = static_cast<uint32_t>(mNodes.size());
+			mNodes.resize(pair + 2);
+			mParents.resize(pair + 2);
+			mBuiltArea.resize(pair + 2);
+		}
+
+		map[2 * j + 1] = pair;
+		map[2 * j + 2] = pair + 1;
+	}
+
+	for (uint32_t i = 0; i < local.nodes.size(); i++) {
+		BvhNode node = local.nodes[i];
+		if (node.count == 0)
+			node.first = map[node.first];
+
+		mNodes[map[i]] = node;
+		mBuiltArea[map[i]] = local.area[i];
+
+		if (i > 0) {
+			mParents[map[i]] = map[local.parents[i]];
+
+			if (node.count)
+				for (uint32_t o = node.first; o < node.first + node.count; o++)
+					mLeafOf[mIndices[o]] = map[i];
+		}
+	}
+
+	if (local.nodes[0].count)
+		for (uint32_t o = first; o < first + count; o++)
+			mLeafOf[mIndices[o]] = root;
+
+	// Unused pairs become interior nodes without children, skipped by refit and never reached.
+	const size_t used = (local.nodes.size() - 1) / 2;
+	for (size_t j = used; j < slots.size(); j++) {
+		mNodes[slots[j]] = makeNode(emptyBounds(), NO_NODE, 0);
+		mNodes[slots[j] + 1] = makeNode(emptyBounds(), NO_NODE, 0);
+		mFreePairs.push_back(slots[j]);
+	}
+}
+
+void Bvh::query(const Bounds& box, std::vector<uint32_t>& objects) const {
+	if (mNodes.empty())
+		return;
+
+	const auto overlaps = [&box](const BvhNode& n) {
+		return n.minX <= box.max.x && n.maxX >= box.min.x && n.minY <= box.max.y && n.maxY >= box.min.y && n.minZ <= box.max.z && n.maxZ >= box.min.z;
+	};
+
+	uint32_t stack[64];
+	uint32_t size = 0;
+
+	if (overlaps(mNodes[0]))
+		stack[size++] = 0;
+
+	while (size) {
+		const BvhNode& n = mNodes[stack[--size]];
+
+		if (n.count) {
+			for (uint32_t i = n.first; i < n.first + n.count; i++) {
+				const Bounds& b = mObjectBounds[mIndices[i]];
+
+				if (b.min.x <= box.max.x && b.max.x >= box.min.x && b.min.y <= box.max.y && b.max.y >= box.min.y && b.min.z <= box.max.z && b.max.z >= box.min.z)
+					objects.push_back(mIndices[i]);
+			}
+		} else {
+			if (overlaps(mNodes[n.first]))
+				stack[size++] = n.first;
+			if (overlaps(mNodes[n.first + 1]))
+				stack[size++] = n.first + 1;
+		}
+	}
+}
+
+uint32_t Bvh::raycast(const Ray& ray, float& t) const {
+	const float3 invDirection = { 1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z };
+
+	return raycast(ray, t, [&](uint32_t object, const Ray& r, float tMax) {
+		return intersectBox(mObjectBounds[object], r.origin, invDirection, tMax);
+	});
+}
+
+float Bvh::sahCost() const {
+	if (mNodes.empty())
+		return 0.0f;
+
+	float cost = 0.0f;
+	std::vector<uint32_t> stack = { 0 };
+
+	while (!stack.empty()) {
+		const BvhNode& n = mNodes[stack.back()];
+		stack.pop_back();
+
+		if (n.count) {
+			cost += area(nodeBounds(n)) * static_cast<float>(n.count);
+		} else {
+			cost += area(nodeBounds(n));
+			stack.push_back(n.first);
+			stack.push_back(n.first + 1);
+		}
+	}
+
+	return cost / nodeArea(0);
+}
+
+}
@@ -0,0 +1,105 @@
+// ReSharper disable CppInconsistentNaming
+#include "CookedMesh.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace Atom {
+
+static uint64_t alignUp(uint64_t value, uint64_t alignment) {
+	return (value + alignment - 1) & ~(alignment - 1);
+}
+
+bool CookedMesh::open(const std::string& path) {
+	close();
+
+	if (!mFile.open(path))
+		return false;
+
+	if (mFile.size() < sizeof(CookedMeshHeader)) {
+		close();
+		return false;
+	}
+
+	const auto& h = header();
+	const uint64_t size = mFile.size();
+	const uint64_t indexSize = h.indexFormat == static_cast<uint32_t>(IndexFormat::UInt16) ? 2 : 4;
+
+	const bool valid = h.magic == COOKED_MESH_MAGIC && h.version == COOKED_MESH_VERSION &&
+	                   h.vertexStride == sizeof(PackedVertex) &&
+	                   h.vertexBytes == static_cast<uint64_t>(h.vertexCount) * sizeof(PackedVertex) &&
+	                   h.indexBytes == static_cast<uint64_t>(h.indexCount) * indexSize &&
+	                   h.vertexOffset <= size && h.vertexBytes <= size - h.vertexOffset &&
+	                   h.indexOffset <= size && h.indexBytes <= size - h.indexOffset;
+
+	if (!valid) {
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+void CookedMesh::close() {
+	mFile.close();
+}
+
+void writeCookedMesh(const std::string& path, const IndexedMesh<MeshVertex>& mesh, UVFormat uvFormat, uint64_t sourceSize, int64_t sourceTime) {
+	CookedMeshHeader header = {};
+	header.magic = COOKED_MESH_MAGIC;
+	header.version = COOKED_MESH_VERSION;
+	header.sourceSize = sourceSize;
+	header.sourceTime = sourceTime;
+	header.vertexCount = static_cast<uint32_t>(mesh.vertices.size());
+	header.vertexStride = sizeof(PackedVertex);
+	header.indexCount = mesh.indexCount;
+	header.indexFormat = static_cast<uint32_t>(mesh.indexFormat);
+	header.vertexOffset = alignUp(sizeof(CookedMeshHeader), COOKED_MESH_ALIGNMENT);
+	header.vertexBytes = mesh.vertices.size() * sizeof(PackedVertex);
+	header.indexOffset = alignUp(header.vertexOffset + header.vertexBytes, COOKED_MESH_ALIGNMENT);
+	header.indexBytes = mesh.indexBytes();
+
+	// Header, padding and both blobs assembled in memory, then one write.
+	std::vector<uint8_t> file(static_cast<size_t>(header.indexOffset + header.indexBytes), 0);
+	auto* vertices = reinterpret_cast<PackedVertex*>(file.data() + header.vertexOffset);
+
+	header.quantization = packVertices(mesh.vertices.data(), mesh.vertices.size(), uvFormat, vertices);
+	memcpy(file.data(), &header, sizeof header);
+
+	if (header.indexBytes)
+		memcpy(file.data() + header.indexOffset, mesh.indexData.data(), static_cast<size_t>(header.indexBytes));
+
+	const std::filesystem::path target(path);
+
+	if (target.has_parent_path())
+		std::filesystem::create_directories(target.parent_path());
+
+	const std::string temporary = path + ".tmp";
+	{
+		std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+
+		if (!out)
+			throw std::runtime_error("Failed to create cooked mesh " + temporary + "\n");
+
+		out.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+		out.close();
+
+		if (!out) {
+			std::filesystem::remove(temporary);
+			throw std::runtime_error("Failed to write cooked mesh " + temporary + "\n");
+		}
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporary, target, error);
+
+	if (error) {
+		std::filesystem::remove(temporary, error);
+		throw std::runtime_error("Failed to replace cooked mesh " + path + "\n");
+	}
+}
+
+}
@@ -0,0 +1,216 @@
+// ReSharper disable CppInconsistentNaming
+#include "DdsTexture.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+namespace Atom {
+
+namespace {
+
+constexpr uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+constexpr uint32_t FOURCC_DX10 = 0x30315844;
+constexpr uint32_t FOURCC_DXT1 = 0x31545844;
+constexpr uint32_t FOURCC_DXT5 = 0x35545844;
+constexpr uint32_t FOURCC_ATI2 = 0x32495441;
+
+constexpr uint32_t DDSD_CAPS = 0x1, DDSD_HEIGHT = 0x2, DDSD_WIDTH = 0x4, DDSD_PITCH = 0x8;
+constexpr uint32_t DDSD_PIXELFORMAT = 0x1000, DDSD_MIPMAPCOUNT = 0x20000, DDSD_LINEARSIZE = 0x80000;
+constexpr uint32_t DDPF_FOURCC = 0x4;
+constexpr uint32_t DDSCAPS_COMPLEX = 0x8, DDSCAPS_TEXTURE = 0x1000, DDSCAPS_MIPMAP = 0x400000;
+constexpr uint32_t D3D10_RESOURCE_DIMENSION_TEXTURE2D = 3;
+
+struct DdsPixelFormat {
+	uint32_t size;
+	uint32_t flags;
+	uint32_t fourCC;
+	uint32_t rgbBitCount;
+	uint32_t masks[4];
+};
+
+struct DdsHeader {
+	uint32_t magic;
+	uint32_t size;
+	uint32_t flags;
+	uint32_t height;
+	uint32_t width;
+	uint32_t pitchOrLinearSize;
+	uint32_t depth;
+	uint32_t mipMapCount;
+	uint32_t reserved1[11];
+	DdsPixelFormat pixelFormat;
+	uint32_t caps[4];
+	uint32_t reserved2;
+};
+
+struct DdsHeaderDX10 {
+	uint32_t dxgiFormat;
+	uint32_t resourceDimension;
+	uint32_t miscFlag;
+	uint32_t arraySize;
+	uint32_t miscFlags2;
+};
+
+static_assert(sizeof(DdsHeader) == 128 && sizeof(DdsHeaderDX10) == 20, "DDS layout");
+
+// DXGI_FORMAT values, UNORM and UNORM_SRGB of each.
+struct DxgiFormat {
+	TextureFormat format;
+	uint32_t linear;
+	uint32_t srgb;
+};
+
+constexpr DxgiFormat DXGI_FORMATS[] = {
+	{ TextureFormat::RGBA8, 28, 29 },
+	{ TextureFormat::BC1, 71, 72 },
+	{ TextureFormat::BC3, 77, 78 },
+	{ TextureFormat::BC5, 83, 83 },
+	{ TextureFormat::BC7, 98, 99 }
+};
+
+}
+
+
+bool DdsTexture::open(const std::string& path) {
+	close();
+
+	if (!mFile.open(path) || !parse(mFile.data(), mFile.size())) {
+		close();
+		return false;
+	}
+
+	return true;
+}
+
+bool DdsTexture::parse(const uint8_t* data, size_t size) {
+	// Nothing carries over from a file parsed before, the legacy FourCCs never set mSrgb.
+	mData = nullptr;
+	mLevels.clear();
+	mFormat = TextureFormat::RGBA8;
+	mSrgb = false;
+	mLayers = 1;
+	mLayerBytes = 0;
+
+	if (size < sizeof(DdsHeader))
+		return false;
+
+	DdsHeader header;
+	memcpy(&header, data, sizeof header);
+
+	if (header.magic != DDS_MAGIC || header.size != 124 || !(header.pixelFormat.flags & DDPF_FOURCC) || header.width == 0 || header.height == 0)
+		return false;
+
+	size_t offset = sizeof(DdsHeader);
+	uint32_t layers = 1;
+	bool known = true;
+
+	if (header.pixelFormat.fourCC == FOURCC_DX10) {
+		if (size < offset + sizeof(DdsHeaderDX10))
+			return false;
+
+		DdsHeaderDX10 dx10;
+		memcpy(&dx10, data + offset, sizeof dx10);
+		offset += sizeof dx10;
+
+		if (dx10.resourceDimension != D3D10_RESOURCE_DIMENSION_TEXTURE2D || dx10.miscFlag != 0)
+			return false;
+
+		layers = std::max(dx10.arraySize, 1u);
+
+		known = false;
+
+		for (const auto& f : DXGI_FORMATS)
+			if (dx10.dxgiFormat == f.linear || dx10.dxgiFormat == f.srgb) {
+				mFormat = f.format;
+				mSrgb = dx10.dxgiFormat == f.srgb && f.srgb != f.linear;
+				known = true;
+			}
+	} else if (header.pixelFormat.fourCC == FOURCC_DXT1) {
+		mFormat = TextureFormat::BC1;
+	} else if (header.pixelFormat.fourCC == FOURCC_DXT5) {
+		mFormat = TextureFormat::BC3;
+	} else if (header.pixelFormat.fourCC == FOURCC_ATI2) {
+		mFormat = TextureFormat::BC5;
+	} else {
+		known = false;
+	}
+
+	if (!known)
+		return false;
+
+	const uint32_t levels = (header.flags & DDSD_MIPMAPCOUNT) && header.mipMapCount > 0 ? header.mipMapCount : 1;
+
+	if (levels > mipLevelCount(header.width, header.height))
+		return false;
+
+	const size_t start = offset;
+
+	for (uint32_t i = 0, w = header.width, h = header.height; i < levels; i++, w = std::max(1u, w / 2), h = std::max(1u, h / 2)) {
+		const size_t bytes = textureLevelBytes(mFormat, w, h);
+		mLevels.push_back({ w, h, offset, bytes });
+		offset += bytes;
+	}
+
+	// Layers repeat the whole chain.
+	mLayerBytes = offset - start;
+
+	if (mLayerBytes > (size - start) / layers) {
+		mLevels.clear();
+		return false;
+	}
+
+	mLayers = layers;
+	mData = data;
+	return true;
+}
+
+void DdsTexture::close() {
+	mFile.close();
+	mData = nullptr;
+	mLevels.clear();
+}
+
+void writeDds(const std::string& path, const TextureImage& image) {
+	const TextureLevel& top = image.levels.at(0);
+
+	DdsHeader header = {};
+	header.magic = DDS_MAGIC;
+	header.size = 124;
+	header.flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT |
+	               (isBlockCompressed(image.format) ? DDSD_LINEARSIZE : DDSD_PITCH);
+	header.height = top.height;
+	header.width = top.width;
+	header.pitchOrLinearSize = static_cast<uint32_t>(isBlockCompressed(image.format) ? top.bytes : textureRowBytes(image.format, top.width));
+	header.depth = 1;
+	header.mipMapCount = static_cast<uint32_t>(image.levels.size());
+	header.pixelFormat.size = 32;
+	header.pixelFormat.flags = DDPF_FOURCC;
+	header.pixelFormat.fourCC = FOURCC_DX10;
+	header.caps[0] = DDSCAPS_TEXTURE | (image.levels.size() > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+
+	DdsHeaderDX10 dx10 = {};
+	dx10.resourceDimension = D3D10_RESOURCE_DIMENSION_TEXTURE2D;
+	dx10.arraySize = image.layers;
+
+	for (const auto& f : DXGI_FORMATS)
+		if (f.format == image.format)
+			dx10.dxgiFormat = image.srgb ? f.srgb : f.linear;
+
+	const std::filesystem::path target(path);
+
+	if (target.has_parent_path())
+		std::filesystem::create_directories(target.parent_path());
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(&header), sizeof header);
+	file.write(reinterpret_cast<const char*>(&dx10), sizeof dx10);
+	file.write(reinterpret_cast<const char*>(image.data.data()), static_cast<std::streamsize>(image.data.size()));
+
+	if (!file)
+		throw std::runtime_error("Could not write texture " + path + "\n");
+}
+
+}
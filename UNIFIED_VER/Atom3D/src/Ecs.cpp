@@ -0,0 +1,381 @@
+// ReSharper disable CppInconsistentNaming
+#include "Ecs.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+
+namespace Atom {
+
+namespace {
+
+// Every array in a chunk starts on a cache line.
+constexpr size_t ARRAY_ALIGNMENT = 64;
+
+// Entries are written before their id is handed out and never change, so reads don't lock.
+std::mutex gComponentMutex;
+std::array<ComponentInfo, MAX_COMPONENTS> gComponents;
+uint32_t gComponentCount = 0;
+
+size_t alignUp(size_t value, size_t alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+uint8_t* allocateChunk(size_t bytes) {
+	return static_cast<uint8_t*>(::operator new(bytes, std::align_val_t(ARRAY_ALIGNMENT)));
+}
+
+void freeChunk(uint8_t* data) {
+	::operator delete(data, std::align_val_t(ARRAY_ALIGNMENT));
+}
+
+}
+
+ComponentId registerComponent(size_t size, size_t alignment) {
+	std::lock_guard<std::mutex> lock(gComponentMutex);
+
+	if (gComponentCount == MAX_COMPONENTS)
+		throw std::length_error("More than 64 component types\n");
+
+	gComponents[gComponentCount] = { size, alignment };
+	return gComponentCount++;
+}
+
+const ComponentInfo& componentInfo(ComponentId id) {
+	return gComponents[id];
+}
+
+Archetype::Archetype(ComponentMask mask) : mMask(mask) {
+	mAddEdges.fill(UINT32_MAX);
+	mRemoveEdges.fill(UINT32_MAX);
+
+	size_t rowBytes = sizeof(Entity);
+
+	for (ComponentId id = 0; id < MAX_COMPONENTS; id++)
+		if (mask & (ComponentMask(1) << id)) {
+			mComponents.push_back(id);
+			rowBytes += componentInfo(id).size;
+		}
+
+	// As many rows as fit once every array is padded to its alignment, at least one.
+	const auto layout = [&](uint32_t capacity) {
+		size_t offset = alignUp(sizeof(Entity) * capacity, ARRAY_ALIGNMENT);
+
+		for (const ComponentId id : mComponents) {
+			const ComponentInfo& info = componentInfo(id);
+			offset = alignUp(offset, std::max(info.alignment, ARRAY_ALIGNMENT));
+			mOffsets[id] = static_cast<uint32_t>(offset);
+			offset += alignUp(info.size * capacity, ARRAY_ALIGNMENT);
+		}
+
+		return offset;
+	};
+
+	mCapacity = static_cast<uint32_t>(std::max<size_t>(ECS_CHUNK_BYTES / rowBytes, 1));
+	while (mCapacity > 1 && layout(mCapacity) > ECS_CHUNK_BYTES)
+		mCapacity--;
+
+	mChunkBytes = std::max(layout(mCapacity), ECS_CHUNK_BYTES);
+}
+
+Archetype::~Archetype() {
+	for (const auto& chunk : mChunks)
+		freeChunk(chunk.data);
+
+	if (mSpare)
+		freeChunk(mSpare);
+}
+
+void Archetype::push(Entity entity, uint32_t& chunk, uint32_t& row) {
+	if (mChunks.empty() || mChunks.back().count == mCapacity) {
+		uint8_t* data = mSpare ? mSpare : allocateChunk(mChunkBytes);
+		mSpare = nullptr;
+		mChunks.push_back({ data, 0 });
+	}
+
+	Chunk& last = mChunks.back();
+	chunk = static_cast<uint32_t>(mChunks.size() - 1);
+	row = last.count++;
+	entities(last)[row] = entity;
+	mSize++;
+}
+
+Entity Archetype::erase(uint32_t chunk, uint32_t row) {
+	Chunk& last = mChunks.back();
+	const uint32_t lastRow = last.count - 1;
+	Entity moved = NULL_ENTITY;
+
+	if (chunk != mChunks.size() - 1 || row != lastRow) {
+		const Chunk& target = mChunks[chunk];
+		moved = entities(last)[lastRow];
+		entities(target)[row] = moved;
+
+		for (const ComponentId id : mComponents) {
+			const size_t size = componentInfo(id).size;
+			std::memcpy(static_cast<uint8_t*>(array(target, id)) + row * size, static_cast<uint8_t*>(array(last, id)) + lastRow * size, size);
+		}
+	}
+
+	mSize--;
+
+	if (--last.count == 0) {
+		if (mSpare)
+			freeChunk(mSpare);
+		mSpare = last.data;
+		mChunks.pop_back();
+	}
+
+	return moved;
+}
+
+World::World() {
+	// Archetype 0 has no components, create() puts entities there.
+	archetypeFor(0);
+}
+
+uint32_t World::archetypeFor(ComponentMask mask) {
+	const auto it = mArchetypeIndex.find(mask);
+	if (it != mArchetypeIndex.end())
+		return it->second;
+
+	const auto index = static_cast<uint32_t>(mArchetypes.size());
+	mArchetypes.push_back(std::make_unique<Archetype>(mask));
+	mArchetypeIndex.emplace(mask, index);
+	return index;
+}
+
+Entity World::create() {
+	return create(ComponentMask(0));
+}
+
+Entity World::create(ComponentMask mask) {
+	assert(mIterating == 0 && "Record structural changes in an EntityCommandBuffer during queries");
+
+	uint32_t index;
+	if (!mFreeRecords.empty()) {
+		index = mFreeRecords.back();
+		mFreeRecords.pop_back();
+	} else {
+		index = static_cast<uint32_t>(mRecords.size());
+		mRecords.push_back({ 0, 0, 0, 0 });
+	}
+
+	Record& record = mRecords[index];
+	record.archetype = archetypeFor(mask);
+	const Entity entity = { index, record.generation };
+
+	Archetype& archetype = *mArchetypes[record.archetype];
+	archetype.push(entity, record.chunk, record.row);
+
+	// Zeroed until the caller sets them.
+	for (const ComponentId id : archetype.components()) {
+		const size_t size = componentInfo(id).size;
+		std::memset(static_cast<uint8_t*>(archetype.array(archetype.chunks()[record.chunk], id)) + record.row * size, 0, size);
+	}
+
+	mSize++;
+	return entity;
+}
+
+bool World::alive(Entity entity) const {
+	return entity.index < mRecords.size() && mRecords[entity.index].generation == entity.generation && mRecords[entity.index].archetype != UINT32_MAX;
+}
+
+void World::erase(const Record& record) {
+	const Entity moved = mArchetypes[record.archetype]->erase(record.chunk, record.row);
+
+	if (moved != NULL_ENTITY) {
+		mRecords[moved.index].chunk = record.chunk;
+		mRecords[moved.index].row = record.row;
+	}
+}
+
+void World::destroy(Entity entity) {
+	assert(mIterating == 0 && "Record structural changes in an EntityCommandBuffer during queries");
+
+	if (!alive(entity))
+		return;
+
+	Record& record = mRecords[entity.index];
+	erase(record);
+
+	record.archetype = UINT32_MAX;
+	record.generation++;
+	mFreeRecords.push_back(entity.index);
+	mSize--;
+}
+
+void World::clear() {
+	assert(mIterating == 0 && "Record structural changes in an EntityCommandBuffer during queries");
+
+	for (const auto& archetype : mArchetypes) {
+		for (auto& chunk : archetype->chunks())
+			for (uint32_t row = 0; row < chunk.count; row++) {
+				Record& record = mRecords[archetype->entities(chunk)[row].index];
+				record.archetype = UINT32_MAX;
+				record.generation++;
+				mFreeRecords.push_back(archetype->entities(chunk)[row].index);
+			}
+
+		while (!archetype->chunks().empty())
+			archetype->erase(static_cast<uint32_t>(archetype->chunks().size() - 1), archetype->chunks().back().count - 1);
+	}
+
+	mSize = 0;
+}
+
+void World::move(Entity entity, uint32_t to) {
+	Record& record = mRecords[entity.index];
+	const Record from = record;
+	Archetype& source = *mArchetypes[from.archetype];
+	Archetype& target = *mArchetypes[to];
+
+	target.push(entity, record.chunk, record.row);
+	record.archetype = to;
+
+	const Archetype::Chunk& sourceChunk = source.chunks()[from.chunk];
+	const Archetype::Chunk& targetChunk = target.chunks()[record.chunk];
+
+	for (const ComponentId id : target.components())
+		if (source.mask() & (ComponentMask(1) << id)) {
+			const size_t size = componentInfo(id).size;
+			std::memcpy(static_cast<uint8_t*>(target.array(targetChunk, id)) + record.row * size, static_cast<uint8_t*>(source.array(sourceChunk, id)) + from.row * size, size);
+		}
+
+	erase(from);
+}
+
+void World::addComponent(Entity entity, ComponentId id, const void* data) {
+	assert(mIterating == 0 && "Record structural changes in an EntityCommandBuffer during queries");
+
+	if (!alive(entity))
+		return;
+
+	const uint32_t from = mRecords[entity.index].archetype;
+
+	if (!(mArchetypes[from]->mask() & (ComponentMask(1) << id))) {
+		uint32_t to = mArchetypes[from]->mAddEdges[id];
+
+		if (to == UINT32_MAX) {
+			to = archetypeFor(mArchetypes[from]->mask() | (ComponentMask(1) << id));
+			mArchetypes[from]->mAddEdges[id] = to;
+			mArchetypes[to]->mRemoveEdges[id] = from;
+		}
+
+		move(entity, to);
+	}
+
+	std::memcpy(component(entity, id), data, componentInfo(id).size);
+}
+
+void World::removeComponent(Entity entity, ComponentId id) {
+	assert(mIterating == 0 && "Record structural changes in an EntityCommandBuffer during queries");
+
+	if (!alive(entity))
+		return;
+
+	const uint32_t from = mRecords[entity.index].archetype;
+
+	if (!(mArchetypes[from]->mask() & (ComponentMask(1) << id)))
+		return;
+
+	uint32_t to = mArchetypes[from]->mRemoveEdges[id];
+
+	if (to == UINT32_MAX) {
+		to = archetypeFor(mArchetypes[from]->mask() & ~(ComponentMask(1) << id));
+		mArchetypes[from]->mRemoveEdges[id] = to;
+		mArchetypes[to]->mAddEdges[id] = from;
+	}
+
+	move(entity, to);
+}
+
+void* World::component(Entity entity, ComponentId id) {
+	if (!alive(entity))
+		return nullptr;
+
+	const Record& record = mRecords[entity.index];
+	const Archetype& archetype = *mArchetypes[record.archetype];
+
+	if (!(archetype.mask() & (ComponentMask(1) << id)))
+		return nullptr;
+
+	return static_cast<uint8_t*>(archetype.array(archetype.chunks()[record.chunk], id)) + record.row * componentInfo(id).size;
+}
+
+// Placeholders are the create's number with a generation no real entity reaches.
+static constexpr uint32_t PENDING_GENERATION = UINT32_MAX;
+
+Entity EntityCommandBuffer::create() {
+	const Entity entity = { mCreated++, PENDING_GENERATION };
+	mCommands.push_back({ Op::Create, 0, entity, 0 });
+	return entity;
+}
+
+void EntityCommandBuffer::destroy(Entity entity) {
+	record(Op::Destroy, entity, 0, nullptr, 0);
+}
+
+void EntityCommandBuffer::record(Op op, Entity entity, ComponentId component, const void* data, size_t size) {
+	mCommands.push_back({ op, component, entity, mData.size() });
+
+	if (size) {
+		const auto* bytes = static_cast<const uint8_t*>(data);
+		mData.insert(mData.end(), bytes, bytes + size);
+	}
+}
+
+void EntityCommandBuffer::apply(World& world) {
+	std::vector<Entity> created(mCreated);
+
+	const auto resolve = [&](Entity entity) {
+		return entity.generation == PENDING_GENERATION ? created[entity.index] : entity;
+	};
+
+	for (size_t i = 0; i < mCommands.size(); i++) {
+		const Command& command = mCommands[i];
+
+		switch (command.op) {
+			case Op::Create: {
+				// The adds right after it pick the archetype, then fill their components in place.
+				size_t end = i + 1;
+				ComponentMask mask = 0;
+
+				while (end < mCommands.size() && mCommands[end].op == Op::Add && mCommands[end].entity == command.entity) {
+					mask |= ComponentMask(1) << mCommands[end].component;
+					end++;
+				}
+
+				const Entity entity = world.create(mask);
+				created[command.entity.index] = entity;
+
+				for (size_t j = i + 1; j < end; j++)
+					std::memcpy(world.component(entity, mCommands[j].component), mData.data() + mCommands[j].data, componentInfo(mCommands[j].component).size);
+
+				i = end - 1;
+				break;
+			}
+			case Op::Destroy:
+				world.destroy(resolve(command.entity));
+				break;
+			case Op::Add:
+				world.addComponent(resolve(command.entity), command.component, mData.data() + command.data);
+				break;
+			case Op::Remove:
+				world.removeComponent(resolve(command.entity), command.component);
+				break;
+		}
+	}
+
+	clear();
+}
+
+void EntityCommandBuffer::clear() {
+	mCommands.clear();
+	mData.clear();
+	mCreated = 0;
+}
+
+}
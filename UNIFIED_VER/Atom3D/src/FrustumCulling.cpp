@@ -0,0 +1,422 @@
+// ReSharper disable CppInconsistentNaming
+#include "FrustumCulling.hpp"
+#include "ParallelFor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Same widths as TransformBatch: AVX-512 builds (-mavx512f, /arch:AVX512) test 16 objects per step,
+// AVX2 builds 8, everything else one at a time.
+#if defined(ATOM_SIMD_AVX2) && defined(__AVX512F__)
+#define ATOM_CULL_AVX512 1
+#endif
+
+namespace Atom {
+
+Frustum extractFrustum(const float4x4& viewProj) {
+	// Rows of the matrix, clip = (row0 . p, row1 . p, row2 . p, row3 . p).
+	float4 row[4];
+	for (int r = 0; r < 4; r++)
+		row[r] = { viewProj.columns[0][r], viewProj.columns[1][r], viewProj.columns[2][r], viewProj.columns[3][r] };
+
+	Frustum f = { {
+		row[3] + row[0], row[3] - row[0],
+		row[3] + row[1], row[3] - row[1],
+		row[2], row[3] - row[2]
+	} };
+
+	for (auto& plane : f.planes) {
+		const float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+		plane = plane * (length > 0.0f ? 1.0f / length : 0.0f);
+	}
+
+	return f;
+}
+
+Bounds transformBounds(const Bounds& local, const float4x4& m) {
+	const float3 center = (local.min + local.max) * 0.5f, extent = (local.max - local.min) * 0.5f;
+	float3 worldCenter, worldExtent;
+
+	for (int r = 0; r < 3; r++) {
+		worldCenter[r] = m.columns[0][r] * center.x + m.columns[1][r] * center.y + m.columns[2][r] * center.z + m.columns[3][r];
+		worldExtent[r] = std::fabs(m.columns[0][r]) * extent.x + std::fabs(m.columns[1][r]) * extent.y + std::fabs(m.columns[2][r]) * extent.z;
+	}
+
+	return { worldCenter - worldExtent, worldCenter + worldExtent };
+}
+
+void CullBoxesSoA::resize(size_t count) {
+	for (auto* stream : { &centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ })
+		stream->resize(count, 0.0f);
+}
+
+void CullBoxesSoA::set(size_t i, const Bounds& b) {
+	centerX[i] = (b.min.x + b.max.x) * 0.5f;
+	centerY[i] = (b.min.y + b.max.y) * 0.5f;
+	centerZ[i] = (b.min.z + b.max.z) * 0.5f;
+	extentX[i] = (b.max.x - b.min.x) * 0.5f;
+	extentY[i] = (b.max.y - b.min.y) * 0.5f;
+	extentZ[i] = (b.max.z - b.min.z) * 0.5f;
+}
+
+size_t CullBoxesSoA::push(const Bounds& b) {
+	const size_t i = size();
+	resize(i + 1);
+	set(i, b);
+
+	return i;
+}
+
+void CullSpheresSoA::resize(size_t count) {
+	for (auto* stream : { &centerX, &centerY, &centerZ, &radius })
+		stream->resize(count, 0.0f);
+}
+
+void CullSpheresSoA::set(size_t i, const float3& center, float r) {
+	centerX[i] = center.x;
+	centerY[i] = center.y;
+	centerZ[i] = center.z;
+	radius[i] = r;
+}
+
+size_t CullSpheresSoA::push(const float3& center, float r) {
+	const size_t i = size();
+	resize(i + 1);
+	set(i, center, r);
+
+	return i;
+}
+
+namespace {
+
+// Objects per parallelFor block, every kernel width divides it. Each block packs its visible
+// indices at its own offset in the output, the blocks' lists are moved together after.
+constexpr size_t BLOCK = 4096;
+// Below this many blocks per chunk waking the workers costs more than it saves.
+constexpr size_t MIN_BLOCKS_PER_CHUNK = 8;
+
+float planeDistance(const float4& plane, float x, float y, float z) {
+	return plane.x * x + plane.y * y + plane.z * z + plane.w;
+}
+
+// Signed distance of the box's farthest corner in front of the plane.
+float boxDistance(const float4& plane, float cx, float cy, float cz, float ex, float ey, float ez) {
+	return planeDistance(plane, cx, cy, cz) + std::fabs(plane.x) * ex + std::fabs(plane.y) * ey + std::fabs(plane.z) * ez;
+}
+
+bool boxVisible(const Frustum& f, const CullBoxesSoA& b, size_t i) {
+	for (const auto& plane : f.planes)
+		if (boxDistance(plane, b.centerX[i], b.centerY[i], b.centerZ[i], b.extentX[i], b.extentY[i], b.extentZ[i]) < 0.0f)
+			return false;
+
+	return true;
+}
+
+bool sphereVisible(const Frustum& f, const CullSpheresSoA& s, size_t i) {
+	for (const auto& plane : f.planes)
+		if (planeDistance(plane, s.centerX[i], s.centerY[i], s.centerZ[i]) + s.radius[i] < 0.0f)
+			return false;
+
+	return true;
+}
+
+#if defined(ATOM_SIMD_AVX2)
+
+// For every 8 bit mask the set lanes' numbers packed to the front, 4 bits each, and how many there are.
+struct CompressTable {
+	uint32_t lanes[256];
+	uint8_t count[256];
+
+	constexpr CompressTable() : lanes(), count() {
+		for (uint32_t mask = 0; mask < 256; mask++)
+			for (uint32_t lane = 0; lane < 8; lane++)
+				if (mask >> lane & 1)
+					lanes[mask] |= lane << (4 * count[mask]++);
+	}
+};
+
+constexpr CompressTable COMPRESS;
+
+struct Lanes8 {
+	using V = __m256;
+	static constexpr size_t WIDTH = 8;
+
+	static V load(const float* p) { return _mm256_loadu_ps(p); }
+	static V splat(float f) { return _mm256_set1_ps(f); }
+	static V add(V a, V b) { return _mm256_add_ps(a, b); }
+	static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+	static V min(V a, V b) { return _mm256_min_ps(a, b); }
+
+	// a * b + c
+	static V madd(V a, V b, V c) {
+#if defined(ATOM_SIMD_FMA)
+		return _mm256_fmadd_ps(a, b, c);
+#else
+		return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+	}
+
+	// Writes base + lane for the lanes of distance >= 0 to out, returns how many. Always stores 8
+	// indices, the ones past the count are overwritten by the next step or never read.
+	static size_t compress(V distance, uint32_t base, uint32_t* out) {
+		const auto mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ)));
+		const __m256i lanes = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32(static_cast<int>(COMPRESS.lanes[mask])), _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28)), _mm256_set1_epi32(7));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_add_epi32(lanes, _mm256_set1_epi32(static_cast<int>(base))));
+
+		return COMPRESS.count[mask];
+	}
+};
+
+#endif
+
+#if defined(ATOM_CULL_AVX512)
+
+struct Lanes16 {
+	using V = __m512;
+	static constexpr size_t WIDTH = 16;
+
+	static V load(const float* p) { return _mm512_loadu_ps(p); }
+	static V splat(float f) { return _mm512_set1_ps(f); }
+	static V add(V a, V b) { return _mm512_add_ps(a, b); }
+	static V mul(V a, V b) { return _mm512_mul_ps(a, b); }
+	static V min(V a, V b) { return _mm512_min_ps(a, b); }
+	static V madd(V a, V b, V c) { return _mm512_fmadd_ps(a, b, c); }
+
+	// Only writes the visible lanes' indices.
+	static size_t compress(V distance, uint32_t base, uint32_t* out) {
+		const __mmask16 mask = _mm512_cmp_ps_mask(distance, _mm512_setzero_ps(), _CMP_GE_OQ);
+		const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+		_mm512_mask_compressstoreu_epi32(out, mask, _mm512_add_epi32(lanes, _mm512_set1_epi32(static_cast<int>(base))));
+
+		return COMPRESS.count[mask & 0xFF] + COMPRESS.count[mask >> 8];
+	}
+};
+
+#endif
+
+#if defined(ATOM_SIMD_AVX2)
+
+// The planes splatted, |normal| for the box extents.
+template<typename L>
+struct Planes {
+	typename L::V x[6], y[6], z[6], w[6], absX[6], absY[6], absZ[6];
+
+	explicit Planes(const Frustum& f) {
+		for (int p = 0; p < 6; p++) {
+			x[p] = L::splat(f.planes[p].x);
+			y[p] = L::splat(f.planes[p].y);
+			z[p] = L::splat(f.planes[p].z);
+			w[p] = L::splat(f.planes[p].w);
+			absX[p] = L::splat(std::fabs(f.planes[p].x));
+			absY[p] = L::splat(std::fabs(f.planes[p].y));
+			absZ[p] = L::splat(std::fabs(f.planes[p].z));
+		}
+	}
+};
+
+// Same test as boxVisible, one object per lane: the smallest distance over the planes decides.
+template<typename L>
+size_t cullBoxRange(const Frustum& f, const CullBoxesSoA& b, size_t begin, size_t end, uint32_t* visible) {
+	using V = typename L::V;
+	const Planes<L> planes(f);
+	size_t n = 0, i = begin;
+
+	for (; i + L::WIDTH <= end; i += L::WIDTH) {
+		const V cx = L::load(&b.centerX[i]), cy = L::load(&b.centerY[i]), cz = L::load(&b.centerZ[i]);
+		const V ex = L::load(&b.extentX[i]), ey = L::load(&b.extentY[i]), ez = L::load(&b.extentZ[i]);
+		V distance = L::splat(FLT_MAX);
+
+		for (int p = 0; p < 6; p++) {
+			const V center = L::madd(planes.x[p], cx, L::madd(planes.y[p], cy, L::madd(planes.z[p], cz, planes.w[p])));
+			const V radius = L::madd(planes.absX[p], ex, L::madd(planes.absY[p], ey, L::mul(planes.absZ[p], ez)));
+			distance = L::min(distance, L::add(center, radius));
+		}
+
+		n += L::compress(distance, static_cast<uint32_t>(i), visible + n);
+	}
+
+	for (; i < end; i++)
+		if (boxVisible(f, b, i))
+			visible[n++] = static_cast<uint32_t>(i);
+
+	return n;
+}
+
+template<typename L>
+size_t cullSphereRange(const Frustum& f, const CullSpheresSoA& s, size_t begin, size_t end, uint32_t* visible) {
+	using V = typename L::V;
+	const Planes<L> planes(f);
+	size_t n = 0, i = begin;
+
+	for (; i + L::WIDTH <= end; i += L::WIDTH) {
+		const V cx = L::load(&s.centerX[i]), cy = L::load(&s.centerY[i]), cz = L::load(&s.centerZ[i]);
+		V distance = L::splat(FLT_MAX);
+
+		for (int p = 0; p < 6; p++)
+			distance = L::min(distance, L::madd(planes.x[p], cx, L::madd(planes.y[p], cy, L::madd(planes.z[p], cz, planes.w[p]))));
+
+		n += L::compress(L::add(distance, L::load(&s.radius[i])), static_cast<uint32_t>(i), visible + n);
+	}
+
+	for (; i < end; i++)
+		if (sphereVisible(f, s, i))
+			visible[n++] = static_cast<uint32_t>(i);
+
+	return n;
+}
+
+#endif
+
+size_t cullBoxesRange(const Frustum& f, const CullBoxesSoA& b, size_t begin, size_t end, uint32_t* visible) {
+#if defined(ATOM_CULL_AVX512)
+	return cullBoxRange<Lanes16>(f, b, begin, end, visible);
+#elif defined(ATOM_SIMD_AVX2)
+	return cullBoxRange<Lanes8>(f, b, begin, end, visible);
+#else
+	size_t n = 0;
+
+	for (size_t i = begin; i < end; i++)
+		if (boxVisible(f, b, i))
+			visible[n++] = static_cast<uint32_t>(i);
+
+	return n;
+#endif
+}
+
+size_t cullSpheresRange(const Frustum& f, const CullSpheresSoA& s, size_t begin, size_t end, uint32_t* visible) {
+#if defined(ATOM_CULL_AVX512)
+	return cullSphereRange<Lanes16>(f, s, begin, end, visible);
+#elif defined(ATOM_SIMD_AVX2)
+	return cullSphereRange<Lanes8>(f, s, begin, end, visible);
+#else
+	size_t n = 0;
+
+	for (size_t i = begin; i < end; i++)
+		if (sphereVisible(f, s, i))
+			visible[n++] = static_cast<uint32_t>(i);
+
+	return n;
+#endif
+}
+
+// cullRange(begin, end, out) per block, then the blocks' lists packed together.
+template<typename F>
+size_t cullParallel(size_t count, uint32_t* visible, F&& cullRange) {
+	const size_t blocks = (count + BLOCK - 1) / BLOCK;
+	std::vector<size_t> counts(blocks);
+
+	parallelFor(blocks, MIN_BLOCKS_PER_CHUNK, [&](size_t first, size_t last) {
+		for (size_t block = first; block < last; block++)
+			counts[block] = cullRange(block * BLOCK, std::min((block + 1) * BLOCK, count), visible + block * BLOCK);
+	});
+
+	// Every list moves down by what the blocks before it culled, a fraction of the output.
+	size_t n = blocks ? counts[0] : 0;
+
+	for (size_t block = 1; block < blocks; block++) {
+		std::memmove(visible + n, visible + block * BLOCK, counts[block] * sizeof(uint32_t));
+		n += counts[block];
+	}
+
+	return n;
+}
+
+}
+
+size_t cullBoxes(const Frustum& f, const CullBoxesSoA& b, size_t first, size_t count, uint32_t* visible) {
+	return cullBoxesRange(f, b, first, first + count, visible);
+}
+
+size_t cullSpheres(const Frustum& f, const CullSpheresSoA& s, size_t first, size_t count, uint32_t* visible) {
+	return cullSpheresRange(f, s, first, first + count, visible);
+}
+
+size_t cullBoxes(const Frustum& f, const CullBoxesSoA& b, uint32_t* visible) {
+	return cullParallel(b.size(), visible, [&](size_t begin, size_t end, uint32_t* out) { return cullBoxesRange(f, b, begin, end, out); });
+}
+
+size_t cullSpheres(const Frustum& f, const CullSpheresSoA& s, uint32_t* visible) {
+	return cullParallel(s.size(), visible, [&](size_t begin, size_t end, uint32_t* out) { return cullSpheresRange(f, s, begin, end, out); });
+}
+
+void cullBvh(const Frustum& f, const Bvh& bvh, std::vector<uint32_t>& visible) {
+	if (bvh.empty())
+		return;
+
+	const auto& nodes = bvh.nodes();
+	const auto& indices = bvh.indices();
+
+	// Planes still to test, a node entirely in front of one takes its subtree with it.
+	struct Entry {
+		uint32_t node;
+		uint32_t planes;
+	};
+
+	Entry stack[64];
+	uint32_t size = 0;
+	stack[size++] = { 0, 0x3F };
+
+	while (size) {
+		const Entry entry = stack[--size];
+		const BvhNode& n = nodes[entry.node];
+		const float cx = (n.minX + n.maxX) * 0.5f, cy = (n.minY + n.maxY) * 0.5f, cz = (n.minZ + n.maxZ) * 0.5f;
+		const float ex = (n.maxX - n.minX) * 0.5f, ey = (n.maxY - n.minY) * 0.5f, ez = (n.maxZ - n.minZ) * 0.5f;
+		uint32_t planes = entry.planes;
+		bool outside = false;
+
+		for (int p = 0; p < 6 && !outside; p++) {
+			if (!(planes >> p & 1))
+				continue;
+
+			const float4& plane = f.planes[p];
+			const float center = planeDistance(plane, cx, cy, cz);
+			const float radius = std::fabs(plane.x) * ex + std::fabs(plane.y) * ey + std::fabs(plane.z) * ez;
+
+			if (center + radius < 0.0f)
+				outside = true;
+			else if (center - radius >= 0.0f)
+				planes &= ~(1u << p);
+		}
+
+		if (outside)
+			continue;
+
+		if (planes == 0) {
+			// A subtree's objects are one range of indices, from its leftmost leaf to its rightmost.
+			uint32_t leftmost = entry.node, rightmost = entry.node;
+			while (!nodes[leftmost].count)
+				leftmost = nodes[leftmost].first;
+			while (!nodes[rightmost].count)
+				rightmost = nodes[rightmost].first + 1;
+
+			visible.insert(visible.end(), indices.begin() + nodes[leftmost].first, indices.begin() + nodes[rightmost].first + nodes[rightmost].count);
+		} else if (n.count) {
+			for (uint32_t i = n.first; i < n.first + n.count; i++) {
+				const Bounds& b = bvh.objectBounds(indices[i]);
+				bool inside = true;
+
+				for (int p = 0; p < 6 && inside; p++)
+					if (planes >> p & 1)
+						inside = boxDistance(f.planes[p], (b.min.x + b.max.x) * 0.5f, (b.min.y + b.max.y) * 0.5f, (b.min.z + b.max.z) * 0.5f,
+						                     (b.max.x - b.min.x) * 0.5f, (b.max.y - b.min.y) * 0.5f, (b.max.z - b.min.z) * 0.5f) >= 0.0f;
+
+				if (inside)
+					visible.push_back(indices[i]);
+			}
+		} else {
+			stack[size++] = { n.first, planes };
+			stack[size++] = { n.first + 1, planes };
+		}
+	}
+}
+
+const char* cullKernelName() {
+#if defined(ATOM_CULL_AVX512)
+	return "AVX-512";
+#else
+	return ATOM_SIMD_NAME;
+#endif
+}
+
+}
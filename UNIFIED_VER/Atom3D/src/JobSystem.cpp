@@ -0,0 +1,329 @@
+// ReSharper disable CppInconsistentNaming
+#include "JobSystem.hpp"
+
+namespace Atom {
+
+// Failed looks for work before an idle worker goes to sleep.
+static constexpr uint32_t IDLE_SPINS = 32;
+
+static std::atomic<uint64_t> gNextSystemId{ 1 };
+
+// The system (by id) whose deque tThreadIndex is, 0 for none.
+static thread_local uint64_t tSystemId = 0;
+static thread_local uint32_t tThreadIndex = 0;
+static thread_local Job* tCurrentJob = nullptr;
+static thread_local uint32_t tRandom = 0x9e3779b9u;
+// Rings of systems this thread uses from outside, by system id.
+static thread_local std::vector<std::pair<uint64_t, JobRing*>> tExternalRings;
+
+struct JobRing {
+	std::unique_ptr<Job[]> jobs{ new Job[JobSystem::JOBS_PER_THREAD] };
+	uint32_t next = 0;
+};
+
+// Chase-Lev deque (the C11 version of Lê et al., "Correct and Efficient Work-Stealing for Weak Memory
+// Models") over a fixed array. The owner pushes and pops at the bottom, thieves take from the top.
+class JobDeque {
+public:
+	// False when full.
+	bool push(Job* job) {
+		const int64_t bottom = mBottom.load(std::memory_order_relaxed);
+		const int64_t top = mTop.load(std::memory_order_acquire);
+
+		if (bottom - top >= CAPACITY)
+			return false;
+
+		mJobs[bottom & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+		mBottom.store(bottom + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	Job* pop() {
+		const int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+		mBottom.store(bottom, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		int64_t top = mTop.load(std::memory_order_relaxed);
+
+		if (top > bottom) {
+			mBottom.store(bottom + 1, std::memory_order_relaxed);
+			return nullptr;
+		}
+
+		Job* job = mJobs[bottom & (CAPACITY - 1)].load(std::memory_order_relaxed);
+
+		// The last job, a thief may be taking it too.
+		if (top == bottom) {
+			if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				job = nullptr;
+
+			mBottom.store(bottom + 1, std::memory_order_relaxed);
+		}
+
+		return job;
+	}
+
+	// nullptr when empty or when another thread won the race for the top job.
+	Job* steal() {
+		int64_t top = mTop.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const int64_t bottom = mBottom.load(std::memory_order_acquire);
+
+		if (top >= bottom)
+			return nullptr;
+
+		Job* job = mJobs[top & (CAPACITY - 1)].load(std::memory_order_relaxed);
+
+		if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			return nullptr;
+
+		return job;
+	}
+
+	[[nodiscard]] bool empty() const {
+		return mBottom.load(std::memory_order_relaxed) <= mTop.load(std::memory_order_relaxed);
+	}
+
+private:
+	// A quarter of the ring, a thread with this many queued runs new jobs itself (JobSystem::run)
+	// long before its ring fills up.
+	static constexpr int64_t CAPACITY = JobSystem::JOBS_PER_THREAD / 4;
+
+	alignas(64) std::atomic<int64_t> mTop{ 0 };
+	alignas(64) std::atomic<int64_t> mBottom{ 0 };
+	alignas(64) std::atomic<Job*> mJobs[CAPACITY];
+};
+
+
+JobSystem::JobSystem(uint32_t threadCount)
+	: mId(gNextSystemId.fetch_add(1, std::memory_order_relaxed)),
+	  mThreadCount(threadCount ? threadCount : std::max(1u, std::thread::hardware_concurrency())),
+	  mOwnerPreviousId(tSystemId), mOwnerPreviousIndex(tThreadIndex) {
+	for (uint32_t i = 0; i < mThreadCount; i++) {
+		mDeques.push_back(std::make_unique<JobDeque>());
+		mRings.push_back(std::make_unique<JobRing>());
+	}
+
+	tSystemId = mId;
+	tThreadIndex = 0;
+
+	for (uint32_t i = 1; i < mThreadCount; i++)
+		mThreads.emplace_back([this, i] { workerLoop(i); });
+}
+
+JobSystem::~JobSystem() {
+	mStop.store(true, std::memory_order_release);
+
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+	}
+
+	mWake.notify_all();
+
+	for (auto& thread : mThreads)
+		thread.join();
+
+	if (tSystemId == mId) {
+		tSystemId = mOwnerPreviousId;
+		tThreadIndex = mOwnerPreviousIndex;
+	}
+}
+
+void JobSystem::run(Job* job) {
+	const uint32_t index = threadIndex();
+
+	if (index == NO_THREAD) {
+		std::lock_guard<std::mutex> lock(mSharedMutex);
+		mShared.push_back(job);
+		mSharedCount.store(mShared.size(), std::memory_order_relaxed);
+	} else if (!mDeques[index]->push(job)) {
+		execute(job);
+		return;
+	}
+
+	wake();
+}
+
+void JobSystem::wait(const Job* job) {
+	while (!done(job)) {
+		if (Job* other = findWork())
+			execute(other);
+		else
+			std::this_thread::yield();
+	}
+}
+
+Job* JobSystem::currentJob() {
+	return tCurrentJob;
+}
+
+Job* JobSystem::allocate(Job* parent) {
+	JobRing& jobs = ring();
+
+	// Jobs still in flight from the last time around are skipped, waiting for one could wait on an
+	// ancestor of the job making this one. Only a full ring runs other jobs to free some.
+	for (uint32_t tried = 0;; tried++) {
+		Job* job = &jobs.jobs[jobs.next++ % JOBS_PER_THREAD];
+
+		if (done(job)) {
+			job->parent = parent;
+			job->unfinished.store(1, std::memory_order_relaxed);
+
+			if (parent)
+				parent->unfinished.fetch_add(1, std::memory_order_relaxed);
+
+			return job;
+		}
+
+		if (tried == JOBS_PER_THREAD) {
+			if (Job* other = findWork())
+				execute(other);
+			else
+				std::this_thread::yield();
+
+			tried = 0;
+		}
+	}
+}
+
+void JobSystem::execute(Job* job) {
+	Job* const previous = tCurrentJob;
+	tCurrentJob = job;
+	job->function(job->payload);
+	tCurrentJob = previous;
+
+	finish(job);
+}
+
+void JobSystem::finish(Job* job) {
+	// Read parent first, a done job may be handed out again right away.
+	while (job) {
+		Job* const parent = job->parent;
+
+		if (job->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1)
+			break;
+
+		job = parent;
+	}
+}
+
+Job* JobSystem::findWork() {
+	const uint32_t index = threadIndex();
+
+	if (index != NO_THREAD)
+		if (Job* job = mDeques[index]->pop())
+			return job;
+
+	if (mSharedCount.load(std::memory_order_relaxed)) {
+		std::lock_guard<std::mutex> lock(mSharedMutex);
+
+		if (!mShared.empty()) {
+			Job* job = mShared.front();
+			mShared.pop_front();
+			mSharedCount.store(mShared.size(), std::memory_order_relaxed);
+			return job;
+		}
+	}
+
+	// xorshift, so thieves don't all start at the same victim.
+	tRandom ^= tRandom << 13;
+	tRandom ^= tRandom >> 17;
+	tRandom ^= tRandom << 5;
+
+	for (uint32_t i = 0, start = tRandom % mThreadCount; i < mThreadCount; i++) {
+		const uint32_t victim = (start + i) % mThreadCount;
+
+		if (victim != index)
+			if (Job* job = mDeques[victim]->steal())
+				return job;
+	}
+
+	return nullptr;
+}
+
+bool JobSystem::wantsWork() const {
+	const uint32_t index = threadIndex();
+	return index != NO_THREAD && mDeques[index]->empty();
+}
+
+void JobSystem::wake() {
+	// Pairs with the fence a worker makes after counting itself as a sleeper: either it sees the job
+	// pushed before this, or this sees it sleeping.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (mSleepers.load(std::memory_order_relaxed) == 0)
+		return;
+
+	mEpoch.fetch_add(1, std::memory_order_relaxed);
+
+	// A worker between checking mEpoch and blocking holds the mutex, it can't miss the notify.
+	{
+		std::lock_guard<std::mutex> lock(mSleepMutex);
+	}
+
+	mWake.notify_one();
+}
+
+void JobSystem::workerLoop(uint32_t index) {
+	tSystemId = mId;
+	tThreadIndex = index;
+	tRandom = 0x9e3779b9u * (index + 1);
+	uint32_t idle = 0;
+
+	while (!mStop.load(std::memory_order_acquire)) {
+		if (Job* job = findWork()) {
+			execute(job);
+			idle = 0;
+			continue;
+		}
+
+		if (++idle < IDLE_SPINS) {
+			std::this_thread::yield();
+			continue;
+		}
+
+		mSleepers.fetch_add(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const uint64_t epoch = mEpoch.load(std::memory_order_relaxed);
+		Job* job = findWork();
+
+		if (!job) {
+			std::unique_lock<std::mutex> lock(mSleepMutex);
+			mWake.wait(lock, [&] { return mStop.load(std::memory_order_relaxed) || mEpoch.load(std::memory_order_relaxed) != epoch; });
+		}
+
+		mSleepers.fetch_sub(1, std::memory_order_relaxed);
+		idle = 0;
+
+		if (job)
+			execute(job);
+	}
+}
+
+uint32_t JobSystem::threadIndex() const {
+	return tSystemId == mId ? tThreadIndex : NO_THREAD;
+}
+
+JobRing& JobSystem::ring() {
+	const uint32_t index = threadIndex();
+
+	if (index != NO_THREAD)
+		return *mRings[index];
+
+	for (const auto& [id, ring] : tExternalRings)
+		if (id == mId)
+			return *ring;
+
+	std::lock_guard<std::mutex> lock(mSharedMutex);
+	mExternalRings.push_back(std::make_unique<JobRing>());
+	tExternalRings.emplace_back(mId, mExternalRings.back().get());
+
+	return *mExternalRings.back();
+}
+
+JobSystem& jobSystem() {
+	static JobSystem system;
+	return system;
+}
+
+}
@@ -0,0 +1,205 @@
+// ReSharper disable CppInconsistentNaming
+#include "Lz4.hpp"
+
+#include <cstring>
+#include <vector>
+
+namespace Atom {
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t LAST_LITERALS = 5;   // The block always ends in at least this many literals
+constexpr size_t MATCH_FIND_LIMIT = 12; // and no match starts in the last 12 bytes
+constexpr size_t MAX_OFFSET = 65535;
+constexpr int HASH_BITS = 16;
+
+uint32_t read32(const uint8_t* p) {
+	uint32_t v;
+	memcpy(&v, p, 4);
+	return v;
+}
+
+uint32_t hash4(uint32_t v) {
+	return (v * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// Lengths past the 4 bit token field go on as 255, 255, ..., rest.
+uint8_t* writeLength(uint8_t* out, size_t length) {
+	for (; length >= 255; length -= 255)
+		*out++ = 255;
+
+	*out++ = static_cast<uint8_t>(length);
+	return out;
+}
+
+bool readLength(const uint8_t*& in, const uint8_t* end, size_t& length) {
+	uint8_t b;
+
+	do {
+		if (in == end)
+			return false;
+
+		b = *in++;
+		length += b;
+	} while (b == 255);
+
+	return true;
+}
+
+}
+
+size_t lz4Compress(const uint8_t* src, size_t size, uint8_t* dst, size_t capacity) {
+	if (size >= 0xFFFFFFFFu)
+		return 0;
+
+	uint8_t* op = dst;
+	uint8_t* const opEnd = dst + capacity;
+	size_t anchor = 0;
+
+	// Writes the literals since anchor, then a match of length at offset (none for the last sequence).
+	auto emit = [&](size_t literalEnd, size_t offset, size_t length) {
+		const size_t literals = literalEnd - anchor;
+		const size_t worst = 1 + literals / 255 + 1 + literals + 2 + length / 255 + 1;
+
+		if (static_cast<size_t>(opEnd - op) < worst)
+			return false;
+
+		const size_t matchCode = length ? length - MIN_MATCH : 0;
+		uint8_t* token = op++;
+		*token = static_cast<uint8_t>((literals < 15 ? literals : 15) << 4);
+
+		if (literals >= 15)
+			op = writeLength(op, literals - 15);
+
+		memcpy(op, src + anchor, literals);
+		op += literals;
+
+		if (length) {
+			*op++ = static_cast<uint8_t>(offset);
+			*op++ = static_cast<uint8_t>(offset >> 8);
+			*token |= static_cast<uint8_t>(matchCode < 15 ? matchCode : 15);
+
+			if (matchCode >= 15)
+				op = writeLength(op, matchCode - 15);
+		}
+
+		return true;
+	};
+
+	if (size > MATCH_FIND_LIMIT) {
+		std::vector<uint32_t> table(size_t(1) << HASH_BITS, 0);
+		const size_t matchLimit = size - LAST_LITERALS;
+		const size_t searchEnd = size - MATCH_FIND_LIMIT;
+		size_t ip = 0;
+
+		while (ip < searchEnd) {
+			const uint32_t sequence = read32(src + ip);
+			uint32_t& slot = table[hash4(sequence)];
+			size_t ref = slot;
+			slot = static_cast<uint32_t>(ip);
+
+			if (ref >= ip || ip - ref > MAX_OFFSET || read32(src + ref) != sequence) {
+				// The longer nothing matches the bigger the steps, so JPEGs and BC blocks go by quickly.
+				ip += 1 + ((ip - anchor) >> 6);
+				continue;
+			}
+
+			while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1]) {
+				ip--;
+				ref--;
+			}
+
+			size_t length = MIN_MATCH;
+
+			while (ip + length < matchLimit && src[ip + length] == src[ref + length])
+				length++;
+
+			if (!emit(ip, ip - ref, length))
+				return 0;
+
+			ip += length;
+			anchor = ip;
+
+			if (ip - 2 < searchEnd)
+				table[hash4(read32(src + ip - 2))] = static_cast<uint32_t>(ip - 2);
+		}
+	}
+
+	if (!emit(size, 0, 0))
+		return 0;
+
+	return static_cast<size_t>(op - dst);
+}
+
+bool lz4Decompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize) {
+	const uint8_t* ip = src;
+	const uint8_t* const ipEnd = src + srcSize;
+	uint8_t* op = dst;
+	uint8_t* const opEnd = dst + dstSize;
+
+	while (ip < ipEnd) {
+		const uint8_t token = *ip++;
+		size_t literals = token >> 4;
+
+		if (literals == 15 && !readLength(ip, ipEnd, literals))
+			return false;
+
+		if (literals > static_cast<size_t>(ipEnd - ip) || literals > static_cast<size_t>(opEnd - op))
+			return false;
+
+		// Short runs copy a fixed 16 bytes when both sides have room, the next sequence overwrites the rest.
+		if (literals <= 16 && ipEnd - ip >= 16 && opEnd - op >= 16)
+			memcpy(op, ip, 16);
+		else
+			memcpy(op, ip, literals);
+		ip += literals;
+		op += literals;
+
+		// The last sequence has literals only.
+		if (ip == ipEnd)
+			break;
+
+		if (ipEnd - ip < 2)
+			return false;
+
+		const size_t offset = ip[0] | static_cast<size_t>(ip[1]) << 8;
+		ip += 2;
+
+		if (offset == 0 || offset > static_cast<size_t>(op - dst))
+			return false;
+
+		size_t length = token & 15;
+
+		if (length == 15 && !readLength(ip, ipEnd, length))
+			return false;
+
+		length += MIN_MATCH;
+
+		if (length > static_cast<size_t>(opEnd - op))
+			return false;
+
+		const uint8_t* match = op - offset;
+		uint8_t* const matchEnd = op + length;
+
+		// Chunks no bigger than the offset never read bytes they haven't written yet, and may run up to a
+		// chunk past the match while there is room for it. Overlapping matches repeat the last offset
+		// bytes, which a forward byte copy does by itself.
+		if (offset >= 16 && opEnd - matchEnd >= 16) {
+			for (; op < matchEnd; op += 16, match += 16)
+				memcpy(op, match, 16);
+		} else if (offset >= 8 && opEnd - matchEnd >= 8) {
+			for (; op < matchEnd; op += 8, match += 8)
+				memcpy(op, match, 8);
+		} else {
+			while (op < matchEnd)
+				*op++ = *match++;
+		}
+
+		op = matchEnd;
+	}
+
+	return op == opEnd;
+}
+
+}
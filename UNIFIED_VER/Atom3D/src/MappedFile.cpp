@@ -0,0 +1,149 @@
+// ReSharper disable CppInconsistentNaming
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <utility>
+
+namespace Atom {
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+	*this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	if (this != &other) {
+		close();
+		std::swap(mData, other.mData);
+		std::swap(mSize, other.mSize);
+#ifdef _WIN32
+		std::swap(mMapping, other.mMapping);
+#endif
+	}
+
+	return *this;
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const std::string& path) {
+	close();
+
+	// The mapping keeps the file open, the handle isn't needed once it exists.
+	const HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+
+	const HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+
+	if (!mapping)
+		return false;
+
+	const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+	if (!view) {
+		CloseHandle(mapping);
+		return false;
+	}
+
+	mData = static_cast<const uint8_t*>(view);
+	mSize = static_cast<size_t>(size.QuadPart);
+	mMapping = mapping;
+
+	return true;
+}
+
+void MappedFile::close() {
+	if (mData)
+		UnmapViewOfFile(mData);
+
+	if (mMapping)
+		CloseHandle(mMapping);
+
+	mData = nullptr;
+	mSize = 0;
+	mMapping = nullptr;
+}
+
+void MappedFile::prefetch(size_t offset, size_t size) const {
+	if (offset >= mSize)
+		return;
+
+	WIN32_MEMORY_RANGE_ENTRY range;
+	range.VirtualAddress = const_cast<uint8_t*>(mData + offset);
+	range.NumberOfBytes = std::min(size, mSize - offset);
+	PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+#else
+bool MappedFile::open(const std::string& path) {
+	close();
+
+	const int fd = ::open(path.c_str(), O_RDONLY);
+
+	if (fd < 0)
+		return false;
+
+	struct stat info = {};
+
+	if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+		::close(fd);
+		return false;
+	}
+
+	// The mapping stays valid after the descriptor is closed.
+	void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+
+	if (view == MAP_FAILED)
+		return false;
+
+	mData = static_cast<const uint8_t*>(view);
+	mSize = static_cast<size_t>(info.st_size);
+
+	return true;
+}
+
+void MappedFile::close() {
+	if (mData)
+		munmap(const_cast<uint8_t*>(mData), mSize);
+
+	mData = nullptr;
+	mSize = 0;
+}
+
+void MappedFile::prefetch(size_t offset, size_t size) const {
+	if (offset >= mSize)
+		return;
+
+	// madvise wants a page aligned start.
+	const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+	const size_t start = offset & ~(page - 1);
+	const size_t end = offset + std::min(size, mSize - offset);
+
+	madvise(const_cast<uint8_t*>(mData + start), end - start, MADV_WILLNEED);
+}
+#endif
+
+}
@@ -0,0 +1,1311 @@
+// ReSharper disable CppInconsistentNaming
+#include "MeshImporter.hpp"
+#include "MeshOptimizer.hpp"
+#include "ParallelFor.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+namespace Atom {
+
+namespace {
+
+constexpr uint32_t NO_INDEX = UINT32_MAX;
+
+std::vector<uint8_t> readFile(const std::string& path) {
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+
+	if (!file)
+		throw std::runtime_error("Failed to open " + path + "\n");
+
+	std::vector<uint8_t> data(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+	if (!file)
+		throw std::runtime_error("Failed to read " + path + "\n");
+
+	return data;
+}
+
+// Decimal number, [-+]digits[.digits][(e|E)[-+]digits]. Up to 18 significant digits are exact, plenty
+// for floats and for integers below 2^53. Returns p unchanged if there is no number.
+const char* parseNumber(const char* p, const char* end, double& out) {
+	static constexpr double POWERS_OF_TEN[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	const char* start = p;
+	bool negative = false;
+
+	if (p < end && (*p == '-' || *p == '+'))
+		negative = *p++ == '-';
+
+	uint64_t mantissa = 0;
+	int exponent = 0;
+	bool digits = false;
+
+	for (; p < end && *p >= '0' && *p <= '9'; p++, digits = true) {
+		if (mantissa < 100000000000000000ull)
+			mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+		else
+			exponent++;
+	}
+
+	if (p < end && *p == '.')
+		for (p++; p < end && *p >= '0' && *p <= '9'; p++, digits = true) {
+			if (mantissa < 100000000000000000ull) {
+				mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+				exponent--;
+			}
+		}
+
+	if (!digits)
+		return start;
+
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		const char* e = p + 1;
+		bool negativeExponent = false;
+
+		if (e < end && (*e == '-' || *e == '+'))
+			negativeExponent = *e++ == '-';
+
+		if (e < end && *e >= '0' && *e <= '9') {
+			int value = 0;
+
+			for (; e < end && *e >= '0' && *e <= '9'; e++)
+				value = std::min(value * 10 + (*e - '0'), 10000);
+
+			exponent += negativeExponent ? -value : value;
+			p = e;
+		}
+	}
+
+	double value = static_cast<double>(mantissa);
+
+	if (exponent < 0)
+		value = exponent >= -22 ? value / POWERS_OF_TEN[-exponent] : value * std::pow(10.0, exponent);
+	else if (exponent > 0)
+		value = exponent <= 22 ? value * POWERS_OF_TEN[exponent] : value * std::pow(10.0, exponent);
+
+	out = negative ? -value : value;
+
+	return p;
+}
+
+const char* parseFloat(const char* p, const char* end, float& out) {
+	double value = 0;
+	const char* next = parseNumber(p, end, value);
+	out = static_cast<float>(value);
+
+	return next;
+}
+
+const char* parseInt(const char* p, const char* end, int64_t& out) {
+	const char* start = p;
+	bool negative = false;
+
+	if (p < end && (*p == '-' || *p == '+'))
+		negative = *p++ == '-';
+
+	int64_t value = 0;
+	const char* digits = p;
+
+	for (; p < end && *p >= '0' && *p <= '9'; p++)
+		value = std::min<int64_t>(value * 10 + (*p - '0'), INT32_MAX);
+
+	if (p == digits)
+		return start;
+
+	out = negative ? -value : value;
+
+	return p;
+}
+
+bool isSpace(char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+const char* skipSpace(const char* p, const char* end) {
+	while (p < end && isSpace(*p))
+		p++;
+
+	return p;
+}
+
+// One piece of a mesh welded on its own, merged with the others at the end.
+struct MeshPiece {
+	std::vector<MeshVertex> vertices;
+	std::vector<uint32_t> indices;
+	std::string error;
+};
+
+void computeNormals(MeshPiece& piece) {
+	const auto normals = computeVertexNormals(piece.vertices[0].position, piece.vertices.size(), sizeof(MeshVertex), piece.indices.data(), piece.indices.size());
+
+	for (size_t v = 0; v < piece.vertices.size(); v++) {
+		piece.vertices[v].normal[0] = normals[v].x;
+		piece.vertices[v].normal[1] = normals[v].y;
+		piece.vertices[v].normal[2] = normals[v].z;
+	}
+}
+
+void weld(MeshPiece& piece, const MeshVertex* corners, size_t cornerCount) {
+	MeshBuilder<MeshVertex> builder(cornerCount / 2);
+	builder.addTriangles(corners, cornerCount);
+
+	auto mesh = builder.build();
+	piece.vertices = std::move(mesh.vertices);
+	piece.indices = mesh.indices();
+}
+
+// Concatenates the pieces. With weldAcross, vertices repeated in several pieces are stored once,
+// only the pieces' unique vertices go through the table again.
+IndexedMesh<MeshVertex> mergePieces(std::vector<MeshPiece>& pieces, bool weldAcross) {
+	for (const auto& piece : pieces)
+		if (!piece.error.empty())
+			throw std::runtime_error(piece.error);
+
+	size_t vertexCount = 0, indexCount = 0;
+
+	for (const auto& piece : pieces) {
+		vertexCount += piece.vertices.size();
+		indexCount += piece.indices.size();
+	}
+
+	IndexedMesh<MeshVertex> mesh;
+	std::vector<uint32_t> indices;
+	indices.reserve(indexCount);
+
+	if (weldAcross) {
+		MeshBuilder<MeshVertex> builder(vertexCount);
+		std::vector<uint32_t> remap;
+
+		for (auto& piece : pieces) {
+			remap.resize(piece.vertices.size());
+
+			for (size_t v = 0; v < piece.vertices.size(); v++)
+				remap[v] = builder.addVertex(piece.vertices[v]);
+
+			for (const uint32_t index : piece.indices)
+				indices.push_back(remap[index]);
+
+			piece = MeshPiece();
+		}
+
+		mesh = builder.build();
+	} else {
+		mesh.vertices.reserve(vertexCount);
+
+		for (auto& piece : pieces) {
+			const auto base = static_cast<uint32_t>(mesh.vertices.size());
+			mesh.vertices.insert(mesh.vertices.end(), piece.vertices.begin(), piece.vertices.end());
+
+			for (const uint32_t index : piece.indices)
+				indices.push_back(base + index);
+
+			piece = MeshPiece();
+		}
+	}
+
+	mesh.setIndices(indices.data(), indices.size());
+
+	return mesh;
+}
+
+IndexedMesh<MeshVertex> finishMesh(IndexedMesh<MeshVertex> mesh, const std::string& path) {
+	if (mesh.indexCount == 0)
+		throw std::runtime_error("No triangles in " + path + "\n");
+
+	optimizeMesh(mesh, offsetof(MeshVertex, position));
+
+	return mesh;
+}
+
+
+// OBJ
+enum class ObjLine {
+	Position,
+	UV,
+	Normal,
+	Face,
+	Other
+};
+
+// Classifies a line by its tag and moves p past it.
+ObjLine objLine(const char*& p, const char* end) {
+	p = skipSpace(p, end);
+
+	if (end - p < 2)
+		return ObjLine::Other;
+
+	if (p[0] == 'f' && isSpace(p[1])) {
+		p += 2;
+		return ObjLine::Face;
+	}
+
+	if (p[0] != 'v')
+		return ObjLine::Other;
+
+	if (isSpace(p[1])) {
+		p += 2;
+		return ObjLine::Position;
+	}
+
+	if (end - p >= 3 && isSpace(p[2]) && (p[1] == 't' || p[1] == 'n')) {
+		const char tag = p[1];
+		p += 3;
+		return tag == 't' ? ObjLine::UV : ObjLine::Normal;
+	}
+
+	return ObjLine::Other;
+}
+
+// Calls f(lineBegin, lineEnd) for every line of [begin, end).
+template<typename F>
+void forEachLine(const char* begin, const char* end, F&& f) {
+	while (begin < end) {
+		const auto* newline = static_cast<const char*>(memchr(begin, '\n', static_cast<size_t>(end - begin)));
+		const char* lineEnd = newline ? newline : end;
+
+		f(begin, lineEnd);
+		begin = lineEnd + 1;
+	}
+}
+
+struct ObjCorner {
+	uint32_t position, uv, normal;
+};
+
+struct ObjChunk {
+	const char* begin;
+	const char* end;
+
+	// Attributes before this chunk, from the counting pass, to resolve negative indices.
+	size_t positionBase = 0, uvBase = 0, normalBase = 0;
+	size_t positionCount = 0, uvCount = 0, normalCount = 0;
+
+	std::vector<float> positions, uvs, normals;
+	std::vector<ObjCorner> corners; // 3 per triangle
+	std::string error;
+};
+
+// 1 based, negative counts back from the attributes read so far, 0 is invalid.
+uint32_t resolveObjIndex(int64_t index, size_t readSoFar) {
+	if (index > 0)
+		return static_cast<uint32_t>(index - 1);
+
+	if (index < 0 && static_cast<size_t>(-index) <= readSoFar)
+		return static_cast<uint32_t>(static_cast<int64_t>(readSoFar) + index);
+
+	return NO_INDEX - 1; // Out of range for every attribute, caught when the corners are resolved
+}
+
+void parseObjChunk(ObjChunk& chunk) {
+	std::vector<ObjCorner> polygon;
+
+	forEachLine(chunk.begin, chunk.end, [&](const char* p, const char* end) {
+		const ObjLine kind = objLine(p, end);
+
+		if (kind == ObjLine::Position || kind == ObjLine::Normal || kind == ObjLine::UV) {
+			auto& target = kind == ObjLine::Position ? chunk.positions : kind == ObjLine::Normal ? chunk.normals : chunk.uvs;
+			const int components = kind == ObjLine::UV ? 2 : 3;
+
+			for (int k = 0; k < components; k++) {
+				float value = 0;
+				p = parseFloat(skipSpace(p, end), end, value);
+
+				// OBJ UVs start at the bottom left.
+				target.push_back(kind == ObjLine::UV && k == 1 ? 1.0f - value : value);
+			}
+		} else if (kind == ObjLine::Face) {
+			const size_t positionsRead = chunk.positionBase + chunk.positions.size() / 3;
+			const size_t uvsRead = chunk.uvBase + chunk.uvs.size() / 2;
+			const size_t normalsRead = chunk.normalBase + chunk.normals.size() / 3;
+
+			polygon.clear();
+
+			for (p = skipSpace(p, end); p < end && *p != '#'; p = skipSpace(p, end)) {
+				ObjCorner corner = { NO_INDEX, NO_INDEX, NO_INDEX };
+				int64_t index = 0;
+				const char* next = parseInt(p, end, index);
+
+				if (next == p) {
+					if (chunk.error.empty())
+						chunk.error = "Bad face: " + std::string(p, end);
+					return;
+				}
+
+				corner.position = resolveObjIndex(index, positionsRead);
+				p = next;
+
+				if (p < end && *p == '/') {
+					next = parseInt(++p, end, index);
+
+					if (next != p)
+						corner.uv = resolveObjIndex(index, uvsRead);
+
+					p = next;
+
+					if (p < end && *p == '/') {
+						next = parseInt(++p, end, index);
+
+						if (next != p)
+							corner.normal = resolveObjIndex(index, normalsRead);
+
+						p = next;
+					}
+				}
+
+				// Anything else glued to the corner.
+				while (p < end && !isSpace(*p))
+					p++;
+
+				polygon.push_back(corner);
+			}
+
+			for (size_t i = 2; i < polygon.size(); i++)
+				chunk.corners.insert(chunk.corners.end(), { polygon[0], polygon[i - 1], polygon[i] });
+		}
+	});
+}
+
+// Corners to vertices, welded within the chunk.
+void weldObjChunk(const ObjChunk& chunk, const std::vector<float>& positions, const std::vector<float>& uvs, const std::vector<float>& normals, MeshPiece& piece) {
+	std::vector<MeshVertex> vertices(chunk.corners.size());
+
+	for (size_t i = 0; i < chunk.corners.size(); i++) {
+		const ObjCorner& corner = chunk.corners[i];
+		MeshVertex& v = vertices[i];
+		v = {};
+
+		if (corner.position >= positions.size() / 3 || (corner.uv != NO_INDEX && corner.uv >= uvs.size() / 2) ||
+		    (corner.normal != NO_INDEX && corner.normal >= normals.size() / 3)) {
+			piece.error = "Face index out of range";
+			return;
+		}
+
+		memcpy(v.position, &positions[corner.position * 3], sizeof v.position);
+
+		if (corner.uv != NO_INDEX)
+			memcpy(v.uv, &uvs[corner.uv * 2], sizeof v.uv);
+
+		if (corner.normal != NO_INDEX)
+			memcpy(v.normal, &normals[corner.normal * 3], sizeof v.normal);
+	}
+
+	weld(piece, vertices.data(), vertices.size());
+}
+
+
+// JSON, as much as glTF needs
+struct JsonValue {
+	enum class Type : uint8_t {
+		Null,
+		Bool,
+		Number,
+		String,
+		Array,
+		Object
+	};
+
+	Type type = Type::Null;
+	bool boolean = false;
+	double number = 0;
+	std::string string;
+	std::vector<JsonValue> items;      // Array elements or object values
+	std::vector<std::string> keys;     // Object keys, parallel to items
+
+	// Missing members and elements read as null, so lookups can be chained. Keys are literals, an
+	// overload taking const char* would be ambiguous with [0].
+	template<size_t N>
+	const JsonValue& operator[](const char (&key)[N]) const {
+		for (size_t i = 0; i < keys.size(); i++)
+			if (keys[i] == key)
+				return items[i];
+
+		return null();
+	}
+
+	const JsonValue& operator[](size_t i) const {
+		return type == Type::Array && i < items.size() ? items[i] : null();
+	}
+
+	[[nodiscard]] bool isNull() const { return type == Type::Null; }
+	[[nodiscard]] size_t size() const { return type == Type::Array ? items.size() : 0; }
+	[[nodiscard]] double numberOr(double fallback) const { return type == Type::Number ? number : fallback; }
+
+	// Non negative integer index or size, throws on anything else.
+	[[nodiscard]] size_t index(const char* what) const {
+		if (type != Type::Number || number < 0 || number != std::floor(number))
+			throw std::runtime_error(std::string("glTF: bad ") + what + "\n");
+
+		return static_cast<size_t>(number);
+	}
+
+	static const JsonValue& null() {
+		static const JsonValue value;
+		return value;
+	}
+};
+
+class JsonParser {
+public:
+	JsonParser(const char* begin, const char* end) : mP(begin), mEnd(end) {}
+
+	JsonValue parse() {
+		JsonValue value = parseValue(0);
+		skipWhitespace();
+
+		if (mP != mEnd)
+			fail("trailing characters");
+
+		return value;
+	}
+
+private:
+	JsonValue parseValue(int depth) {
+		if (depth > 128)
+			fail("nested too deep");
+
+		skipWhitespace();
+
+		if (mP == mEnd)
+			fail("unexpected end");
+
+		JsonValue value;
+
+		switch (*mP) {
+		case '{':
+			value.type = JsonValue::Type::Object;
+			mP++;
+
+			if (consume('}'))
+				break;
+
+			do {
+				skipWhitespace();
+				value.keys.push_back(parseString());
+				skipWhitespace();
+
+				if (!consume(':'))
+					fail("expected ':'");
+
+				value.items.push_back(parseValue(depth + 1));
+				skipWhitespace();
+			} while (consume(','));
+
+			if (!consume('}'))
+				fail("expected '}'");
+			break;
+		case '[':
+			value.type = JsonValue::Type::Array;
+			mP++;
+
+			if (consume(']'))
+				break;
+
+			do {
+				value.items.push_back(parseValue(depth + 1));
+				skipWhitespace();
+			} while (consume(','));
+
+			if (!consume(']'))
+				fail("expected ']'");
+			break;
+		case '"':
+			value.type = JsonValue::Type::String;
+			value.string = parseString();
+			break;
+		case 't':
+			literal("true");
+			value.type = JsonValue::Type::Bool;
+			value.boolean = true;
+			break;
+		case 'f':
+			literal("false");
+			value.type = JsonValue::Type::Bool;
+			break;
+		case 'n':
+			literal("null");
+			break;
+		default: {
+			const char* next = parseNumber(mP, mEnd, value.number);
+
+			if (next == mP)
+				fail("unexpected character");
+
+			value.type = JsonValue::Type::Number;
+			mP = next;
+		}
+		}
+
+		return value;
+	}
+
+	std::string parseString() {
+		if (!consume('"'))
+			fail("expected string");
+
+		std::string out;
+
+		while (mP < mEnd && *mP != '"') {
+			if (*mP != '\\') {
+				out.push_back(*mP++);
+				continue;
+			}
+
+			if (++mP == mEnd)
+				break;
+
+			switch (*mP++) {
+			case '"': out.push_back('"'); break;
+			case '\\': out.push_back('\\'); break;
+			case '/': out.push_back('/'); break;
+			case 'b': out.push_back('\b'); break;
+			case 'f': out.push_back('\f'); break;
+			case 'n': out.push_back('\n'); break;
+			case 'r': out.push_back('\r'); break;
+			case 't': out.push_back('\t'); break;
+			case 'u': {
+				uint32_t c = parseHex4();
+
+				// Surrogate pair.
+				if (c >= 0xD800 && c < 0xDC00 && mEnd - mP >= 6 && mP[0] == '\\' && mP[1] == 'u') {
+					mP += 2;
+					c = 0x10000 + ((c - 0xD800) << 10) + (parseHex4() - 0xDC00);
+				}
+
+				appendUtf8(out, c);
+				break;
+			}
+			default:
+				fail("bad escape");
+			}
+		}
+
+		if (!consume('"'))
+			fail("unterminated string");
+
+		return out;
+	}
+
+	uint32_t parseHex4() {
+		if (mEnd - mP < 4)
+			fail("bad \\u escape");
+
+		uint32_t value = 0;
+
+		for (int i = 0; i < 4; i++, mP++) {
+			const char c = *mP;
+			value <<= 4;
+
+			if (c >= '0' && c <= '9')
+				value |= c - '0';
+			else if (c >= 'a' && c <= 'f')
+				value |= c - 'a' + 10;
+			else if (c >= 'A' && c <= 'F')
+				value |= c - 'A' + 10;
+			else
+				fail("bad \\u escape");
+		}
+
+		return value;
+	}
+
+	static void appendUtf8(std::string& out, uint32_t c) {
+		if (c < 0x80) {
+			out.push_back(static_cast<char>(c));
+		} else if (c < 0x800) {
+			out.push_back(static_cast<char>(0xC0 | c >> 6));
+			out.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+		} else if (c < 0x10000) {
+			out.push_back(static_cast<char>(0xE0 | c >> 12));
+			out.push_back(static_cast<char>(0x80 | (c >> 6 & 0x3F)));
+			out.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+		} else {
+			out.push_back(static_cast<char>(0xF0 | c >> 18));
+			out.push_back(static_cast<char>(0x80 | (c >> 12 & 0x3F)));
+			out.push_back(static_cast<char>(0x80 | (c >> 6 & 0x3F)));
+			out.push_back(static_cast<char>(0x80 | (c & 0x3F)));
+		}
+	}
+
+	void literal(const char* word) {
+		const size_t length = strlen(word);
+
+		if (static_cast<size_t>(mEnd - mP) < length || memcmp(mP, word, length) != 0)
+			fail("unexpected character");
+
+		mP += length;
+	}
+
+	bool consume(char c) {
+		skipWhitespace();
+
+		if (mP < mEnd && *mP == c) {
+			mP++;
+			return true;
+		}
+
+		return false;
+	}
+
+	void skipWhitespace() {
+		while (mP < mEnd && (*mP == ' ' || *mP == '\t' || *mP == '\n' || *mP == '\r'))
+			mP++;
+	}
+
+	[[noreturn]] static void fail(const char* what) {
+		throw std::runtime_error(std::string("glTF JSON: ") + what + "\n");
+	}
+
+	const char* mP;
+	const char* mEnd;
+};
+
+
+// glTF
+constexpr uint32_t GLB_MAGIC = 0x46546C67; // "glTF"
+constexpr uint32_t GLB_CHUNK_JSON = 0x4E4F534A;
+constexpr uint32_t GLB_CHUNK_BIN = 0x004E4942;
+
+enum GltfComponentType : uint32_t {
+	Byte = 5120,
+	UnsignedByte = 5121,
+	Short = 5122,
+	UnsignedShort = 5123,
+	UnsignedInt = 5125,
+	Float = 5126
+};
+
+struct GltfFile {
+	JsonValue json;
+	std::vector<std::vector<uint8_t>> buffers;
+};
+
+std::vector<uint8_t> decodeBase64(const char* p, const char* end) {
+	std::vector<uint8_t> out;
+	out.reserve(static_cast<size_t>(end - p) / 4 * 3);
+
+	uint32_t bits = 0;
+	int bitCount = 0;
+
+	for (; p < end && *p != '='; p++) {
+		const char c = *p;
+		uint32_t value;
+
+		if (c >= 'A' && c <= 'Z')
+			value = c - 'A';
+		else if (c >= 'a' && c <= 'z')
+			value = c - 'a' + 26;
+		else if (c >= '0' && c <= '9')
+			value = c - '0' + 52;
+		else if (c == '+' || c == '-')
+			value = 62;
+		else if (c == '/' || c == '_')
+			value = 63;
+		else
+			throw std::runtime_error("glTF: bad base64 data\n");
+
+		bits = bits << 6 | value;
+		bitCount += 6;
+
+		if (bitCount >= 8) {
+			bitCount -= 8;
+			out.push_back(static_cast<uint8_t>(bits >> bitCount));
+		}
+	}
+
+	return out;
+}
+
+// Relative URIs may be percent encoded, "my%20mesh.bin".
+std::string decodeUri(const std::string& uri) {
+	std::string out;
+
+	for (size_t i = 0; i < uri.size(); i++) {
+		if (uri[i] == '%' && i + 2 < uri.size()) {
+			out.push_back(static_cast<char>(std::stoi(uri.substr(i + 1, 2), nullptr, 16)));
+			i += 2;
+		} else {
+			out.push_back(uri[i]);
+		}
+	}
+
+	return out;
+}
+
+GltfFile loadGltf(const std::string& path) {
+	const std::vector<uint8_t> data = readFile(path);
+	GltfFile file;
+	std::vector<uint8_t> binChunk;
+
+	uint32_t magic = 0;
+
+	if (data.size() >= 4)
+		memcpy(&magic, data.data(), 4);
+
+	if (magic == GLB_MAGIC) {
+		// 12 byte header, then chunks of length, type, data. JSON first, the optional BIN second.
+		size_t offset = 12;
+		bool haveJson = false;
+
+		while (offset + 8 <= data.size()) {
+			uint32_t length, type;
+			memcpy(&length, &data[offset], 4);
+			memcpy(&type, &data[offset + 4], 4);
+			offset += 8;
+
+			if (length > data.size() - offset)
+				throw std::runtime_error("glTF: truncated GLB chunk in " + path + "\n");
+
+			const auto* chunk = reinterpret_cast<const char*>(&data[offset]);
+
+			if (type == GLB_CHUNK_JSON && !haveJson) {
+				file.json = JsonParser(chunk, chunk + length).parse();
+				haveJson = true;
+			} else if (type == GLB_CHUNK_BIN && binChunk.empty()) {
+				binChunk.assign(data.begin() + static_cast<ptrdiff_t>(offset), data.begin() + static_cast<ptrdiff_t>(offset + length));
+			}
+
+			offset += (length + 3) & ~3u;
+		}
+
+		if (!haveJson)
+			throw std::runtime_error("glTF: no JSON chunk in " + path + "\n");
+	} else {
+		const auto* text = reinterpret_cast<const char*>(data.data());
+		file.json = JsonParser(text, text + data.size()).parse();
+	}
+
+	const auto& required = file.json["extensionsRequired"];
+
+	if (required.size() > 0)
+		throw std::runtime_error("glTF: required extension " + required[0].string + " isn't supported\n");
+
+	const std::filesystem::path directory = std::filesystem::path(path).parent_path();
+	const auto& buffers = file.json["buffers"];
+
+	for (size_t i = 0; i < buffers.size(); i++) {
+		const auto& buffer = buffers[i];
+		const std::string& uri = buffer["uri"].string;
+		std::vector<uint8_t> bytes;
+
+		if (buffer["uri"].isNull()) {
+			bytes = std::move(binChunk);
+		} else if (uri.compare(0, 5, "data:") == 0) {
+			const size_t comma = uri.find(',');
+
+			if (comma == std::string::npos || uri.rfind(";base64", comma) == std::string::npos)
+				throw std::runtime_error("glTF: only base64 data URIs are supported\n");
+
+			bytes = decodeBase64(uri.data() + comma + 1, uri.data() + uri.size());
+		} else {
+			bytes = readFile((directory / decodeUri(uri)).string());
+		}
+
+		if (bytes.size() < buffer["byteLength"].index("buffer byteLength"))
+			throw std::runtime_error("glTF: buffer " + std::to_string(i) + " is shorter than its byteLength\n");
+
+		file.buffers.push_back(std::move(bytes));
+	}
+
+	return file;
+}
+
+// Where an accessor's elements are, checked against the buffer.
+struct GltfAccessor {
+	const uint8_t* data = nullptr;
+	size_t count = 0;
+	size_t stride = 0;
+	uint32_t componentType = 0;
+	uint32_t components = 0;
+	bool normalized = false;
+};
+
+uint32_t componentSize(uint32_t componentType) {
+	switch (componentType) {
+	case Byte:
+	case UnsignedByte:
+		return 1;
+	case Short:
+	case UnsignedShort:
+		return 2;
+	case UnsignedInt:
+	case Float:
+		return 4;
+	default:
+		throw std::runtime_error("glTF: bad accessor componentType\n");
+	}
+}
+
+GltfAccessor gltfAccessor(const GltfFile& file, size_t index) {
+	const auto& accessor = file.json["accessors"][index];
+
+	if (accessor.isNull())
+		throw std::runtime_error("glTF: accessor " + std::to_string(index) + " doesn't exist\n");
+
+	if (!accessor["sparse"].isNull())
+		throw std::runtime_error("glTF: sparse accessors aren't supported\n");
+
+	GltfAccessor out;
+	out.count = accessor["count"].index("accessor count");
+	out.componentType = static_cast<uint32_t>(accessor["componentType"].index("accessor componentType"));
+	out.normalized = accessor["normalized"].boolean;
+
+	const std::string& type = accessor["type"].string;
+	out.components = type == "SCALAR" ? 1 : type == "VEC2" ? 2 : type == "VEC3" ? 3 : type == "VEC4" ? 4 : 0;
+
+	if (out.components == 0)
+		throw std::runtime_error("glTF: unsupported accessor type " + type + "\n");
+
+	const size_t elementSize = componentSize(out.componentType) * out.components;
+
+	// Accessors without a buffer view are all zeros, nothing a mesh can use.
+	const auto& view = file.json["bufferViews"][accessor["bufferView"].index("accessor bufferView")];
+	const size_t buffer = view["buffer"].index("bufferView buffer");
+
+	if (buffer >= file.buffers.size())
+		throw std::runtime_error("glTF: bufferView references a missing buffer\n");
+
+	const size_t offset = static_cast<size_t>(view["byteOffset"].numberOr(0)) + static_cast<size_t>(accessor["byteOffset"].numberOr(0));
+	const size_t viewEnd = static_cast<size_t>(view["byteOffset"].numberOr(0)) + view["byteLength"].index("bufferView byteLength");
+	out.stride = static_cast<size_t>(view["byteStride"].numberOr(static_cast<double>(elementSize)));
+
+	if (out.count > 0 && (viewEnd > file.buffers[buffer].size() || offset + (out.count - 1) * out.stride + elementSize > viewEnd))
+		throw std::runtime_error("glTF: accessor " + std::to_string(index) + " reads past its buffer view\n");
+
+	out.data = file.buffers[buffer].data() + offset;
+
+	return out;
+}
+
+float readComponent(const uint8_t* p, uint32_t componentType, bool normalized) {
+	switch (componentType) {
+	case Float: {
+		float value;
+		memcpy(&value, p, sizeof value);
+		return value;
+	}
+	case Byte: {
+		const auto value = static_cast<float>(static_cast<int8_t>(*p));
+		return normalized ? std::max(value / 127.0f, -1.0f) : value;
+	}
+	case UnsignedByte:
+		return normalized ? *p / 255.0f : static_cast<float>(*p);
+	case Short: {
+		int16_t value;
+		memcpy(&value, p, sizeof value);
+		return normalized ? std::max(value / 32767.0f, -1.0f) : static_cast<float>(value);
+	}
+	case UnsignedShort: {
+		uint16_t value;
+		memcpy(&value, p, sizeof value);
+		return normalized ? value / 65535.0f : static_cast<float>(value);
+	}
+	default: {
+		uint32_t value;
+		memcpy(&value, p, sizeof value);
+		return normalized ? static_cast<float>(value / 4294967295.0) : static_cast<float>(value);
+	}
+	}
+}
+
+// The first components of every element, widened to float.
+void readFloats(const GltfAccessor& accessor, uint32_t components, float* out) {
+	const uint32_t size = componentSize(accessor.componentType);
+	const uint32_t count = std::min(components, accessor.components);
+
+	for (size_t i = 0; i < accessor.count; i++) {
+		const uint8_t* element = accessor.data + i * accessor.stride;
+
+		for (uint32_t k = 0; k < count; k++)
+			out[i * components + k] = readComponent(element + k * size, accessor.componentType, accessor.normalized);
+	}
+}
+
+std::vector<uint32_t> readIndices(const GltfAccessor& accessor) {
+	if (accessor.components != 1 || (accessor.componentType != UnsignedByte && accessor.componentType != UnsignedShort && accessor.componentType != UnsignedInt))
+		throw std::runtime_error("glTF: indices must be unsigned scalars\n");
+
+	std::vector<uint32_t> indices(accessor.count);
+	const uint32_t size = componentSize(accessor.componentType);
+
+	for (size_t i = 0; i < accessor.count; i++) {
+		uint32_t value = 0;
+		memcpy(&value, accessor.data + i * accessor.stride, size); // Little endian, the low bytes
+		indices[i] = value;
+	}
+
+	return indices;
+}
+
+float4x4 gltfNodeMatrix(const JsonValue& node) {
+	const auto& matrix = node["matrix"];
+
+	if (matrix.size() == 16) {
+		float4x4 m;
+
+		for (int c = 0; c < 4; c++)
+			for (int r = 0; r < 4; r++)
+				m.columns[c][r] = static_cast<float>(matrix[c * 4 + r].numberOr(0));
+
+		return m;
+	}
+
+	const auto& t = node["translation"];
+	const auto& r = node["rotation"];
+	const auto& s = node["scale"];
+
+	const float4x4 translation = matrix4x4_translation(static_cast<float>(t[0].numberOr(0)), static_cast<float>(t[1].numberOr(0)), static_cast<float>(t[2].numberOr(0)));
+	const float4x4 rotation = matrix4x4_from_quaternion(quaternion(static_cast<float>(r[0].numberOr(0)), static_cast<float>(r[1].numberOr(0)),
+	                                                               static_cast<float>(r[2].numberOr(0)), static_cast<float>(r[3].numberOr(1))));
+	const float4x4 scale = matrix4x4_scale(static_cast<float>(s[0].numberOr(1)), static_cast<float>(s[1].numberOr(1)), static_cast<float>(s[2].numberOr(1)));
+
+	return translation * rotation * scale;
+}
+
+struct GltfPrimitive {
+	const JsonValue* primitive;
+	float4x4 world;
+};
+
+// Every triangle primitive of the default scene with its node's world matrix. Files without scenes
+// are a library of meshes, those are taken as is.
+std::vector<GltfPrimitive> gltfPrimitives(const JsonValue& json) {
+	std::vector<std::pair<size_t, float4x4>> instances;
+	const auto& nodes = json["nodes"];
+	const auto& scenes = json["scenes"];
+
+	if (scenes.size() == 0) {
+		for (size_t m = 0; m < json["meshes"].size(); m++)
+			instances.emplace_back(m, matrix4x4_identity());
+	} else {
+		const auto& roots = scenes[static_cast<size_t>(json["scene"].numberOr(0))]["nodes"];
+		std::vector<std::pair<size_t, float4x4>> stack;
+		std::vector<bool> visited(nodes.size(), false);
+
+		for (size_t i = 0; i < roots.size(); i++)
+			stack.emplace_back(roots[i].index("scene node"), matrix4x4_identity());
+
+		while (!stack.empty()) {
+			const auto [index, parent] = stack.back();
+			stack.pop_back();
+
+			// Nodes form a forest, a node seen twice is a broken file, not a second instance.
+			if (index >= nodes.size() || visited[index])
+				continue;
+
+			visited[index] = true;
+
+			const auto& node = nodes[index];
+			const float4x4 world = parent * gltfNodeMatrix(node);
+
+			if (!node["mesh"].isNull())
+				instances.emplace_back(node["mesh"].index("node mesh"), world);
+
+			for (size_t c = 0; c < node["children"].size(); c++)
+				stack.emplace_back(node["children"][c].index("node child"), world);
+		}
+	}
+
+	std::vector<GltfPrimitive> primitives;
+
+	for (const auto& [mesh, world] : instances) {
+		const auto& list = json["meshes"][mesh]["primitives"];
+
+		for (size_t p = 0; p < list.size(); p++)
+			if (list[p]["mode"].numberOr(4) == 4)
+				primitives.push_back({ &list[p], world });
+	}
+
+	return primitives;
+}
+
+void readGltfPrimitive(const GltfFile& file, const GltfPrimitive& primitive, MeshPiece& piece) {
+	const auto& attributes = (*primitive.primitive)["attributes"];
+
+	if (attributes["POSITION"].isNull())
+		return;
+
+	const GltfAccessor positions = gltfAccessor(file, attributes["POSITION"].index("POSITION"));
+	const size_t count = positions.count;
+
+	std::vector<float> position(count * 3, 0.0f), normal, uv(count * 2, 0.0f);
+	readFloats(positions, 3, position.data());
+
+	const bool hasNormals = !attributes["NORMAL"].isNull();
+
+	if (hasNormals) {
+		const GltfAccessor normals = gltfAccessor(file, attributes["NORMAL"].index("NORMAL"));
+
+		if (normals.count != count)
+			throw std::runtime_error("glTF: NORMAL and POSITION counts differ\n");
+
+		normal.assign(count * 3, 0.0f);
+		readFloats(normals, 3, normal.data());
+	}
+
+	if (!attributes["TEXCOORD_0"].isNull()) {
+		const GltfAccessor uvs = gltfAccessor(file, attributes["TEXCOORD_0"].index("TEXCOORD_0"));
+
+		if (uvs.count != count)
+			throw std::runtime_error("glTF: TEXCOORD_0 and POSITION counts differ\n");
+
+		readFloats(uvs, 2, uv.data());
+	}
+
+	std::vector<uint32_t> indices;
+	const auto& indexAccessor = (*primitive.primitive)["indices"];
+
+	if (indexAccessor.isNull()) {
+		indices.resize(count);
+		std::iota(indices.begin(), indices.end(), 0u);
+	} else {
+		indices = readIndices(gltfAccessor(file, indexAccessor.index("indices")));
+	}
+
+	indices.resize(indices.size() / 3 * 3);
+
+	// Mirroring transforms turn the winding around, swap two corners to keep the front faces.
+	const float3x3 upperLeft = matrix3x3_upper_left(primitive.world);
+	const float3x3 normalMatrix = matrix_inverse_transpose(upperLeft);
+	const float3& a = upperLeft.columns[0];
+	const float3& b = upperLeft.columns[1];
+	const float3& c = upperLeft.columns[2];
+	const bool mirrored = a.x * (b.y * c.z - b.z * c.y) - a.y * (b.x * c.z - b.z * c.x) + a.z * (b.x * c.y - b.y * c.x) < 0;
+
+	std::vector<MeshVertex> corners(indices.size());
+
+	for (size_t i = 0; i < indices.size(); i++) {
+		const size_t corner = !mirrored || i % 3 == 0 ? i : i % 3 == 1 ? i + 1 : i - 1;
+		const uint32_t index = indices[corner];
+
+		if (index >= count)
+			throw std::runtime_error("glTF: index out of range\n");
+
+		MeshVertex& v = corners[i];
+		const float4 p = primitive.world * float4{ position[index * 3], position[index * 3 + 1], position[index * 3 + 2], 1.0f };
+		v.position[0] = p.x;
+		v.position[1] = p.y;
+		v.position[2] = p.z;
+
+		if (hasNormals) {
+			const float3 n = normalMatrix * float3{ normal[index * 3], normal[index * 3 + 1], normal[index * 3 + 2] };
+			const float length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+			const float scale = length > 0 ? 1.0f / length : 0.0f;
+
+			v.normal[0] = n.x * scale;
+			v.normal[1] = n.y * scale;
+			v.normal[2] = n.z * scale;
+		} else {
+			v.normal[0] = v.normal[1] = v.normal[2] = 0;
+		}
+
+		v.uv[0] = uv[index * 2];
+		v.uv[1] = uv[index * 2 + 1];
+	}
+
+	weld(piece, corners.data(), corners.size());
+
+	if (!hasNormals && !piece.vertices.empty())
+		computeNormals(piece);
+}
+
+}
+
+IndexedMesh<MeshVertex> importObj(const std::string& path) {
+	const std::vector<uint8_t> data = readFile(path);
+	const auto* text = reinterpret_cast<const char*>(data.data());
+	const char* textEnd = text + data.size();
+
+	// Chunks of at least 1MB, a few per thread, cut at line starts.
+	constexpr size_t MIN_CHUNK_BYTES = 1 << 20;
+	const size_t chunkCount = std::clamp<size_t>(data.size() / MIN_CHUNK_BYTES, 1, static_cast<size_t>(parallelThreadCount()) * 4);
+	std::vector<ObjChunk> chunks(chunkCount);
+
+	const char* chunkBegin = text;
+
+	for (size_t c = 0; c < chunkCount; c++) {
+		const char* chunkEnd = c + 1 == chunkCount ? textEnd : text + data.size() * (c + 1) / chunkCount;
+
+		if (chunkEnd < chunkBegin)
+			chunkEnd = chunkBegin;
+
+		while (chunkEnd < textEnd && chunkEnd[-1] != '\n')
+			chunkEnd++;
+
+		chunks[c].begin = chunkBegin;
+		chunks[c].end = chunkEnd;
+		chunkBegin = chunkEnd;
+	}
+
+	// Counting pass, so each chunk knows how many attributes come before it. Negative indices are
+	// relative to the attributes read so far.
+	parallelFor(chunkCount, 1, [&](size_t begin, size_t end) {
+		for (size_t c = begin; c < end; c++)
+			forEachLine(chunks[c].begin, chunks[c].end, [&](const char* p, const char* lineEnd) {
+				switch (objLine(p, lineEnd)) {
+				case ObjLine::Position: chunks[c].positionCount++; break;
+				case ObjLine::UV: chunks[c].uvCount++; break;
+				case ObjLine::Normal: chunks[c].normalCount++; break;
+				default: break;
+				}
+			});
+	});
+
+	for (size_t c = 1; c < chunkCount; c++) {
+		chunks[c].positionBase = chunks[c - 1].positionBase + chunks[c - 1].positionCount;
+		chunks[c].uvBase = chunks[c - 1].uvBase + chunks[c - 1].uvCount;
+		chunks[c].normalBase = chunks[c - 1].normalBase + chunks[c - 1].normalCount;
+	}
+
+	parallelFor(chunkCount, 1, [&](size_t begin, size_t end) {
+		for (size_t c = begin; c < end; c++) {
+			chunks[c].positions.reserve(chunks[c].positionCount * 3);
+			chunks[c].uvs.reserve(chunks[c].uvCount * 2);
+			chunks[c].normals.reserve(chunks[c].normalCount * 3);
+			parseObjChunk(chunks[c]);
+		}
+	});
+
+	std::vector<float> positions, uvs, normals;
+
+	for (auto& chunk : chunks) {
+		if (!chunk.error.empty())
+			throw std::runtime_error("OBJ " + path + ": " + chunk.error + "\n");
+
+		positions.insert(positions.end(), chunk.positions.begin(), chunk.positions.end());
+		uvs.insert(uvs.end(), chunk.uvs.begin(), chunk.uvs.end());
+		normals.insert(normals.end(), chunk.normals.begin(), chunk.normals.end());
+		chunk.positions = {};
+		chunk.uvs = {};
+		chunk.normals = {};
+	}
+
+	std::vector<MeshPiece> pieces(chunkCount);
+
+	parallelFor(chunkCount, 1, [&](size_t begin, size_t end) {
+		for (size_t c = begin; c < end; c++)
+			weldObjChunk(chunks[c], positions, uvs, normals, pieces[c]);
+	});
+
+	for (auto& piece : pieces)
+		if (!piece.error.empty())
+			piece.error = "OBJ " + path + ": " + piece.error + "\n";
+
+	auto mesh = mergePieces(pieces, true);
+
+	if (normals.empty() && !mesh.vertices.empty()) {
+		MeshPiece piece;
+		piece.vertices = std::move(mesh.vertices);
+		piece.indices = mesh.indices();
+		computeNormals(piece);
+
+		mesh.vertices = std::move(piece.vertices);
+	}
+
+	return finishMesh(std::move(mesh), path);
+}
+
+IndexedMesh<MeshVertex> importGltf(const std::string& path) {
+	const GltfFile file = loadGltf(path);
+	const std::vector<GltfPrimitive> primitives = gltfPrimitives(file.json);
+	std::vector<MeshPiece> pieces(primitives.size());
+
+	parallelFor(primitives.size(), 1, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			try {
+				readGltfPrimitive(file, primitives[i], pieces[i]);
+			} catch (const std::exception& e) {
+				pieces[i].error = path + ": " + e.what();
+			}
+		}
+	});
+
+	return finishMesh(mergePieces(pieces, false), path);
+}
+
+IndexedMesh<MeshVertex> importMesh(const std::string& path) {
+	std::string extension = std::filesystem::path(path).extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+
+	if (extension == ".obj")
+		return importObj(path);
+
+	if (extension == ".gltf" || extension == ".glb")
+		return importGltf(path);
+
+	throw std::runtime_error("Unsupported mesh format " + path + "\n");
+}
+
+std::string cookedMeshPath(const std::string& source, const std::string& cacheDirectory) {
+	const std::filesystem::path sourcePath(source);
+	const std::string absolute = std::filesystem::absolute(sourcePath).lexically_normal().string();
+
+	char hash[17];
+	snprintf(hash, sizeof hash, "%016llx", static_cast<unsigned long long>(hashBytes(absolute.data(), absolute.size())));
+
+	return (std::filesystem::path(cacheDirectory) / (sourcePath.stem().string() + "-" + hash + ".amesh")).string();
+}
+
+CookedMesh loadMesh(const std::string& source, const std::string& cacheDirectory, UVFormat uvFormat) {
+	std::error_code error;
+	const uint64_t sourceSize = std::filesystem::file_size(source, error);
+	const auto sourceTime = static_cast<int64_t>(std::filesystem::last_write_time(source, error).time_since_epoch().count());
+
+	if (error)
+		throw std::runtime_error("Failed to open mesh " + source + "\n");
+
+	const std::string cachePath = cookedMeshPath(source, cacheDirectory);
+	CookedMesh mesh;
+
+	if (mesh.open(cachePath)) {
+		const auto& header = mesh.header();
+
+		if (header.sourceSize == sourceSize && header.sourceTime == sourceTime && header.quantization.uvFormat == static_cast<uint32_t>(uvFormat))
+			return mesh;
+
+		mesh.close();
+	}
+
+	writeCookedMesh(cachePath, importMesh(source), uvFormat, sourceSize, sourceTime);
+
+	if (!mesh.open(cachePath))
+		throw std::runtime_error("Failed to map cooked mesh " + cachePath + "\n");
+
+	return mesh;
+}
+
+std::vector<CookedMesh> loadMeshes(const std::vector<std::string>& sources, const std::string& cacheDirectory, UVFormat uvFormat) {
+	std::vector<CookedMesh> meshes(sources.size());
+	std::vector<std::string> errors(sources.size());
+
+	parallelFor(sources.size(), 1, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) {
+			try {
+				meshes[i] = loadMesh(sources[i], cacheDirectory, uvFormat);
+			} catch (const std::exception& e) {
+				errors[i] = e.what();
+			}
+		}
+	});
+
+	for (const auto& error : errors)
+		if (!error.empty())
+			throw std::runtime_error(error);
+
+	return meshes;
+}
+
+}
@@ -0,0 +1,339 @@
+// ReSharper disable CppInconsistentNaming
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numeric>
+
+namespace Atom {
+
+namespace {
+
+// FIFO cache as a ring of vertex ids plus the ring position each vertex was inserted at, so a lookup
+// is one compare instead of a scan.
+class FifoCache {
+public:
+	FifoCache(size_t vertexCount, uint32_t size) : mInsertedAt(vertexCount, 0), mSize(size) {}
+
+	// True if the vertex had to be transformed.
+	bool access(uint32_t vertex) {
+		if (mInsertedAt[vertex] != 0 && mTime - mInsertedAt[vertex] < mSize)
+			return false;
+
+		mInsertedAt[vertex] = ++mTime;
+		return true;
+	}
+
+	void flush() {
+		mTime += mSize;
+	}
+
+private:
+	std::vector<uint32_t> mInsertedAt;
+	uint32_t mSize;
+	uint32_t mTime = 0;
+};
+
+// Triangles using each vertex, compressed: triangles of vertex v are
+// triangles[offsets[v]] .. triangles[offsets[v + 1]].
+struct Adjacency {
+	std::vector<uint32_t> offsets;
+	std::vector<uint32_t> triangles;
+
+	Adjacency(const uint32_t* indices, size_t indexCount, size_t vertexCount) : offsets(vertexCount + 1, 0), triangles(indexCount) {
+		for (size_t i = 0; i < indexCount; i++)
+			offsets[indices[i] + 1]++;
+
+		std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+		std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+
+		for (size_t i = 0; i < indexCount; i++)
+			triangles[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+	}
+};
+
+}
+
+VertexCacheStats analyzeVertexCache(const uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize) {
+	VertexCacheStats stats;
+
+	if (indexCount < 3)
+		return stats;
+
+	FifoCache cache(vertexCount, cacheSize);
+	std::vector<bool> referenced(vertexCount, false);
+	size_t referencedCount = 0;
+
+	for (size_t i = 0; i < indexCount; i++) {
+		stats.vertexTransforms += cache.access(indices[i]);
+
+		if (!referenced[indices[i]]) {
+			referenced[indices[i]] = true;
+			referencedCount++;
+		}
+	}
+
+	stats.acmr = static_cast<float>(stats.vertexTransforms) / static_cast<float>(indexCount / 3);
+	stats.atvr = static_cast<float>(stats.vertexTransforms) / static_cast<float>(referencedCount);
+
+	return stats;
+}
+
+// Fans around one vertex at a time, emitting all its remaining triangles, then moves to the
+// neighbour that is still in the cache and has the most work left that fits in it. When nothing
+// qualifies it falls back to recently used vertices, then to the next vertex with triangles left.
+void optimizeVertexCache(uint32_t* indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize) {
+	const size_t triangleCount = indexCount / 3;
+
+	if (triangleCount == 0 || vertexCount == 0)
+		return;
+
+	const Adjacency adjacency(indices, indexCount, vertexCount);
+
+	std::vector<uint32_t> liveTriangles(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+		liveTriangles[v] = adjacency.offsets[v + 1] - adjacency.offsets[v];
+
+	std::vector<uint32_t> cacheTime(vertexCount, 0);
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<uint32_t> deadEnds;
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> result;
+	result.reserve(indexCount);
+
+	uint32_t time = cacheSize + 1;
+	size_t cursor = 0;
+	int64_t fanning = 0;
+
+	while (fanning >= 0) {
+		const auto f = static_cast<uint32_t>(fanning);
+		candidates.clear();
+
+		for (uint32_t a = adjacency.offsets[f]; a < adjacency.offsets[f + 1]; a++) {
+			const uint32_t t = adjacency.triangles[a];
+
+			if (emitted[t])
+				continue;
+
+			for (int k = 0; k < 3; k++) {
+				const uint32_t v = indices[t * 3 + k];
+
+				result.push_back(v);
+				deadEnds.push_back(v);
+				candidates.push_back(v);
+				liveTriangles[v]--;
+
+				if (time - cacheTime[v] > cacheSize)
+					cacheTime[v] = time++;
+			}
+
+			emitted[t] = true;
+		}
+
+		// Best candidate still in the cache after its remaining triangles are emitted.
+		fanning = -1;
+		int64_t bestPriority = -1;
+
+		for (const uint32_t v : candidates) {
+			if (liveTriangles[v] == 0)
+				continue;
+
+			int64_t priority = 0;
+
+			if (time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize)
+				priority = time - cacheTime[v];
+
+			if (priority > bestPriority) {
+				bestPriority = priority;
+				fanning = v;
+			}
+		}
+
+		if (fanning >= 0)
+			continue;
+
+		while (!deadEnds.empty()) {
+			const uint32_t v = deadEnds.back();
+			deadEnds.pop_back();
+
+			if (liveTriangles[v] > 0) {
+				fanning = v;
+				break;
+			}
+		}
+
+		if (fanning >= 0)
+			continue;
+
+		for (; cursor < vertexCount; cursor++)
+			if (liveTriangles[cursor] > 0) {
+				fanning = static_cast<int64_t>(cursor);
+				break;
+			}
+	}
+
+	memcpy(indices, result.data(), result.size() * sizeof(uint32_t));
+}
+
+void optimizeOverdraw(uint32_t* indices, size_t indexCount, const float* positions, size_t vertexCount, size_t positionStride, uint32_t cacheSize, float threshold) {
+	const size_t triangleCount = indexCount / 3;
+
+	if (triangleCount < 2 || vertexCount == 0)
+		return;
+
+	const auto position = [&](uint32_t v) {
+		return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + v * positionStride);
+	};
+
+	// Hard boundaries, triangles where all three vertices missed. The cache restarts there anyway.
+	std::vector<uint32_t> hardClusters;
+	std::vector<uint8_t> misses(triangleCount);
+	{
+		FifoCache cache(vertexCount, cacheSize);
+
+		for (size_t t = 0; t < triangleCount; t++) {
+			misses[t] = static_cast<uint8_t>(cache.access(indices[t * 3]) + cache.access(indices[t * 3 + 1]) + cache.access(indices[t * 3 + 2]));
+
+			if (misses[t] == 3 || t == 0)
+				hardClusters.push_back(static_cast<uint32_t>(t));
+		}
+	}
+
+	hardClusters.push_back(static_cast<uint32_t>(triangleCount));
+
+	// Soft boundaries, split a hard cluster wherever the part so far is already within threshold of
+	// its ACMR. Splitting flushes the cache, the next part starts cold.
+	std::vector<uint32_t> clusters;
+	{
+		FifoCache cache(vertexCount, cacheSize);
+
+		for (size_t c = 0; c + 1 < hardClusters.size(); c++) {
+			const uint32_t begin = hardClusters[c], end = hardClusters[c + 1];
+
+			uint32_t clusterMisses = 0;
+			for (uint32_t t = begin; t < end; t++)
+				clusterMisses += misses[t];
+
+			const float targetAcmr = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+
+			cache.flush();
+			clusters.push_back(begin);
+
+			uint32_t partStart = begin, partMisses = 0;
+
+			for (uint32_t t = begin; t < end; t++) {
+				partMisses += cache.access(indices[t * 3]) + cache.access(indices[t * 3 + 1]) + cache.access(indices[t * 3 + 2]);
+
+				if (t + 1 < end && static_cast<float>(partMisses) <= targetAcmr * static_cast<float>(t + 1 - partStart)) {
+					clusters.push_back(t + 1);
+					cache.flush();
+					partStart = t + 1;
+					partMisses = 0;
+				}
+			}
+		}
+	}
+
+	clusters.push_back(static_cast<uint32_t>(triangleCount));
+
+	// Area weighted centroid of everything, and per cluster centroid and average normal.
+	const size_t clusterCount = clusters.size() - 1;
+	std::vector<float> clusterData(clusterCount * 7, 0.0f);
+	float meshCenter[3] = { 0, 0, 0 };
+	float meshArea = 0;
+	double signedVolume = 0;
+
+	for (size_t c = 0; c < clusterCount; c++) {
+		float* data = &clusterData[c * 7]; // centroid xyz, normal xyz, area
+
+		for (uint32_t t = clusters[c]; t < clusters[c + 1]; t++) {
+			const float* a = position(indices[t * 3]);
+			const float* b = position(indices[t * 3 + 1]);
+			const float* d = position(indices[t * 3 + 2]);
+
+			const float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+			const float e2[3] = { d[0] - a[0], d[1] - a[1], d[2] - a[2] };
+			const float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+			const float area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+			for (int k = 0; k < 3; k++) {
+				data[k] += (a[k] + b[k] + d[k]) / 3 * area;
+				data[3 + k] += n[k];
+			}
+
+			data[6] += area;
+			signedVolume += a[0] * n[0] + a[1] * n[1] + a[2] * n[2];
+		}
+
+		for (int k = 0; k < 3; k++)
+			meshCenter[k] += data[k];
+
+		meshArea += data[6];
+	}
+
+	if (meshArea > 0)
+		for (float& k : meshCenter)
+			k /= meshArea;
+
+	// Normals come out of the cross product pointing outwards for counter clockwise triangles. A
+	// closed mesh with the other winding has negative volume, flip them so either works.
+	const float outwards = signedVolume < 0 ? -1.0f : 1.0f;
+
+	std::vector<float> sortKeys(clusterCount);
+
+	for (size_t c = 0; c < clusterCount; c++) {
+		const float* data = &clusterData[c * 7];
+		const float area = data[6] > 0 ? data[6] : 1.0f;
+		const float length = std::sqrt(data[3] * data[3] + data[4] * data[4] + data[5] * data[5]);
+		const float inverseLength = length > 0 ? 1.0f / length : 0.0f;
+
+		float key = 0;
+		for (int k = 0; k < 3; k++)
+			key += (data[k] / area - meshCenter[k]) * data[3 + k] * inverseLength;
+
+		sortKeys[c] = key * outwards;
+	}
+
+	std::vector<uint32_t> order(clusterCount);
+	std::iota(order.begin(), order.end(), 0u);
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+	std::vector<uint32_t> result;
+	result.reserve(triangleCount * 3);
+
+	for (const uint32_t c : order)
+		result.insert(result.end(), indices + clusters[c] * 3, indices + clusters[c + 1] * 3);
+
+	memcpy(indices, result.data(), result.size() * sizeof(uint32_t));
+}
+
+size_t optimizeVertexFetch(void* vertices, uint32_t* indices, size_t indexCount, size_t vertexCount, size_t vertexSize) {
+	constexpr uint32_t UNUSED = UINT32_MAX;
+
+	std::vector<uint32_t> remap(vertexCount, UNUSED);
+	uint32_t next = 0;
+
+	for (size_t i = 0; i < indexCount; i++) {
+		uint32_t& target = remap[indices[i]];
+
+		if (target == UNUSED)
+			target = next++;
+
+		indices[i] = target;
+	}
+
+	const auto* source = static_cast<const uint8_t*>(vertices);
+	std::vector<uint8_t> reordered(static_cast<size_t>(next) * vertexSize);
+
+	for (size_t v = 0; v < vertexCount; v++)
+		if (remap[v] != UNUSED)
+			memcpy(&reordered[remap[v] * vertexSize], source + v * vertexSize, vertexSize);
+
+	memcpy(vertices, reordered.data(), reordered.size());
+
+	return next;
+}
+
+}
@@ -0,0 +1,270 @@
+// ReSharper disable CppInconsistentNaming
+#include "MipChain.hpp"
+#include "AtomSimd.hpp"
+#include "ParallelFor.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Atom {
+
+using namespace Simd;
+
+namespace {
+
+constexpr double PI_D = 3.14159265358979323846;
+
+constexpr float KAISER_RADIUS = 2.0f; // In destination pixels
+constexpr float KAISER_ALPHA = 4.0f;
+
+// Roughly this many pixels per parallelFor chunk, smaller levels run on the caller.
+constexpr size_t PIXELS_PER_CHUNK = 1 << 15;
+
+float srgbToLinear(float c) {
+	return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+float linearToSrgb(float c) {
+	return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+}
+
+// 8 bit sRGB to linear, and linear quantized to 16 bits back to 8 bit sRGB. 16 bits are fine enough
+// that the table only differs from the exact conversion where it rounds within a hair of .5.
+struct SrgbTables {
+	float toLinear[256];
+	uint8_t fromLinear[65536];
+
+	SrgbTables() {
+		for (int i = 0; i < 256; i++)
+			toLinear[i] = srgbToLinear(i / 255.0f);
+
+		for (int i = 0; i < 65536; i++)
+			fromLinear[i] = static_cast<uint8_t>(std::lround(linearToSrgb(i / 65535.0f) * 255.0f));
+	}
+};
+
+const SrgbTables& srgbTables() {
+	static const SrgbTables tables;
+	return tables;
+}
+
+// Zeroth order modified Bessel function of the first kind, the Kaiser window's building block.
+double besselI0(double x) {
+	double sum = 1, term = 1;
+
+	for (int k = 1; k < 32; k++) {
+		term *= (x / (2 * k)) * (x / (2 * k));
+		sum += term;
+
+		if (term < sum * 1e-12)
+			break;
+	}
+
+	return sum;
+}
+
+// Source pixels and weights that make up each destination pixel along one axis. Taps past the edges
+// are clamped to the edge pixel when the filter runs.
+struct AxisFilter {
+	std::vector<int32_t> first;   // Per destination pixel
+	std::vector<uint32_t> offset; // Into weights, per destination pixel plus one
+	std::vector<float> weights;
+};
+
+AxisFilter axisFilter(uint32_t source, uint32_t destination, MipFilter filter) {
+	AxisFilter f;
+	const double ratio = static_cast<double>(source) / destination;
+
+	f.offset.push_back(0);
+
+	for (uint32_t x = 0; x < destination; x++) {
+		const double center = (x + 0.5) * ratio;
+		int32_t begin, end;
+
+		if (filter == MipFilter::Box) {
+			begin = static_cast<int32_t>(std::floor(x * ratio));
+			end = static_cast<int32_t>(std::ceil((x + 1) * ratio));
+		} else {
+			begin = static_cast<int32_t>(std::floor(center - KAISER_RADIUS * ratio));
+			end = static_cast<int32_t>(std::ceil(center + KAISER_RADIUS * ratio));
+		}
+
+		const size_t start = f.weights.size();
+		double total = 0;
+
+		for (int32_t i = begin; i < end; i++) {
+			double w;
+
+			if (filter == MipFilter::Box) {
+				// Overlap of source pixel [i, i + 1) with the destination footprint.
+				w = std::min<double>(i + 1, (x + 1) * ratio) - std::max<double>(i, x * ratio);
+			} else {
+				const double d = (i + 0.5 - center) / ratio;
+				const double t = d / KAISER_RADIUS;
+
+				if (t <= -1 || t >= 1)
+					continue;
+
+				const double sinc = d == 0 ? 1 : std::sin(PI_D * d) / (PI_D * d);
+				w = sinc * besselI0(KAISER_ALPHA * std::sqrt(1 - t * t)) / besselI0(KAISER_ALPHA);
+			}
+
+			if (f.weights.size() == start)
+				f.first.push_back(i);
+
+			f.weights.push_back(static_cast<float>(w));
+			total += w;
+		}
+
+		for (size_t i = start; i < f.weights.size(); i++)
+			f.weights[i] = static_cast<float>(f.weights[i] / total);
+
+		f.offset.push_back(static_cast<uint32_t>(f.weights.size()));
+	}
+
+	return f;
+}
+
+// RGBA float pixels, one Simd::Vec each.
+using Image = std::vector<float>;
+
+void decode(const uint8_t* rgba, size_t pixels, bool srgb, float* out) {
+	const auto& tables = srgbTables();
+	const float inv = 1.0f / 255.0f;
+
+	for (size_t i = 0; i < pixels; i++, rgba += 4, out += 4) {
+		if (srgb)
+			storeu(out, set(tables.toLinear[rgba[0]], tables.toLinear[rgba[1]], tables.toLinear[rgba[2]], rgba[3] * inv));
+		else
+			storeu(out, mul(set(rgba[0], rgba[1], rgba[2], rgba[3]), splat(inv)));
+	}
+}
+
+void encode(const float* pixels, size_t count, bool srgb, uint8_t* out) {
+	const auto& tables = srgbTables();
+
+	// sRGB channels index the 16 bit table, the rest round to 8 bits directly.
+	const Vec scale = srgb ? set(65535, 65535, 65535, 255) : splat(255);
+	alignas(16) float v[4];
+
+	for (size_t i = 0; i < count; i++, pixels += 4, out += 4) {
+		store(v, madd(min(max(loadu(pixels), zero()), splat(1)), scale, splat(0.5f)));
+
+		for (int c = 0; c < 4; c++) {
+			const auto q = static_cast<uint32_t>(v[c]);
+			out[c] = srgb && c < 3 ? tables.fromLinear[q] : static_cast<uint8_t>(q);
+		}
+	}
+}
+
+// Separable downsample, rows first into a width reduced copy, then columns. sourceRow(y, scratch)
+// returns row y as float pixels, decoding into scratch (width pixels) if it has to.
+template<typename SourceRow>
+void downsample(SourceRow&& sourceRow, uint32_t width, uint32_t height, Image& destination, uint32_t newWidth, uint32_t newHeight, MipFilter filter) {
+	const AxisFilter fx = axisFilter(width, newWidth, filter);
+	const AxisFilter fy = axisFilter(height, newHeight, filter);
+
+	Image rows(static_cast<size_t>(newWidth) * height * 4);
+	destination.assign(static_cast<size_t>(newWidth) * newHeight * 4, 0.0f);
+
+	parallelFor(height, std::max<size_t>(1, PIXELS_PER_CHUNK / width), [&](size_t begin, size_t end) {
+		Image scratch;
+
+		for (size_t y = begin; y < end; y++) {
+			const float* src = sourceRow(y, scratch);
+			float* dst = &rows[y * newWidth * 4];
+
+			for (uint32_t x = 0; x < newWidth; x++) {
+				Vec sum = zero();
+
+				for (uint32_t k = fx.offset[x]; k < fx.offset[x + 1]; k++) {
+					const int32_t i = std::clamp<int32_t>(fx.first[x] + static_cast<int32_t>(k - fx.offset[x]), 0, static_cast<int32_t>(width) - 1);
+					sum = madd(splat(fx.weights[k]), loadu(src + i * 4), sum);
+				}
+
+				storeu(dst + x * 4, sum);
+			}
+		}
+	});
+
+	parallelFor(newHeight, std::max<size_t>(1, PIXELS_PER_CHUNK / newWidth), [&](size_t begin, size_t end) {
+		for (size_t y = begin; y < end; y++) {
+			float* dst = &destination[y * newWidth * 4];
+
+			// Whole rows at a time, so the taps stream through memory instead of striding down columns.
+			for (uint32_t k = fy.offset[y]; k < fy.offset[y + 1]; k++) {
+				const int32_t row = std::clamp<int32_t>(fy.first[y] + static_cast<int32_t>(k - fy.offset[y]), 0, static_cast<int32_t>(height) - 1);
+				const float* src = &rows[static_cast<size_t>(row) * newWidth * 4];
+				const Vec w = splat(fy.weights[k]);
+
+				for (uint32_t x = 0; x < newWidth; x++)
+					storeu(dst + x * 4, madd(w, loadu(src + x * 4), loadu(dst + x * 4)));
+			}
+		}
+	});
+}
+
+}
+
+
+uint32_t mipLevelCount(uint32_t width, uint32_t height) {
+	uint32_t levels = 1;
+
+	for (uint32_t size = std::max(width, height); size > 1; size >>= 1)
+		levels++;
+
+	return levels;
+}
+
+MipChain generateMipChain(const uint8_t* rgba, uint32_t width, uint32_t height, bool srgb, MipFilter filter) {
+	MipChain chain;
+
+	if (width == 0 || height == 0)
+		return chain;
+
+	size_t bytes = 0;
+
+	for (uint32_t w = width, h = height, i = 0; i < mipLevelCount(width, height); i++, w = std::max(1u, w / 2), h = std::max(1u, h / 2)) {
+		chain.levels.push_back({ w, h, bytes });
+		bytes += chain.levels.back().bytes();
+	}
+
+	chain.data.resize(bytes);
+	memcpy(chain.data.data(), rgba, chain.levels[0].bytes());
+
+	if (chain.levels.size() == 1)
+		return chain;
+
+	// Level 0 is decoded a row at a time as the first pass reads it, the bytes are all there is of it.
+	Image current, next;
+
+	for (size_t i = 1; i < chain.levels.size(); i++) {
+		const MipLevel& above = chain.levels[i - 1];
+		const MipLevel& level = chain.levels[i];
+
+		if (i == 1)
+			downsample([&](size_t y, Image& scratch) {
+				scratch.resize(static_cast<size_t>(width) * 4);
+				decode(rgba + y * width * 4, width, srgb, scratch.data());
+				return static_cast<const float*>(scratch.data());
+			}, width, height, next, level.width, level.height, filter);
+		else
+			downsample([&](size_t y, Image&) {
+				return static_cast<const float*>(&current[y * above.width * 4]);
+			}, above.width, above.height, next, level.width, level.height, filter);
+
+		std::swap(current, next);
+
+		const size_t count = static_cast<size_t>(level.width) * level.height;
+		uint8_t* out = chain.data.data() + level.offset;
+
+		parallelFor(count, PIXELS_PER_CHUNK, [&](size_t begin, size_t end) {
+			encode(&current[begin * 4], end - begin, srgb, out + begin * 4);
+		});
+	}
+
+	return chain;
+}
+
+}
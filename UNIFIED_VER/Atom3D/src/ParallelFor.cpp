@@ -0,0 +1,22 @@
+// ReSharper disable CppInconsistentNaming
+#include "ParallelFor.hpp"
+#include "JobSystem.hpp"
+
+#include <algorithm>
+
+namespace Atom {
+
+void parallelFor(size_t count, size_t minChunk, const std::function<void(size_t, size_t)>& body) {
+	auto& jobs = jobSystem();
+
+	// Stealing keeps threads busy, so the chunks can be smaller than an even split, but not so small
+	// that a tiny minChunk floods the deques.
+	const size_t slots = static_cast<size_t>(jobs.threadCount()) * 8;
+	jobs.parallelFor(count, std::max(minChunk, count / slots), body);
+}
+
+uint32_t parallelThreadCount() {
+	return jobSystem().threadCount();
+}
+
+}
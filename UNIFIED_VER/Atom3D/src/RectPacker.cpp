@@ -0,0 +1,225 @@
+// ReSharper disable CppInconsistentNaming
+#include "RectPacker.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace Atom {
+
+void SkylinePacker::reset(uint32_t width, uint32_t height) {
+	mWidth = width;
+	mHeight = height;
+	mUsed = 0;
+	mSkyline.assign(1, { 0, 0, width });
+}
+
+bool SkylinePacker::insert(uint32_t w, uint32_t h, PackRect& placed) {
+	// Lowest resulting top edge, then the least wasted width.
+	size_t best = SIZE_MAX;
+	uint32_t bestY = UINT32_MAX, bestWidth = UINT32_MAX;
+
+	for (size_t i = 0; i < mSkyline.size(); i++) {
+		if (mSkyline[i].x + w > mWidth)
+			break;
+
+		// The rectangle sits on the highest segment it spans.
+		uint32_t y = 0, remaining = w;
+
+		for (size_t j = i; remaining > 0; j++) {
+			y = std::max(y, mSkyline[j].y);
+			remaining -= std::min(remaining, mSkyline[j].width);
+		}
+
+		if (y + h > mHeight)
+			continue;
+
+		if (y + h < bestY || (y + h == bestY && mSkyline[i].width < bestWidth)) {
+			best = i;
+			bestY = y + h;
+			bestWidth = mSkyline[i].width;
+		}
+	}
+
+	if (best == SIZE_MAX)
+		return false;
+
+	placed = { mSkyline[best].x, bestY - h, w, h };
+
+	// New segment over the covered ones, the last covered one keeps what sticks out.
+	const Segment added = { placed.x, bestY, w };
+	size_t end = best;
+
+	while (end < mSkyline.size() && mSkyline[end].x + mSkyline[end].width <= added.x + w)
+		end++;
+
+	if (end < mSkyline.size() && mSkyline[end].x < added.x + w) {
+		mSkyline[end].width -= added.x + w - mSkyline[end].x;
+		mSkyline[end].x = added.x + w;
+	}
+
+	mSkyline.erase(mSkyline.begin() + static_cast<ptrdiff_t>(best), mSkyline.begin() + static_cast<ptrdiff_t>(end));
+	mSkyline.insert(mSkyline.begin() + static_cast<ptrdiff_t>(best), added);
+
+	// Neighbours at the same height merge.
+	for (size_t i = 0; i + 1 < mSkyline.size();)
+		if (mSkyline[i].y == mSkyline[i + 1].y) {
+			mSkyline[i].width += mSkyline[i + 1].width;
+			mSkyline.erase(mSkyline.begin() + static_cast<ptrdiff_t>(i) + 1);
+		} else {
+			i++;
+		}
+
+	mUsed += static_cast<uint64_t>(w) * h;
+	return true;
+}
+
+double SkylinePacker::occupancy() const {
+	return static_cast<double>(mUsed) / (static_cast<double>(mWidth) * mHeight);
+}
+
+void MaxRectsPacker::reset(uint32_t width, uint32_t height) {
+	mWidth = width;
+	mHeight = height;
+	mUsed = 0;
+	mFree.assign(1, { 0, 0, width, height });
+}
+
+bool MaxRectsPacker::insert(uint32_t w, uint32_t h, PackRect& placed) {
+	// Best short side fit, then best long side fit.
+	size_t best = SIZE_MAX;
+	uint32_t bestShort = UINT32_MAX, bestLong = UINT32_MAX;
+
+	for (size_t i = 0; i < mFree.size(); i++) {
+		const PackRect& f = mFree[i];
+
+		if (f.width < w || f.height < h)
+			continue;
+
+		const uint32_t dx = f.width - w, dy = f.height - h;
+		const uint32_t shortSide = std::min(dx, dy), longSide = std::max(dx, dy);
+
+		if (shortSide < bestShort || (shortSide == bestShort && longSide < bestLong)) {
+			best = i;
+			bestShort = shortSide;
+			bestLong = longSide;
+		}
+	}
+
+	if (best == SIZE_MAX)
+		return false;
+
+	placed = { mFree[best].x, mFree[best].y, w, h };
+	split(placed);
+	prune();
+
+	mUsed += static_cast<uint64_t>(w) * h;
+	return true;
+}
+
+// Every free rectangle the new one overlaps is replaced by up to four maximal ones around it.
+void MaxRectsPacker::split(const PackRect& used) {
+	const size_t count = mFree.size();
+
+	for (size_t i = 0; i < count; i++) {
+		const PackRect f = mFree[i];
+
+		if (used.x >= f.x + f.width || used.x + used.width <= f.x || used.y >= f.y + f.height || used.y + used.height <= f.y)
+			continue;
+
+		if (used.x > f.x)
+			mFree.push_back({ f.x, f.y, used.x - f.x, f.height });
+
+		if (used.x + used.width < f.x + f.width)
+			mFree.push_back({ used.x + used.width, f.y, f.x + f.width - (used.x + used.width), f.height });
+
+		if (used.y > f.y)
+			mFree.push_back({ f.x, f.y, f.width, used.y - f.y });
+
+		if (used.y + used.height < f.y + f.height)
+			mFree.push_back({ f.x, used.y + used.height, f.width, f.y + f.height - (used.y + used.height) });
+
+		mFree[i].width = 0; // Removed by prune
+	}
+}
+
+// Drops the split rectangles and the ones inside another.
+void MaxRectsPacker::prune() {
+	mFree.erase(std::remove_if(mFree.begin(), mFree.end(), [](const PackRect& r) { return r.width == 0 || r.height == 0; }), mFree.end());
+
+	auto contains = [](const PackRect& a, const PackRect& b) {
+		return b.x >= a.x && b.y >= a.y && b.x + b.width <= a.x + a.width && b.y + b.height <= a.y + a.height;
+	};
+
+	for (size_t i = 0; i < mFree.size(); i++)
+		for (size_t j = i + 1; j < mFree.size(); j++) {
+			if (contains(mFree[j], mFree[i])) {
+				mFree.erase(mFree.begin() + static_cast<ptrdiff_t>(i));
+				i--;
+				break;
+			}
+
+			if (contains(mFree[i], mFree[j])) {
+				mFree.erase(mFree.begin() + static_cast<ptrdiff_t>(j));
+				j--;
+			}
+		}
+}
+
+double MaxRectsPacker::occupancy() const {
+	return static_cast<double>(mUsed) / (static_cast<double>(mWidth) * mHeight);
+}
+
+template<typename Packer>
+static std::vector<PackPlacement> packPages(const std::vector<PackRect>& sizes, const std::vector<uint32_t>& order, uint32_t width, uint32_t height, uint32_t& pages) {
+	std::vector<PackPlacement> placements(sizes.size(), { {}, UINT32_MAX });
+	std::vector<Packer> packers;
+
+	for (const uint32_t i : order) {
+		const PackRect& size = sizes[i];
+
+		if (size.width > width || size.height > height)
+			continue;
+
+		// First page with room, a new one when none has.
+		bool placed = false;
+
+		for (uint32_t page = 0; page < packers.size() && !placed; page++)
+			if (packers[page].insert(size.width, size.height, placements[i].rect)) {
+				placements[i].page = page;
+				placed = true;
+			}
+
+		if (!placed) {
+			packers.emplace_back();
+			packers.back().reset(width, height);
+			packers.back().insert(size.width, size.height, placements[i].rect);
+			placements[i].page = static_cast<uint32_t>(packers.size() - 1);
+		}
+	}
+
+	pages = static_cast<uint32_t>(packers.size());
+	return placements;
+}
+
+std::vector<PackPlacement> packRects(const std::vector<PackRect>& sizes, uint32_t width, uint32_t height, PackAlgorithm algorithm, uint32_t* pageCount) {
+	// Tall ones first for the skyline, big ones first for maxrects.
+	std::vector<uint32_t> order(sizes.size());
+	std::iota(order.begin(), order.end(), 0u);
+	std::stable_sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+		if (algorithm == PackAlgorithm::Skyline && sizes[a].height != sizes[b].height)
+			return sizes[a].height > sizes[b].height;
+
+		return static_cast<uint64_t>(sizes[a].width) * sizes[a].height > static_cast<uint64_t>(sizes[b].width) * sizes[b].height;
+	});
+
+	uint32_t pages = 0;
+	auto placements = algorithm == PackAlgorithm::Skyline ? packPages<SkylinePacker>(sizes, order, width, height, pages)
+	                                                      : packPages<MaxRectsPacker>(sizes, order, width, height, pages);
+
+	if (pageCount)
+		*pageCount = pages;
+
+	return placements;
+}
+
+}
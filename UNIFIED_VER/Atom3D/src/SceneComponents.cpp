@@ -0,0 +1,13 @@
+// ReSharper disable CppInconsistentNaming
+#include "SceneComponents.hpp"
+
+namespace Atom {
+
+void updateWorldMatrices(World& world) {
+	world.parallelEachChunk<const Transform, WorldMatrix>([](size_t count, Entity*, const Transform* transforms, WorldMatrix* matrices) {
+		for (size_t i = 0; i < count; i++)
+			matrices[i].matrix = composeTransform(transforms[i]);
+	});
+}
+
+}
@@ -0,0 +1,132 @@
+// ReSharper disable CppInconsistentNaming
+#include "TextureAtlas.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+
+namespace Atom {
+
+static uint32_t alignUp(uint32_t value, uint32_t alignment) {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+const AtlasRegion* TextureAtlas::find(std::string_view name) const {
+	for (const auto& region : regions)
+		if (region.name == name)
+			return &region;
+
+	return nullptr;
+}
+
+// Copies image to (x, y) of layer and repeats its edge pixels over [x0, x1) x [y0, y1) around it.
+static void blit(const AtlasImage& image, std::vector<uint8_t>& layer, uint32_t layerWidth, uint32_t x, uint32_t y, uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1) {
+	for (uint32_t ty = y0; ty < y1; ty++) {
+		const uint32_t sy = static_cast<uint32_t>(std::clamp<int64_t>(static_cast<int64_t>(ty) - y, 0, image.height - 1));
+		const uint8_t* src = image.rgba + static_cast<size_t>(sy) * image.width * 4;
+		uint8_t* dst = layer.data() + (static_cast<size_t>(ty) * layerWidth + x0) * 4;
+
+		for (uint32_t tx = x0; tx < x1; tx++, dst += 4) {
+			const uint32_t sx = static_cast<uint32_t>(std::clamp<int64_t>(static_cast<int64_t>(tx) - x, 0, image.width - 1));
+			memcpy(dst, src + sx * 4, 4);
+		}
+	}
+}
+
+static AtlasRegion regionOf(const AtlasImage& image, uint32_t layer, uint32_t x, uint32_t y, uint32_t layerWidth, uint32_t layerHeight) {
+	const float w = static_cast<float>(layerWidth), h = static_cast<float>(layerHeight);
+	return { image.name, layer, x, y, image.width, image.height, { image.width / w, image.height / h }, { x / w, y / h } };
+}
+
+TextureAtlas buildAtlas(const std::vector<AtlasImage>& images, const AtlasOptions& options) {
+	std::vector<PackRect> sizes;
+
+	for (const auto& image : images)
+		sizes.push_back({ 0, 0, alignUp(image.width + 2 * options.padding, 4), alignUp(image.height + 2 * options.padding, 4) });
+
+	uint32_t layerCount = 0;
+	const auto placements = packRects(sizes, options.width, options.height, options.packer, &layerCount);
+
+	TextureAtlas atlas;
+	atlas.width = options.width;
+	atlas.height = options.height;
+	atlas.layers.assign(layerCount, std::vector<uint8_t>(static_cast<size_t>(options.width) * options.height * 4, 0));
+
+	for (size_t i = 0; i < images.size(); i++) {
+		const PackPlacement& p = placements[i];
+
+		if (p.page == UINT32_MAX)
+			throw std::invalid_argument("Image " + images[i].name + " doesn't fit in a " + std::to_string(options.width) + "x" + std::to_string(options.height) + " atlas\n");
+
+		const uint32_t x = p.rect.x + options.padding, y = p.rect.y + options.padding;
+		blit(images[i], atlas.layers[p.page], options.width, x, y, p.rect.x, p.rect.y, p.rect.x + p.rect.width, p.rect.y + p.rect.height);
+		atlas.regions.push_back(regionOf(images[i], p.page, x, y, options.width, options.height));
+	}
+
+	return atlas;
+}
+
+TextureAtlas buildTextureArray(const std::vector<AtlasImage>& images) {
+	TextureAtlas atlas;
+
+	for (const auto& image : images) {
+		atlas.width = std::max(atlas.width, image.width);
+		atlas.height = std::max(atlas.height, image.height);
+	}
+
+	for (size_t i = 0; i < images.size(); i++) {
+		atlas.layers.emplace_back(static_cast<size_t>(atlas.width) * atlas.height * 4);
+		blit(images[i], atlas.layers.back(), atlas.width, 0, 0, 0, 0, atlas.width, atlas.height);
+		atlas.regions.push_back(regionOf(images[i], static_cast<uint32_t>(i), 0, 0, atlas.width, atlas.height));
+	}
+
+	return atlas;
+}
+
+void remapUVs(float* uvs, size_t count, size_t stride, const AtlasRegion& region) {
+	auto* bytes = reinterpret_cast<uint8_t*>(uvs);
+
+	for (size_t i = 0; i < count; i++, bytes += stride) {
+		float uv[2];
+		memcpy(uv, bytes, sizeof uv);
+		uv[0] = uv[0] * region.uvScale.x + region.uvOffset.x;
+		uv[1] = uv[1] * region.uvScale.y + region.uvOffset.y;
+		memcpy(bytes, uv, sizeof uv);
+	}
+}
+
+std::string atlasDescription(const TextureAtlas& atlas) {
+	std::ostringstream out;
+	out << "atlas " << atlas.width << " " << atlas.height << " " << atlas.layers.size() << "\n";
+
+	for (const auto& r : atlas.regions)
+		out << r.name << " " << r.layer << " " << r.x << " " << r.y << " " << r.width << " " << r.height << "\n";
+
+	return out.str();
+}
+
+bool parseAtlas(const char* text, size_t size, TextureAtlas& atlas) {
+	std::istringstream in(std::string(text, size));
+	std::string keyword;
+	size_t layers = 0;
+
+	if (!(in >> keyword >> atlas.width >> atlas.height >> layers) || keyword != "atlas" || atlas.width == 0 || atlas.height == 0)
+		return false;
+
+	atlas.regions.clear();
+
+	AtlasImage image = {};
+	uint32_t layer, x, y;
+
+	while (in >> image.name >> layer >> x >> y >> image.width >> image.height) {
+		if (layer >= layers || x + image.width > atlas.width || y + image.height > atlas.height)
+			return false;
+
+		atlas.regions.push_back(regionOf(image, layer, x, y, atlas.width, atlas.height));
+	}
+
+	return in.eof();
+}
+
+}
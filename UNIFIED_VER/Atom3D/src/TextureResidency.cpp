@@ -0,0 +1,215 @@
+// ReSharper disable CppInconsistentNaming
+#include "TextureResidency.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <queue>
+
+namespace Atom {
+
+float mipForFootprint(uint32_t width, uint32_t height, float footprintPixels) {
+	const float texels = static_cast<float>(std::max(width, height));
+	return footprintPixels >= texels ? 0.0f : std::log2(texels / std::max(footprintPixels, 1e-3f));
+}
+
+float screenFootprint(float worldSize, float distance, float fovY, float viewportHeight) {
+	return worldSize / (2 * std::max(distance, 1e-4f) * std::tan(fovY / 2)) * viewportHeight;
+}
+
+TextureResidency::Id TextureResidency::add(const std::vector<uint64_t>& levelBytes, uint32_t tailMip) {
+	Id id;
+
+	if (mFree.empty()) {
+		id = static_cast<Id>(mEntries.size());
+		mEntries.emplace_back();
+	} else {
+		id = mFree.back();
+		mFree.pop_back();
+	}
+
+	Entry& e = mEntries[id];
+	e = Entry();
+	e.levelBytes = levelBytes;
+	e.levelUsed.assign(levelBytes.size(), 0);
+	e.tailMip = std::min(tailMip, static_cast<uint32_t>(levelBytes.size()) - 1);
+	e.residentMip = e.tailMip;
+	e.wantedMip = static_cast<uint32_t>(levelBytes.size());
+	e.alive = true;
+
+	mResident += std::accumulate(levelBytes.begin() + e.tailMip, levelBytes.end(), uint64_t(0));
+	mTotals.residentBytes = mResident;
+	mTotals.textureCount++;
+
+	return id;
+}
+
+void TextureResidency::remove(Id id) {
+	Entry& e = mEntries[id];
+
+	mResident -= std::accumulate(e.levelBytes.begin() + e.residentMip, e.levelBytes.end(), uint64_t(0));
+	mTotals.residentBytes = mResident;
+	mTotals.textureCount--;
+
+	e = Entry();
+	mFree.push_back(id);
+}
+
+void TextureResidency::request(Id id, float mip) {
+	Entry& e = mEntries[id];
+	const auto levels = static_cast<uint32_t>(e.levelBytes.size());
+	const uint32_t level = std::min(static_cast<uint32_t>(std::max(mip, 0.0f)), levels - 1);
+
+	// First request this frame replaces the last frame's, later ones can only want more.
+	if (e.requestFrame != mFrame || level < e.wantedMip)
+		e.wantedMip = level;
+
+	e.requestFrame = mFrame;
+
+	for (uint32_t i = level; i < levels; i++)
+		e.levelUsed[i] = mFrame;
+}
+
+bool TextureResidency::makeRoom(uint64_t bytes, bool evictCurrent, std::vector<uint32_t>& startMips) {
+	if (mBudget == 0 || mResident + bytes <= mBudget)
+		return true;
+
+	// Oldest finest level first. A texture goes back in with its next level after each eviction.
+	using Candidate = std::pair<uint64_t, Id>;
+	std::priority_queue<Candidate, std::vector<Candidate>, std::greater<>> oldest;
+
+	for (Id id = 0; id < mEntries.size(); id++) {
+		const Entry& e = mEntries[id];
+
+		if (e.alive && e.residentMip < e.tailMip)
+			oldest.push({ e.levelUsed[e.residentMip], id });
+	}
+
+	while (mResident + bytes > mBudget && !oldest.empty()) {
+		const auto [used, id] = oldest.top();
+		oldest.pop();
+
+		if (used >= mFrame && !evictCurrent)
+			return false;
+
+		Entry& e = mEntries[id];
+
+		if (startMips[id] == UINT32_MAX)
+			startMips[id] = e.residentMip;
+
+		mResident -= e.levelBytes[e.residentMip];
+		e.residentMip++;
+		e.evictions++;
+		mTotals.evictions++;
+
+		if (e.residentMip < e.tailMip)
+			oldest.push({ e.levelUsed[e.residentMip], id });
+	}
+
+	return mResident + bytes <= mBudget;
+}
+
+std::vector<TextureResidency::Change> TextureResidency::update() {
+	mTotals.loads = 0;
+	mTotals.evictions = 0;
+	mTotals.uploadBytes = 0;
+	mTotals.overBudget = false;
+	mTotals.wantedBytes = 0;
+
+	// residentMip of each texture before the update, UINT32_MAX while untouched.
+	std::vector<uint32_t> startMips(mEntries.size(), UINT32_MAX);
+	std::vector<Id> loading;
+
+	for (Id id = 0; id < mEntries.size(); id++) {
+		Entry& e = mEntries[id];
+
+		if (!e.alive)
+			continue;
+
+		// Not requested this frame, nothing new to stream in for it.
+		if (e.requestFrame != mFrame)
+			e.wantedMip = static_cast<uint32_t>(e.levelBytes.size());
+
+		const uint32_t wanted = std::min(e.wantedMip, e.tailMip);
+		mTotals.wantedBytes += std::accumulate(e.levelBytes.begin() + wanted, e.levelBytes.end(), uint64_t(0));
+
+		if (e.wantedMip < e.residentMip)
+			loading.push_back(id);
+	}
+
+	// Over budget already (it was lowered), even levels in use go.
+	if (!makeRoom(0, true, startMips))
+		mTotals.overBudget = true;
+
+	// Textures missing the most levels first, a blurry texture up close stands out the most. One
+	// level at a time, coarse ones are cheap and fix most of the blur.
+	std::sort(loading.begin(), loading.end(), [&](Id a, Id b) {
+		return mEntries[a].residentMip - mEntries[a].wantedMip > mEntries[b].residentMip - mEntries[b].wantedMip;
+	});
+
+	// Smallest level that didn't fit, the evictable levels only get fewer so bigger ones won't either.
+	uint64_t failedBytes = UINT64_MAX;
+	bool progress = true;
+
+	while (progress) {
+		progress = false;
+
+		for (const Id id : loading) {
+			Entry& e = mEntries[id];
+
+			if (e.residentMip <= e.wantedMip)
+				continue;
+
+			const uint64_t bytes = e.levelBytes[e.residentMip - 1];
+
+			if (bytes >= failedBytes || (mUploadLimit && mTotals.uploadBytes + bytes > mUploadLimit && mTotals.uploadBytes > 0))
+				continue;
+
+			if (!makeRoom(bytes, false, startMips)) {
+				mTotals.overBudget = true;
+				failedBytes = bytes;
+				continue;
+			}
+
+			if (startMips[id] == UINT32_MAX)
+				startMips[id] = e.residentMip;
+
+			e.residentMip--;
+			e.loads++;
+			mResident += bytes;
+			mTotals.loads++;
+			mTotals.uploadBytes += bytes;
+			progress = true;
+		}
+	}
+
+	std::vector<Change> changes;
+
+	for (Id id = 0; id < mEntries.size(); id++)
+		if (startMips[id] != UINT32_MAX && startMips[id] != mEntries[id].residentMip)
+			changes.push_back({ id, mEntries[id].residentMip });
+
+	mTotals.residentBytes = mResident;
+	mFrame++;
+
+	return changes;
+}
+
+TextureResidencyStats TextureResidency::stats(Id id) const {
+	const Entry& e = mEntries[id];
+	TextureResidencyStats s = {};
+
+	s.levelCount = static_cast<uint32_t>(e.levelBytes.size());
+	s.tailMip = e.tailMip;
+	s.residentMip = e.residentMip;
+	s.wantedMip = e.wantedMip;
+	s.residentBytes = std::accumulate(e.levelBytes.begin() + e.residentMip, e.levelBytes.end(), uint64_t(0));
+	s.fullBytes = std::accumulate(e.levelBytes.begin(), e.levelBytes.end(), uint64_t(0));
+	s.lastUsedFrame = e.requestFrame;
+	s.loads = e.loads;
+	s.evictions = e.evictions;
+
+	return s;
+}
+
+}
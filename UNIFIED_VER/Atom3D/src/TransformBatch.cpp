@@ -0,0 +1,328 @@
+// ReSharper disable CppInconsistentNaming
+#include "TransformBatch.hpp"
+#include "ParallelFor.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+// AVX-512 builds (-mavx512f, /arch:AVX512) run 16 objects per step, AVX2 builds 8. Everything else
+// composes one object at a time through AtomMath, which is still SSE2/NEON.
+#if defined(ATOM_SIMD_AVX2) && defined(__AVX512F__)
+#define ATOM_BATCH_AVX512 1
+#endif
+
+namespace Atom {
+
+void TransformSoA::resize(size_t count) {
+	// New objects get the identity transform.
+	for (auto* stream : { &positionX, &positionY, &positionZ, &rotationX, &rotationY, &rotationZ })
+		stream->resize(count, 0.0f);
+
+	for (auto* stream : { &rotationW, &scaleX, &scaleY, &scaleZ })
+		stream->resize(count, 1.0f);
+}
+
+void TransformSoA::set(size_t i, const float3& position, const quaternion_float& rotation, const float3& scale) {
+	positionX[i] = position.x;
+	positionY[i] = position.y;
+	positionZ[i] = position.z;
+	rotationX[i] = rotation.x;
+	rotationY[i] = rotation.y;
+	rotationZ[i] = rotation.z;
+	rotationW[i] = rotation.w;
+	scaleX[i] = scale.x;
+	scaleY[i] = scale.y;
+	scaleZ[i] = scale.z;
+}
+
+size_t TransformSoA::push(const float3& position, const quaternion_float& rotation, const float3& scale) {
+	const size_t i = size();
+	resize(i + 1);
+	set(i, position, rotation, scale);
+
+	return i;
+}
+
+namespace {
+
+// Objects per parallelFor block, every batch kernel width divides it so only the very last block has a scalar tail.
+constexpr size_t BLOCK = 16;
+// Below this many blocks per chunk waking the workers costs more than it saves.
+constexpr size_t MIN_BLOCKS_PER_CHUNK = 256;
+// Batches writing more than this are past L2 and won't be read back soon, so the kernels skip the
+// cache with streaming stores (when the outputs are 32/64 byte aligned), roughly halving the time at 1M objects.
+constexpr size_t STREAMING_BYTES = 4u << 20;
+
+void composeOne(const TransformSoA& t, size_t i, const float4x4* viewProj, float4x4* world, float4x4* mvp) {
+	const float qx = t.rotationX[i], qy = t.rotationY[i], qz = t.rotationZ[i], qw = t.rotationW[i];
+	const float x2 = qx + qx, y2 = qy + qy, z2 = qz + qz;
+	const float xx = qx * x2, xy = qx * y2, xz = qx * z2;
+	const float yy = qy * y2, yz = qy * z2, zz = qz * z2;
+	const float wx = qw * x2, wy = qw * y2, wz = qw * z2;
+	const float sx = t.scaleX[i], sy = t.scaleY[i], sz = t.scaleZ[i];
+
+	const float4x4 m = { {
+		{ (1 - (yy + zz)) * sx, (xy + wz) * sx, (xz - wy) * sx, 0 },
+		{ (xy - wz) * sy, (1 - (xx + zz)) * sy, (yz + wx) * sy, 0 },
+		{ (xz + wy) * sz, (yz - wx) * sz, (1 - (xx + yy)) * sz, 0 },
+		{ t.positionX[i], t.positionY[i], t.positionZ[i], 1 }
+	} };
+
+	if (world)
+		world[i] = m;
+
+	if (mvp)
+		mvp[i] = matrix_multiply(*viewProj, m);
+}
+
+#if defined(ATOM_SIMD_AVX2)
+
+struct Lanes8 {
+	using V = __m256;
+	static constexpr size_t WIDTH = 8;
+	static constexpr uintptr_t STREAM_ALIGNMENT = 32;
+
+	static V load(const float* p) { return _mm256_loadu_ps(p); }
+	static V splat(float f) { return _mm256_set1_ps(f); }
+	static V zero() { return _mm256_setzero_ps(); }
+	static V add(V a, V b) { return _mm256_add_ps(a, b); }
+	static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+	static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+
+	// a * b + c
+	static V madd(V a, V b, V c) {
+#if defined(ATOM_SIMD_FMA)
+		return _mm256_fmadd_ps(a, b, c);
+#else
+		return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+	}
+
+	// Row k of the result is lane k of every input.
+	static void transpose(V& r0, V& r1, V& r2, V& r3, V& r4, V& r5, V& r6, V& r7) {
+		const V t0 = _mm256_unpacklo_ps(r0, r1), t1 = _mm256_unpackhi_ps(r0, r1);
+		const V t2 = _mm256_unpacklo_ps(r2, r3), t3 = _mm256_unpackhi_ps(r2, r3);
+		const V t4 = _mm256_unpacklo_ps(r4, r5), t5 = _mm256_unpackhi_ps(r4, r5);
+		const V t6 = _mm256_unpacklo_ps(r6, r7), t7 = _mm256_unpackhi_ps(r6, r7);
+
+		const V s0 = _mm256_shuffle_ps(t0, t2, 0x44), s1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+		const V s2 = _mm256_shuffle_ps(t1, t3, 0x44), s3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+		const V s4 = _mm256_shuffle_ps(t4, t6, 0x44), s5 = _mm256_shuffle_ps(t4, t6, 0xEE);
+		const V s6 = _mm256_shuffle_ps(t5, t7, 0x44), s7 = _mm256_shuffle_ps(t5, t7, 0xEE);
+
+		r0 = _mm256_permute2f128_ps(s0, s4, 0x20);
+		r1 = _mm256_permute2f128_ps(s1, s5, 0x20);
+		r2 = _mm256_permute2f128_ps(s2, s6, 0x20);
+		r3 = _mm256_permute2f128_ps(s3, s7, 0x20);
+		r4 = _mm256_permute2f128_ps(s0, s4, 0x31);
+		r5 = _mm256_permute2f128_ps(s1, s5, 0x31);
+		r6 = _mm256_permute2f128_ps(s2, s6, 0x31);
+		r7 = _mm256_permute2f128_ps(s3, s7, 0x31);
+	}
+
+	// m[column * 4 + row] holds that element for 8 objects, turned back into 8 column major matrices.
+	static void store(V m[16], float4x4* out, bool streaming) {
+		transpose(m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7]);
+		transpose(m[8], m[9], m[10], m[11], m[12], m[13], m[14], m[15]);
+
+		if (streaming)
+			for (int k = 0; k < 8; k++) {
+				_mm256_stream_ps(&out[k].columns[0].x, m[k]);
+				_mm256_stream_ps(&out[k].columns[2].x, m[k + 8]);
+			}
+		else
+			for (int k = 0; k < 8; k++) {
+				_mm256_storeu_ps(&out[k].columns[0].x, m[k]);
+				_mm256_storeu_ps(&out[k].columns[2].x, m[k + 8]);
+			}
+	}
+};
+
+#endif
+
+#if defined(ATOM_BATCH_AVX512)
+
+struct Lanes16 {
+	using V = __m512;
+	static constexpr size_t WIDTH = 16;
+	static constexpr uintptr_t STREAM_ALIGNMENT = 64;
+
+	static V load(const float* p) { return _mm512_loadu_ps(p); }
+	static V splat(float f) { return _mm512_set1_ps(f); }
+	static V zero() { return _mm512_setzero_ps(); }
+	static V add(V a, V b) { return _mm512_add_ps(a, b); }
+	static V sub(V a, V b) { return _mm512_sub_ps(a, b); }
+	static V mul(V a, V b) { return _mm512_mul_ps(a, b); }
+	static V madd(V a, V b, V c) { return _mm512_fmadd_ps(a, b, c); }
+
+	// The unpack/shuffle steps of Lanes8::transpose work within 128 bit lanes, after them lane L of
+	// s[j] holds 4 consecutive elements of object 4L + j. Returns s[0..3] for rows r0..r3 and s[4..7] for r4..r7.
+	static void interleave(const V r[8], V s[8]) {
+		const V t0 = _mm512_unpacklo_ps(r[0], r[1]), t1 = _mm512_unpackhi_ps(r[0], r[1]);
+		const V t2 = _mm512_unpacklo_ps(r[2], r[3]), t3 = _mm512_unpackhi_ps(r[2], r[3]);
+		const V t4 = _mm512_unpacklo_ps(r[4], r[5]), t5 = _mm512_unpackhi_ps(r[4], r[5]);
+		const V t6 = _mm512_unpacklo_ps(r[6], r[7]), t7 = _mm512_unpackhi_ps(r[6], r[7]);
+
+		s[0] = _mm512_shuffle_ps(t0, t2, 0x44);
+		s[1] = _mm512_shuffle_ps(t0, t2, 0xEE);
+		s[2] = _mm512_shuffle_ps(t1, t3, 0x44);
+		s[3] = _mm512_shuffle_ps(t1, t3, 0xEE);
+		s[4] = _mm512_shuffle_ps(t4, t6, 0x44);
+		s[5] = _mm512_shuffle_ps(t4, t6, 0xEE);
+		s[6] = _mm512_shuffle_ps(t5, t7, 0x44);
+		s[7] = _mm512_shuffle_ps(t5, t7, 0xEE);
+	}
+
+	// Columns 0-1 come from the first interleave, 2-3 from the second, then a 128 bit lane shuffle
+	// gathers each object's four columns into one register.
+	static void store(V m[16], float4x4* out, bool streaming) {
+		V a[8], b[8];
+		interleave(m, a);
+		interleave(m + 8, b);
+
+		for (int j = 0; j < 4; j++) {
+			const V x = _mm512_shuffle_f32x4(a[j], a[j + 4], 0x44);
+			const V xh = _mm512_shuffle_f32x4(a[j], a[j + 4], 0xEE);
+			const V y = _mm512_shuffle_f32x4(b[j], b[j + 4], 0x44);
+			const V yh = _mm512_shuffle_f32x4(b[j], b[j + 4], 0xEE);
+
+			const V objects[4] = {
+				_mm512_shuffle_f32x4(x, y, 0x88), _mm512_shuffle_f32x4(x, y, 0xDD),
+				_mm512_shuffle_f32x4(xh, yh, 0x88), _mm512_shuffle_f32x4(xh, yh, 0xDD)
+			};
+
+			for (int l = 0; l < 4; l++) {
+				if (streaming)
+					_mm512_stream_ps(&out[4 * l + j].columns[0].x, objects[l]);
+				else
+					_mm512_storeu_ps(&out[4 * l + j].columns[0].x, objects[l]);
+			}
+		}
+	}
+};
+
+#endif
+
+#if defined(ATOM_SIMD_AVX2)
+
+// Same math as composeOne, one object per lane.
+template<typename L>
+void composeRange(const TransformSoA& t, size_t begin, size_t end, const float4x4* viewProj, float4x4* world, float4x4* mvp, bool streaming) {
+	using V = typename L::V;
+
+	streaming = streaming && (!world || reinterpret_cast<uintptr_t>(world) % L::STREAM_ALIGNMENT == 0) &&
+	                         (!mvp || reinterpret_cast<uintptr_t>(mvp) % L::STREAM_ALIGNMENT == 0);
+
+	const V one = L::splat(1.0f);
+	const V zero = L::zero();
+
+	V vp[16];
+
+	if (viewProj)
+		for (int c = 0; c < 4; c++)
+			for (int r = 0; r < 4; r++)
+				vp[c * 4 + r] = L::splat(viewProj->columns[c][r]);
+
+	size_t i = begin;
+
+	for (; i + L::WIDTH <= end; i += L::WIDTH) {
+		const V qx = L::load(&t.rotationX[i]);
+		const V qy = L::load(&t.rotationY[i]);
+		const V qz = L::load(&t.rotationZ[i]);
+		const V qw = L::load(&t.rotationW[i]);
+		const V sx = L::load(&t.scaleX[i]);
+		const V sy = L::load(&t.scaleY[i]);
+		const V sz = L::load(&t.scaleZ[i]);
+
+		const V x2 = L::add(qx, qx), y2 = L::add(qy, qy), z2 = L::add(qz, qz);
+		const V xx = L::mul(qx, x2), xy = L::mul(qx, y2), xz = L::mul(qx, z2);
+		const V yy = L::mul(qy, y2), yz = L::mul(qy, z2), zz = L::mul(qz, z2);
+		const V wx = L::mul(qw, x2), wy = L::mul(qw, y2), wz = L::mul(qw, z2);
+
+		V m[16] = {
+			L::mul(L::sub(one, L::add(yy, zz)), sx), L::mul(L::add(xy, wz), sx), L::mul(L::sub(xz, wy), sx), zero,
+			L::mul(L::sub(xy, wz), sy), L::mul(L::sub(one, L::add(xx, zz)), sy), L::mul(L::add(yz, wx), sy), zero,
+			L::mul(L::add(xz, wy), sz), L::mul(L::sub(yz, wx), sz), L::mul(L::sub(one, L::add(xx, yy)), sz), zero,
+			L::load(&t.positionX[i]), L::load(&t.positionY[i]), L::load(&t.positionZ[i]), one
+		};
+
+		if (mvp) {
+			// viewProj * world, the w row of world is (0, 0, 0, 1) so the 4th term is only in column 3.
+			V r[16];
+
+			for (int c = 0; c < 4; c++)
+				for (int row = 0; row < 4; row++) {
+					V acc = c == 3 ? vp[12 + row] : zero;
+					acc = L::madd(vp[row], m[c * 4], acc);
+					acc = L::madd(vp[4 + row], m[c * 4 + 1], acc);
+					r[c * 4 + row] = L::madd(vp[8 + row], m[c * 4 + 2], acc);
+				}
+
+			L::store(r, mvp + i, streaming);
+		}
+
+		if (world)
+			L::store(m, world + i, streaming);
+	}
+
+	// Streaming stores are weakly ordered, fence before parallelFor's join hands the results over.
+	if (streaming)
+		_mm_sfence();
+
+	for (; i < end; i++)
+		composeOne(t, i, viewProj, world, mvp);
+}
+
+#endif
+
+void compose(const TransformSoA& t, size_t begin, size_t end, const float4x4* viewProj, float4x4* world, float4x4* mvp, bool streaming) {
+#if defined(ATOM_BATCH_AVX512)
+	composeRange<Lanes16>(t, begin, end, viewProj, world, mvp, streaming);
+#elif defined(ATOM_SIMD_AVX2)
+	composeRange<Lanes8>(t, begin, end, viewProj, world, mvp, streaming);
+#else
+	(void)streaming;
+
+	for (size_t i = begin; i < end; i++)
+		composeOne(t, i, viewProj, world, mvp);
+#endif
+}
+
+void composeParallel(const TransformSoA& t, const float4x4* viewProj, float4x4* world, float4x4* mvp) {
+	const size_t count = t.size();
+	const size_t blocks = (count + BLOCK - 1) / BLOCK;
+	const bool streaming = count * sizeof(float4x4) * ((world ? 1 : 0) + (mvp ? 1 : 0)) >= STREAMING_BYTES;
+
+	parallelFor(blocks, MIN_BLOCKS_PER_CHUNK, [&](size_t first, size_t last) {
+		compose(t, first * BLOCK, std::min(last * BLOCK, count), viewProj, world, mvp, streaming);
+	});
+}
+
+}
+
+
+void composeWorldMatrices(const TransformSoA& t, size_t first, size_t count, float4x4* world) {
+	compose(t, first, first + count, nullptr, world, nullptr, count * sizeof(float4x4) >= STREAMING_BYTES);
+}
+
+void composeMVPMatrices(const TransformSoA& t, size_t first, size_t count, const float4x4& viewProj, float4x4* world, float4x4* mvp) {
+	compose(t, first, first + count, &viewProj, world, mvp, count * sizeof(float4x4) * (world ? 2 : 1) >= STREAMING_BYTES);
+}
+
+void composeWorldMatrices(const TransformSoA& t, float4x4* world) {
+	composeParallel(t, nullptr, world, nullptr);
+}
+
+void composeMVPMatrices(const TransformSoA& t, const float4x4& viewProj, float4x4* world, float4x4* mvp) {
+	composeParallel(t, &viewProj, world, mvp);
+}
+
+const char* transformBatchKernelName() {
+#if defined(ATOM_BATCH_AVX512)
+	return "AVX-512";
+#else
+	return ATOM_SIMD_NAME;
+#endif
+}
+
+}
@@ -0,0 +1,234 @@
+// ReSharper disable CppInconsistentNaming
+#include "TransformHierarchy.hpp"
+#include "ParallelFor.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Atom {
+
+namespace {
+
+// Below this many dirty nodes in a level waking the workers costs more than it saves.
+constexpr size_t MIN_NODES_PER_CHUNK = 2048;
+
+template<typename T>
+void permute(std::vector<T>& values, const std::vector<uint32_t>& order) {
+	std::vector<T> permuted;
+	permuted.reserve(order.size());
+
+	for (const uint32_t from : order)
+		permuted.push_back(values[from]);
+
+	values.swap(permuted);
+}
+
+}
+
+TransformHierarchy::Node TransformHierarchy::create(Node parent, const Transform& local, Entity entity) {
+	if (parent != NO_NODE && !valid(parent))
+		throw std::invalid_argument("Parent isn't a node of this hierarchy\n");
+
+	Node node;
+	if (!mFreeNodes.empty()) {
+		node = mFreeNodes.back();
+		mFreeNodes.pop_back();
+	} else {
+		node = static_cast<Node>(mIndexOf.size());
+		mIndexOf.push_back(NO_INDEX);
+	}
+
+	mIndexOf[node] = static_cast<uint32_t>(mNode.size());
+	mLocal.push_back(local);
+	mWorld.push_back(matrix_identity_float4x4);
+	mNode.push_back(node);
+	mParentNode.push_back(parent);
+	mEntity.push_back(entity);
+	mDirtyFlag.push_back(1);
+
+	mSize++;
+	mStructureChanged = true;
+	return node;
+}
+
+bool TransformHierarchy::valid(Node node) const {
+	return node < mIndexOf.size() && mIndexOf[node] != NO_INDEX;
+}
+
+void TransformHierarchy::destroy(Node node) {
+	if (!valid(node))
+		return;
+
+	// The subtree is found through the child ranges, which need a current structure.
+	if (mStructureChanged)
+		rebuild();
+
+	std::vector<uint32_t> stack = { mIndexOf[node] };
+
+	while (!stack.empty()) {
+		const uint32_t index = stack.back();
+		stack.pop_back();
+
+		for (uint32_t i = 0; i < mChildCount[index]; i++)
+			stack.push_back(mFirstChild[index] + i);
+
+		mIndexOf[mNode[index]] = NO_INDEX;
+		mFreeNodes.push_back(mNode[index]);
+		mNode[index] = NO_NODE;
+		mSize--;
+	}
+
+	mStructureChanged = true;
+}
+
+void TransformHierarchy::setParent(Node node, Node parent) {
+	if (parent != NO_NODE && !valid(parent))
+		throw std::invalid_argument("Parent isn't a node of this hierarchy\n");
+
+	for (Node ancestor = parent; ancestor != NO_NODE; ancestor = mParentNode[mIndexOf[ancestor]])
+		if (ancestor == node)
+			throw std::invalid_argument("A node can't be parented under its own subtree\n");
+
+	const uint32_t index = mIndexOf[node];
+	mParentNode[index] = parent;
+	mStructureChanged = true;
+	markDirty(index);
+}
+
+void TransformHierarchy::setLocal(Node node, const Transform& local) {
+	const uint32_t index = mIndexOf[node];
+	mLocal[index] = local;
+	markDirty(index);
+}
+
+void TransformHierarchy::markDirty(uint32_t index) {
+	if (mDirtyFlag[index])
+		return;
+
+	mDirtyFlag[index] = 1;
+
+	// Otherwise rebuild() collects it.
+	if (!mStructureChanged)
+		mDirty[mLevel[index]].push_back(index);
+}
+
+void TransformHierarchy::rebuild() {
+	const auto count = static_cast<uint32_t>(mNode.size());
+
+	// Children of every live node by its current index, roots in their current order.
+	std::vector<uint32_t> childStart(count + 1, 0), children(mSize), order;
+	order.reserve(mSize);
+
+	for (uint32_t i = 0; i < count; i++) {
+		if (mNode[i] == NO_NODE)
+			continue;
+
+		if (mParentNode[i] == NO_NODE)
+			order.push_back(i);
+		else
+			childStart[mIndexOf[mParentNode[i]] + 1]++;
+	}
+
+	for (uint32_t i = 0; i < count; i++)
+		childStart[i + 1] += childStart[i];
+
+	std::vector<uint32_t> cursor(childStart.begin(), childStart.end() - 1);
+
+	for (uint32_t i = 0; i < count; i++)
+		if (mNode[i] != NO_NODE && mParentNode[i] != NO_NODE)
+			children[cursor[mIndexOf[mParentNode[i]]]++] = i;
+
+	// Breadth first, each node's children appended together.
+	mFirstChild.assign(mSize, 0);
+	mChildCount.assign(mSize, 0);
+
+	for (size_t head = 0; head < order.size(); head++) {
+		const uint32_t from = order[head];
+		mFirstChild[head] = static_cast<uint32_t>(order.size());
+		mChildCount[head] = childStart[from + 1] - childStart[from];
+		order.insert(order.end(), children.begin() + childStart[from], children.begin() + childStart[from + 1]);
+	}
+
+	permute(mLocal, order);
+	permute(mWorld, order);
+	permute(mNode, order);
+	permute(mParentNode, order);
+	permute(mEntity, order);
+	permute(mDirtyFlag, order);
+
+	for (uint32_t i = 0; i < mSize; i++)
+		mIndexOf[mNode[i]] = i;
+
+	// Parents come first, so their level is known by the time their children get theirs.
+	mParent.resize(mSize);
+	mLevel.resize(mSize);
+	uint32_t levels = 0;
+
+	for (uint32_t i = 0; i < mSize; i++) {
+		mParent[i] = mParentNode[i] == NO_NODE ? NO_INDEX : mIndexOf[mParentNode[i]];
+		mLevel[i] = mParent[i] == NO_INDEX ? 0 : mLevel[mParent[i]] + 1;
+		levels = std::max(levels, mLevel[i] + 1);
+	}
+
+	mDirty.resize(levels);
+	for (auto& dirty : mDirty)
+		dirty.clear();
+
+	for (uint32_t i = 0; i < mSize; i++)
+		if (mDirtyFlag[i])
+			mDirty[mLevel[i]].push_back(i);
+
+	mStructureChanged = false;
+}
+
+size_t TransformHierarchy::update() {
+	if (mStructureChanged)
+		rebuild();
+
+	mChanged.clear();
+	size_t written = 0;
+
+	for (size_t level = 0; level < mDirty.size(); level++) {
+		auto& dirty = mDirty[level];
+
+		if (dirty.empty())
+			continue;
+
+		// Reads only the level above, which is done.
+		parallelFor(dirty.size(), MIN_NODES_PER_CHUNK, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i++) {
+				const uint32_t index = dirty[i];
+				const float4x4 local = composeTransform(mLocal[index]);
+				mWorld[index] = mParent[index] == NO_INDEX ? local : matrix_multiply(mWorld[mParent[index]], local);
+			}
+		});
+
+		// Their children move with them.
+		for (const uint32_t index : dirty) {
+			mDirtyFlag[index] = 0;
+			mChanged.push_back(mNode[index]);
+
+			for (uint32_t child = mFirstChild[index]; child < mFirstChild[index] + mChildCount[index]; child++)
+				if (!mDirtyFlag[child]) {
+					mDirtyFlag[child] = 1;
+					mDirty[level + 1].push_back(child);
+				}
+		}
+
+		written += dirty.size();
+		dirty.clear();
+	}
+
+	return written;
+}
+
+void syncWorldMatrices(const TransformHierarchy& hierarchy, World& world) {
+	for (const auto node : hierarchy.changed()) {
+		const Entity entity = hierarchy.entity(node);
+
+		if (auto* matrix = world.get<WorldMatrix>(entity))
+			matrix->matrix = hierarchy.world(node);
+	}
+}
+
+}
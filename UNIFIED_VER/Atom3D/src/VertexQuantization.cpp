@@ -0,0 +1,106 @@
+// ReSharper disable CppInconsistentNaming
+#include "VertexQuantization.hpp"
+
+namespace Atom {
+
+static const float* attribute(const float* base, size_t i, size_t stride) {
+	return reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(base) + i * stride);
+}
+
+PositionQuantization positionQuantization(const float* positions, size_t count, size_t stride) {
+	float minP[3] = { 0, 0, 0 }, maxP[3] = { 0, 0, 0 };
+
+	for (size_t i = 0; i < count; i++) {
+		const float* p = attribute(positions, i, stride);
+
+		for (int k = 0; k < 3; k++) {
+			minP[k] = i == 0 ? p[k] : std::min(minP[k], p[k]);
+			maxP[k] = i == 0 ? p[k] : std::max(maxP[k], p[k]);
+		}
+	}
+
+	PositionQuantization q;
+	q.offset = { minP[0], minP[1], minP[2] };
+	q.scale = { maxP[0] - minP[0], maxP[1] - minP[1], maxP[2] - minP[2] };
+
+	return q;
+}
+
+UVQuantization uvQuantization(const float* uvs, size_t count, size_t stride, UVFormat format) {
+	float minUV[2] = { 0, 0 }, maxUV[2] = { 0, 0 };
+
+	for (size_t i = 0; i < count; i++) {
+		const float* uv = attribute(uvs, i, stride);
+
+		for (int k = 0; k < 2; k++) {
+			minUV[k] = i == 0 ? uv[k] : std::min(minUV[k], uv[k]);
+			maxUV[k] = i == 0 ? uv[k] : std::max(maxUV[k], uv[k]);
+		}
+	}
+
+	UVQuantization q;
+	q.format = format;
+	q.offset = { minUV[0], minUV[1] };
+	q.scale = { maxUV[0] - minUV[0], maxUV[1] - minUV[1] };
+
+	return q;
+}
+
+std::vector<float3> computeVertexNormals(const float* positions, size_t vertexCount, size_t stride, const uint32_t* indices, size_t indexCount) {
+	std::vector<float3> normals(vertexCount, float3{ 0, 0, 0 });
+
+	for (size_t i = 0; i + 2 < indexCount; i += 3) {
+		const float* a = attribute(positions, indices[i], stride);
+		const float* b = attribute(positions, indices[i + 1], stride);
+		const float* c = attribute(positions, indices[i + 2], stride);
+
+		const float e1[3] = { b[0] - a[0], b[1] - a[1], b[2] - a[2] };
+		const float e2[3] = { c[0] - a[0], c[1] - a[1], c[2] - a[2] };
+
+		// Unnormalized cross product, its length is twice the area.
+		const float n[3] = { e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2], e1[0] * e2[1] - e1[1] * e2[0] };
+
+		for (size_t k = 0; k < 3; k++) {
+			float3& normal = normals[indices[i + k]];
+			normal.x += n[0];
+			normal.y += n[1];
+			normal.z += n[2];
+		}
+	}
+
+	for (auto& n : normals) {
+		const float length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+
+		if (length > 0)
+			n = { n.x / length, n.y / length, n.z / length };
+	}
+
+	return normals;
+}
+
+MeshQuantization packVertices(const MeshVertex* vertices, size_t count, UVFormat uvFormat, PackedVertex* out) {
+	MeshQuantization q;
+	q.uvFormat = static_cast<uint32_t>(uvFormat);
+
+	if (count == 0)
+		return q;
+
+	const auto positions = positionQuantization(vertices[0].position, count, sizeof(MeshVertex));
+	const auto uvs = uvQuantization(vertices[0].uv, count, sizeof(MeshVertex), uvFormat);
+
+	for (size_t i = 0; i < count; i++) {
+		const auto& v = vertices[i];
+		out[i].position = quantizePosition(positions, v.position[0], v.position[1], v.position[2]);
+		out[i].textureCoords = quantizeUV(uvs, v.uv[0], v.uv[1]);
+		out[i].normal = octEncode(v.normal[0], v.normal[1], v.normal[2]);
+	}
+
+	q.positionScale = { positions.scale.x, positions.scale.y, positions.scale.z, 0.0f };
+	q.positionOffset = { positions.offset.x, positions.offset.y, positions.offset.z, 1.0f };
+	q.uvScale = uvs.scale;
+	q.uvOffset = uvs.offset;
+
+	return q;
+}
+
+}
@@ -0,0 +1,108 @@
+// ReSharper disable CppInconsistentNaming
+#include "VirtualFileSystem.hpp"
+
+#include <filesystem>
+#include <stdexcept>
+
+namespace Atom {
+
+static std::filesystem::path looseFilePath(const std::string& directory, const std::string& name) {
+	return std::filesystem::u8path(directory) / std::filesystem::u8path(name);
+}
+
+bool VirtualFileSystem::mountPack(const std::string& path) {
+	auto pack = std::make_unique<AssetPack>();
+
+	if (!pack->open(path))
+		return false;
+
+	pack->prefetch();
+	mMounts.push_back({ std::move(pack), {} });
+	return true;
+}
+
+void VirtualFileSystem::mountDirectory(const std::string& directory) {
+	mMounts.push_back({ nullptr, directory });
+}
+
+void VirtualFileSystem::unmountAll() {
+	mMounts.clear();
+}
+
+bool VirtualFileSystem::exists(std::string_view name) const {
+	const std::string normalized = normalizeAssetName(name);
+	std::error_code error;
+
+	for (auto mount = mMounts.rbegin(); mount != mMounts.rend(); ++mount)
+		if (mount->pack ? mount->pack->find(normalized) != nullptr : std::filesystem::is_regular_file(looseFilePath(mount->directory, normalized), error))
+			return true;
+
+	return false;
+}
+
+bool VirtualFileSystem::open(std::string_view name, AssetFile& file) const {
+	file = AssetFile();
+
+	const std::string normalized = normalizeAssetName(name);
+
+	for (auto mount = mMounts.rbegin(); mount != mMounts.rend(); ++mount) {
+		if (mount->pack) {
+			const AssetPackEntry* entry = mount->pack->find(normalized);
+
+			if (!entry)
+				continue;
+
+			if (entry->compression == static_cast<uint32_t>(AssetCompression::None)) {
+				file.mData = mount->pack->storedData(*entry);
+			} else {
+				file.mBuffer.resize(static_cast<size_t>(entry->size));
+
+				if (!mount->pack->read(*entry, file.mBuffer.data()))
+					return false;
+
+				file.mData = file.mBuffer.data();
+			}
+
+			file.mSize = static_cast<size_t>(entry->size);
+			file.mOpen = true;
+			return true;
+		}
+
+		const std::filesystem::path path = looseFilePath(mount->directory, normalized);
+		std::error_code error;
+
+		if (!std::filesystem::is_regular_file(path, error))
+			continue;
+
+		// MappedFile won't map empty files, they are still valid assets.
+		if (!file.mFile.open(path.string()) && std::filesystem::file_size(path, error) != 0)
+			return false;
+
+		file.mData = file.mFile.data();
+		file.mSize = file.mFile.size();
+		file.mOpen = true;
+		return true;
+	}
+
+	return false;
+}
+
+std::vector<uint8_t> VirtualFileSystem::read(std::string_view name) const {
+	AssetFile file;
+
+	if (!open(name, file))
+		throw std::runtime_error("Failed to open file: " + std::string(name));
+
+	return { file.data(), file.data() + file.size() };
+}
+
+size_t VirtualFileSystem::packCount() const {
+	size_t count = 0;
+
+	for (const auto& mount : mMounts)
+		count += mount.pack != nullptr;
+
+	return count;
+}
+
+}
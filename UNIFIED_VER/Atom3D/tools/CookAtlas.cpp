@@ -0,0 +1,147 @@
+// ReSharper disable CppInconsistentNaming
+// Atlas cooker: packs images into the layers of one array texture and writes it as a DDS plus a
+// .atlas file with every image's region, see TextureAtlas.hpp. Needs the stb_image the Metal
+// project vendors, see the README for the build line.
+//
+//   cookatlas [--array] [--size 2048] [--padding 4] [--packer maxrects|skyline]
+//             [--format bc1|bc3|bc5|bc7|rgba8] [--mips kaiser|box|none] [--linear] image... -o atlas
+//
+// Writes atlas.dds and atlas.atlas. Regions are named by the image paths as given. --array puts one
+// image in each layer instead of packing them.
+#include "BlockCompression.hpp"
+#include "DdsTexture.hpp"
+#include "MipChain.hpp"
+#include "TextureAtlas.hpp"
+
+#include "stb_image.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace Atom;
+
+static bool parseFormat(const std::string& name, TextureFormat& format) {
+	const std::pair<const char*, TextureFormat> formats[] = {
+		{ "bc1", TextureFormat::BC1 }, { "bc3", TextureFormat::BC3 }, { "bc5", TextureFormat::BC5 }, { "bc7", TextureFormat::BC7 }, { "rgba8", TextureFormat::RGBA8 }
+	};
+
+	for (const auto& f : formats)
+		if (name == f.first) {
+			format = f.second;
+			return true;
+		}
+
+	return false;
+}
+
+int main(int argc, char** argv) {
+	TextureFormat format = TextureFormat::BC7;
+	AtlasOptions options;
+	std::string mips = "kaiser", packer = "maxrects", output;
+	bool srgb = true, array = false;
+	std::vector<std::string> inputs;
+
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+
+		if (arg == "--format" && i + 1 < argc) {
+			if (!parseFormat(argv[++i], format)) {
+				std::fprintf(stderr, "Unknown format %s\n", argv[i]);
+				return 1;
+			}
+		} else if (arg == "--size" && i + 1 < argc) {
+			options.width = options.height = static_cast<uint32_t>(std::stoul(argv[++i]));
+		} else if (arg == "--padding" && i + 1 < argc) {
+			options.padding = static_cast<uint32_t>(std::stoul(argv[++i]));
+		} else if (arg == "--packer" && i + 1 < argc) {
+			packer = argv[++i];
+		} else if (arg == "--mips" && i + 1 < argc) {
+			mips = argv[++i];
+		} else if (arg == "--linear") {
+			srgb = false;
+		} else if (arg == "--array") {
+			array = true;
+		} else if (arg == "-o" && i + 1 < argc) {
+			output = argv[++i];
+		} else {
+			inputs.push_back(arg);
+		}
+	}
+
+	if (inputs.empty() || output.empty() || (mips != "kaiser" && mips != "box" && mips != "none") || (packer != "maxrects" && packer != "skyline")) {
+		std::fprintf(stderr, "usage: cookatlas [--array] [--size 2048] [--padding 4] [--packer maxrects|skyline] [--format bc1|bc3|bc5|bc7|rgba8] [--mips kaiser|box|none] [--linear] image... -o atlas\n");
+		return 1;
+	}
+
+	options.packer = packer == "skyline" ? PackAlgorithm::Skyline : PackAlgorithm::MaxRects;
+
+	const auto start = std::chrono::steady_clock::now();
+	std::vector<AtlasImage> images;
+	std::vector<stbi_uc*> pixels;
+	int failures = 0;
+
+	// Top row first, like Texture::load and any other DDS writer.
+	stbi_set_flip_vertically_on_load_thread(false);
+
+	for (const auto& input : inputs) {
+		int width, height, channels;
+		stbi_uc* image = stbi_load(input.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+
+		if (!image) {
+			std::fprintf(stderr, "Could not load image at %s\n", input.c_str());
+			failures++;
+			continue;
+		}
+
+		pixels.push_back(image);
+		images.push_back({ input, image, static_cast<uint32_t>(width), static_cast<uint32_t>(height) });
+	}
+
+	try {
+		const TextureAtlas atlas = array ? buildTextureArray(images) : buildAtlas(images, options);
+
+		for (auto* image : pixels)
+			stbi_image_free(image);
+
+		std::vector<MipChain> layers;
+		uint64_t imageTexels = 0;
+
+		for (const auto& layer : atlas.layers) {
+			if (mips == "none") {
+				MipChain chain;
+				chain.levels.push_back({ atlas.width, atlas.height, 0 });
+				chain.data = layer;
+				layers.push_back(std::move(chain));
+			} else {
+				layers.push_back(generateMipChain(layer.data(), atlas.width, atlas.height, srgb, mips == "box" ? MipFilter::Box : MipFilter::Kaiser));
+			}
+		}
+
+		for (const auto& region : atlas.regions)
+			imageTexels += static_cast<uint64_t>(region.width) * region.height;
+
+		const TextureImage image = compressMipChains(layers, format, srgb);
+		writeDds(output + ".dds", image);
+
+		std::ofstream description(output + ".atlas", std::ios::binary | std::ios::trunc);
+		description << atlasDescription(atlas);
+
+		if (!description) {
+			std::fprintf(stderr, "Could not write %s.atlas\n", output.c_str());
+			return 1;
+		}
+
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::printf("%s.dds: %zu images in %zu %ux%u %s layers, %.0f%% used, %.1f KB, %.0f ms\n", output.c_str(), atlas.regions.size(), atlas.layers.size(),
+		            atlas.width, atlas.height, textureFormatName(format), 100.0 * imageTexels / (static_cast<double>(atlas.width) * atlas.height * atlas.layers.size()),
+		            image.data.size() / 1024.0, seconds * 1e3);
+	} catch (const std::exception& e) {
+		std::fprintf(stderr, "%s", e.what());
+		return 1;
+	}
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,116 @@
+// ReSharper disable CppInconsistentNaming
+// Texture cooker: decodes images, builds their mip chains and writes them as DDS in a BCn format,
+// ready for Texture::load to upload without any processing. Needs the stb_image the Metal project
+// vendors, see the README for the build line.
+//
+//   cooktexture [--format bc1|bc3|bc5|bc7|rgba8] [--mips kaiser|box|none] [--linear] image... [-o directory]
+//
+// Outputs go next to the inputs (or into the -o directory) with a .dds extension. --linear is for
+// data that isn't color, normal maps for instance, which should also use bc5.
+#include "BlockCompression.hpp"
+#include "DdsTexture.hpp"
+#include "MipChain.hpp"
+
+#include "stb_image.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace Atom;
+
+static bool parseFormat(const std::string& name, TextureFormat& format) {
+	const std::pair<const char*, TextureFormat> formats[] = {
+		{ "bc1", TextureFormat::BC1 }, { "bc3", TextureFormat::BC3 }, { "bc5", TextureFormat::BC5 }, { "bc7", TextureFormat::BC7 }, { "rgba8", TextureFormat::RGBA8 }
+	};
+
+	for (const auto& f : formats)
+		if (name == f.first) {
+			format = f.second;
+			return true;
+		}
+
+	return false;
+}
+
+int main(int argc, char** argv) {
+	TextureFormat format = TextureFormat::BC7;
+	std::string mips = "kaiser", outputDirectory;
+	bool srgb = true;
+	std::vector<std::string> inputs;
+
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+
+		if (arg == "--format" && i + 1 < argc) {
+			if (!parseFormat(argv[++i], format)) {
+				std::fprintf(stderr, "Unknown format %s\n", argv[i]);
+				return 1;
+			}
+		} else if (arg == "--mips" && i + 1 < argc) {
+			mips = argv[++i];
+		} else if (arg == "--linear") {
+			srgb = false;
+		} else if (arg == "-o" && i + 1 < argc) {
+			outputDirectory = argv[++i];
+		} else {
+			inputs.push_back(arg);
+		}
+	}
+
+	if (inputs.empty() || (mips != "kaiser" && mips != "box" && mips != "none")) {
+		std::fprintf(stderr, "usage: cooktexture [--format bc1|bc3|bc5|bc7|rgba8] [--mips kaiser|box|none] [--linear] image... [-o directory]\n");
+		return 1;
+	}
+
+	int failures = 0;
+
+	for (const auto& input : inputs) {
+		const auto start = std::chrono::steady_clock::now();
+
+		// Top row first, like Texture::load and any other DDS writer.
+		stbi_set_flip_vertically_on_load_thread(false);
+
+		int width, height, channels;
+		unsigned char* pixels = stbi_load(input.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+
+		if (!pixels) {
+			std::fprintf(stderr, "Could not load image at %s\n", input.c_str());
+			failures++;
+			continue;
+		}
+
+		MipChain chain;
+
+		if (mips == "none") {
+			chain.levels.push_back({ static_cast<uint32_t>(width), static_cast<uint32_t>(height), 0 });
+			chain.data.assign(pixels, pixels + chain.levels[0].bytes());
+		} else {
+			chain = generateMipChain(pixels, width, height, srgb, mips == "box" ? MipFilter::Box : MipFilter::Kaiser);
+		}
+
+		stbi_image_free(pixels);
+
+		const TextureImage image = compressMipChain(chain, format, srgb);
+		std::filesystem::path output = outputDirectory.empty() ? std::filesystem::path(input) : std::filesystem::path(outputDirectory) / std::filesystem::path(input).filename();
+		output.replace_extension(".dds");
+
+		try {
+			writeDds(output.string(), image);
+		} catch (const std::exception& e) {
+			std::fprintf(stderr, "%s", e.what());
+			failures++;
+			continue;
+		}
+
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::printf("%s -> %s  %dx%d %s, %zu levels, %.1f KB -> %.1f KB, %.0f ms\n", input.c_str(), output.string().c_str(), width, height, textureFormatName(format),
+		            image.levels.size(), chain.data.size() / 1024.0, image.data.size() / 1024.0, seconds * 1e3);
+	}
+
+	return failures == 0 ? 0 : 1;
+}
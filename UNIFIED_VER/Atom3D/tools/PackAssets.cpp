@@ -0,0 +1,112 @@
+// ReSharper disable CppInconsistentNaming
+// Asset packer: collects files and directories (recursively) into one .apak that the engines mount
+// through the VirtualFileSystem, see the README for the build line.
+//
+//   packassets -o pack.apak [--root directory] [--store ext,...] [--align bytes] path...
+//
+// Entries are named by their path relative to --root (the working directory by default), which is
+// the name the engine asks for: "packassets -o engine/assets.apak engine/assets" packs
+// "engine/assets/mc_grass.jpeg". --store lists extensions that aren't worth trying to compress.
+#include "AssetPack.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace Atom;
+
+namespace fs = std::filesystem;
+
+int main(int argc, char** argv) {
+	std::string output, root = ".", store;
+	uint32_t alignment = ASSET_PACK_ALIGNMENT;
+	std::vector<std::string> paths;
+
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+
+		if (arg == "-o" && i + 1 < argc) {
+			output = argv[++i];
+		} else if (arg == "--root" && i + 1 < argc) {
+			root = argv[++i];
+		} else if (arg == "--store" && i + 1 < argc) {
+			store = "," + std::string(argv[++i]) + ",";
+		} else if (arg == "--align" && i + 1 < argc) {
+			alignment = static_cast<uint32_t>(std::stoul(argv[++i]));
+		} else {
+			paths.push_back(arg);
+		}
+	}
+
+	if (output.empty() || paths.empty() || alignment == 0 || (alignment & (alignment - 1))) {
+		std::fprintf(stderr, "usage: packassets -o pack.apak [--root directory] [--store ext,...] [--align bytes] path...\n");
+		return 1;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	std::vector<AssetPackInput> inputs;
+	uint64_t totalBytes = 0;
+
+	auto add = [&](const fs::path& file) {
+		// Never the pack itself or a half written one from a failed run.
+		std::error_code error;
+
+		if (file.extension() == ".tmp" || fs::equivalent(file, output, error))
+			return;
+
+		std::string extension = file.extension().string();
+
+		if (!extension.empty())
+			extension.erase(0, 1);
+
+		AssetPackInput input;
+		input.name = fs::relative(file, root).generic_string();
+		input.source = file.string();
+		input.compress = store.find("," + extension + ",") == std::string::npos;
+		input.alignment = alignment;
+
+		totalBytes += fs::file_size(file);
+		inputs.push_back(std::move(input));
+	};
+
+	try {
+		for (const auto& path : paths) {
+			if (fs::is_directory(path)) {
+				for (const auto& item : fs::recursive_directory_iterator(path))
+					if (item.is_regular_file())
+						add(item.path());
+			} else if (fs::is_regular_file(path)) {
+				add(path);
+			} else {
+				std::fprintf(stderr, "No file or directory at %s\n", path.c_str());
+				return 1;
+			}
+		}
+
+		writeAssetPack(output, inputs);
+	} catch (const std::exception& e) {
+		std::fprintf(stderr, "%s", e.what());
+		return 1;
+	}
+
+	AssetPack pack;
+
+	if (!pack.open(output)) {
+		std::fprintf(stderr, "Could not read back %s\n", output.c_str());
+		return 1;
+	}
+
+	size_t compressed = 0;
+
+	for (size_t i = 0; i < pack.entryCount(); i++)
+		compressed += pack.entry(i).compression != static_cast<uint32_t>(AssetCompression::None);
+
+	const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::printf("%s: %zu entries (%zu compressed), %.1f KB -> %.1f KB, %.0f ms\n", output.c_str(), pack.entryCount(), compressed,
+	            totalBytes / 1024.0, fs::file_size(output) / 1024.0, seconds * 1e3);
+
+	return 0;
+}
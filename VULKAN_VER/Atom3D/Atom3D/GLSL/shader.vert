@@ -1,21 +1,24 @@
 #version 450
 // #extension GL_KHR_vulkan_glsl: enable
 
-layout(location = 0) out vec3 fragColor;
+// Positions are unorm16 inside the mesh bounds, normals two octahedral snorm16s. Vertex fetch
+// normalizes both, the bounds come in as push constants. Nothing is lit yet, the normal is the color.
+layout(push_constant) uniform Quantization {
+	vec4 positionScale;
+	vec4 positionOffset;
+} quantization;
 
-vec2 pos[3] = vec2[](
-	vec2(0.0, -0.5),
-	vec2(0.5, 0.5),
-	vec2(-0.5, 0.5)
-);
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec2 inNormal;
 
-vec3 colors[3] = vec3[](
-	vec3(1.0, 0, 0),
-	vec3(0, 1.0, 0),
-	vec3(0, 0, 1.0)
-);
+layout(location = 0) out vec3 fragColor;
 
 void main() {
-	gl_Position = vec4(pos[gl_VertexIndex], 0.0, 1.0);
-	fragColor = colors[gl_VertexIndex];
+	gl_Position = vec4(inPosition.xyz * quantization.positionScale.xyz + quantization.positionOffset.xyz, 1.0);
+
+	vec3 normal = vec3(inNormal, 1.0 - abs(inNormal.x) - abs(inNormal.y));
+	float t = max(-normal.z, 0.0);
+	normal.xy += mix(vec2(t), vec2(-t), greaterThanEqual(normal.xy, vec2(0.0)));
+
+	fragColor = normalize(normal) * 0.5 + 0.5;
 }
\ No newline at end of file
@@ -7,17 +7,33 @@
 // Get rid of gross Windows macros
 #define NOMINMAX
 
+#ifdef _WIN32
 #define VK_USE_PLATFORM_WIN32_KHR
+#endif
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
+#ifdef _WIN32
 #define GLFW_EXPOSE_NATIVE_WIN32
 #include <GLFW/glfw3native.h>
+#endif
 
 #define VULKAN_HPP_NO_EXCEPTIONS
 #include <vulkan/vulkan.hpp>
 
 #include <glm/vec2.hpp>
 
+#include "PipelineCache.hpp"
+#include "MemoryAllocator.hpp"
+#include "StagingRing.hpp"
+#include "CommandRecorder.hpp"
+#include "FrustumCulling.hpp"
+#include "JobSystem.hpp"
+#include "MeshBuilder.hpp"
+#include "MeshImporter.hpp"
+#include "MeshOptimizer.hpp"
+#include "VirtualFileSystem.hpp"
+#include "VertexQuantization.hpp"
+
 #include <iostream>
 #include <exception>
 #include <string>
@@ -25,9 +41,12 @@
 #include <set>
 #include <limits>
 #include <algorithm>
+#include <array>
 #include <optional>
 #include <fstream>
 #include <cassert>
+#include <cstring>
+#include <chrono>
 
 namespace Atom {
 
@@ -58,6 +77,69 @@ struct QueueFamilyIndices {
 	}
 };
 
+// Everything a single frame in flight needs, so recording frame N+1 never touches frame N's objects.
+// Its command buffers come from mRecorder's pools for the slot.
+struct FrameData {
+	vk::Semaphore imageAvailableS;
+	vk::Semaphore renderFinishedS;
+	vk::Fence inFlightF;
+	// Signalled once the slot's last present is done with its swapchain, VK_EXT_swapchain_maintenance1 only.
+	vk::Fence presentF;
+	bool presentPending = false;
+};
+
+// Vertex input of the shared 16 byte PackedVertex, the layout cooked meshes are stored in. Nothing
+// is textured yet, so the UVs aren't fetched. shader.vert decodes the position with the mesh's
+// MeshQuantization push constants, the normal is unpacked from its octahedral snorm16s.
+inline vk::VertexInputBindingDescription packedVertexBinding() {
+	return { 0, sizeof(PackedVertex), vk::VertexInputRate::eVertex };
+}
+
+inline std::array<vk::VertexInputAttributeDescription, 2> packedVertexAttributes() {
+	return { {
+		{ 0, 0, vk::Format::eR16G16B16A16Unorm, offsetof(PackedVertex, position) },
+		{ 1, 0, vk::Format::eR16G16Snorm, offsetof(PackedVertex, normal) }
+	} };
+}
+
+// Device local vertex and index buffers of one uploaded mesh.
+struct MeshBuffers {
+	vk::Buffer vertexBuffer;
+	Allocation vertexAllocation;
+	vk::Buffer indexBuffer;
+	Allocation indexAllocation;
+	uint32_t indexCount = 0;
+	vk::IndexType indexType = vk::IndexType::eUint16;
+	MeshQuantization quantization = {};
+};
+
+struct FrameStats {
+	uint32_t frameCount = 0;
+	double totalMs = 0;
+	double avgMs = 0;
+	double minMs = 0;
+	double maxMs = 0;
+	double p99Ms = 0;
+	// Culling, the time averaged over the frames and the counts of the last one.
+	double avgCullMs = 0;
+	size_t visibleDraws = 0;
+	size_t culledDraws = 0;
+	// Recording the frame's command buffers, averaged over the frames.
+	double avgRecordMs = 0;
+	uint32_t recordingThreads = 0;
+};
+
+// Swapchain objects replaced by a resize, kept alive until the frames that used them are done and
+// its presents have finished.
+struct RetiredSwapchain {
+	vk::SwapchainKHR swapchain;
+	std::vector<vk::ImageView> imageViews;
+	std::vector<vk::Framebuffer> framebuffers;
+	uint64_t retiredAtFrame = 0;
+	// First frame presented on a newer swapchain, UINT64_MAX until then. Only used without present fences.
+	uint64_t newPresentFrame = UINT64_MAX;
+};
+
 struct SwapChainSupportDetails {
 	vk::SurfaceCapabilitiesKHR capabilities;
 	std::vector<vk::SurfaceFormatKHR> formats;
@@ -70,7 +152,27 @@ public:
 
 	void init();
 	void run();
-	void cleanup() const;
+	void cleanup();
+
+	// Headless mode renders into offscreen images instead of a window/swapchain.
+	// Must be set before init().
+	void setHeadless(bool);
+	void setSize(int, int);
+	void setFramesInFlight(uint32_t);
+	// Mesh file (.obj, .gltf, .glb) drawn instead of the quad, cooked into MESH_CACHE_DIRECTORY the
+	// first time. Must be set before init().
+	void setMeshPath(const std::string&);
+	// Draws the mesh this many times, a stand in for a scene until there is one (recording benchmarks).
+	void setDrawCount(uint32_t);
+	// Threads recording each frame's draws, 0 for every jobSystem() thread. Must be set before init().
+	void setRecordingThreads(uint32_t);
+
+	// Headless frame loop, returns CPU side frame times.
+	FrameStats renderFrames(uint32_t);
+
+	// Reads the last rendered frame back to host memory as tightly packed RGBA8.
+	[[nodiscard]] std::vector<uint8_t> readbackFrame();
+	void saveFrame(const std::string&);
 
 private:
 	void initWindow();
@@ -79,36 +181,57 @@ private:
 	void pickPhysicalDevice();
 	void createLogicalDevice();
 	void createSurface();
+	void createAllocator();
 	void createSwagChain();
+	void createOffscreenTargets();
 	void createImageViews();
 	void createRenderPass();
+	void createPipelineCache();
 	void createGraphicsPipeline();
 	void createFramebuffers();
 	void createCommandPool();
-	void createCommandBuffer();
+	void createCommandBuffers();
 	void createSyncObjects();
+	void createStagingRing();
+	void createMesh();
+	void cullDraws();
+
+	MeshBuffers uploadMesh(const PackedVertex*, uint32_t, const void*, uint32_t, IndexFormat, const MeshQuantization&);
+	void destroyMesh(const MeshBuffers&);
+
+	bool recreateSwapchain();
+	void releaseRetiredSwapchains(bool);
 
 	void drawFrame();
 
 	[[nodiscard]] bool checkValidationLayerSupport() const;
 	[[nodiscard]] bool checkDeviceExtensionSupport(vk::PhysicalDevice) const;
 	[[nodiscard]] std::vector<const char*> getRequiredExtensions() const;
+	[[nodiscard]] std::vector<const char*> getRequiredDeviceExtensions() const;
 	bool isDeviceGucci(vk::PhysicalDevice) const;
 
 	QueueFamilyIndices findQueueFamilies(vk::PhysicalDevice) const;
 	SwapChainSupportDetails querySwapChainSupport(vk::PhysicalDevice) const;
 
-	static std::vector<char> readFile(const std::string&);
+	// Whole asset through mFiles, from the asset pack or a loose file.
+	[[nodiscard]] std::vector<char> readFile(const std::string&) const;
 
 	vk::ShaderModule createShaderModule(const std::vector<char>&) const;
 
+	vk::CommandBuffer beginOneTimeCommands() const;
+	void endOneTimeCommands(vk::CommandBuffer) const;
+
 	void recordCommandBuffer(vk::CommandBuffer, uint32_t);
+	// Draws [begin, end) of mVisibleDraws into a secondary buffer inside the render pass.
+	void recordDraws(vk::CommandBuffer, size_t, size_t) const;
 
 	// Swap Chain Config
 	vk::SurfaceFormatKHR chooseSwapSurfaceFormat(const std::vector<vk::SurfaceFormatKHR>&);
 	vk::PresentModeKHR chooseSwapPresentMode(const std::vector<vk::PresentModeKHR>&);
 	vk::Extent2D chooseSwapExtent(const vk::SurfaceCapabilitiesKHR&) const;
 
+	static void framebufferResizeCallback(GLFWwindow*, int, int);
+
 	// Debug stuff
 	static VKAPI_ATTR vk::Bool32 VKAPI_CALL debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT, VkDebugUtilsMessageTypeFlagsEXT, const VkDebugUtilsMessengerCallbackDataEXT*, void*);
 	void setupDebugMessenger();
@@ -122,6 +245,8 @@ private:
 	vk::Instance mInstance;
 	vk::PhysicalDevice mPhysicalDevice = VK_NULL_HANDLE;
 	vk::Device mLogicalDevice;
+	MemoryAllocator mAllocator;
+	StagingRing mStagingRing;
 	vk::Queue mGraphicsQueue;
 	vk::Queue mPresentQueue;
 	vk::SurfaceKHR mSurface;
@@ -129,25 +254,66 @@ private:
 	std::vector<vk::Image> mSwapchainImages;
 	std::vector<vk::ImageView> mSwapchainImageViews;
 
+	// Headless render targets, stand in for the swapchain images.
+	std::vector<Allocation> mOffscreenAllocations;
+	uint32_t mOffscreenIndex = 0;
+	uint32_t mLastImageIndex = 0;
+
+	// One time commands (uploads, readback). Frame command buffers come from mRecorder.
 	vk::CommandPool mCommandPool;
-	vk::CommandBuffer mCommandBuffer;
+	CommandRecorder mRecorder;
+	uint32_t mRecordingThreads = 0;
+	double mRecordMs = 0;
+
+	VirtualFileSystem mFiles;
+
+	MeshBuffers mMesh;
+	std::string mMeshPath;
+
+	// World boxes of the draws and the ones cullDraws() kept for this frame.
+	CullBoxesSoA mDrawBounds;
+	std::vector<uint32_t> mVisibleDraws;
+	CullStats mCullStats;
+	uint32_t mDrawCount = 1;
 
 	vk::Format mSwapchainImageFormat;
 	vk::Extent2D mSwapchainExtent;
 	std::vector<vk::Framebuffer> mSwapchainFramebuffers;
 
+	// Set by resizes and out of date/suboptimal results, the swapchain is rebuilt on the next drawFrame().
+	bool mSwapchainDirty = false;
+	std::vector<RetiredSwapchain> mRetiredSwapchains;
+	// VK_EXT_surface_maintenance1 on the instance, and VK_EXT_swapchain_maintenance1 (present fences) on the device.
+	bool mSurfaceMaintenance1 = false;
+	bool mSwapchainMaintenance1 = false;
+
 	vk::RenderPass mRenderPass;
 	vk::PipelineLayout mPipelineLayout;
 	vk::Pipeline mGraphicsPipeline;
+	PipelineCache mPipelineCache;
+
+	// Frames in flight ring, mCurrentFrame is the slot being recorded.
+	std::vector<FrameData> mFrames;
+	uint32_t mFramesInFlight = 2;
+	uint32_t mCurrentFrame = 0;
+	uint64_t mFrameNumber = 0;
 
-	// Sync Objects
-	vk::Semaphore mImageAvailableS;
-	vk::Semaphore mRenderFinishedS;
-	vk::Fence mInFlightF;
+	// Fence of the frame slot last rendering to each swapchain image.
+	std::vector<vk::Fence> mImagesInFlight;
 
 	vk::DebugUtilsMessengerEXT mDebugMessenger;
 
 	vec2I mViewSize;
+	bool mHeadless = false;
+
+	static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 3;
+	static constexpr vk::DeviceSize STAGING_RING_SIZE = 16ull * 1024 * 1024;
+	static constexpr vk::Format OFFSCREEN_FORMAT = vk::Format::eR8G8B8A8Unorm;
+	static constexpr const char* MESH_CACHE_DIRECTORY = "cache/meshes";
+	static constexpr const char* ASSET_PACK = "Atom3D.apak";
+	// Fewer draws than this per secondary buffer cost more to stitch than to record on one thread.
+	static constexpr size_t MIN_DRAWS_PER_RECORDING_THREAD = 256;
+
 	const std::vector<const char*> mValidationLayers = {
 		"VK_LAYER_KHRONOS_validation"
 	};
@@ -165,5 +331,4 @@ private:
 
 }
 
-
 #endif
\ No newline at end of file
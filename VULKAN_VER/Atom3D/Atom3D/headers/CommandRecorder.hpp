@@ -0,0 +1,71 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_COMMAND_RECORDER_HPP
+#define ATOM_COMMAND_RECORDER_HPP
+
+#define VULKAN_HPP_NO_EXCEPTIONS
+#include <vulkan/vulkan.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace Atom {
+
+// Command pools for recording a frame on the job threads. Every frame slot has a pool for its
+// primary buffer and one per recorded range (up to threadCount) for secondary buffers. A range is
+// recorded by a single job, so no pool is ever used by two threads at once and recording takes no
+// locks. Pools aren't tied to job threads, one thread may record several ranges, each from the
+// range's own pool. The pools are made without RESET_COMMAND_BUFFER: beginFrame resets a slot's
+// pools whole, which puts every buffer allocated from them back to the initial state. Buffers stay
+// allocated and are reused the next time around.
+class CommandRecorder {
+public:
+	CommandRecorder() = default;
+
+	void init(vk::Device, uint32_t queueFamily, uint32_t frameSlots, uint32_t threadCount);
+	void destroy();
+
+	// Resets the slot's pools, the GPU has to be done with it (drawFrame waited on its fence).
+	// Returns the slot's primary buffer, ready to begin.
+	vk::CommandBuffer beginFrame(uint32_t slot);
+
+	// Splits [0, count) into up to threadCount ranges of at least minPerThread items and records
+	// range i into a secondary buffer from range i's pool, the ranges spread over jobSystem().
+	// record(buffer, begin, end) runs between the buffer's begin() and end(). The buffer continues
+	// inheritance's render pass, but no state is inherited, so it binds its own. It runs concurrently
+	// with the other ranges and must not throw. Returns the buffers in range order, for executeCommands.
+	const std::vector<vk::CommandBuffer>& recordSecondaries(const vk::CommandBufferInheritanceInfo& inheritance, size_t count, size_t minPerThread,
+		const std::function<void(vk::CommandBuffer, size_t, size_t)>& record);
+
+	[[nodiscard]] uint32_t threadCount() const { return mThreadCount; }
+
+private:
+	struct RangePool {
+		vk::CommandPool pool;
+		std::vector<vk::CommandBuffer> buffers;
+		// Buffers handed out since the last reset.
+		size_t used = 0;
+	};
+
+	struct FrameSlot {
+		vk::CommandPool primaryPool;
+		vk::CommandBuffer primary;
+		std::vector<RangePool> ranges;
+	};
+
+	vk::Device mDevice;
+	std::vector<FrameSlot> mSlots;
+	uint32_t mCurrentSlot = 0;
+	uint32_t mThreadCount = 1;
+
+	// Last recordSecondaries() call, buffers and their begin/end results by range.
+	std::vector<vk::CommandBuffer> mRecorded;
+	std::vector<vk::Result> mResults;
+};
+
+}
+
+#endif
@@ -0,0 +1,114 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_MEMORY_ALLOCATOR_HPP
+#define ATOM_MEMORY_ALLOCATOR_HPP
+
+#define VULKAN_HPP_NO_EXCEPTIONS
+#include <vulkan/vulkan.hpp>
+
+#include "Tlsf.hpp"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Atom {
+
+// A sub-allocated (or dedicated) range of device memory. Keep it around to free the range later.
+struct Allocation {
+	vk::DeviceMemory memory;
+	vk::DeviceSize offset = 0;
+	vk::DeviceSize size = 0;
+	void* mapped = nullptr; // Persistently mapped pointer for host visible memory, already offset.
+
+	uint32_t memoryType = 0;
+	uint32_t block = UINT32_MAX; // UINT32_MAX for dedicated allocations.
+	uint32_t node = Tlsf::INVALID_NODE;
+	bool linear = true;
+
+	[[nodiscard]] bool dedicated() const { return block == UINT32_MAX; }
+};
+
+struct MemoryTypeStats {
+	uint32_t blockCount = 0;
+	uint32_t allocationCount = 0;
+	uint32_t dedicatedCount = 0;
+	uint32_t freeRangeCount = 0;
+	vk::DeviceSize blockBytes = 0;     // Reserved from the driver for blocks.
+	vk::DeviceSize usedBytes = 0;      // Handed out from blocks.
+	vk::DeviceSize dedicatedBytes = 0;
+	vk::DeviceSize largestFreeRange = 0;
+
+	// 0 when all free space is one range, towards 1 as it splinters.
+	[[nodiscard]] double fragmentation() const {
+		const auto freeBytes = blockBytes - usedBytes;
+		return freeBytes ? 1.0 - static_cast<double>(largestFreeRange) / static_cast<double>(freeBytes) : 0.0;
+	}
+};
+
+struct AllocatorStats {
+	std::vector<MemoryTypeStats> memoryTypes;
+	uint32_t deviceAllocationCount = 0; // Live vkAllocateMemory calls, vs maxMemoryAllocationCount.
+	uint32_t maxDeviceAllocations = 0;
+};
+
+// Sub-allocates buffers and images out of large vk::DeviceMemory blocks, one set of blocks per memory
+// type, TLSF inside each block. Big or driver-preferred resources get a dedicated allocation instead.
+// Linear (buffers) and optimal (images) resources live in separate blocks so bufferImageGranularity
+// never has to be considered between neighbours.
+class MemoryAllocator {
+public:
+	MemoryAllocator() = default;
+
+	void init(vk::PhysicalDevice, vk::Device, vk::DeviceSize blockSize = DEFAULT_BLOCK_SIZE);
+	void destroy();
+
+	Allocation allocate(const vk::MemoryRequirements&, vk::MemoryPropertyFlags, bool linear, bool dedicated = false);
+	void free(const Allocation&);
+
+	// Create + allocate + bind in one go.
+	vk::Buffer createBuffer(const vk::BufferCreateInfo&, vk::MemoryPropertyFlags, Allocation&);
+	vk::Image createImage(const vk::ImageCreateInfo&, vk::MemoryPropertyFlags, Allocation&);
+	void destroyBuffer(vk::Buffer, const Allocation&);
+	void destroyImage(vk::Image, const Allocation&);
+
+	[[nodiscard]] uint32_t findMemoryType(uint32_t, vk::MemoryPropertyFlags) const;
+
+	[[nodiscard]] AllocatorStats stats() const;
+	void report() const;
+
+	static constexpr vk::DeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+
+private:
+	struct Block {
+		vk::DeviceMemory memory;
+		std::unique_ptr<Tlsf> tlsf;
+		void* mapped = nullptr;
+		bool linear = true;
+	};
+
+	struct MemoryType {
+		std::vector<Block> blocks; // Empty slots have a null tlsf and get reused.
+		uint32_t dedicatedCount = 0;
+		vk::DeviceSize dedicatedBytes = 0;
+	};
+
+	Allocation allocateDedicated(vk::DeviceSize, uint32_t, const vk::MemoryDedicatedAllocateInfo*);
+	bool allocateFromBlocks(const vk::MemoryRequirements&, uint32_t, bool, Allocation&);
+	uint32_t createBlock(uint32_t, bool, const vk::MemoryRequirements&);
+	void* mapIfHostVisible(vk::DeviceMemory, uint32_t, vk::DeviceSize) const;
+
+	vk::Device mDevice;
+	vk::PhysicalDeviceMemoryProperties mMemoryProperties;
+	vk::DeviceSize mBlockSize = DEFAULT_BLOCK_SIZE;
+	uint32_t mMaxAllocations = 0;
+	uint32_t mDeviceAllocationCount = 0;
+
+	std::vector<MemoryType> mTypes;
+	mutable std::mutex mMutex;
+};
+
+}
+
+#endif
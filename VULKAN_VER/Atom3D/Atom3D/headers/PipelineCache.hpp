@@ -0,0 +1,71 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_PIPELINE_CACHE_HPP
+#define ATOM_PIPELINE_CACHE_HPP
+
+#define VULKAN_HPP_NO_EXCEPTIONS
+#include <vulkan/vulkan.hpp>
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace Atom {
+
+// Header written in front of the driver's cache blob. The driver validates its own header, but
+// driverVersion is not part of it, and a stale blob from an old driver is just wasted I/O.
+struct PipelineCacheHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t vendorID;
+	uint32_t deviceID;
+	uint32_t driverVersion;
+	uint8_t uuid[VK_UUID_SIZE];
+	uint64_t dataSize;
+	uint64_t dataHash;
+	double coldCompileMs; // Total compile time of the last run that missed, for the "time saved" report.
+};
+
+struct PipelineCacheStats {
+	uint32_t hits = 0;
+	uint32_t misses = 0;
+	double createMs = 0;
+	double coldCompileMs = 0;
+	bool loaded = false;
+};
+
+// vk::PipelineCache persisted to disk between runs, one file per device UUID.
+class PipelineCache {
+public:
+	PipelineCache() = default;
+
+	void init(vk::PhysicalDevice, vk::Device, const std::string& directory = ".");
+	void save() const;
+	void destroy() const;
+
+	vk::Pipeline createGraphicsPipeline(const vk::GraphicsPipelineCreateInfo&);
+
+	void report() const;
+
+	[[nodiscard]] vk::PipelineCache handle() const { return mCache; }
+	[[nodiscard]] const PipelineCacheStats& stats() const { return mStats; }
+
+private:
+	std::vector<uint8_t> loadFile();
+	[[nodiscard]] static uint64_t hash(const uint8_t*, size_t);
+
+	vk::Device mDevice;
+	vk::PipelineCache mCache;
+	vk::PhysicalDeviceProperties mProperties;
+	std::string mPath;
+
+	PipelineCacheStats mStats;
+
+	static constexpr uint32_t CACHE_MAGIC = 0x4D544341; // "ACTM"
+	static constexpr uint32_t CACHE_VERSION = 1;
+};
+
+}
+
+#endif
@@ -0,0 +1,65 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_STAGING_RING_HPP
+#define ATOM_STAGING_RING_HPP
+
+#define VULKAN_HPP_NO_EXCEPTIONS
+#include <vulkan/vulkan.hpp>
+
+#include "MemoryAllocator.hpp"
+#include "RingAllocator.hpp"
+
+#include <cstring>
+
+namespace Atom {
+
+struct StagingAllocation {
+	vk::Buffer buffer;
+	vk::DeviceSize offset = 0;
+	vk::DeviceSize size = 0;
+	void* mapped = nullptr;
+};
+
+// Persistently mapped, host coherent upload buffer. Allocations are bumped out of the current frame
+// slot, and the slot's space comes back once drawFrame has waited on its fence. Today it only stages
+// mesh uploads (uploadMesh), which wait for their copy anyway. Nothing per frame goes through it
+// yet, the draws take their data from push constants.
+class StagingRing {
+public:
+	StagingRing() = default;
+
+	void init(MemoryAllocator&, vk::PhysicalDevice, vk::DeviceSize size, uint32_t frameSlots);
+	void destroy(MemoryAllocator&);
+
+	void beginFrame(uint32_t slot);
+
+	// Throws when the ring is full.
+	StagingAllocation allocate(vk::DeviceSize size, vk::DeviceSize alignment);
+	// Same, but mapped is nullptr when it doesn't fit, for callers with somewhere else to go.
+	StagingAllocation tryAllocate(vk::DeviceSize size, vk::DeviceSize alignment);
+	StagingAllocation allocateUniform(vk::DeviceSize size) { return allocate(size, mUniformAlignment); }
+
+	template<typename T>
+	StagingAllocation upload(const T& data, vk::DeviceSize alignment) {
+		auto a = allocate(sizeof(T), alignment);
+		memcpy(a.mapped, &data, sizeof(T));
+		return a;
+	}
+
+	[[nodiscard]] vk::Buffer buffer() const { return mBuffer; }
+
+	void report() const;
+
+private:
+	vk::Buffer mBuffer;
+	Allocation mAllocation;
+	RingAllocator mRing;
+
+	vk::DeviceSize mUniformAlignment = 256;
+	vk::DeviceSize mCopyAlignment = 16;
+};
+
+}
+
+#endif
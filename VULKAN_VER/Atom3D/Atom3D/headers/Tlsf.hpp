@@ -0,0 +1,80 @@
+// ReSharper disable CppInconsistentNaming
+#pragma once
+
+#ifndef ATOM_TLSF_HPP
+#define ATOM_TLSF_HPP
+
+#include <cstdint>
+#include <vector>
+
+namespace Atom {
+
+// Two level segregated fit allocator over an abstract range [0, size). It never touches the memory
+// it manages, all bookkeeping lives in mNodes, so it works for GPU memory blocks.
+// Allocation and free are O(1): one bitmap scan per level, plus neighbour merging on free.
+class Tlsf {
+public:
+	static constexpr uint32_t INVALID_NODE = UINT32_MAX;
+
+	// Offsets and sizes are kept multiples of MIN_ALLOC, so alignment padding is always big enough
+	// to become a free range of its own.
+	static constexpr uint64_t MIN_ALLOC = 256;
+
+	struct Allocation {
+		uint64_t offset = 0;
+		uint64_t size = 0;
+		uint32_t node = INVALID_NODE;
+	};
+
+	explicit Tlsf(uint64_t size);
+
+	[[nodiscard]] bool allocate(uint64_t size, uint64_t alignment, Allocation& out);
+	void free(uint32_t node);
+
+	[[nodiscard]] uint64_t size() const { return mSize; }
+	[[nodiscard]] uint64_t usedBytes() const { return mUsed; }
+	[[nodiscard]] uint64_t freeBytes() const { return mSize - mUsed; }
+	[[nodiscard]] uint32_t allocationCount() const { return mAllocationCount; }
+	[[nodiscard]] uint64_t largestFreeRange() const;
+	[[nodiscard]] uint32_t freeRangeCount() const;
+	[[nodiscard]] bool empty() const { return mAllocationCount == 0; }
+
+private:
+	static constexpr uint32_t SL_LOG2 = 5;
+	static constexpr uint32_t SL_COUNT = 1u << SL_LOG2;
+	static constexpr uint32_t FL_COUNT = 48;
+
+	struct Node {
+		uint64_t offset;
+		uint64_t size;
+		uint32_t prevPhys;
+		uint32_t nextPhys;
+		uint32_t prevFree;
+		uint32_t nextFree;
+		bool free;
+	};
+
+	static void mapping(uint64_t size, uint32_t& fl, uint32_t& sl);
+	static void mappingSearch(uint64_t size, uint32_t& fl, uint32_t& sl);
+
+	uint32_t findSuitable(uint32_t& fl, uint32_t& sl) const;
+	uint32_t newNode();
+	void releaseNode(uint32_t);
+	void insertFree(uint32_t);
+	void removeFree(uint32_t);
+
+	std::vector<Node> mNodes;
+	std::vector<uint32_t> mSpareNodes;
+
+	uint64_t mFlBitmap = 0;
+	uint32_t mSlBitmap[FL_COUNT] = {};
+	uint32_t mHeads[FL_COUNT][SL_COUNT];
+
+	uint64_t mSize;
+	uint64_t mUsed = 0;
+	uint32_t mAllocationCount = 0;
+};
+
+}
+
+#endif
@@ -9,24 +9,72 @@ AtomCore::AtomCore() {
 }
 
 void AtomCore::init() {
-	initWindow();
+	// Starts the job threads from here, so this thread is the one whose waits help with the work.
+	jobSystem();
+
+	// Loose files under the working directory, the asset pack (packassets) over them when there is one.
+	mFiles.mountDirectory(".");
+	mFiles.mountPack(ASSET_PACK);
+
+	if (!mHeadless)
+		initWindow();
+
 	initVulkan();
 }
 
+void AtomCore::setHeadless(bool headless) {
+	mHeadless = headless;
+}
+
+void AtomCore::setSize(int x, int y) {
+	mViewSize = { x, y };
+}
+
+void AtomCore::setFramesInFlight(uint32_t count) {
+	mFramesInFlight = std::clamp(count, 1u, MAX_FRAMES_IN_FLIGHT);
+}
+
+void AtomCore::setMeshPath(const std::string& path) {
+	mMeshPath = path;
+}
+
+void AtomCore::setDrawCount(uint32_t count) {
+	mDrawCount = std::max(count, 1u);
+}
+
+void AtomCore::setRecordingThreads(uint32_t count) {
+	mRecordingThreads = count;
+}
+
 void AtomCore::initVulkan() {
 	createInstance();
 	setupDebugMessenger();
-	createSurface();
+
+	if (!mHeadless)
+		createSurface();
+
 	pickPhysicalDevice();
 	createLogicalDevice();
-	createSwagChain();
+	createAllocator();
+
+	if (mHeadless)
+		createOffscreenTargets();
+	else
+		createSwagChain();
+
 	createImageViews();
 	createRenderPass();
+	createPipelineCache();
 	createGraphicsPipeline();
 	createFramebuffers();
 	createCommandPool();
-	createCommandBuffer();
+	createStagingRing();
+	createMesh();
+	createCommandBuffers();
 	createSyncObjects();
+
+	mPipelineCache.report();
+	mAllocator.report();
 }
 
 
@@ -50,7 +98,26 @@ void AtomCore::createInstance() {
 	createInfo.sType = vk::StructureType::eInstanceCreateInfo;
 	createInfo.pApplicationInfo = &appInfo;
 
-	const auto extensions = getRequiredExtensions();
+	auto extensions = getRequiredExtensions();
+
+	// Needed by VK_EXT_swapchain_maintenance1 on the device, optional.
+	if (!mHeadless) {
+		const auto available = vk::enumerateInstanceExtensionProperties();
+		bool surfaceMaintenance1 = false, surfaceCapabilities2 = false;
+
+		if (available.result == vk::Result::eSuccess) {
+			for (const auto& e : available.value) {
+				surfaceMaintenance1 |= strcmp(e.extensionName, VK_EXT_SURFACE_MAINTENANCE_1_EXTENSION_NAME) == 0;
+				surfaceCapabilities2 |= strcmp(e.extensionName, VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME) == 0;
+			}
+		}
+
+		if (surfaceMaintenance1 && surfaceCapabilities2) {
+			extensions.push_back(VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME);
+			extensions.push_back(VK_EXT_SURFACE_MAINTENANCE_1_EXTENSION_NAME);
+			mSurfaceMaintenance1 = true;
+		}
+	}
 
 	createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
 	createInfo.ppEnabledExtensionNames = extensions.data();
@@ -91,6 +158,8 @@ void AtomCore::createSurface() {
 
 	if (glfwCreateWindowSurface(mInstance, mWindow, nullptr, &pSurf) != VK_SUCCESS)
 		throw std::runtime_error("Failed to create window surface");
+
+	mSurface = vk::SurfaceKHR(pSurf);
 }
 
 
@@ -144,8 +213,36 @@ void AtomCore::createLogicalDevice() {
 
 	createInfo.pEnabledFeatures = &deviceFeatures;
 
-	createInfo.enabledExtensionCount = static_cast<uint32_t>(mDeviceExtensions.size());
-	createInfo.ppEnabledExtensionNames = mDeviceExtensions.data();
+	auto deviceExtensions = getRequiredDeviceExtensions();
+
+	// Present fences, the only way to know a retired swapchain's presents are done.
+	VkPhysicalDeviceSwapchainMaintenance1FeaturesEXT maintenance1 = {};
+	maintenance1.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SWAPCHAIN_MAINTENANCE_1_FEATURES_EXT;
+
+	if (mSurfaceMaintenance1) {
+		const auto available = mPhysicalDevice.enumerateDeviceExtensionProperties();
+		bool supported = false;
+
+		if (available.result == vk::Result::eSuccess)
+			for (const auto& e : available.value)
+				supported |= strcmp(e.extensionName, VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME) == 0;
+
+		if (supported) {
+			VkPhysicalDeviceFeatures2 features = {};
+			features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+			features.pNext = &maintenance1;
+			vkGetPhysicalDeviceFeatures2(mPhysicalDevice, &features);
+		}
+
+		if (maintenance1.swapchainMaintenance1) {
+			deviceExtensions.push_back(VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME);
+			createInfo.pNext = &maintenance1;
+			mSwapchainMaintenance1 = true;
+		}
+	}
+
+	createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
+	createInfo.ppEnabledExtensionNames = deviceExtensions.data();
 
 	if (mEnableValidationLayers) {
 		createInfo.enabledLayerCount = static_cast<uint32_t>(mValidationLayers.size());
@@ -164,6 +261,11 @@ void AtomCore::createLogicalDevice() {
 }
 
 
+void AtomCore::createAllocator() {
+	mAllocator.init(mPhysicalDevice, mLogicalDevice);
+}
+
+
 void AtomCore::createSwagChain() {
 	const auto support = querySwapChainSupport(mPhysicalDevice);
 
@@ -176,51 +278,84 @@ void AtomCore::createSwagChain() {
 	if (support.capabilities.maxImageCount > 0 && imageCount > support.capabilities.maxImageCount)
 		imageCount = support.capabilities.maxImageCount;
 
-	VkSwapchainCreateInfoKHR createInfo = {};
+	auto createInfo = vk::SwapchainCreateInfoKHR();
+	createInfo.setSurface(mSurface);
 
-	createInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
-	createInfo.surface = mSurface;
-
-	createInfo.minImageCount = imageCount;
-	createInfo.imageFormat = surfaceFormat.format;
-	createInfo.imageColorSpace = surfaceFormat.colorSpace;
-	createInfo.imageExtent = extent;
-	createInfo.imageArrayLayers = 1;
-	createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+	createInfo.setMinImageCount(imageCount);
+	createInfo.setImageFormat(surfaceFormat.format);
+	createInfo.setImageColorSpace(surfaceFormat.colorSpace);
+	createInfo.setImageExtent(extent);
+	createInfo.setImageArrayLayers(1);
+	createInfo.setImageUsage(vk::ImageUsageFlagBits::eColorAttachment);
 
 	QueueFamilyIndices indices = findQueueFamilies(mPhysicalDevice);
 	uint32_t pIndices[] = { indices.graphicsFamily.value(), indices.presentFamily.value() };
 
 	if (indices.graphicsFamily != indices.presentFamily) {
-		createInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
-		createInfo.queueFamilyIndexCount = 2;
-		createInfo.pQueueFamilyIndices = pIndices;
+		createInfo.setImageSharingMode(vk::SharingMode::eConcurrent);
+		createInfo.setQueueFamilyIndexCount(2);
+		createInfo.setPQueueFamilyIndices(pIndices);
 	} else {
-		createInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
-		createInfo.queueFamilyIndexCount = 0;
-		createInfo.pQueueFamilyIndices = nullptr;
+		createInfo.setImageSharingMode(vk::SharingMode::eExclusive);
 	}
 
-	createInfo.preTransform = support.capabilities.currentTransform;
-	createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+	createInfo.setPreTransform(support.capabilities.currentTransform);
+	createInfo.setCompositeAlpha(vk::CompositeAlphaFlagBitsKHR::eOpaque);
 
-	createInfo.presentMode = presentMode;
-	createInfo.clipped = VK_TRUE;
+	createInfo.setPresentMode(presentMode);
+	createInfo.setClipped(vk::True);
 
-	createInfo.oldSwapchain = VK_NULL_HANDLE;
+	// Null on first creation. On a resize the old swapchain hands its images over to the new one,
+	// frames still in flight on it can finish and present.
+	createInfo.setOldSwapchain(mSwapchain);
 
-	if (vkCreateSwapchainKHR(mLogicalDevice, &createInfo, nullptr, &mSwapchain) != VK_SUCCESS)
+	auto sr = mLogicalDevice.createSwapchainKHR(createInfo);
+	if (sr.result != vk::Result::eSuccess)
 		throw std::runtime_error("Failed to create swap chain.\n");
 
-	vkGetSwapchainImagesKHR(mLogicalDevice, mSwapchain, &imageCount, nullptr);
-	mSwapchainImages.resize(imageCount);
-	vkGetSwapchainImagesKHR(mLogicalDevice, mSwapchain, &imageCount, mSwapchainImages.data());
+	mSwapchain = sr.value;
+
+	auto ir = mLogicalDevice.getSwapchainImagesKHR(mSwapchain);
+	if (ir.result != vk::Result::eSuccess)
+		throw std::runtime_error("Failed to get swap chain images.\n");
+
+	mSwapchainImages = ir.value;
 
 	mSwapchainImageFormat = surfaceFormat.format;
 	mSwapchainExtent = extent;
 }
 
 
+// Headless stand-in for the swap chain. Plain device local images that the render pass
+// leaves in TRANSFER_SRC so they can be read back.
+void AtomCore::createOffscreenTargets() {
+	mSwapchainImageFormat = OFFSCREEN_FORMAT;
+	mSwapchainExtent = vk::Extent2D(static_cast<uint32_t>(mViewSize.x), static_cast<uint32_t>(mViewSize.y));
+
+	// One target per frame slot so frames in flight never wait on each other's image.
+	const uint32_t imageCount = std::max(mFramesInFlight, 2u);
+
+	mSwapchainImages.resize(imageCount);
+	mOffscreenAllocations.resize(imageCount);
+
+	for (uint32_t i = 0; i < imageCount; i++) {
+		auto imageInfo = vk::ImageCreateInfo();
+		imageInfo.setImageType(vk::ImageType::e2D);
+		imageInfo.setFormat(mSwapchainImageFormat);
+		imageInfo.setExtent({ mSwapchainExtent.width, mSwapchainExtent.height, 1 });
+		imageInfo.setMipLevels(1);
+		imageInfo.setArrayLayers(1);
+		imageInfo.setSamples(vk::SampleCountFlagBits::e1);
+		imageInfo.setTiling(vk::ImageTiling::eOptimal);
+		imageInfo.setUsage(vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc);
+		imageInfo.setSharingMode(vk::SharingMode::eExclusive);
+		imageInfo.setInitialLayout(vk::ImageLayout::eUndefined);
+
+		mSwapchainImages[i] = mAllocator.createImage(imageInfo, vk::MemoryPropertyFlagBits::eDeviceLocal, mOffscreenAllocations[i]);
+	}
+}
+
+
 void AtomCore::createImageViews() {
 	mSwapchainImageViews.resize(mSwapchainImages.size());
 
@@ -259,7 +394,7 @@ void AtomCore::createRenderPass() {
 	colorAtt.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 	colorAtt.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	colorAtt.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	colorAtt.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	colorAtt.finalLayout = mHeadless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
 	VkAttachmentReference caRef = {};
 	caRef.attachment = 0;
@@ -292,6 +427,11 @@ void AtomCore::createRenderPass() {
 }
 
 
+void AtomCore::createPipelineCache() {
+	mPipelineCache.init(mPhysicalDevice, mLogicalDevice);
+}
+
+
 // Beefy boy
 void AtomCore::createGraphicsPipeline() {
 	auto vertShader = readFile("GLSL/vert.spv");
@@ -313,12 +453,15 @@ void AtomCore::createGraphicsPipeline() {
 
 	VkPipelineShaderStageCreateInfo stages[] = { vertStageInfo, fragStageInfo };
 
+	const auto bindingDescription = packedVertexBinding();
+	const auto attributeDescriptions = packedVertexAttributes();
+
 	VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
 	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-	vertexInputInfo.vertexBindingDescriptionCount = 0;
-	vertexInputInfo.pVertexBindingDescriptions = nullptr;
-	vertexInputInfo.vertexAttributeDescriptionCount = 0;
-	vertexInputInfo.pVertexAttributeDescriptions = nullptr;
+	vertexInputInfo.vertexBindingDescriptionCount = 1;
+	vertexInputInfo.pVertexBindingDescriptions = &static_cast<const VkVertexInputBindingDescription&>(bindingDescription);
+	vertexInputInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+	vertexInputInfo.pVertexAttributeDescriptions = &static_cast<const VkVertexInputAttributeDescription&>(attributeDescriptions[0]);
 
 	VkPipelineInputAssemblyStateCreateInfo inputAss = {};
 	inputAss.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -375,10 +518,16 @@ void AtomCore::createGraphicsPipeline() {
 	dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
 	dynamicState.pDynamicStates = dynamicStates.data();
 
+	VkPushConstantRange quantizationRange = {};
+	quantizationRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	quantizationRange.offset = 0;
+	quantizationRange.size = sizeof(MeshQuantization);
+
 	VkPipelineLayoutCreateInfo pipeLayoutInfo = {};
 	pipeLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
 	pipeLayoutInfo.setLayoutCount = 0;
-	pipeLayoutInfo.pushConstantRangeCount = 0;
+	pipeLayoutInfo.pushConstantRangeCount = 1;
+	pipeLayoutInfo.pPushConstantRanges = &quantizationRange;
 
 	if (vkCreatePipelineLayout(mLogicalDevice, &pipeLayoutInfo, nullptr, &mPipelineLayout) != VK_SUCCESS)
 		throw std::runtime_error("Failed to create pipeline layout.\n");
@@ -400,8 +549,7 @@ void AtomCore::createGraphicsPipeline() {
 	pipeInfo.subpass = 0;
 	pipeInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-	if (vkCreateGraphicsPipelines(mLogicalDevice, VK_NULL_HANDLE, 1, &pipeInfo, nullptr, &mGraphicsPipeline) != VK_SUCCESS)
-		throw std::runtime_error("Failed to create graphics pipeline.\n");
+	mGraphicsPipeline = mPipelineCache.createGraphicsPipeline(vk::GraphicsPipelineCreateInfo(pipeInfo));
 
 	vkDestroyShaderModule(mLogicalDevice, fragModule, nullptr);
 	vkDestroyShaderModule(mLogicalDevice, vertModule, nullptr);
@@ -434,80 +582,353 @@ void AtomCore::createCommandPool() {
 
 	VkCommandPoolCreateInfo poolInfo = {};
 	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
 	poolInfo.queueFamilyIndex = qfi.graphicsFamily.value();
 
 	if (vkCreateCommandPool(mLogicalDevice, &poolInfo, nullptr, &mCommandPool) != VK_SUCCESS)
 		throw std::runtime_error("Failed to create command pool.\n");
 }
 
-void AtomCore::createCommandBuffer() {
-	VkCommandBufferAllocateInfo allocInfo = {};
-	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	allocInfo.commandPool = mCommandPool;
-	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-	allocInfo.commandBufferCount = 1;
+// A primary buffer per frame slot plus pools for every recording thread, see recordCommandBuffer.
+void AtomCore::createCommandBuffers() {
+	mFrames.resize(mFramesInFlight);
 
-	if (vkAllocateCommandBuffers(mLogicalDevice, &allocInfo, &mCommandBuffer) != VK_SUCCESS)
-		throw std::runtime_error("Failed to create command buffers.\n");
+	const QueueFamilyIndices qfi = findQueueFamilies(mPhysicalDevice);
+	mRecorder.init(mLogicalDevice, qfi.graphicsFamily.value(), mFramesInFlight, mRecordingThreads ? mRecordingThreads : jobSystem().threadCount());
 }
 
 void AtomCore::createSyncObjects() {
-	VkSemaphoreCreateInfo si = {};
-	si.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-	VkFenceCreateInfo fi = {};
-	fi.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-	fi.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+	auto si = vk::SemaphoreCreateInfo();
+	auto fi = vk::FenceCreateInfo();
+	fi.setFlags(vk::FenceCreateFlagBits::eSignaled);
+
+	for (auto& frame : mFrames) {
+		auto ias = mLogicalDevice.createSemaphore(si);
+		auto rfs = mLogicalDevice.createSemaphore(si);
+		auto iff = mLogicalDevice.createFence(fi);
 
-	if (vkCreateSemaphore(mLogicalDevice, &si, nullptr, &mImageAvailableS) != VK_SUCCESS ||
-		vkCreateSemaphore(mLogicalDevice, &si, nullptr, &mRenderFinishedS) != VK_SUCCESS ||
-		vkCreateFence(mLogicalDevice, &fi, nullptr, &mInFlightF) != VK_SUCCESS)
-		throw std::runtime_error("Failed to create semaphores/fences.\n");
+		if (ias.result != vk::Result::eSuccess || rfs.result != vk::Result::eSuccess || iff.result != vk::Result::eSuccess)
+			throw std::runtime_error("Failed to create semaphores/fences.\n");
 
+		frame.imageAvailableS = ias.value;
+		frame.renderFinishedS = rfs.value;
+		frame.inFlightF = iff.value;
 
+		if (mSwapchainMaintenance1) {
+			auto pf = mLogicalDevice.createFence(vk::FenceCreateInfo());
+
+			if (pf.result != vk::Result::eSuccess)
+				throw std::runtime_error("Failed to create semaphores/fences.\n");
+
+			frame.presentF = pf.value;
+		}
+	}
+
+	mImagesInFlight.assign(mSwapchainImages.size(), vk::Fence());
+}
+
+void AtomCore::createStagingRing() {
+	mStagingRing.init(mAllocator, mPhysicalDevice, STAGING_RING_SIZE, mFramesInFlight);
+}
+
+// Quad written as a triangle soup, the way exporters hand meshes over. Welding brings it from 6
+// vertices down to 4, the index buffer covers the rest.
+void AtomCore::createMesh() {
+	if (!mMeshPath.empty()) {
+		const CookedMesh mesh = loadMesh(mMeshPath, MESH_CACHE_DIRECTORY);
+
+		// No camera yet, fold a fit into the decode instead: centered, the longest side as wide as
+		// the quad, depth in 0..1. y and z are flipped, so the mesh is seen upright from +z like a
+		// right handed camera would, and counter clockwise front faces stay front faces.
+		MeshQuantization fit = mesh.quantization();
+		const float4 scale = fit.positionScale;
+		const float extent = std::max({ scale.x, scale.y, scale.z, 1e-6f });
+
+		fit.positionScale = { scale.x / extent, -scale.y / extent, -scale.z / extent, 0.0f };
+		fit.positionOffset = { -0.5f * scale.x / extent, 0.5f * scale.y / extent, 0.5f + 0.5f * scale.z / extent, 1.0f };
+
+		mMesh = uploadMesh(mesh.vertices(), mesh.vertexCount(), mesh.indexData(), mesh.indexCount(), mesh.indexFormat(), fit);
+		return;
+	}
+
+	const MeshVertex quad[] = {
+		{ { -0.5f, -0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f } },
+		{ {  0.5f, -0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 0.0f } },
+		{ {  0.5f,  0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f } },
+		{ {  0.5f,  0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 1.0f, 1.0f } },
+		{ { -0.5f,  0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f } },
+		{ { -0.5f, -0.5f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f } }
+	};
+
+	MeshBuilder<MeshVertex> builder;
+	builder.addTriangles(quad, std::size(quad));
+
+	auto mesh = builder.build();
+	optimizeMesh(mesh, offsetof(MeshVertex, position));
+
+	std::vector<PackedVertex> packed(mesh.vertices.size());
+	const MeshQuantization quantization = packVertices(mesh.vertices.data(), mesh.vertices.size(), UVFormat::Half, packed.data());
+
+	mMesh = uploadMesh(packed.data(), static_cast<uint32_t>(packed.size()), mesh.indexData.data(), mesh.indexCount, mesh.indexFormat, quantization);
+}
+
+// No camera yet, the mesh's decode places it in clip space, so its box is every draw (one unless
+// setDrawCount asked for more) and the frustum is the clip volume itself.
+void AtomCore::cullDraws() {
+	const auto start = std::chrono::steady_clock::now();
+
+	// positionQuantization's scales are never negative, but createMesh's fit for a cooked mesh
+	// negates the y and z ones to turn it upright. offset + scale is then the lower end on those axes.
+	const float4 a = mMesh.quantization.positionOffset, b = a + mMesh.quantization.positionScale;
+	const Bounds box = { { std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z) }, { std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z) } };
+	mDrawBounds.resize(mDrawCount);
+
+	for (uint32_t i = 0; i < mDrawCount; i++)
+		mDrawBounds.set(i, box);
+
+	mVisibleDraws.resize(mDrawBounds.size());
+	mVisibleDraws.resize(cullBoxes(extractFrustum(matrix_identity_float4x4), mDrawBounds, mVisibleDraws.data()));
+
+	mCullStats.visible = mVisibleDraws.size();
+	mCullStats.culled = mDrawBounds.size() - mVisibleDraws.size();
+	mCullStats.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Vertices and indices go through the staging ring and a single copy submission fills both device
+// local buffers. The copy is waited on, so the space is free again once the current slot comes back
+// around. Meshes bigger than what's left in the ring get a staging buffer of their own.
+MeshBuffers AtomCore::uploadMesh(const PackedVertex* vertices, uint32_t vertexCount, const void* indices, uint32_t indexCount, IndexFormat indexFormat, const MeshQuantization& quantization) {
+	MeshBuffers buffers;
+	buffers.quantization = quantization;
+	buffers.indexCount = indexCount;
+	buffers.indexType = indexFormat == IndexFormat::UInt16 ? vk::IndexType::eUint16 : vk::IndexType::eUint32;
+
+	const vk::DeviceSize vertexBytes = static_cast<vk::DeviceSize>(vertexCount) * sizeof(PackedVertex);
+	const vk::DeviceSize indexBytes = static_cast<vk::DeviceSize>(indexCount) * (indexFormat == IndexFormat::UInt16 ? sizeof(uint16_t) : sizeof(uint32_t));
+
+	StagingAllocation staging = mStagingRing.tryAllocate(vertexBytes + indexBytes, 4);
+	Allocation stagingAllocation;
+
+	if (!staging.mapped) {
+		auto stagingInfo = vk::BufferCreateInfo();
+		stagingInfo.setSize(vertexBytes + indexBytes);
+		stagingInfo.setUsage(vk::BufferUsageFlagBits::eTransferSrc);
+		stagingInfo.setSharingMode(vk::SharingMode::eExclusive);
+
+		staging.buffer = mAllocator.createBuffer(stagingInfo, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent, stagingAllocation);
+		staging.mapped = stagingAllocation.mapped;
+	}
+
+	memcpy(staging.mapped, vertices, static_cast<size_t>(vertexBytes));
+	memcpy(static_cast<uint8_t*>(staging.mapped) + vertexBytes, indices, static_cast<size_t>(indexBytes));
+
+	auto vertexInfo = vk::BufferCreateInfo();
+	vertexInfo.setSize(vertexBytes);
+	vertexInfo.setUsage(vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer);
+	vertexInfo.setSharingMode(vk::SharingMode::eExclusive);
+	buffers.vertexBuffer = mAllocator.createBuffer(vertexInfo, vk::MemoryPropertyFlagBits::eDeviceLocal, buffers.vertexAllocation);
+
+	auto indexInfo = vk::BufferCreateInfo();
+	indexInfo.setSize(indexBytes);
+	indexInfo.setUsage(vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer);
+	indexInfo.setSharingMode(vk::SharingMode::eExclusive);
+	buffers.indexBuffer = mAllocator.createBuffer(indexInfo, vk::MemoryPropertyFlagBits::eDeviceLocal, buffers.indexAllocation);
+
+	auto cmd = beginOneTimeCommands();
+
+	const vk::BufferCopy vertexCopy = { staging.offset, 0, vertexBytes };
+	const vk::BufferCopy indexCopy = { staging.offset + vertexBytes, 0, indexBytes };
+	cmd.copyBuffer(staging.buffer, buffers.vertexBuffer, 1, &vertexCopy);
+	cmd.copyBuffer(staging.buffer, buffers.indexBuffer, 1, &indexCopy);
+
+	endOneTimeCommands(cmd);
+
+	if (staging.buffer != mStagingRing.buffer())
+		mAllocator.destroyBuffer(staging.buffer, stagingAllocation);
+
+	return buffers;
+}
+
+void AtomCore::destroyMesh(const MeshBuffers& mesh) {
+	mAllocator.destroyBuffer(mesh.vertexBuffer, mesh.vertexAllocation);
+	mAllocator.destroyBuffer(mesh.indexBuffer, mesh.indexAllocation);
+}
+
+// Rebuilds the swapchain and everything sized to it without draining the queue. The old swapchain,
+// its views and framebuffers are retired and freed once the frames recorded against them and its
+// presents are done.
+// Returns false while the window is minimized, there is nothing to render to.
+bool AtomCore::recreateSwapchain() {
+	const auto support = querySwapChainSupport(mPhysicalDevice);
+	const auto extent = chooseSwapExtent(support.capabilities);
+
+	if (extent.width == 0 || extent.height == 0)
+		return false;
+
+	RetiredSwapchain retired;
+	retired.swapchain = mSwapchain;
+	retired.imageViews = std::move(mSwapchainImageViews);
+	retired.framebuffers = std::move(mSwapchainFramebuffers);
+	retired.retiredAtFrame = mFrameNumber;
+
+	mRetiredSwapchains.push_back(std::move(retired));
+
+	createSwagChain();
+
+	// Size dependent attachments (depth, MSAA) go here once the renderer has them.
+	createImageViews();
+	createFramebuffers();
+
+	mImagesInFlight.assign(mSwapchainImages.size(), vk::Fence());
+	mSwapchainDirty = false;
+
+	return true;
 }
 
+// Frame n waits on the fences of frame n - mFramesInFlight, so by frame retiredAtFrame + mFramesInFlight - 1
+// every frame submitted before the swapchain was retired has been waited on. The render fence says
+// nothing about the presents queued after it though, a swapchain can't be destroyed under those. With
+// present fences they were waited on along with the render fences. Without, the swapchain is kept
+// until a newer one has presented and that frame's fence has been waited on, by which point the
+// presentation engine has moved past the old swapchain's images.
+void AtomCore::releaseRetiredSwapchains(bool force) {
+	auto it = mRetiredSwapchains.begin();
+
+	while (it != mRetiredSwapchains.end()) {
+		const bool done = mSwapchainMaintenance1
+			? mFrameNumber + 1 >= it->retiredAtFrame + mFramesInFlight
+			: it->newPresentFrame != UINT64_MAX && mFrameNumber >= it->newPresentFrame + mFramesInFlight;
+
+		if (!force && !done) {
+			++it;
+			continue;
+		}
+
+		for (const auto fb : it->framebuffers)
+			mLogicalDevice.destroyFramebuffer(fb);
+
+		for (const auto iv : it->imageViews)
+			mLogicalDevice.destroyImageView(iv);
+
+		mLogicalDevice.destroySwapchainKHR(it->swapchain);
+
+		it = mRetiredSwapchains.erase(it);
+	}
+}
+
+// Only waits on the fence of the slot about to be reused, so the CPU records frame N+1
+// while the GPU is still busy with frame N.
 void AtomCore::drawFrame() {
-	mLogicalDevice.waitForFences(1, &mInFlightF, vk::True, UINT64_MAX);
-	mLogicalDevice.resetFences(1, &mInFlightF);
+	auto& frame = mFrames[mCurrentFrame];
+
+	mLogicalDevice.waitForFences(1, &frame.inFlightF, vk::True, UINT64_MAX);
+
+	// Before releaseRetiredSwapchains, a retired swapchain may still have this slot's present pending.
+	if (frame.presentPending) {
+		mLogicalDevice.waitForFences(1, &frame.presentF, vk::True, UINT64_MAX);
+		mLogicalDevice.resetFences(1, &frame.presentF);
+		frame.presentPending = false;
+	}
+
+	// The GPU is done with everything this slot uploaded last time around.
+	mStagingRing.beginFrame(mCurrentFrame);
 
 	uint32_t imageIndex;
-	mLogicalDevice.acquireNextImageKHR(mSwapchain, UINT64_MAX, mImageAvailableS, VK_NULL_HANDLE, &imageIndex);
-	// vkAcquireNextImageKHR(mLogicalDevice, mSwapchain, UINT64_MAX, mImageAvailableS, VK_NULL_HANDLE, &imageIndex);
 
-	mCommandBuffer.reset();
-	// vkResetCommandBuffer(mCommandBuffer, 0);
+	if (mHeadless) {
+		imageIndex = mOffscreenIndex;
+		mOffscreenIndex = (mOffscreenIndex + 1) % static_cast<uint32_t>(mSwapchainImages.size());
+	} else {
+		releaseRetiredSwapchains(false);
+
+		if (mSwapchainDirty && !recreateSwapchain())
+			return;
+
+		const auto ar = mLogicalDevice.acquireNextImageKHR(mSwapchain, UINT64_MAX, frame.imageAvailableS, VK_NULL_HANDLE, &imageIndex);
+
+		// Fence is still signaled, the slot is simply tried again next frame.
+		if (ar == vk::Result::eErrorOutOfDateKHR) {
+			mSwapchainDirty = true;
+			return;
+		}
+
+		// Suboptimal still acquired an image and signals the semaphore, draw this one and rebuild after.
+		if (ar == vk::Result::eSuboptimalKHR)
+			mSwapchainDirty = true;
+		else if (ar != vk::Result::eSuccess)
+			throw std::runtime_error("Failed to acquire swap chain image.\n");
+	}
 
-	recordCommandBuffer(mCommandBuffer, imageIndex);
+	// The swapchain can hand back an image an older slot is still rendering to.
+	if (mImagesInFlight[imageIndex])
+		mLogicalDevice.waitForFences(1, &mImagesInFlight[imageIndex], vk::True, UINT64_MAX);
 
-	VkSubmitInfo subInfo = {};
-	subInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	mImagesInFlight[imageIndex] = frame.inFlightF;
 
-	VkSemaphore waitS[] = { mImageAvailableS };
-	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-	subInfo.waitSemaphoreCount = 1;
-	subInfo.pWaitSemaphores = waitS;
-	subInfo.pWaitDstStageMask = waitStages;
-	subInfo.commandBufferCount = 1;
-	subInfo.pCommandBuffers = &mCommandBuffer;
+	mLogicalDevice.resetFences(1, &frame.inFlightF);
 
-	VkSemaphore signalS[] = { mRenderFinishedS };
-	subInfo.signalSemaphoreCount = 1;
-	subInfo.pSignalSemaphores = signalS;
+	// Resets the slot's pools whole, the fence above says the GPU is done with their buffers.
+	const vk::CommandBuffer commandBuffer = mRecorder.beginFrame(mCurrentFrame);
 
-	if (vkQueueSubmit(mGraphicsQueue, 1, &subInfo, mInFlightF) != VK_SUCCESS)
+	cullDraws();
+
+	const auto recordStart = std::chrono::steady_clock::now();
+	recordCommandBuffer(commandBuffer, imageIndex);
+	mRecordMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - recordStart).count();
+
+	vk::PipelineStageFlags waitStages[] = { vk::PipelineStageFlagBits::eColorAttachmentOutput };
+
+	auto subInfo = vk::SubmitInfo();
+	subInfo.setWaitSemaphoreCount(mHeadless ? 0 : 1);
+	subInfo.setPWaitSemaphores(&frame.imageAvailableS);
+	subInfo.setPWaitDstStageMask(waitStages);
+	subInfo.setCommandBufferCount(1);
+	subInfo.setPCommandBuffers(&commandBuffer);
+	subInfo.setSignalSemaphoreCount(mHeadless ? 0 : 1);
+	subInfo.setPSignalSemaphores(&frame.renderFinishedS);
+
+	if (mGraphicsQueue.submit(1, &subInfo, frame.inFlightF) != vk::Result::eSuccess)
 		throw std::runtime_error("Failed to submit draw command buffer.\n");
 
-	VkPresentInfoKHR presentInfo = {};
-	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
-	presentInfo.waitSemaphoreCount = 1;
-	presentInfo.pWaitSemaphores = signalS;
-	presentInfo.swapchainCount = 1;
-	presentInfo.pSwapchains = &mSwapchain;
-	presentInfo.pImageIndices = &imageIndex;
-	presentInfo.pResults = nullptr;
+	mLastImageIndex = imageIndex;
+	mCurrentFrame = (mCurrentFrame + 1) % mFramesInFlight;
+	mFrameNumber++;
+
+	// Nothing to present to.
+	if (mHeadless)
+		return;
+
+	auto presentInfo = vk::PresentInfoKHR();
+	presentInfo.setWaitSemaphoreCount(1);
+	presentInfo.setPWaitSemaphores(&frame.renderFinishedS);
+	presentInfo.setSwapchainCount(1);
+	presentInfo.setPSwapchains(&mSwapchain);
+	presentInfo.setPImageIndices(&imageIndex);
+
+	auto presentFence = vk::SwapchainPresentFenceInfoEXT();
 
-	vkQueuePresentKHR(mPresentQueue, &presentInfo);
+	if (mSwapchainMaintenance1) {
+		presentFence.setSwapchainCount(1);
+		presentFence.setPFences(&frame.presentF);
+		presentInfo.setPNext(&presentFence);
+	}
+
+	const auto pr = mPresentQueue.presentKHR(presentInfo);
+
+	// Out of date presents still count as queued, their fence is signalled all the same.
+	if (pr == vk::Result::eSuccess || pr == vk::Result::eSuboptimalKHR || pr == vk::Result::eErrorOutOfDateKHR)
+		frame.presentPending = mSwapchainMaintenance1;
+
+	// The newest swapchain showed this frame, the ones retired before it wait for its fence.
+	if (pr == vk::Result::eSuccess || pr == vk::Result::eSuboptimalKHR)
+		for (auto& retired : mRetiredSwapchains)
+			if (retired.newPresentFrame == UINT64_MAX)
+				retired.newPresentFrame = mFrameNumber - 1;
+
+	if (pr == vk::Result::eErrorOutOfDateKHR || pr == vk::Result::eSuboptimalKHR)
+		mSwapchainDirty = true;
+	else if (pr != vk::Result::eSuccess)
+		throw std::runtime_error("Failed to present swap chain image.\n");
 }
 
 
@@ -516,6 +937,10 @@ bool AtomCore::isDeviceGucci(vk::PhysicalDevice device) const {
 
 	const auto extensionSupported = checkDeviceExtensionSupport(device);
 
+	// No surface to present to, any device with a graphics queue will do.
+	if (mHeadless)
+		return indices.isComplete() && extensionSupported;
+
 	bool swapChainGucci = false;
 
 	if (extensionSupported) {
@@ -543,6 +968,17 @@ QueueFamilyIndices AtomCore::findQueueFamilies(vk::PhysicalDevice device) const
 		if (property.queueFlags & vk::QueueFlagBits::eGraphics)
 			indices.graphicsFamily = i;
 
+		// Headless never presents, so the graphics queue doubles as the present queue.
+		if (mHeadless) {
+			if (indices.graphicsFamily.has_value()) {
+				indices.presentFamily = indices.graphicsFamily;
+				break;
+			}
+
+			i++;
+			continue;
+		}
+
 		vkGetPhysicalDeviceSurfaceSupportKHR(device, i, mSurface, &presentSupport);
 
 		if (presentSupport)
@@ -570,22 +1006,16 @@ SwapChainSupportDetails AtomCore::querySwapChainSupport(vk::PhysicalDevice devic
 }
 
 
-std::vector<char> AtomCore::readFile(const std::string& filename) {
-	std::ifstream file(filename, std::ios::ate | std::ios::binary);
+std::vector<char> AtomCore::readFile(const std::string& filename) const {
+	AssetFile file;
 
-	if (!file.is_open()) {
+	if (!mFiles.open(filename, file)) {
 		throw std::runtime_error("Failed to open file: " + filename);
 	}
 
-	size_t fileSize = (size_t)file.tellg();
-	std::vector<char> buffer(fileSize);
-
-	file.seekg(0);
-	file.read(buffer.data(), static_cast<std::streamsize>(fileSize));
+	const auto* data = reinterpret_cast<const char*>(file.data());
 
-	file.close();
-
-	return buffer;
+	return { data, data + file.size() };
 }
 
 
@@ -602,10 +1032,12 @@ vk::ShaderModule AtomCore::createShaderModule(const std::vector<char>& code) con
 	return shaderModule;
 }
 
+// The draws are split over the recording threads, each range into a secondary buffer of its own
+// (recordDraws), and the primary only runs the render pass and executes them in draw order.
 void AtomCore::recordCommandBuffer(vk::CommandBuffer commandBuffer, uint32_t imageIndex) {
 	auto beginInfo = vk::CommandBufferBeginInfo();
 	// beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO; sType set by constructor in HPP impl
-	beginInfo.setFlags({});
+	beginInfo.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
 
 	if (commandBuffer.begin(&beginInfo) != vk::Result::eSuccess)
 		throw std::runtime_error("Failed to begin recording command buffer.\n");
@@ -619,7 +1051,27 @@ void AtomCore::recordCommandBuffer(vk::CommandBuffer commandBuffer, uint32_t ima
 	rpInfo.clearValueCount = 1;
 	rpInfo.pClearValues = &clearColor;
 
-	commandBuffer.beginRenderPass(&rpInfo, vk::SubpassContents::eInline);
+	commandBuffer.beginRenderPass(&rpInfo, vk::SubpassContents::eSecondaryCommandBuffers);
+
+	auto inheritance = vk::CommandBufferInheritanceInfo();
+	inheritance.setRenderPass(mRenderPass);
+	inheritance.setSubpass(0);
+	inheritance.setFramebuffer(mSwapchainFramebuffers[imageIndex]);
+
+	const auto& secondaries = mRecorder.recordSecondaries(inheritance, mVisibleDraws.size(), MIN_DRAWS_PER_RECORDING_THREAD,
+		[this](vk::CommandBuffer buffer, size_t begin, size_t end) { recordDraws(buffer, begin, end); });
+
+	if (!secondaries.empty())
+		commandBuffer.executeCommands(static_cast<uint32_t>(secondaries.size()), secondaries.data());
+
+	commandBuffer.endRenderPass();
+
+	if (commandBuffer.end() != vk::Result::eSuccess)
+		throw std::runtime_error("Failed to record command buffer.\n");
+}
+
+// Secondary buffers inherit no state, every one binds the pipeline and mesh itself.
+void AtomCore::recordDraws(vk::CommandBuffer commandBuffer, size_t begin, size_t end) const {
 	commandBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, mGraphicsPipeline);
 
 	vk::Viewport viewport = {
@@ -640,12 +1092,14 @@ void AtomCore::recordCommandBuffer(vk::CommandBuffer commandBuffer, uint32_t ima
 
 	commandBuffer.setScissor(0, 1, &scissor);
 
-	commandBuffer.draw(3, 0, 1, 0);
+	const vk::DeviceSize vertexOffset = 0;
+	commandBuffer.bindVertexBuffers(0, 1, &mMesh.vertexBuffer, &vertexOffset);
+	commandBuffer.bindIndexBuffer(mMesh.indexBuffer, 0, mMesh.indexType);
+	commandBuffer.pushConstants(mPipelineLayout, vk::ShaderStageFlagBits::eVertex, 0, sizeof(MeshQuantization), &mMesh.quantization);
 
-	commandBuffer.endRenderPass();
-
-	if (commandBuffer.end() != vk::Result::eSuccess)
-		throw std::runtime_error("Failed to record command buffer.\n");
+	// Every draw is the one mesh for now.
+	for (size_t i = begin; i < end; i++)
+		commandBuffer.drawIndexed(mMesh.indexCount, 1, 0, 0, 0);
 }
 
 
@@ -713,7 +1167,8 @@ bool AtomCore::checkDeviceExtensionSupport(vk::PhysicalDevice device) const {
 	if (availableExtensions.result != vk::Result::eSuccess)
 		throw std::runtime_error("Could not enumerateDeviceExtensionProperties");
 
-	std::set<std::string> requiredExtensions(mDeviceExtensions.begin(), mDeviceExtensions.end());
+	const auto deviceExtensions = getRequiredDeviceExtensions();
+	std::set<std::string> requiredExtensions(deviceExtensions.begin(), deviceExtensions.end());
 
 	for (const auto& e: availableExtensions.value)
 		requiredExtensions.erase(e.extensionName);
@@ -723,10 +1178,15 @@ bool AtomCore::checkDeviceExtensionSupport(vk::PhysicalDevice device) const {
 
 
 std::vector<const char*> AtomCore::getRequiredExtensions() const {
-	uint32_t glfwExtCount = 0;
-	const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtCount);
+	std::vector<const char*> extensions;
 
-	std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtCount);
+	// Headless runs without glfw, so no surface extensions either.
+	if (!mHeadless) {
+		uint32_t glfwExtCount = 0;
+		const char** glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtCount);
+
+		extensions.assign(glfwExtensions, glfwExtensions + glfwExtCount);
+	}
 
 	if (mEnableValidationLayers) {
 		extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
@@ -736,6 +1196,52 @@ std::vector<const char*> AtomCore::getRequiredExtensions() const {
 }
 
 
+std::vector<const char*> AtomCore::getRequiredDeviceExtensions() const {
+	if (mHeadless)
+		return {};
+
+	return mDeviceExtensions;
+}
+
+
+vk::CommandBuffer AtomCore::beginOneTimeCommands() const {
+	auto allocInfo = vk::CommandBufferAllocateInfo();
+	allocInfo.setCommandPool(mCommandPool);
+	allocInfo.setLevel(vk::CommandBufferLevel::ePrimary);
+	allocInfo.setCommandBufferCount(1);
+
+	auto ar = mLogicalDevice.allocateCommandBuffers(allocInfo);
+	if (ar.result != vk::Result::eSuccess)
+		throw std::runtime_error("Failed to allocate one time command buffer.\n");
+
+	auto commandBuffer = ar.value[0];
+
+	auto beginInfo = vk::CommandBufferBeginInfo();
+	beginInfo.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+
+	if (commandBuffer.begin(beginInfo) != vk::Result::eSuccess)
+		throw std::runtime_error("Failed to begin one time command buffer.\n");
+
+	return commandBuffer;
+}
+
+
+void AtomCore::endOneTimeCommands(vk::CommandBuffer commandBuffer) const {
+	if (commandBuffer.end() != vk::Result::eSuccess)
+		throw std::runtime_error("Failed to record one time command buffer.\n");
+
+	auto subInfo = vk::SubmitInfo();
+	subInfo.setCommandBufferCount(1);
+	subInfo.setPCommandBuffers(&commandBuffer);
+
+	if (mGraphicsQueue.submit(1, &subInfo, VK_NULL_HANDLE) != vk::Result::eSuccess)
+		throw std::runtime_error("Failed to submit one time command buffer.\n");
+
+	mGraphicsQueue.waitIdle();
+	mLogicalDevice.freeCommandBuffers(mCommandPool, 1, &commandBuffer);
+}
+
+
 VKAPI_ATTR VkBool32 VKAPI_CALL AtomCore::debugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT severity, 
 								 VkDebugUtilsMessageTypeFlagsEXT type, 
 								 const VkDebugUtilsMessengerCallbackDataEXT* pCallbackData, 
@@ -811,41 +1317,212 @@ void AtomCore::initWindow() {
 	glfwInit();
 
 	glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-	glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+	glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
 
 	mWindow = glfwCreateWindow(mViewSize.x, mViewSize.y, "Atom3D", nullptr, nullptr);
+
+	glfwSetWindowUserPointer(mWindow, this);
+	glfwSetFramebufferSizeCallback(mWindow, framebufferResizeCallback);
+}
+
+// Drivers don't have to report out of date on a resize, so flag it ourselves.
+void AtomCore::framebufferResizeCallback(GLFWwindow* window, int width, int height) {
+	auto core = static_cast<AtomCore*>(glfwGetWindowUserPointer(window));
+
+	core->mViewSize = { width, height };
+	core->mSwapchainDirty = true;
 }
 
 void AtomCore::run() {
+	if (mHeadless)
+		throw std::runtime_error("No window to run in headless mode, use renderFrames().\n");
+
 	while (!glfwWindowShouldClose(mWindow)) {
 		glfwPollEvents();
+
+		// Minimized, sleep until something happens instead of spinning.
+		int w = 0, h = 0;
+		glfwGetFramebufferSize(mWindow, &w, &h);
+
+		if (w == 0 || h == 0) {
+			glfwWaitEvents();
+			continue;
+		}
+
+		drawFrame();
+	}
+}
+
+// Frame time is measured between drawFrame() returns, which is what the CPU sees once the
+// ring is full and drawFrame() blocks on the oldest slot.
+FrameStats AtomCore::renderFrames(uint32_t frameCount) {
+	std::vector<double> frameTimes;
+	frameTimes.reserve(frameCount);
+
+	const auto start = std::chrono::steady_clock::now();
+	auto last = start;
+	double cullMs = 0, recordMs = 0;
+
+	for (uint32_t i = 0; i < frameCount; i++) {
 		drawFrame();
+		cullMs += mCullStats.ms;
+		recordMs += mRecordMs;
+
+		const auto now = std::chrono::steady_clock::now();
+		frameTimes.push_back(std::chrono::duration<double, std::milli>(now - last).count());
+		last = now;
 	}
+
+	mLogicalDevice.waitIdle();
+
+	FrameStats stats;
+	stats.frameCount = frameCount;
+	stats.totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	if (frameCount == 0)
+		return stats;
+
+	std::sort(frameTimes.begin(), frameTimes.end());
+
+	stats.avgMs = stats.totalMs / frameCount;
+	stats.minMs = frameTimes.front();
+	stats.maxMs = frameTimes.back();
+	stats.p99Ms = frameTimes[std::min<size_t>(frameTimes.size() - 1, frameTimes.size() * 99 / 100)];
+	stats.avgCullMs = cullMs / frameCount;
+	stats.visibleDraws = mCullStats.visible;
+	stats.culledDraws = mCullStats.culled;
+	stats.avgRecordMs = recordMs / frameCount;
+	stats.recordingThreads = mRecorder.threadCount();
+
+	std::cout << "Rendered " << frameCount << " frames (" << mFramesInFlight << " in flight) in " << stats.totalMs << " ms, "
+	          << stats.avgMs << " ms avg, " << stats.p99Ms << " ms p99 (" << 1000.0 / stats.avgMs << " fps)" << std::endl;
+	std::cout << "Culling: " << stats.visibleDraws << " visible, " << stats.culledDraws << " culled, " << stats.avgCullMs << " ms avg" << std::endl;
+	std::cout << "Recording: " << stats.recordingThreads << " threads, " << stats.avgRecordMs << " ms avg" << std::endl;
+
+	return stats;
+}
+
+// Copies the last rendered image into a host visible buffer. The render pass already left it in
+// TRANSFER_SRC_OPTIMAL, the barrier only makes the color writes visible to the copy.
+std::vector<uint8_t> AtomCore::readbackFrame() {
+	if (!mHeadless)
+		throw std::runtime_error("readbackFrame() is only supported in headless mode.\n");
+
+	mLogicalDevice.waitIdle();
+
+	const vk::DeviceSize size = static_cast<vk::DeviceSize>(mSwapchainExtent.width) * mSwapchainExtent.height * 4;
+
+	auto bufferInfo = vk::BufferCreateInfo();
+	bufferInfo.setSize(size);
+	bufferInfo.setUsage(vk::BufferUsageFlagBits::eTransferDst);
+	bufferInfo.setSharingMode(vk::SharingMode::eExclusive);
+
+	Allocation allocation;
+	const auto buffer = mAllocator.createBuffer(bufferInfo, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent, allocation);
+
+	auto cmd = beginOneTimeCommands();
+
+	auto barrier = vk::ImageMemoryBarrier();
+	barrier.setSrcAccessMask(vk::AccessFlagBits::eColorAttachmentWrite);
+	barrier.setDstAccessMask(vk::AccessFlagBits::eTransferRead);
+	barrier.setOldLayout(vk::ImageLayout::eTransferSrcOptimal);
+	barrier.setNewLayout(vk::ImageLayout::eTransferSrcOptimal);
+	barrier.setSrcQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+	barrier.setDstQueueFamilyIndex(VK_QUEUE_FAMILY_IGNORED);
+	barrier.setImage(mSwapchainImages[mLastImageIndex]);
+	barrier.setSubresourceRange({ vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 });
+
+	cmd.pipelineBarrier(vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::PipelineStageFlagBits::eTransfer,
+	                    {}, 0, nullptr, 0, nullptr, 1, &barrier);
+
+	auto region = vk::BufferImageCopy();
+	region.setBufferOffset(0);
+	region.setBufferRowLength(0);
+	region.setBufferImageHeight(0);
+	region.setImageSubresource({ vk::ImageAspectFlagBits::eColor, 0, 0, 1 });
+	region.setImageOffset({ 0, 0, 0 });
+	region.setImageExtent({ mSwapchainExtent.width, mSwapchainExtent.height, 1 });
+
+	cmd.copyImageToBuffer(mSwapchainImages[mLastImageIndex], vk::ImageLayout::eTransferSrcOptimal, buffer, 1, &region);
+
+	endOneTimeCommands(cmd);
+
+	std::vector<uint8_t> pixels(static_cast<size_t>(size));
+	memcpy(pixels.data(), allocation.mapped, pixels.size());
+
+	mAllocator.destroyBuffer(buffer, allocation);
+
+	return pixels;
+}
+
+// Binary PPM, dead simple to diff in image regression tests.
+void AtomCore::saveFrame(const std::string& filename) {
+	const auto pixels = readbackFrame();
+
+	std::ofstream file(filename, std::ios::binary);
+
+	if (!file.is_open())
+		throw std::runtime_error("Failed to open file: " + filename);
+
+	file << "P6\n" << mSwapchainExtent.width << " " << mSwapchainExtent.height << "\n255\n";
+
+	for (size_t i = 0; i < pixels.size(); i += 4)
+		file.write(reinterpret_cast<const char*>(&pixels[i]), 3);
 }
 
-void AtomCore::cleanup() const {
+void AtomCore::cleanup() {
+	mLogicalDevice.waitIdle();
+
+	mStagingRing.report();
+	mStagingRing.destroy(mAllocator);
+
+	destroyMesh(mMesh);
+
+	for (const auto& frame : mFrames)
+		if (frame.presentPending)
+			mLogicalDevice.waitForFences(1, &frame.presentF, vk::True, UINT64_MAX);
+
+	releaseRetiredSwapchains(true);
+
 	if (mEnableValidationLayers)
 		mInstance.destroyDebugUtilsMessengerEXT(mDebugMessenger);
 
-	mCommandBuffer.reset();
-	mLogicalDevice.freeCommandBuffers(mCommandPool, 1, &mCommandBuffer);
+	for (const auto& frame : mFrames) {
+		mLogicalDevice.destroySemaphore(frame.imageAvailableS);
+		mLogicalDevice.destroySemaphore(frame.renderFinishedS);
+		mLogicalDevice.destroyFence(frame.inFlightF);
+		mLogicalDevice.destroyFence(frame.presentF);
+	}
 
+	mRecorder.destroy();
 	mLogicalDevice.destroyCommandPool(mCommandPool);
-	mLogicalDevice.destroySemaphore(mImageAvailableS);
-	mLogicalDevice.destroySemaphore(mRenderFinishedS);
-	mLogicalDevice.destroyFence(mInFlightF);
 
 	for (const auto fb : mSwapchainFramebuffers)
 		mLogicalDevice.destroyFramebuffer(fb);
 
 	mLogicalDevice.destroyRenderPass(mRenderPass);
 	mLogicalDevice.destroyPipeline(mGraphicsPipeline);
+
+	mPipelineCache.save();
+	mPipelineCache.destroy();
 	mLogicalDevice.destroyPipelineLayout(mPipelineLayout);
 
 	for (const auto iv : mSwapchainImageViews)
 		mLogicalDevice.destroyImageView(iv);
 
+	if (mHeadless) {
+		for (size_t i = 0; i < mSwapchainImages.size(); i++)
+			mAllocator.destroyImage(mSwapchainImages[i], mOffscreenAllocations[i]);
+
+		mAllocator.destroy();
+		mLogicalDevice.destroy();
+		mInstance.destroy();
+
+		return;
+	}
+
 	mLogicalDevice.destroySwapchainKHR(mSwapchain);
+	mAllocator.destroy();
 	mLogicalDevice.destroy();
 
 	mInstance.destroySurfaceKHR(mSurface);
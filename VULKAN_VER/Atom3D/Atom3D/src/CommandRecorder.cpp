@@ -0,0 +1,130 @@
+// ReSharper disable CppInconsistentNaming
+#include "CommandRecorder.hpp"
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace Atom {
+
+void CommandRecorder::init(vk::Device device, uint32_t queueFamily, uint32_t frameSlots, uint32_t threadCount) {
+	mDevice = device;
+	mThreadCount = std::max(threadCount, 1u);
+	mSlots.resize(frameSlots);
+
+	// Transient and no RESET_COMMAND_BUFFER, buffers only come back through resetting the whole pool.
+	auto poolInfo = vk::CommandPoolCreateInfo();
+	poolInfo.setFlags(vk::CommandPoolCreateFlagBits::eTransient);
+	poolInfo.setQueueFamilyIndex(queueFamily);
+
+	for (auto& slot : mSlots) {
+		if (mDevice.createCommandPool(&poolInfo, nullptr, &slot.primaryPool) != vk::Result::eSuccess)
+			throw std::runtime_error("Failed to create command pool.\n");
+
+		auto allocInfo = vk::CommandBufferAllocateInfo();
+		allocInfo.setCommandPool(slot.primaryPool);
+		allocInfo.setLevel(vk::CommandBufferLevel::ePrimary);
+		allocInfo.setCommandBufferCount(1);
+
+		auto ar = mDevice.allocateCommandBuffers(allocInfo);
+		if (ar.result != vk::Result::eSuccess)
+			throw std::runtime_error("Failed to create command buffers.\n");
+
+		slot.primary = ar.value[0];
+		slot.ranges.resize(mThreadCount);
+
+		for (auto& range : slot.ranges)
+			if (mDevice.createCommandPool(&poolInfo, nullptr, &range.pool) != vk::Result::eSuccess)
+				throw std::runtime_error("Failed to create command pool.\n");
+	}
+}
+
+void CommandRecorder::destroy() {
+	// Destroying a pool frees the buffers allocated from it.
+	for (const auto& slot : mSlots) {
+		mDevice.destroyCommandPool(slot.primaryPool);
+
+		for (const auto& range : slot.ranges)
+			mDevice.destroyCommandPool(range.pool);
+	}
+
+	mSlots.clear();
+}
+
+vk::CommandBuffer CommandRecorder::beginFrame(uint32_t slot) {
+	auto& frame = mSlots[slot];
+	mCurrentSlot = slot;
+
+	if (mDevice.resetCommandPool(frame.primaryPool, {}) != vk::Result::eSuccess)
+		throw std::runtime_error("Failed to reset command pool.\n");
+
+	for (auto& range : frame.ranges) {
+		if (mDevice.resetCommandPool(range.pool, {}) != vk::Result::eSuccess)
+			throw std::runtime_error("Failed to reset command pool.\n");
+
+		range.used = 0;
+	}
+
+	return frame.primary;
+}
+
+const std::vector<vk::CommandBuffer>& CommandRecorder::recordSecondaries(const vk::CommandBufferInheritanceInfo& inheritance, size_t count, size_t minPerThread,
+	const std::function<void(vk::CommandBuffer, size_t, size_t)>& record) {
+	auto& frame = mSlots[mCurrentSlot];
+	mRecorded.clear();
+
+	if (count == 0)
+		return mRecorded;
+
+	minPerThread = std::max<size_t>(minPerThread, 1);
+	const size_t ranges = std::clamp<size_t>(count / minPerThread, 1, mThreadCount);
+
+	// Allocated here, before any job touches the pools, so the jobs only record. Range r records
+	// from pool r only, whichever job thread runs it.
+	for (size_t r = 0; r < ranges; r++) {
+		auto& pool = frame.ranges[r];
+
+		if (pool.used == pool.buffers.size()) {
+			auto allocInfo = vk::CommandBufferAllocateInfo();
+			allocInfo.setCommandPool(pool.pool);
+			allocInfo.setLevel(vk::CommandBufferLevel::eSecondary);
+			allocInfo.setCommandBufferCount(1);
+
+			auto ar = mDevice.allocateCommandBuffers(allocInfo);
+			if (ar.result != vk::Result::eSuccess)
+				throw std::runtime_error("Failed to create command buffers.\n");
+
+			pool.buffers.push_back(ar.value[0]);
+		}
+
+		mRecorded.push_back(pool.buffers[pool.used++]);
+	}
+
+	auto beginInfo = vk::CommandBufferBeginInfo();
+	beginInfo.setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue);
+	beginInfo.setPInheritanceInfo(&inheritance);
+
+	// Jobs can't throw, failures are thrown from here once they're all done.
+	mResults.assign(ranges, vk::Result::eSuccess);
+
+	jobSystem().parallelFor(ranges, 1, [&](size_t first, size_t last) {
+		for (size_t r = first; r < last; r++) {
+			const vk::CommandBuffer buffer = mRecorded[r];
+			mResults[r] = buffer.begin(&beginInfo);
+
+			if (mResults[r] != vk::Result::eSuccess)
+				continue;
+
+			record(buffer, count * r / ranges, count * (r + 1) / ranges);
+			mResults[r] = buffer.end();
+		}
+	});
+
+	for (const vk::Result result : mResults)
+		if (result != vk::Result::eSuccess)
+			throw std::runtime_error("Failed to record secondary command buffer.\n");
+
+	return mRecorded;
+}
+
+}
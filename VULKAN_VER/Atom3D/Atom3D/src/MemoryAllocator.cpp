@@ -0,0 +1,367 @@
+#include "MemoryAllocator.hpp"
+
+#include <iostream>
+#include <algorithm>
+
+namespace Atom {
+
+void MemoryAllocator::init(vk::PhysicalDevice physicalDevice, vk::Device device, vk::DeviceSize blockSize) {
+	mDevice = device;
+	mMemoryProperties = physicalDevice.getMemoryProperties();
+	mMaxAllocations = physicalDevice.getProperties().limits.maxMemoryAllocationCount;
+	mBlockSize = blockSize;
+	mTypes.resize(mMemoryProperties.memoryTypeCount);
+}
+
+
+void MemoryAllocator::destroy() {
+	std::lock_guard lock(mMutex);
+
+	for (uint32_t t = 0; t < mTypes.size(); t++) {
+		for (auto& block : mTypes[t].blocks) {
+			if (!block.tlsf)
+				continue;
+
+			if (!block.tlsf->empty())
+				std::cerr << "MemoryAllocator: " << block.tlsf->allocationCount() << " allocations leaked in memory type " << t << "\n";
+
+			mDevice.freeMemory(block.memory);
+		}
+
+		if (mTypes[t].dedicatedCount)
+			std::cerr << "MemoryAllocator: " << mTypes[t].dedicatedCount << " dedicated allocations leaked in memory type " << t << "\n";
+	}
+
+	mTypes.clear();
+}
+
+
+uint32_t MemoryAllocator::findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties) const {
+	for (uint32_t i = 0; i < mMemoryProperties.memoryTypeCount; i++) {
+		if ((typeFilter & (1u << i)) && (mMemoryProperties.memoryTypes[i].propertyFlags & properties) == properties)
+			return i;
+	}
+
+	throw std::runtime_error("Failed to find suitable memory type.\n");
+}
+
+
+Allocation MemoryAllocator::allocate(const vk::MemoryRequirements& requirements, vk::MemoryPropertyFlags properties, bool linear, bool dedicated) {
+	const auto type = findMemoryType(requirements.memoryTypeBits, properties);
+
+	// Anything over half a block would waste most of one, give it its own memory.
+	if (dedicated || requirements.size > mBlockSize / 2)
+		return allocateDedicated(requirements.size, type, nullptr);
+
+	Allocation allocation;
+
+	if (allocateFromBlocks(requirements, type, linear, allocation))
+		return allocation;
+
+	// Out of room for another block, a smaller dedicated allocation may still fit.
+	return allocateDedicated(requirements.size, type, nullptr);
+}
+
+
+Allocation MemoryAllocator::allocateDedicated(vk::DeviceSize size, uint32_t type, const vk::MemoryDedicatedAllocateInfo* dedicatedInfo) {
+	auto allocInfo = vk::MemoryAllocateInfo();
+	allocInfo.setAllocationSize(size);
+	allocInfo.setMemoryTypeIndex(type);
+	allocInfo.setPNext(dedicatedInfo);
+
+	auto mr = mDevice.allocateMemory(allocInfo);
+	if (mr.result != vk::Result::eSuccess)
+		throw std::runtime_error("Failed to allocate dedicated memory.\n");
+
+	Allocation allocation;
+	allocation.memory = mr.value;
+	allocation.offset = 0;
+	allocation.size = size;
+	allocation.memoryType = type;
+	allocation.mapped = mapIfHostVisible(allocation.memory, type, VK_WHOLE_SIZE);
+
+	std::lock_guard lock(mMutex);
+	mTypes[type].dedicatedCount++;
+	mTypes[type].dedicatedBytes += size;
+	mDeviceAllocationCount++;
+
+	return allocation;
+}
+
+
+bool MemoryAllocator::allocateFromBlocks(const vk::MemoryRequirements& requirements, uint32_t type, bool linear, Allocation& allocation) {
+	std::lock_guard lock(mMutex);
+
+	auto& blocks = mTypes[type].blocks;
+	Tlsf::Allocation range;
+
+	auto tryBlock = [&](uint32_t b) {
+		auto& block = blocks[b];
+
+		if (!block.tlsf || block.linear != linear || !block.tlsf->allocate(requirements.size, requirements.alignment, range))
+			return false;
+
+		allocation.memory = block.memory;
+		allocation.offset = range.offset;
+		allocation.size = range.size;
+		allocation.mapped = block.mapped ? static_cast<char*>(block.mapped) + range.offset : nullptr;
+		allocation.memoryType = type;
+		allocation.block = b;
+		allocation.node = range.node;
+		allocation.linear = linear;
+
+		return true;
+	};
+
+	for (uint32_t b = 0; b < blocks.size(); b++) {
+		if (tryBlock(b))
+			return true;
+	}
+
+	const auto b = createBlock(type, linear, requirements);
+
+	if (b == UINT32_MAX)
+		return false;
+
+	if (tryBlock(b))
+		return true;
+
+	// Nothing else will ever land in a block made for this request, don't keep it around empty.
+	mDevice.freeMemory(blocks[b].memory);
+	blocks[b] = Block();
+	mDeviceAllocationCount--;
+
+	return false;
+}
+
+
+uint32_t MemoryAllocator::createBlock(uint32_t type, bool linear, const vk::MemoryRequirements& requirements) {
+	if (mDeviceAllocationCount >= mMaxAllocations)
+		return UINT32_MAX;
+
+	// What Tlsf::allocate searches for, doubled so its size class rounding still lands in the block.
+	const auto minAlloc = Tlsf::MIN_ALLOC;
+	const auto rounded = (std::max<vk::DeviceSize>(requirements.size, 1) + minAlloc - 1) / minAlloc * minAlloc;
+	const auto needed = 2 * (rounded + std::max(requirements.alignment, minAlloc) - minAlloc);
+
+	// Never let one block eat more than an eighth of a small heap, unless the request needs it.
+	const auto heapSize = mMemoryProperties.memoryHeaps[mMemoryProperties.memoryTypes[type].heapIndex].size;
+	const auto capped = std::min(mBlockSize, std::max<vk::DeviceSize>(heapSize / 8, minAlloc * 64));
+	const auto size = std::max(capped, needed);
+
+	auto allocInfo = vk::MemoryAllocateInfo();
+	allocInfo.setAllocationSize(size);
+	allocInfo.setMemoryTypeIndex(type);
+
+	auto mr = mDevice.allocateMemory(allocInfo);
+	if (mr.result != vk::Result::eSuccess)
+		return UINT32_MAX;
+
+	Block block;
+	block.memory = mr.value;
+	block.tlsf = std::make_unique<Tlsf>(size);
+	block.mapped = mapIfHostVisible(block.memory, type, VK_WHOLE_SIZE);
+	block.linear = linear;
+
+	mDeviceAllocationCount++;
+
+	auto& blocks = mTypes[type].blocks;
+
+	for (uint32_t b = 0; b < blocks.size(); b++) {
+		if (!blocks[b].tlsf) {
+			blocks[b] = std::move(block);
+			return b;
+		}
+	}
+
+	blocks.push_back(std::move(block));
+
+	return static_cast<uint32_t>(blocks.size() - 1);
+}
+
+
+void* MemoryAllocator::mapIfHostVisible(vk::DeviceMemory memory, uint32_t type, vk::DeviceSize size) const {
+	if (!(mMemoryProperties.memoryTypes[type].propertyFlags & vk::MemoryPropertyFlagBits::eHostVisible))
+		return nullptr;
+
+	auto mapped = mDevice.mapMemory(memory, 0, size);
+	if (mapped.result != vk::Result::eSuccess)
+		throw std::runtime_error("Failed to map memory.\n");
+
+	return mapped.value;
+}
+
+
+void MemoryAllocator::free(const Allocation& allocation) {
+	if (!allocation.memory)
+		return;
+
+	std::lock_guard lock(mMutex);
+
+	auto& type = mTypes[allocation.memoryType];
+
+	if (allocation.dedicated()) {
+		mDevice.freeMemory(allocation.memory);
+
+		type.dedicatedCount--;
+		type.dedicatedBytes -= allocation.size;
+		mDeviceAllocationCount--;
+
+		return;
+	}
+
+	auto& block = type.blocks[allocation.block];
+	block.tlsf->free(allocation.node);
+
+	if (!block.tlsf->empty())
+		return;
+
+	// Keep one empty block per kind around so alloc/free churn doesn't hit the driver.
+	const auto emptyCount = std::count_if(type.blocks.begin(), type.blocks.end(), [&](const Block& b) {
+		return b.tlsf && b.linear == block.linear && b.tlsf->empty();
+	});
+
+	if (emptyCount > 1) {
+		mDevice.freeMemory(block.memory);
+		block = Block();
+		mDeviceAllocationCount--;
+	}
+}
+
+
+vk::Buffer MemoryAllocator::createBuffer(const vk::BufferCreateInfo& info, vk::MemoryPropertyFlags properties, Allocation& allocation) {
+	auto br = mDevice.createBuffer(info);
+	if (br.result != vk::Result::eSuccess)
+		throw std::runtime_error("Failed to create buffer.\n");
+
+	const auto buffer = br.value;
+
+	auto reqInfo = vk::BufferMemoryRequirementsInfo2();
+	reqInfo.setBuffer(buffer);
+
+	vk::MemoryDedicatedRequirements dedicatedReq;
+	vk::MemoryRequirements2 requirements;
+	requirements.pNext = &dedicatedReq;
+
+	mDevice.getBufferMemoryRequirements2(&reqInfo, &requirements);
+
+	if (dedicatedReq.prefersDedicatedAllocation || dedicatedReq.requiresDedicatedAllocation) {
+		auto dedicatedInfo = vk::MemoryDedicatedAllocateInfo();
+		dedicatedInfo.setBuffer(buffer);
+
+		allocation = allocateDedicated(requirements.memoryRequirements.size,
+		                               findMemoryType(requirements.memoryRequirements.memoryTypeBits, properties), &dedicatedInfo);
+	} else {
+		allocation = allocate(requirements.memoryRequirements, properties, true);
+	}
+
+	if (mDevice.bindBufferMemory(buffer, allocation.memory, allocation.offset) != vk::Result::eSuccess)
+		throw std::runtime_error("Failed to bind buffer memory.\n");
+
+	return buffer;
+}
+
+
+vk::Image MemoryAllocator::createImage(const vk::ImageCreateInfo& info, vk::MemoryPropertyFlags properties, Allocation& allocation) {
+	auto ir = mDevice.createImage(info);
+	if (ir.result != vk::Result::eSuccess)
+		throw std::runtime_error("Failed to create image.\n");
+
+	const auto image = ir.value;
+
+	auto reqInfo = vk::ImageMemoryRequirementsInfo2();
+	reqInfo.setImage(image);
+
+	vk::MemoryDedicatedRequirements dedicatedReq;
+	vk::MemoryRequirements2 requirements;
+	requirements.pNext = &dedicatedReq;
+
+	mDevice.getImageMemoryRequirements2(&reqInfo, &requirements);
+
+	const bool linear = info.tiling == vk::ImageTiling::eLinear;
+
+	// Render targets and other big images usually prefer dedicated memory, so do large ones regardless.
+	if (dedicatedReq.prefersDedicatedAllocation || dedicatedReq.requiresDedicatedAllocation ||
+		requirements.memoryRequirements.size > mBlockSize / 2) {
+		auto dedicatedInfo = vk::MemoryDedicatedAllocateInfo();
+		dedicatedInfo.setImage(image);
+
+		allocation = allocateDedicated(requirements.memoryRequirements.size,
+		                               findMemoryType(requirements.memoryRequirements.memoryTypeBits, properties), &dedicatedInfo);
+	} else {
+		allocation = allocate(requirements.memoryRequirements, properties, linear);
+	}
+
+	if (mDevice.bindImageMemory(image, allocation.memory, allocation.offset) != vk::Result::eSuccess)
+		throw std::runtime_error("Failed to bind image memory.\n");
+
+	return image;
+}
+
+
+void MemoryAllocator::destroyBuffer(vk::Buffer buffer, const Allocation& allocation) {
+	mDevice.destroyBuffer(buffer);
+	free(allocation);
+}
+
+
+void MemoryAllocator::destroyImage(vk::Image image, const Allocation& allocation) {
+	mDevice.destroyImage(image);
+	free(allocation);
+}
+
+
+AllocatorStats MemoryAllocator::stats() const {
+	std::lock_guard lock(mMutex);
+
+	AllocatorStats stats;
+	stats.memoryTypes.resize(mTypes.size());
+	stats.deviceAllocationCount = mDeviceAllocationCount;
+	stats.maxDeviceAllocations = mMaxAllocations;
+
+	for (size_t t = 0; t < mTypes.size(); t++) {
+		auto& s = stats.memoryTypes[t];
+
+		for (const auto& block : mTypes[t].blocks) {
+			if (!block.tlsf)
+				continue;
+
+			s.blockCount++;
+			s.allocationCount += block.tlsf->allocationCount();
+			s.freeRangeCount += block.tlsf->freeRangeCount();
+			s.blockBytes += block.tlsf->size();
+			s.usedBytes += block.tlsf->usedBytes();
+			s.largestFreeRange = std::max(s.largestFreeRange, block.tlsf->largestFreeRange());
+		}
+
+		s.dedicatedCount = mTypes[t].dedicatedCount;
+		s.dedicatedBytes = mTypes[t].dedicatedBytes;
+	}
+
+	return stats;
+}
+
+
+void MemoryAllocator::report() const {
+	const auto s = stats();
+	constexpr double mb = 1024.0 * 1024.0;
+
+	std::cout << "GPU memory: " << s.deviceAllocationCount << " / " << s.maxDeviceAllocations << " device allocations\n";
+
+	for (size_t t = 0; t < s.memoryTypes.size(); t++) {
+		const auto& m = s.memoryTypes[t];
+
+		if (!m.blockCount && !m.dedicatedCount)
+			continue;
+
+		std::cout << "\ttype " << t << " " << vk::to_string(mMemoryProperties.memoryTypes[t].propertyFlags) << ": "
+		          << m.allocationCount << " allocations in " << m.blockCount << " blocks, "
+		          << m.usedBytes / mb << " / " << m.blockBytes / mb << " MB used, "
+		          << m.freeRangeCount << " free ranges, " << m.fragmentation() * 100.0 << "% fragmented, "
+		          << m.dedicatedCount << " dedicated (" << m.dedicatedBytes / mb << " MB)\n";
+	}
+
+	std::cout << std::flush;
+}
+
+}
@@ -0,0 +1,213 @@
+#include "PipelineCache.hpp"
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#endif
+
+#include <filesystem>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+
+namespace Atom {
+
+void PipelineCache::init(vk::PhysicalDevice physicalDevice, vk::Device device, const std::string& directory) {
+	mDevice = device;
+	mProperties = physicalDevice.getProperties();
+
+	// Key the file by device UUID so multi GPU machines keep one cache per device.
+	std::ostringstream name;
+	name << directory << "/pipeline_cache_";
+
+	for (uint8_t b : mProperties.pipelineCacheUUID)
+		name << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(b);
+
+	name << ".bin";
+	mPath = name.str();
+
+	const auto initialData = loadFile();
+	mStats.loaded = !initialData.empty();
+
+	auto createInfo = vk::PipelineCacheCreateInfo();
+	createInfo.setInitialDataSize(initialData.size());
+	createInfo.setPInitialData(initialData.empty() ? nullptr : initialData.data());
+
+	auto cr = mDevice.createPipelineCache(createInfo);
+
+	// A blob the driver rejects anyway is not fatal, just start cold.
+	if (cr.result != vk::Result::eSuccess && mStats.loaded) {
+		mStats.loaded = false;
+		createInfo.setInitialDataSize(0);
+		createInfo.setPInitialData(nullptr);
+		cr = mDevice.createPipelineCache(createInfo);
+	}
+
+	if (cr.result != vk::Result::eSuccess)
+		throw std::runtime_error("Failed to create pipeline cache.\n");
+
+	mCache = cr.value;
+}
+
+
+std::vector<uint8_t> PipelineCache::loadFile() {
+	std::ifstream file(mPath, std::ios::ate | std::ios::binary);
+
+	if (!file.is_open())
+		return {};
+
+	const auto fileSize = static_cast<size_t>(file.tellg());
+
+	if (fileSize < sizeof(PipelineCacheHeader))
+		return {};
+
+	PipelineCacheHeader header = {};
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(&header), sizeof header);
+
+	if (header.magic != CACHE_MAGIC || header.version != CACHE_VERSION ||
+		header.vendorID != mProperties.vendorID || header.deviceID != mProperties.deviceID ||
+		header.driverVersion != mProperties.driverVersion ||
+		memcmp(header.uuid, mProperties.pipelineCacheUUID.data(), VK_UUID_SIZE) != 0 ||
+		header.dataSize != fileSize - sizeof header) {
+		std::cout << "Pipeline cache " << mPath << " is stale, rebuilding.\n";
+		return {};
+	}
+
+	std::vector<uint8_t> data(header.dataSize);
+	file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+	if (!file || hash(data.data(), data.size()) != header.dataHash) {
+		std::cout << "Pipeline cache " << mPath << " is corrupt, rebuilding.\n";
+		return {};
+	}
+
+	// Only the header knows the cold time, stash it for the report.
+	mStats.coldCompileMs = header.coldCompileMs;
+
+	return data;
+}
+
+
+void PipelineCache::save() const {
+	auto dr = mDevice.getPipelineCacheData(mCache);
+
+	if (dr.result != vk::Result::eSuccess || dr.value.empty()) {
+		std::cerr << "Failed to get pipeline cache data.\n";
+		return;
+	}
+
+	PipelineCacheHeader header = {};
+	header.magic = CACHE_MAGIC;
+	header.version = CACHE_VERSION;
+	header.vendorID = mProperties.vendorID;
+	header.deviceID = mProperties.deviceID;
+	header.driverVersion = mProperties.driverVersion;
+	memcpy(header.uuid, mProperties.pipelineCacheUUID.data(), VK_UUID_SIZE);
+	header.dataSize = dr.value.size();
+	header.dataHash = hash(dr.value.data(), dr.value.size());
+	header.coldCompileMs = mStats.misses > 0 ? mStats.createMs : mStats.coldCompileMs;
+
+	// Write to a temp file and rename so a crash mid write never leaves a truncated cache behind.
+	const auto tmpPath = mPath + ".tmp";
+	{
+		std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+
+		if (!file.is_open()) {
+			std::cerr << "Failed to open file: " << tmpPath << "\n";
+			return;
+		}
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof header);
+		file.write(reinterpret_cast<const char*>(dr.value.data()), static_cast<std::streamsize>(dr.value.size()));
+		file.close();
+
+		if (!file) {
+			std::cerr << "Failed to write file: " << tmpPath << "\n";
+			std::remove(tmpPath.c_str());
+			return;
+		}
+	}
+
+	// Renamed straight over the old cache, which replaces it atomically, so there is always one file
+	// to load. Only if that fails is the old one removed first.
+#ifdef _WIN32
+	const bool replaced = MoveFileExW(std::filesystem::path(tmpPath).c_str(), std::filesystem::path(mPath).c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	const bool replaced = std::rename(tmpPath.c_str(), mPath.c_str()) == 0;
+#endif
+
+	if (!replaced) {
+		std::remove(mPath.c_str());
+
+		if (std::rename(tmpPath.c_str(), mPath.c_str()) != 0) {
+			std::cerr << "Failed to replace file: " << mPath << "\n";
+			std::remove(tmpPath.c_str());
+		}
+	}
+}
+
+
+void PipelineCache::destroy() const {
+	mDevice.destroyPipelineCache(mCache);
+}
+
+
+// Hit/miss comes from VK_EXT_pipeline_creation_feedback, core since 1.3.
+vk::Pipeline PipelineCache::createGraphicsPipeline(const vk::GraphicsPipelineCreateInfo& info) {
+	vk::PipelineCreationFeedback pipelineFeedback;
+
+	auto feedbackInfo = vk::PipelineCreationFeedbackCreateInfo();
+	feedbackInfo.setPPipelineCreationFeedback(&pipelineFeedback);
+	feedbackInfo.setPipelineStageCreationFeedbackCount(0);
+	feedbackInfo.setPNext(info.pNext);
+
+	auto pipeInfo = info;
+	pipeInfo.setPNext(&feedbackInfo);
+
+	const auto start = std::chrono::steady_clock::now();
+	auto pr = mDevice.createGraphicsPipeline(mCache, pipeInfo);
+	mStats.createMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	if (pr.result != vk::Result::eSuccess)
+		throw std::runtime_error("Failed to create graphics pipeline.\n");
+
+	if ((pipelineFeedback.flags & vk::PipelineCreationFeedbackFlagBits::eValid) &&
+		(pipelineFeedback.flags & vk::PipelineCreationFeedbackFlagBits::eApplicationPipelineCacheHit))
+		mStats.hits++;
+	else
+		mStats.misses++;
+
+	return pr.value;
+}
+
+
+void PipelineCache::report() const {
+	std::cout << "Pipeline cache: " << (mStats.loaded ? "loaded " : "cold start, ") << mPath << "\n"
+	          << "\t" << mStats.hits << " hits, " << mStats.misses << " misses, " << mStats.createMs << " ms creating pipelines";
+
+	if (mStats.loaded && mStats.coldCompileMs > 0)
+		std::cout << " (" << mStats.coldCompileMs - mStats.createMs << " ms saved vs cold)";
+
+	std::cout << std::endl;
+}
+
+
+// FNV-1a, only guards against truncated or half written files.
+uint64_t PipelineCache::hash(const uint8_t* data, size_t size) {
+	uint64_t h = 14695981039346656037ull;
+
+	for (size_t i = 0; i < size; i++) {
+		h ^= data[i];
+		h *= 1099511628211ull;
+	}
+
+	return h;
+}
+
+}
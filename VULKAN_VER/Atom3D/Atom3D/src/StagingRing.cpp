@@ -0,0 +1,74 @@
+#include "StagingRing.hpp"
+
+#include <iostream>
+#include <algorithm>
+
+namespace Atom {
+
+void StagingRing::init(MemoryAllocator& allocator, vk::PhysicalDevice physicalDevice, vk::DeviceSize size, uint32_t frameSlots) {
+	const auto limits = physicalDevice.getProperties().limits;
+
+	mUniformAlignment = limits.minUniformBufferOffsetAlignment;
+	mCopyAlignment = std::max<vk::DeviceSize>(limits.optimalBufferCopyOffsetAlignment, 16);
+
+	auto bufferInfo = vk::BufferCreateInfo();
+	bufferInfo.setSize(size);
+	bufferInfo.setUsage(vk::BufferUsageFlagBits::eUniformBuffer | vk::BufferUsageFlagBits::eStorageBuffer |
+	                    vk::BufferUsageFlagBits::eVertexBuffer | vk::BufferUsageFlagBits::eIndexBuffer |
+	                    vk::BufferUsageFlagBits::eTransferSrc);
+	bufferInfo.setSharingMode(vk::SharingMode::eExclusive);
+
+	mBuffer = allocator.createBuffer(bufferInfo, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent, mAllocation);
+
+	if (!mAllocation.mapped)
+		throw std::runtime_error("Staging ring memory is not host visible.\n");
+
+	mRing.init(size, frameSlots);
+}
+
+
+void StagingRing::destroy(MemoryAllocator& allocator) {
+	allocator.destroyBuffer(mBuffer, mAllocation);
+}
+
+
+void StagingRing::beginFrame(uint32_t slot) {
+	mRing.beginFrame(slot);
+}
+
+
+StagingAllocation StagingRing::allocate(vk::DeviceSize size, vk::DeviceSize alignment) {
+	const auto a = tryAllocate(size, alignment);
+
+	if (!a.mapped)
+		throw std::runtime_error("Staging ring out of space, increase STAGING_RING_SIZE.\n");
+
+	return a;
+}
+
+
+StagingAllocation StagingRing::tryAllocate(vk::DeviceSize size, vk::DeviceSize alignment) {
+	// Covers copies into any texel format as well as plain buffer data.
+	alignment = std::max(alignment, mCopyAlignment);
+
+	const auto offset = mRing.allocate(size, alignment);
+
+	StagingAllocation a;
+
+	if (offset == RingAllocator::INVALID_OFFSET)
+		return a;
+
+	a.buffer = mBuffer;
+	a.offset = offset;
+	a.size = size;
+	a.mapped = static_cast<char*>(mAllocation.mapped) + offset;
+
+	return a;
+}
+
+
+void StagingRing::report() const {
+	std::cout << "Staging ring: " << mRing.capacity() / 1024 << " KB, peak " << mRing.peakFrameBytes() / 1024.0 << " KB per frame" << std::endl;
+}
+
+}
@@ -0,0 +1,281 @@
+#include "Tlsf.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Atom {
+
+namespace {
+
+uint32_t findLastSet(uint64_t v) {
+#ifdef _MSC_VER
+	unsigned long i;
+	_BitScanReverse64(&i, v);
+	return static_cast<uint32_t>(i);
+#else
+	return 63u - static_cast<uint32_t>(__builtin_clzll(v));
+#endif
+}
+
+uint32_t findFirstSet(uint64_t v) {
+#ifdef _MSC_VER
+	unsigned long i;
+	_BitScanForward64(&i, v);
+	return static_cast<uint32_t>(i);
+#else
+	return static_cast<uint32_t>(__builtin_ctzll(v));
+#endif
+}
+
+uint64_t alignUp(uint64_t v, uint64_t alignment) {
+	return (v + alignment - 1) & ~(alignment - 1);
+}
+
+}
+
+Tlsf::Tlsf(uint64_t size) : mSize(size - size % MIN_ALLOC) {
+	for (auto& fl : mHeads)
+		std::fill(std::begin(fl), std::end(fl), INVALID_NODE);
+
+	const auto node = newNode();
+	mNodes[node] = { 0, mSize, INVALID_NODE, INVALID_NODE, INVALID_NODE, INVALID_NODE, true };
+	insertFree(node);
+}
+
+
+void Tlsf::mapping(uint64_t size, uint32_t& fl, uint32_t& sl) {
+	fl = findLastSet(size);
+	sl = static_cast<uint32_t>(size >> (fl - SL_LOG2)) & (SL_COUNT - 1);
+}
+
+
+// Rounds up to the next list start so every range in the found list is big enough.
+void Tlsf::mappingSearch(uint64_t size, uint32_t& fl, uint32_t& sl) {
+	const uint64_t round = (1ull << (findLastSet(size) - SL_LOG2)) - 1;
+	mapping(size + round, fl, sl);
+}
+
+
+uint32_t Tlsf::findSuitable(uint32_t& fl, uint32_t& sl) const {
+	if (fl >= FL_COUNT)
+		return INVALID_NODE;
+
+	uint32_t slMap = mSlBitmap[fl] & (~0u << sl);
+
+	if (!slMap) {
+		const uint64_t flMap = fl + 1 < 64 ? mFlBitmap & (~0ull << (fl + 1)) : 0;
+
+		if (!flMap)
+			return INVALID_NODE;
+
+		fl = findFirstSet(flMap);
+		slMap = mSlBitmap[fl];
+	}
+
+	sl = findFirstSet(slMap);
+
+	return mHeads[fl][sl];
+}
+
+
+bool Tlsf::allocate(uint64_t size, uint64_t alignment, Allocation& out) {
+	size = alignUp(std::max<uint64_t>(size, 1), MIN_ALLOC);
+	alignment = std::max(alignment, MIN_ALLOC);
+
+	// Over-ask by the worst case padding so whatever list we land in is guaranteed to fit.
+	const uint64_t searchSize = size + alignment - MIN_ALLOC;
+
+	if (searchSize > mSize)
+		return false;
+
+	uint32_t fl, sl;
+	mappingSearch(searchSize, fl, sl);
+
+	const auto index = findSuitable(fl, sl);
+
+	if (index == INVALID_NODE)
+		return false;
+
+	removeFree(index);
+
+	const uint64_t padding = alignUp(mNodes[index].offset, alignment) - mNodes[index].offset;
+
+	// Leading padding becomes its own free range. The physical predecessor is never free
+	// (it would have been merged), so there is nothing to merge into.
+	if (padding > 0) {
+		const auto pad = newNode();
+		auto& node = mNodes[index];
+
+		mNodes[pad] = { node.offset, padding, node.prevPhys, index, INVALID_NODE, INVALID_NODE, true };
+
+		if (node.prevPhys != INVALID_NODE)
+			mNodes[node.prevPhys].nextPhys = pad;
+
+		node.prevPhys = pad;
+		node.offset += padding;
+		node.size -= padding;
+
+		insertFree(pad);
+	}
+
+	// Trailing remainder goes back to the free lists.
+	if (mNodes[index].size - size >= MIN_ALLOC) {
+		const auto rest = newNode();
+		auto& node = mNodes[index];
+
+		mNodes[rest] = { node.offset + size, node.size - size, index, node.nextPhys, INVALID_NODE, INVALID_NODE, true };
+
+		if (node.nextPhys != INVALID_NODE)
+			mNodes[node.nextPhys].prevPhys = rest;
+
+		node.nextPhys = rest;
+		node.size = size;
+
+		insertFree(rest);
+	}
+
+	auto& node = mNodes[index];
+	node.free = false;
+
+	mUsed += node.size;
+	mAllocationCount++;
+
+	out.offset = node.offset;
+	out.size = node.size;
+	out.node = index;
+
+	return true;
+}
+
+
+void Tlsf::free(uint32_t index) {
+	assert(index < mNodes.size() && !mNodes[index].free);
+
+	mUsed -= mNodes[index].size;
+	mAllocationCount--;
+	mNodes[index].free = true;
+
+	// Merge with the physical neighbours.
+	const auto prev = mNodes[index].prevPhys;
+
+	if (prev != INVALID_NODE && mNodes[prev].free) {
+		removeFree(prev);
+
+		mNodes[prev].size += mNodes[index].size;
+		mNodes[prev].nextPhys = mNodes[index].nextPhys;
+
+		if (mNodes[index].nextPhys != INVALID_NODE)
+			mNodes[mNodes[index].nextPhys].prevPhys = prev;
+
+		releaseNode(index);
+		index = prev;
+	}
+
+	const auto next = mNodes[index].nextPhys;
+
+	if (next != INVALID_NODE && mNodes[next].free) {
+		removeFree(next);
+
+		mNodes[index].size += mNodes[next].size;
+		mNodes[index].nextPhys = mNodes[next].nextPhys;
+
+		if (mNodes[next].nextPhys != INVALID_NODE)
+			mNodes[mNodes[next].nextPhys].prevPhys = index;
+
+		releaseNode(next);
+	}
+
+	insertFree(index);
+}
+
+
+uint64_t Tlsf::largestFreeRange() const {
+	if (!mFlBitmap)
+		return 0;
+
+	// Any node in the highest non-empty list is within one sub-list of the largest, walk that list.
+	const auto fl = findLastSet(mFlBitmap);
+	const auto sl = findLastSet(mSlBitmap[fl]);
+
+	uint64_t largest = 0;
+
+	for (auto i = mHeads[fl][sl]; i != INVALID_NODE; i = mNodes[i].nextFree)
+		largest = std::max(largest, mNodes[i].size);
+
+	return largest;
+}
+
+
+uint32_t Tlsf::freeRangeCount() const {
+	uint32_t count = 0;
+
+	for (const auto& fl : mHeads)
+		for (const auto head : fl)
+			for (auto i = head; i != INVALID_NODE; i = mNodes[i].nextFree)
+				count++;
+
+	return count;
+}
+
+
+uint32_t Tlsf::newNode() {
+	if (!mSpareNodes.empty()) {
+		const auto i = mSpareNodes.back();
+		mSpareNodes.pop_back();
+		return i;
+	}
+
+	mNodes.push_back({});
+	return static_cast<uint32_t>(mNodes.size() - 1);
+}
+
+
+void Tlsf::releaseNode(uint32_t index) {
+	mSpareNodes.push_back(index);
+}
+
+
+void Tlsf::insertFree(uint32_t index) {
+	uint32_t fl, sl;
+	mapping(mNodes[index].size, fl, sl);
+
+	auto& node = mNodes[index];
+	node.prevFree = INVALID_NODE;
+	node.nextFree = mHeads[fl][sl];
+
+	if (node.nextFree != INVALID_NODE)
+		mNodes[node.nextFree].prevFree = index;
+
+	mHeads[fl][sl] = index;
+	mFlBitmap |= 1ull << fl;
+	mSlBitmap[fl] |= 1u << sl;
+}
+
+
+void Tlsf::removeFree(uint32_t index) {
+	uint32_t fl, sl;
+	mapping(mNodes[index].size, fl, sl);
+
+	const auto& node = mNodes[index];
+
+	if (node.prevFree != INVALID_NODE)
+		mNodes[node.prevFree].nextFree = node.nextFree;
+	else
+		mHeads[fl][sl] = node.nextFree;
+
+	if (node.nextFree != INVALID_NODE)
+		mNodes[node.nextFree].prevFree = node.prevFree;
+
+	if (mHeads[fl][sl] == INVALID_NODE) {
+		mSlBitmap[fl] &= ~(1u << sl);
+
+		if (!mSlBitmap[fl])
+			mFlBitmap &= ~(1ull << fl);
+	}
+}
+
+}
@@ -1,16 +1,135 @@
 #include <iostream>
+#include <cstring>
+#include <string>
 
 #include "AtomCore.hpp"
 //#include "Tutorialbase.cpp"
 
-int main() {
-	Atom::AtomCore engine;
+// Frame time with 1, 2 and 3 frames in flight, each on a fresh engine so nothing is shared.
+static int benchFramesInFlight(bool headless, uint32_t frameCount) {
+	std::vector<Atom::FrameStats> results;
+
+	for (uint32_t framesInFlight = 1; framesInFlight <= 3; framesInFlight++) {
+		Atom::AtomCore engine;
+
+		engine.setHeadless(headless);
+		engine.setFramesInFlight(framesInFlight);
+		engine.init();
+
+		try {
+			engine.renderFrames(frameCount / 10); // Warm up
+			results.push_back(engine.renderFrames(frameCount));
+		} catch (const std::exception& e) {
+			std::cerr << e.what() << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		engine.cleanup();
+	}
+
+	std::cout << "\nframes in flight | avg ms | min ms | p99 ms | max ms | fps\n";
+
+	for (size_t i = 0; i < results.size(); i++) {
+		const auto& r = results[i];
+		std::cout << "                " << i + 1 << " | " << r.avgMs << " | " << r.minMs << " | " << r.p99Ms
+		          << " | " << r.maxMs << " | " << 1000.0 / r.avgMs << "\n";
+	}
+
+	std::cout << std::flush;
+
+	return 0;
+}
+
+// CPU time recording 50k draws on 1 to 64 threads (each range into its own secondary buffer), each
+// thread count on a fresh engine.
+static int benchRecording(bool headless, uint32_t frameCount) {
+	std::vector<Atom::FrameStats> results;
+
+	for (const uint32_t threads : { 1u, 2u, 4u, 8u, 16u, 32u, 64u }) {
+		Atom::AtomCore engine;
+
+		engine.setHeadless(headless);
+		engine.setDrawCount(50000);
+		engine.setRecordingThreads(threads);
+		engine.init();
+
+		try {
+			engine.renderFrames(frameCount / 10); // Warm up
+			results.push_back(engine.renderFrames(frameCount));
+		} catch (const std::exception& e) {
+			std::cerr << e.what() << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		engine.cleanup();
+	}
+
+	std::cout << "\nrecording threads | record ms | speedup | frame ms   (" << Atom::jobSystem().threadCount() << " job threads)\n";
+
+	for (const auto& r : results) {
+		std::cout << "               " << r.recordingThreads << " | " << r.avgRecordMs << " | " << results[0].avgRecordMs / r.avgRecordMs
+		          << "x | " << r.avgMs << "\n";
+	}
+
+	std::cout << std::flush;
+
+	return 0;
+}
+
+int main(int argc, char** argv) {
 	//HelloTriangleApplication app;
 
+	// --headless [--frames N] [--out file.ppm] renders offscreen, e.g. on lavapipe in CI.
+	// --bench compares frame times for 1/2/3 frames in flight.
+	// --bench-recording times recording 50k draws on 1 to 64 threads.
+	// --mesh file.obj|.gltf|.glb draws that instead of the quad.
+	bool headless = false;
+	bool bench = false;
+	bool benchRecord = false;
+	uint32_t frameCount = 1;
+	uint32_t framesInFlight = 2;
+	std::string outFile;
+	std::string meshPath;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--headless") == 0)
+			headless = true;
+		else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+			frameCount = static_cast<uint32_t>(std::stoul(argv[++i]));
+		else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc)
+			outFile = argv[++i];
+		else if (strcmp(argv[i], "--frames-in-flight") == 0 && i + 1 < argc)
+			framesInFlight = static_cast<uint32_t>(std::stoul(argv[++i]));
+		else if (strcmp(argv[i], "--bench") == 0)
+			bench = true;
+		else if (strcmp(argv[i], "--bench-recording") == 0)
+			benchRecord = true;
+		else if (strcmp(argv[i], "--mesh") == 0 && i + 1 < argc)
+			meshPath = argv[++i];
+	}
+
+	if (bench)
+		return benchFramesInFlight(headless, std::max(frameCount, 100u));
+
+	if (benchRecord)
+		return benchRecording(headless, std::max(frameCount, 50u));
+
+	// The benches make engines of their own, this one is only for a normal run.
+	Atom::AtomCore engine;
+	engine.setHeadless(headless);
+	engine.setFramesInFlight(framesInFlight);
+	engine.setMeshPath(meshPath);
 	engine.init();
 
 	try {
-		engine.run();
+		if (headless) {
+			engine.renderFrames(frameCount);
+
+			if (!outFile.empty())
+				engine.saveFrame(outFile);
+		} else {
+			engine.run();
+		}
 		//app.run();
 	} catch (const std::exception& e) {
 		std::cerr << e.what() << std::endl;
@@ -20,4 +139,4 @@ int main() {
 	engine.cleanup();
 
 	return 0;
-}
\ No newline at end of file
+}